@@ -0,0 +1,258 @@
+#pragma once
+#include "Activations.h"
+#include "MatrixKernels.h"
+
+// The arithmetic behind Activations' kernels, shared with code that applies
+// an activation to values it still holds in registers (StaticNetwork's fused
+// layers), so both round exactly alike. Include from .cpp files only: it
+// pulls in <immintrin.h> and stamps out AVX2 and AVX-512 versions with
+// internal linkage.
+
+#ifdef MATRIX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace Activations {
+
+// ---------- Constants shared by the scalar and vector code ----------
+
+// exp(x) = 2^n * e^r with n = round(x / ln 2) and |r| <= ln(2) / 2. ln 2 is
+// split into a short high part and a correction so n * ln 2 is subtracted
+// without losing bits; e^r is a degree-6 polynomial (Cephes expf).
+// The input range keeps 2^n a normal float.
+const float EXP_MIN_INPUT = -87.3f;
+const float EXP_MAX_INPUT = 88.0f;
+const float LOG2E = 1.44269504088896341f;
+const float LN2_HI = 0.693359375f;
+const float LN2_LO = -2.12194440e-4f;
+const float EXP_P0 = 1.9875691500e-4f;
+const float EXP_P1 = 1.3981999507e-3f;
+const float EXP_P2 = 8.3334519073e-3f;
+const float EXP_P3 = 4.1665795894e-2f;
+const float EXP_P4 = 1.6666665459e-1f;
+const float EXP_P5 = 5.0000001201e-1f;
+
+// tanh(x) rounds to +-1 in float beyond this
+const float TANH_LIMIT = 9.0f;
+
+// Sigmoid is tabulated on [-TABLE_RANGE, TABLE_RANGE] (it is within 1.2e-7 of
+// 0 or 1 outside) with TABLE_SCALE entries per unit
+const float TABLE_RANGE = 16.0f;
+const int TABLE_STEPS = 2048;
+const float TABLE_SCALE = TABLE_STEPS / (2.0f * TABLE_RANGE);
+
+// The Table tier's sigmoid values, TABLE_STEPS + 2 entries (built on first use)
+const float* sigmoidTable();
+
+#ifdef MATRIX_KERNELS_X86
+
+// Which vector function a kernel applies
+enum Kernel {
+    SIGMOID_POLYNOMIAL,
+    TANH_POLYNOMIAL,
+    SIGMOID_TABLE,
+    TANH_TABLE,
+    RELU,
+    LEAKY_RELU,
+    HARD_TANH
+};
+
+// Forward kernel for a type in a tier (the Exact tier's sigmoid and tanh
+// have none: they call std::exp / std::tanh per element)
+inline Kernel vectorKernel(Type type, Accuracy tier) {
+    switch (type) {
+        case Type::Sigmoid: return tier == Accuracy::Table ? SIGMOID_TABLE : SIGMOID_POLYNOMIAL;
+        case Type::Tanh: return tier == Accuracy::Table ? TANH_TABLE : TANH_POLYNOMIAL;
+        case Type::ReLU: return RELU;
+        case Type::LeakyReLU: return LEAKY_RELU;
+        case Type::HardTanh: return HARD_TANH;
+    }
+    return SIGMOID_POLYNOMIAL;
+}
+
+// The same algorithms as the scalar code in Activations.cpp, written once
+// against a small set of vector operations (Ops) and stamped out per
+// instruction set. activate<KERNEL> is the forward function; derive<KERNEL>
+// the derivative from the output (the POLYNOMIAL kernels stand for sigmoid
+// and tanh in every tier).
+#define DEFINE_ACTIVATION_MATH(TARGET)                                                                \
+    using V = Ops::V;                                                                                 \
+                                                                                                      \
+    TARGET static inline V expPolynomial(V x) {                                                       \
+        x = Ops::min(Ops::max(x, Ops::set1(EXP_MIN_INPUT)), Ops::set1(EXP_MAX_INPUT));                \
+        V n = Ops::round(Ops::mul(x, Ops::set1(LOG2E)));                                              \
+        V r = Ops::fnmadd(n, Ops::set1(LN2_HI), x);                                                   \
+        r = Ops::fnmadd(n, Ops::set1(LN2_LO), r);                                                     \
+        V p = Ops::set1(EXP_P0);                                                                      \
+        p = Ops::fmadd(p, r, Ops::set1(EXP_P1));                                                      \
+        p = Ops::fmadd(p, r, Ops::set1(EXP_P2));                                                      \
+        p = Ops::fmadd(p, r, Ops::set1(EXP_P3));                                                      \
+        p = Ops::fmadd(p, r, Ops::set1(EXP_P4));                                                      \
+        p = Ops::fmadd(p, r, Ops::set1(EXP_P5));                                                      \
+        p = Ops::fmadd(p, Ops::mul(r, r), Ops::add(r, Ops::set1(1.0f)));                              \
+        return Ops::mul(p, Ops::pow2(n));                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    TARGET static inline V sigmoidLookup(V x, const float* table) {                                   \
+        V range = Ops::set1(TABLE_RANGE);                                                             \
+        V clamped = Ops::min(Ops::max(x, Ops::set1(-TABLE_RANGE)), range);                            \
+        V t = Ops::mul(Ops::add(clamped, range), Ops::set1(TABLE_SCALE));                             \
+        Ops::I i = Ops::truncate(t);                                                                  \
+        V f = Ops::sub(t, Ops::toFloat(i));                                                           \
+        V y0 = Ops::gather(table, i);                                                                 \
+        V y1 = Ops::gather(table + 1, i);                                                             \
+        return Ops::fmadd(f, Ops::sub(y1, y0), y0);                                                   \
+    }                                                                                                 \
+                                                                                                      \
+    template <int KERNEL>                                                                             \
+    TARGET static inline V activate(V x, const float* table) {                                        \
+        V one = Ops::set1(1.0f);                                                                      \
+        V two = Ops::set1(2.0f);                                                                      \
+        switch (KERNEL) {                                                                             \
+            case SIGMOID_POLYNOMIAL:                                                                  \
+                return Ops::div(one, Ops::add(one, expPolynomial(Ops::sub(Ops::set1(0.0f), x))));     \
+            case TANH_POLYNOMIAL: {                                                                   \
+                V limited = Ops::min(Ops::max(x, Ops::set1(-TANH_LIMIT)), Ops::set1(TANH_LIMIT));     \
+                V e = expPolynomial(Ops::mul(two, limited));                                          \
+                return Ops::sub(one, Ops::div(two, Ops::add(e, one)));                                \
+            }                                                                                         \
+            case SIGMOID_TABLE:                                                                       \
+                return sigmoidLookup(x, table);                                                       \
+            case TANH_TABLE:                                                                          \
+                return Ops::sub(Ops::mul(two, sigmoidLookup(Ops::mul(two, x), table)), one);          \
+            case RELU:                                                                                \
+                return Ops::max(x, Ops::set1(0.0f));                                                  \
+            case LEAKY_RELU:                                                                          \
+                return Ops::max(x, Ops::mul(x, Ops::set1(LEAKY_RELU_SLOPE)));                         \
+            default:                                                                                  \
+                return Ops::min(Ops::max(x, Ops::set1(-1.0f)), one);                                  \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    /* Derivatives from the output y, using the same products as derivative() */                     \
+    template <int KERNEL>                                                                             \
+    TARGET static inline V derive(V y) {                                                              \
+        V zero = Ops::set1(0.0f);                                                                     \
+        V one = Ops::set1(1.0f);                                                                      \
+        switch (KERNEL) {                                                                             \
+            case SIGMOID_POLYNOMIAL:                                                                  \
+                return Ops::mul(y, Ops::sub(one, y));                                                 \
+            case TANH_POLYNOMIAL:                                                                     \
+                return Ops::sub(one, Ops::mul(y, y));                                                 \
+            case RELU:                                                                                \
+                return Ops::selectGreater(y, zero, one, zero);                                        \
+            case LEAKY_RELU:                                                                          \
+                return Ops::selectGreater(y, zero, one, Ops::set1(LEAKY_RELU_SLOPE));                 \
+            default: {                                                                                \
+                V magnitude = Ops::max(y, Ops::sub(zero, y));                                         \
+                return Ops::selectGreater(Ops::sub(one, magnitude), zero, one, zero);                 \
+            }                                                                                         \
+        }                                                                                             \
+    }
+
+namespace avx2 {
+
+struct Ops {
+    using V = __m256;
+    using I = __m256i;
+    static const int WIDTH = 8;
+
+    TARGET_AVX2 static V load(const float* p) { return _mm256_loadu_ps(p); }
+    TARGET_AVX2 static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    TARGET_AVX2 static V set1(float value) { return _mm256_set1_ps(value); }
+    TARGET_AVX2 static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    TARGET_AVX2 static V sub(V a, V b) { return _mm256_sub_ps(a, b); }
+    TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    TARGET_AVX2 static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    TARGET_AVX2 static V min(V a, V b) { return _mm256_min_ps(a, b); }
+    TARGET_AVX2 static V max(V a, V b) { return _mm256_max_ps(a, b); }
+    TARGET_AVX2 static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+    TARGET_AVX2 static V fnmadd(V a, V b, V c) { return _mm256_fnmadd_ps(a, b, c); }
+    TARGET_AVX2 static V round(V x) { return _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    TARGET_AVX2 static I truncate(V x) { return _mm256_cvttps_epi32(x); }
+    TARGET_AVX2 static V toFloat(I i) { return _mm256_cvtepi32_ps(i); }
+    TARGET_AVX2 static V gather(const float* table, I i) { return _mm256_i32gather_ps(table, i, 4); }
+    TARGET_AVX2 static V pow2(V n) {
+        I exponent = _mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127));
+        return _mm256_castsi256_ps(_mm256_slli_epi32(exponent, 23));
+    }
+    TARGET_AVX2 static V selectGreater(V a, V b, V then, V otherwise) {
+        return _mm256_blendv_ps(otherwise, then, _mm256_cmp_ps(a, b, _CMP_GT_OQ));
+    }
+    // The first n (1..WIDTH) lanes from / to memory; the other lanes load as zero
+    TARGET_AVX2 static __m256i firstLanes(int n) {
+        return _mm256_cmpgt_epi32(_mm256_set1_epi32(n), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    }
+    TARGET_AVX2 static V loadFirst(const float* p, int n) { return _mm256_maskload_ps(p, firstLanes(n)); }
+    TARGET_AVX2 static void storeFirst(float* p, V v, int n) { _mm256_maskstore_ps(p, firstLanes(n), v); }
+    // Sum of the lanes, added pairwise: half + half, down to one lane
+    TARGET_AVX2 static float sum(V v) {
+        __m128 s = _mm_add_ps(_mm256_castps256_ps128(v), _mm256_extractf128_ps(v, 1));
+        s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+        return _mm_cvtss_f32(_mm_add_ss(s, _mm_movehdup_ps(s)));
+    }
+};
+
+DEFINE_ACTIVATION_MATH(TARGET_AVX2)
+
+}
+
+namespace avx512 {
+
+struct Ops {
+    using V = __m512;
+    using I = __m512i;
+    static const int WIDTH = 16;
+
+    // Zero-masked forms with every lane enabled: same instructions, but they
+    // avoid GCC 12's false -Wmaybe-uninitialized on the plain intrinsics
+    static const __mmask16 ALL = 0xFFFF;
+
+    TARGET_AVX512 static V load(const float* p) { return _mm512_loadu_ps(p); }
+    TARGET_AVX512 static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+    TARGET_AVX512 static V set1(float value) { return _mm512_set1_ps(value); }
+    TARGET_AVX512 static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    TARGET_AVX512 static V sub(V a, V b) { return _mm512_sub_ps(a, b); }
+    TARGET_AVX512 static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    TARGET_AVX512 static V div(V a, V b) { return _mm512_div_ps(a, b); }
+    TARGET_AVX512 static V min(V a, V b) { return _mm512_maskz_min_ps(ALL, a, b); }
+    TARGET_AVX512 static V max(V a, V b) { return _mm512_maskz_max_ps(ALL, a, b); }
+    TARGET_AVX512 static V fmadd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+    TARGET_AVX512 static V fnmadd(V a, V b, V c) { return _mm512_fnmadd_ps(a, b, c); }
+    TARGET_AVX512 static V round(V x) { return _mm512_maskz_roundscale_ps(ALL, x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+    TARGET_AVX512 static I truncate(V x) { return _mm512_maskz_cvttps_epi32(ALL, x); }
+    TARGET_AVX512 static V toFloat(I i) { return _mm512_maskz_cvtepi32_ps(ALL, i); }
+    TARGET_AVX512 static V gather(const float* table, I i) { return _mm512_mask_i32gather_ps(_mm512_setzero_ps(), ALL, i, table, 4); }
+    TARGET_AVX512 static V pow2(V n) {
+        I exponent = _mm512_add_epi32(_mm512_maskz_cvtps_epi32(ALL, n), _mm512_set1_epi32(127));
+        return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(ALL, exponent, 23));
+    }
+    TARGET_AVX512 static V selectGreater(V a, V b, V then, V otherwise) {
+        return _mm512_mask_blend_ps(_mm512_cmp_ps_mask(a, b, _CMP_GT_OQ), otherwise, then);
+    }
+    // The first n (1..WIDTH) lanes from / to memory; the other lanes load as zero
+    TARGET_AVX512 static V loadFirst(const float* p, int n) {
+        return _mm512_maskz_loadu_ps(static_cast<__mmask16>((1u << n) - 1), p);
+    }
+    TARGET_AVX512 static void storeFirst(float* p, V v, int n) {
+        _mm512_mask_storeu_ps(p, static_cast<__mmask16>((1u << n) - 1), v);
+    }
+    // Sum of the lanes, added pairwise: lane l adds lane l + 8, then l + 4, l + 2, l + 1
+    TARGET_AVX512 static float sum(V v) {
+        v = _mm512_add_ps(v, _mm512_maskz_shuffle_f32x4(ALL, v, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm512_add_ps(v, _mm512_maskz_shuffle_f32x4(ALL, v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        v = _mm512_add_ps(v, _mm512_maskz_permute_ps(ALL, v, _MM_SHUFFLE(1, 0, 3, 2)));
+        v = _mm512_add_ps(v, _mm512_maskz_permute_ps(ALL, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        return _mm512_cvtss_f32(v);
+    }
+};
+
+DEFINE_ACTIVATION_MATH(TARGET_AVX512)
+
+}
+
+#undef DEFINE_ACTIVATION_MATH
+
+#endif // MATRIX_KERNELS_X86
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+// Activation functions for network layers, applied to whole rows at once.
+//
+// Every activation has a forward kernel (optionally fused with the bias add)
+// and a derivative kernel written in terms of the activation's output, which
+// is what backpropagation has on hand. Kernels follow the instruction set
+// selected in MatrixKernels (AVX-512 / AVX2 vector code, portable code otherwise).
+//
+// Sigmoid and tanh come in three accuracy tiers. Maximum absolute error
+// against the Exact tier, measured over [-20, 20] (see Benchmark):
+//
+//   Exact       std::exp / std::tanh per element        reference
+//   Polynomial  range-reduced degree-6 exp polynomial     sigmoid 1.2e-7, tanh 1.8e-7
+//   Table       2049-entry sigmoid table, linear interp  sigmoid 3.0e-6, tanh 6.0e-6
+//
+// ReLU, leaky ReLU and hard-tanh are piecewise linear and exact in every tier.
+namespace Activations {
+
+// Stored as integers in model files, so existing values must never change
+enum class Type : int {
+    Sigmoid = 0,
+    Tanh = 1,
+    ReLU = 2,
+    LeakyReLU = 3,
+    HardTanh = 4
+};
+
+const int TYPE_COUNT = 5;
+
+enum class Accuracy {
+    Exact,
+    Polynomial,
+    Table
+};
+
+// Slope of leaky ReLU for negative inputs
+const float LEAKY_RELU_SLOPE = 0.01f;
+
+// values[i] = act(values[i] + bias[i]) in place; bias may be null
+void forward(Type type, float* values, const float* bias, int count);
+
+// forward() on each row of a rows x cols block, with the same bias row for
+// every row. Same results as calling forward() per row, in one pass.
+void forwardRows(Type type, float* values, const float* bias, int rows, int cols);
+
+// gradient[i] *= act'(x), where outputs[i] = act(x) is the forward result
+void backward(Type type, const float* outputs, float* gradient, int count);
+
+// Single-value versions (always the Exact tier)
+float apply(Type type, float x);
+float derivative(Type type, float y);
+
+// Tier used by forward() for sigmoid and tanh (default: Polynomial).
+// Call before starting worker threads.
+Accuracy accuracy();
+void setAccuracy(Accuracy tier);
+
+const char* name(Type type);
+const char* accuracyName(Accuracy tier);
+
+// True when code is the integer value of some Type (for validating model files)
+bool isValid(int code);
+
+}
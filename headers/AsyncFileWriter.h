@@ -0,0 +1,62 @@
+#pragma once
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Background thread that persists files crash-safely off the caller's hot path.
+//
+// Each write produces the complete file under a temporary name next to the
+// target, flushes it to disk (fsync / FlushFileBuffers) and then atomically
+// renames it over the target, so readers and crashes only ever see the old or
+// the new file, never a partial one.
+//
+// Writes to the same file coalesce: a request submitted while an older one for
+// that file is still waiting replaces it, so a burst of saves costs one write.
+class AsyncFileWriter {
+public:
+    // Produces the whole file at the given (temporary) path; false on failure
+    using WriteFunction = std::function<bool(const std::string& path)>;
+
+    AsyncFileWriter();
+    ~AsyncFileWriter();  // finishes every pending write
+
+    AsyncFileWriter(const AsyncFileWriter&) = delete;
+    AsyncFileWriter& operator=(const AsyncFileWriter&) = delete;
+
+    // Queue a write of filename. write runs on the writer thread, so it must
+    // own (capture by value) everything it needs.
+    void submit(const std::string& filename, WriteFunction write);
+
+    // Block until every write submitted so far has finished
+    void flush();
+
+    // Counters for reporting: files written, writes replaced by a newer one, failures
+    long long completedWrites() const;
+    long long coalescedWrites() const;
+    long long failedWrites() const;
+
+    // Write, sync and rename on the calling thread (what the worker does per job)
+    static bool writeFileAtomically(const std::string& filename, const WriteFunction& write);
+
+private:
+    struct Job {
+        std::string filename;
+        WriteFunction write;
+    };
+
+    mutable std::mutex mutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+    std::vector<Job> pending;   // at most one job per filename, oldest first
+    bool busy = false;          // the worker is running a job outside the lock
+    bool stopping = false;
+    long long completed = 0;
+    long long coalesced = 0;
+    long long failed = 0;
+    std::thread worker;
+
+    void workerLoop();
+};
@@ -0,0 +1,129 @@
+#pragma once
+#include "NeuralNetwork.h"
+#include <string>
+
+// Timing harness for the network and simulation hot paths.
+// Run with: main.exe --benchmark
+class Benchmark {
+public:
+    // Run every benchmark and print a summary table. Returns false when a
+    // built-in check (such as the VecSimulation parity check) fails.
+    static bool runAll();
+
+    // Average nanoseconds per predict() call on a single 1x12 state
+    static double benchmarkPredict(const NeuralNetwork& network, int iterations);
+
+    // Average nanoseconds per allocation-free predictInto() call
+    static double benchmarkPredictInto(const NeuralNetwork& network, int iterations);
+
+    // Average nanoseconds per train() call on a single example
+    static double benchmarkTrain(NeuralNetwork& network, int iterations);
+
+    // States per second through predictBatch for N = 1, 8, 64 and 1024,
+    // against the same states run one predictInto at a time
+    static void benchmarkPredictBatch();
+
+    // Examples per second through trainBatch, mini-batch GEMM vs per-sample SGD
+    static void benchmarkTrainBatch();
+
+    // Check that synchronous ParallelTrainer runs repeat exactly and stay close
+    // to single-threaded trainBatch, and that asynchronous Hogwild training
+    // stays close to synchronous, then report scaling over worker counts.
+    // Returns false when either check fails.
+    static bool benchmarkParallelTraining();
+
+    // Train the same network on a fixed regression task with each optimizer
+    // and report the loss reached after a set number of batches, plus the
+    // cost of one fused optimizer step
+    static void benchmarkOptimizers();
+
+    // Load latency of version 1 and version 2 model files (bulk read into a
+    // NeuralNetwork, and memory-mapped with and without the checksum pass),
+    // plus checks that mapped inference matches and that truncated or
+    // corrupted files are rejected. Returns false when a check fails.
+    static bool benchmarkModelLoading();
+
+    // Restoring the best weights from an in-memory snapshot vs reloading the
+    // file, the cost a save adds to the training loop (synchronous crash-safe
+    // write vs queueing on AsyncFileWriter), and a burst of queued saves that
+    // must coalesce and leave the last one on disk. Returns false when a check fails.
+    static bool benchmarkCheckpointing();
+
+    // Cost of starting a random stream (construct + a few draws): std::mt19937
+    // seeded from random_device or a number, and CounterRng
+    static void benchmarkRandomStreams();
+
+    // Time a validation round of seeded episodes played one after another and
+    // through GameLogic::runSimulations, and check the results are identical.
+    // Returns false when they differ.
+    static bool benchmarkParallelValidation();
+
+    // Episodes per second of VecSimulation at several lane counts against
+    // runSimulation one episode at a time, checking every result is identical,
+    // at every lane count and under every ISA. Returns false when one differs.
+    static bool benchmarkVecSimulation();
+
+    // Cost of a frame's bullet work against the bullet count: the old three
+    // passes over double structs vs BulletField's fused pass on each ISA,
+    // checking that every ISA matches the scalar pass exactly, then
+    // BulletLanes against a BulletField per lane on each ISA. Returns false
+    // when one differs.
+    static bool benchmarkBulletScan();
+
+    // BulletField as a pool: random spawns, despawns and lifetimes checked
+    // against a plain list of bullets, then the cost of a spawn + despawn
+    // pair against the old vector push_back and erase. Returns false when the
+    // pool and the list disagree.
+    static bool benchmarkBulletPool();
+
+    // BulletGrid rebuild, collision and nearest-k query cost from 100 to 100k
+    // bullets in an arena 16 times the window, against linear searches,
+    // checking planar and toroidal queries against a linear search. Returns
+    // false when a query differs.
+    static bool benchmarkBulletGrid();
+
+    // ShipPhysics' float step against its double reference: checks the sin/cos
+    // table is correctly rounded, that random-control trajectories stay
+    // within tolerance over an episode and that the structure-of-arrays step
+    // matches the ShipBody one exactly on each ISA, then times a ship-frame
+    // through SpaceShip's methods, the reference, the float step and the
+    // structure-of-arrays step. Returns false when a check fails.
+    static bool benchmarkShipPhysics();
+
+    // Acceptance rate and mean episodes of the SequentialTest used to accept
+    // winning models, on simulated models of known win rate, next to the old
+    // fixed 7-of-10 rule. Returns false when the false accept / false reject
+    // rates at the two tested win rates exceed alpha / beta.
+    static bool benchmarkSequentialTest();
+
+    // Episodes per second of NeuroEvolution generations across worker counts,
+    // checking that every worker count evolves exactly the same best member.
+    // Returns false when they differ.
+    static bool benchmarkNeuroEvolution();
+
+    // Compare the compile-time StaticNetwork<12, 32, 16, 4> with the equivalent
+    // dynamic NeuralNetwork on inference, training and whole simulations; checks
+    // both predict the same on every ISA and accuracy tier, before and after training
+    static bool benchmarkStaticNetwork();
+
+    // Quantize a trained model to int8 and fp16 and compare both with fp32:
+    // inference speed, output drift, model size, and win rate over a fixed
+    // set of simulation seeds. Returns false when a saved .qnn model does not
+    // load back to identical outputs or a truncated one is accepted.
+    static bool benchmarkQuantized();
+
+    // Time every activation and accuracy tier and report its largest
+    // deviation from the exact tier
+    static void benchmarkActivations();
+
+    // Time the dispatched GEMV/GEMM kernels on every supported ISA and
+    // report their largest deviation from the scalar reference
+    static void benchmarkKernels();
+
+    // GFLOP/s of the blocked GEMM across matrix sizes and thread counts
+    static void benchmarkGemmScaling();
+
+private:
+    static void printResult(const std::string& name, double nanoseconds, const std::string& unit = "call",
+                            const std::string& note = "");
+};
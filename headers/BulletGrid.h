@@ -0,0 +1,83 @@
+#pragma once
+#include "BulletField.h"
+#include <vector>
+
+// Uniform-grid index over a BulletField's positions, for arenas with far
+// more bullets than a per-ship linear scan can afford.
+//
+// The arena is cut into columns x rows equal cells that tile it exactly, so
+// the right edge's cells neighbour the left edge's the same way bullets wrap
+// in BulletField::scan. rebuild() sorts the bullets into cells with one
+// counting pass (O(bullets + cells), no allocation once sized) and keeps
+// each cell's positions contiguous, so a query reads a few short runs. With
+// a cell size near cellSizeFor's suggestion a query touches a handful of
+// cells whatever the bullet count.
+//
+// Planar queries measure plain distance, exactly like BulletField::scan.
+// Toroidal queries measure the shortest distance around the wrapped arena
+// and look across the edges for it.
+//
+// Queries are const and can run from several threads once rebuilt.
+class BulletGrid {
+public:
+    enum class Metric {
+        Planar,
+        Toroidal
+    };
+
+    BulletGrid(float width, float height, float cellSize, Metric metric = Metric::Planar);
+
+    // Cell edge that puts about bulletsPerCell bullets in a cell, but never below minimumSize
+    // (e.g. the collision diameter, so a collision query spans at most 2 x 2 cells)
+    static float cellSizeFor(float width, float height, int bullets, float minimumSize, float bulletsPerCell = 2.0f);
+
+    // Index the field's current positions. The field must use this grid's arena size.
+    void rebuild(const BulletField& bullets);
+
+    // Is any bullet closer than radius to (x, y)?
+    bool anyWithin(float x, float y, float radius) const;
+
+    // The up to k bullets nearest to (x, y) and closer than maxRange, nearest
+    // first (ties go to the lower index). Writes their indices and squared
+    // distances and returns how many were found.
+    int nearest(float x, float y, int k, float maxRange, int* indices, float* distancesSquared) const;
+
+    // Squared distance from (x, y) to (bulletX, bulletY) under this grid's metric
+    float distanceSquared(float x, float y, float bulletX, float bulletY) const;
+
+    int columns() const { return columnCount; }
+    int rows() const { return rowCount; }
+    int size() const { return static_cast<int>(order.size()); }
+
+private:
+    float width;
+    float height;
+    Metric metric;
+    int columnCount;
+    int rowCount;
+    float cellWidth;
+    float cellHeight;
+    float inverseCellWidth;   // cells are found by multiplying, the same way in rebuild and queries
+    float inverseCellHeight;
+
+    // Offsets from a query's cell that reach every cell exactly once:
+    // clipped to the grid for Planar, one wrap of it for Toroidal
+    int lowestColumnOffset(int column) const;
+    int highestColumnOffset(int column) const;
+    int lowestRowOffset(int row) const;
+    int highestRowOffset(int row) const;
+
+    std::vector<int> cellStart;  // columns * rows + 1 entries; cell c holds [cellStart[c], cellStart[c + 1])
+    std::vector<int> order;      // bullet indices grouped by cell, ascending within a cell
+    std::vector<float> sortedX;  // positions in the same order
+    std::vector<float> sortedY;
+    std::vector<int> cellOf;     // rebuild scratch: each bullet's cell
+    std::vector<int> cursor;     // rebuild scratch: next free slot per cell
+
+    int column(float x) const;
+    int row(float y) const;
+    int wrap(int value, int count) const { return ((value % count) + count) % count; }
+    // Offer one cell's bullets to a nearest query's sorted candidate list
+    void collectCell(int cell, float x, float y, int k, float rangeSquared, int* indices, float* distancesSquared,
+                     int& found) const;
+};
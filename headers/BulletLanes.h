@@ -0,0 +1,71 @@
+#pragma once
+#include "BulletField.h"
+#include <vector>
+
+// The bullets of many simulated games side by side, for VecSimulation.
+//
+// Each lane is one game's BulletField: the same move and wrap, the same
+// collision radius and nearest-bullet rule, the same lifetimes and the same
+// despawn order (the lane's last bullet fills the hole), so scan() gives
+// every lane the Scan its own BulletField would, bit for bit. The storage is
+// interleaved instead: lane l's bullet i sits at i * stride() + l, so the
+// AVX-512 and AVX2 passes (picked from MatrixKernels::activeIsa) move and
+// measure bullet i of 16 or 8 lanes in one instruction, each lane against
+// its own ship, and keep every lane's hit and nearest bullet in its own
+// vector lane with no horizontal merge.
+//
+// Like BulletField, every array is sized in the constructor and a lane
+// never holds more than capacity bullets. Lanes have no handles.
+class BulletLanes {
+public:
+    // lanes games of up to capacity bullets each, wrapping around a
+    // width x height arena (the window by default)
+    BulletLanes(int lanes, int capacity);
+    BulletLanes(float width, float height, int lanes, int capacity);
+
+    // Spawn a bullet at index size(lane) that scan() despawns after lifetime
+    // frames (FOREVER: never). Returns its index, or -1 when the lane is full.
+    int add(int lane, float x, float y, float velX, float velY, int lifetime = BulletField::FOREVER);
+
+    // Drops every bullet of one lane and restarts its frame count
+    void clear(int lane);
+
+    int laneCount() const { return lanes; }
+    int capacity() const { return perLane; }
+    int stride() const { return laneStride; }
+    int size(int lane) const { return counts[lane]; }
+
+    float x(int lane, int i) const { return xs[slot(lane, i)]; }
+    float y(int lane, int i) const { return ys[slot(lane, i)]; }
+    float velX(int lane, int i) const { return vxs[slot(lane, i)]; }
+    float velY(int lane, int i) const { return vys[slot(lane, i)]; }
+
+    // For every lane whose flying entry is not 0: despawn the bullets whose
+    // lifetime is over, advance the rest one frame, then measure them against
+    // that lane's ship (shipX[lane], shipY[lane]) into scans[lane]. Other
+    // lanes are left alone.
+    void scan(const float* shipX, const float* shipY, const int* flying, BulletField::Scan* scans);
+
+    // The same pass in portable scalar code, for checking the SIMD versions
+    void scanScalar(const float* shipX, const float* shipY, const int* flying, BulletField::Scan* scans);
+
+private:
+    float width;
+    float height;
+    int lanes;
+    int perLane;
+    int laneStride;             // lanes rounded up to a whole AVX-512 block
+    std::vector<float> xs;
+    std::vector<float> ys;
+    std::vector<float> vxs;
+    std::vector<float> vys;
+    std::vector<int> expiry;    // last frame each bullet lives (INT_MAX without a lifetime)
+    std::vector<int> counts;    // live bullets per lane, laneStride entries (0 past lanes)
+    std::vector<int> mortal;    // live bullets with a lifetime, per lane
+    std::vector<int> frames;    // scans since the lane was cleared
+
+    int slot(int lane, int i) const { return i * laneStride + lane; }
+    void removeAt(int lane, int i);
+    // Count the frame and despawn expired bullets of every flying lane
+    void expire(const int* flying);
+};
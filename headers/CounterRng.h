@@ -0,0 +1,88 @@
+#pragma once
+#include <cstdint>
+
+// Counter-based random number generator (Philox4x32-10, Salmon et al. 2011).
+//
+// Output block n of stream s under seed k is a pure function of (k, s, n):
+// four 32-bit values from ten rounds of multiply / xor over the counter
+// (n, s) keyed by k. So a generator costs four words to construct (no state
+// to warm up, unlike std::mt19937's 5 KB), any stream can be started
+// anywhere with discard() in O(1), and streams with different indices never
+// overlap. Identify each independent sequence, such as one game episode, by
+// (run seed, index) and it replays bit for bit on any thread, in any order.
+//
+// Satisfies UniformRandomBitGenerator, so <random> distributions accept it;
+// uniform() and below() are cheaper and give the same values on every platform.
+class CounterRng {
+public:
+    using result_type = uint32_t;
+
+    explicit CounterRng(uint64_t seed, uint64_t stream = 0)
+        : key{static_cast<uint32_t>(seed), static_cast<uint32_t>(seed >> 32)}, stream(stream) {}
+
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return 0xFFFFFFFFu; }
+
+    result_type operator()() {
+        if (index == 4) {
+            refill();
+        }
+        return output[index++];
+    }
+
+    // Skip n outputs
+    void discard(uint64_t n) {
+        uint64_t position = nextBlock * 4 - (4 - index) + n;
+        nextBlock = position / 4;
+        index = 4;
+        if (position % 4 != 0) {
+            refill();
+            index = static_cast<int>(position % 4);
+        }
+    }
+
+    // Uniform in [0, 1) with 24 random bits
+    float uniform() { return static_cast<float>((*this)() >> 8) * (1.0f / 16777216.0f); }
+
+    // Uniform integer in [0, n) (multiply-shift; bias below 2^-32 * n)
+    uint32_t below(uint32_t n) { return static_cast<uint32_t>((static_cast<uint64_t>((*this)()) * n) >> 32); }
+
+    // The four outputs of block `counter` of a stream, without a generator
+    static void block(uint64_t seed, uint64_t stream, uint64_t counter, uint32_t out[4]) {
+        uint32_t k0 = static_cast<uint32_t>(seed);
+        uint32_t k1 = static_cast<uint32_t>(seed >> 32);
+        uint32_t c0 = static_cast<uint32_t>(counter);
+        uint32_t c1 = static_cast<uint32_t>(counter >> 32);
+        uint32_t c2 = static_cast<uint32_t>(stream);
+        uint32_t c3 = static_cast<uint32_t>(stream >> 32);
+        for (int round = 0; round < 10; ++round) {
+            uint64_t product0 = static_cast<uint64_t>(0xD2511F53u) * c0;
+            uint64_t product1 = static_cast<uint64_t>(0xCD9E8D57u) * c2;
+            uint32_t next0 = static_cast<uint32_t>(product1 >> 32) ^ c1 ^ k0;
+            uint32_t next2 = static_cast<uint32_t>(product0 >> 32) ^ c3 ^ k1;
+            c1 = static_cast<uint32_t>(product1);
+            c3 = static_cast<uint32_t>(product0);
+            c0 = next0;
+            c2 = next2;
+            k0 += 0x9E3779B9u;
+            k1 += 0xBB67AE85u;
+        }
+        out[0] = c0;
+        out[1] = c1;
+        out[2] = c2;
+        out[3] = c3;
+    }
+
+private:
+    uint32_t key[2];
+    uint64_t stream;
+    uint64_t nextBlock = 0;
+    uint32_t output[4] = {};
+    int index = 4;  // next unread entry of output; 4 = empty
+
+    void refill() {
+        uint64_t seed = key[0] | (static_cast<uint64_t>(key[1]) << 32);
+        block(seed, stream, nextBlock++, output);
+        index = 0;
+    }
+};
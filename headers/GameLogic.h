@@ -1,16 +1,13 @@
 #pragma once
 #include "SpaceShip.h"
+#include "BulletField.h"
 #include "GameSettings.h"
 #include "NeuralNetwork.h"
+#include "ShipPhysics.h"
+#include <cstdint>
 #include <vector>
 #include <cmath>
 
-// Bullet structure for simulation
-struct SimBullet {
-    double x, y;
-    double velX, velY;
-};
-
 // Game simulation result
 struct SimulationResult {
     bool won;
@@ -19,15 +16,47 @@ struct SimulationResult {
     int framesPlayed;
 };
 
+// Simulation code is templated on the controller network so the fixed-size
+// StaticNetwork can drive it without virtual calls. Definitions live in
+// GameLogic.cpp, explicitly instantiated for NeuralNetwork, ProductionNetwork,
+// QuantizedNetwork and NeuroEvolution::Member.
 class GameLogic {
 public:
-    // Run a complete simulation and return the result
-    static SimulationResult runSimulation(NeuralNetwork* network, int maxFrames);
+    // Run a complete simulation and return the result. Each call is a new
+    // episode of a per-process run seed (safe to call from several threads).
+    template <typename Network>
+    static SimulationResult runSimulation(Network* network, int maxFrames);
+
+    // Play episode `episode` of run `runSeed`: every random draw comes from the
+    // CounterRng stream (runSeed, episode), so the same pair replays the same
+    // episode bit for bit on any thread (e.g. to compare two networks)
+    template <typename Network>
+    static SimulationResult runSimulation(Network* network, int maxFrames, uint64_t runSeed, uint64_t episode);
+
+    // Episodes firstEpisode .. firstEpisode + count - 1 of runSeed, played
+    // concurrently on the shared ThreadPool, each thread stepping its share as
+    // one VecSimulation; results[i] is exactly
+    // runSimulation(network, maxFrames, runSeed, firstEpisode + i). Episodes only
+    // call the network's const predictBatch, so they share it read-only.
+    template <typename Network>
+    static void runSimulations(Network* network, int maxFrames, uint64_t runSeed, uint64_t firstEpisode, int count,
+                               std::vector<SimulationResult>& results);
+
+    // Run seed for runSimulation calls that do not name one (drawn once per process)
+    static uint64_t processRunSeed();
+
+    // Ship start position of episode (runSeed, episode): a random point along an edge
+    static void startPosition(uint64_t runSeed, uint64_t episode, double& startX, double& startY);
+
+    // End-of-episode bonuses and penalties added to the per-frame loss.
+    // finalDistance is the station distance after the last completed frame.
+    static SimulationResult scoreEpisode(bool won, bool hit, float totalLoss, float closestDistanceReached,
+                                         float finalDistance, int frames);
 
     // Process a single frame - returns true if game should continue
     static bool processFrame(
         SpaceShip& ship,
-        std::vector<SimBullet>& bullets,
+        BulletField& bullets,
         int& bulletFireCounter,
         NeuralNetwork* network,
         float& totalLoss,
@@ -39,27 +68,121 @@ public:
     static void fireAtShip(
         double shipX, double shipY,
         double shipVelX, double shipVelY,
-        std::vector<SimBullet>& bullets
+        BulletField& bullets
     );
 
-    // Update bullets (move + wrap)
-    static void updateBullets(std::vector<SimBullet>& bullets);
+    // Velocity of the shot fireAtShip would add, from the station toward the
+    // ship's predicted position; false when there is no direction to fire in
+    static bool aimAtShip(double shipX, double shipY, double shipVelX, double shipVelY, float& velX, float& velY);
 
-    // Check bullet collision with ship
-    static bool checkBulletCollision(
-        double shipX, double shipY,
-        const std::vector<SimBullet>& bullets
-    );
+    // Bullets an episode of maxFrames frames can have alive at once, given
+    // the fire rate and BULLET_LIFETIME: the pool size that never fills up
+    static int bulletCapacity(int maxFrames);
+
+    // Move and wrap the bullets, check them against the ship and find the
+    // nearest one, all in BulletField's single pass
+    static BulletField::Scan updateBullets(double shipX, double shipY, BulletField& bullets);
 
     // Check win condition
     static bool checkWin(double shipX, double shipY);
 
-    // Get AI decision and apply to ship
+    // Network interface: 12 sensor inputs, 4 outputs (thrust, strafe, rotation, brake)
+    static const int INPUT_COUNT = 12;
+    static const int OUTPUT_COUNT = 4;
+
+    // Controls decoded from the network outputs: thrust and brake in [0, 1],
+    // strafe and rotation in [-1, 1]
+    struct Controls {
+        float thrust;
+        float strafe;
+        float rotation;
+        float brake;
+    };
+
+    // Encode a ship state and the bullets as the network's inputs; scan is
+    // this frame's updateBullets result for the same ship position. The
+    // encoding runs in float, with angleOf for both angles, so the batched
+    // buildInputs below can reproduce it lane for lane.
+    static void buildInputs(
+        float shipX, float shipY,
+        float shipVelX, float shipVelY,
+        int rotationAngle,
+        const BulletField& bullets,
+        const BulletField::Scan& scan,
+        float state[INPUT_COUNT]
+    );
+
+    // What the inputs see of the bullets: how many there are and the nearest
+    // one (found is false when none is within NEAREST_RANGE)
+    struct BulletSense {
+        int count;
+        bool found;
+        float x;
+        float y;
+        float velX;
+        float velY;
+        float distanceSquared;
+    };
+
+    // The same encoding from bullets kept elsewhere (e.g. in BulletLanes)
+    static void buildInputs(
+        float shipX, float shipY,
+        float shipVelX, float shipVelY,
+        int rotationAngle,
+        const BulletSense& bullets,
+        float state[INPUT_COUNT]
+    );
+
+    // Encoder inputs of many ships side by side, entry i for row i of the
+    // states (found is 1 when the ship has a nearest bullet, else 0 and the
+    // bullet entries are ignored)
+    struct InputArrays {
+        std::vector<float> shipX;
+        std::vector<float> shipY;
+        std::vector<float> velX;
+        std::vector<float> velY;
+        std::vector<int> rotation;
+        std::vector<int> bulletCount;
+        std::vector<int> found;
+        std::vector<float> bulletX;
+        std::vector<float> bulletY;
+        std::vector<float> bulletVelX;
+        std::vector<float> bulletVelY;
+        std::vector<float> bulletDistanceSquared;
+
+        void resize(int count);
+    };
+
+    // Rows 0 .. count - 1 of states at once: row i is bit for bit what the
+    // single-ship buildInputs writes for entry i. AVX2 and AVX-512 passes
+    // (picked from MatrixKernels::activeIsa) encode 8 or 16 rows per
+    // instruction, the two square roots and two angleOf calls included.
+    static void buildInputs(const InputArrays& inputs, int count, float* states);
+
+    // atan2(y, x) from one division and a degree-17 odd polynomial (SLEEF's
+    // atanf coefficients), within 3.2e-7 radians of std::atan2 (signed zeros aside).
+    // Every step is a correctly rounded operation or an explicit fused
+    // multiply-add, so the SIMD encoder lands on the same bits.
+    static float angleOf(float y, float x);
+
+    static Controls decodeOutputs(const float decision[OUTPUT_COUNT]);
+
+    // GameSettings' drag, speed limit and arena as ShipPhysics settings
+    static ShipPhysics::Settings shipSettings();
+
+    // The frame's ShipPhysics command for decoded controls: dead zones, then
+    // THRUST_POWER / STRAFE_POWER, 6 degrees of turn and up to 10% brake
+    static ShipPhysics::Command shipCommand(const Controls& controls);
+
+    // Get AI decision and fly the ship one frame with ShipPhysics (thrust,
+    // strafe, turn, drag, clamp, move and wrap in one pass)
+    template <typename Network>
     static void applyAIDecision(
-        SpaceShip& ship,
-        NeuralNetwork* network,
-        double shipX, double shipY,
-        const std::vector<SimBullet>& bullets,
+        ShipBody<float>& ship,
+        Network* network,
+        const ShipPhysics::Settings& settings,
+        const BulletField& bullets,
+        const BulletField::Scan& scan,
         float& rotationOutput  // Output for debugging
     );
 };
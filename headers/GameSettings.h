@@ -22,6 +22,14 @@ const float BULLET_SPEED = 2.0f;
 const float BULLET_COLLISION_RADIUS = 10.0f;
 const double SAFE_ZONE_RADIUS = 100.0;  // No bullets fired when ship is this close to station
 const double BULLET_PREDICTION_FACTOR = 0.7;  // How much to lead the target (0 = no prediction, 1 = full)
+const int BULLET_LIFETIME = 0;          // Frames a bullet lives (0 = until the game ends)
+
+// Game mode (main.cpp) keeps its own copies of the window and bullet settings
+// but moves its bullets with the same BulletField pass, so there too:
+//  - bullets wrap at the window edges instead of being dropped 50 px outside
+//    them, and main.cpp's BULLET_LIFETIME is what removes them;
+//  - the hit radius is BULLET_COLLISION_RADIUS (10 px), down from the 20 px
+//    game mode used before.
 
 // Game duration
 const int MAX_FRAMES = 5000;
@@ -6,7 +6,7 @@
 #include <memory>
 #include "SpaceShip.h"
 #include "SpaceStation.h"
-#include "Bullet.h"
+#include "BulletField.h"
 
 #pragma comment(lib, "gdiplus.lib")
 
@@ -52,7 +52,7 @@ public:
 
     bool initialize();
     void render(double shipX, double shipY, float shipRotation, const SpaceStation& station,
-                const std::vector<Bullet>& bullets, int frameCount, const std::string& status,
+                const BulletField& bullets, int frameCount, const std::string& status,
                 ShipState shipState);
     bool isOpen() const { return isRunning; }
     void processMessages();
@@ -1,13 +1,34 @@
 #pragma once
+#include "Activations.h"
 #include "Matrix.h"
+#include "MatrixKernels.h"
 
 class Layer {
 public:
     Matrix weights;
     Matrix biases;
     Matrix outputs;
-    bool useTanh;  // Use tanh activation instead of sigmoid
+    Activations::Type activation;
 
-    Layer(int input_size, int output_size, bool useTanh = false);
+    // Weights rearranged for the blocked GEMM. Only wide layers are packed;
+    // call packWeights() whenever weights change.
+    MatrixKernels::PackedPanels packedWeights;
+    static const int PACK_MIN_WEIGHTS = 64 * 64;
+
+    Layer(int input_size, int output_size, Activations::Type activation = Activations::Type::Sigmoid);
     Matrix forward(const Matrix& input) const;
+
+    // Same, into an existing matrix (resized, reusing its buffer) so training
+    // loops can keep every layer's activations allocated across calls
+    void forward(const Matrix& input, Matrix& output) const;
+
+    // Single-row forward pass into caller-owned memory: output = act(input * weights + biases).
+    // Bias add and activation run in one pass over the outputs; nothing is allocated.
+    void forwardInto(const float* input, float* output) const;
+
+    // Same for rows contiguous input rows (rows x inputs -> rows x outputs) through one GEMM
+    void forwardRows(const float* input, int rows, float* output) const;
+
+    // Refresh packedWeights from weights (no-op for small layers)
+    void packWeights();
 };
@@ -0,0 +1,55 @@
+#pragma once
+#include "Matrix.h"
+#include "MatrixKernels.h"
+#include "ModelFormat.h"
+#include <string>
+#include <vector>
+
+// Read-only network evaluated straight out of a memory-mapped version 2 model
+// file. The weight blocks are used in place (they are 64-byte aligned in the
+// file and the mapping starts on a page boundary), so opening a model costs a
+// header check and, optionally, one checksum pass; pages are read from disk as
+// inference first touches them. Layers wide enough for Layer to pack
+// (Layer::PACK_MIN_WEIGHTS) also get a packed copy for batched inference.
+//
+// Inference uses the same kernels as NeuralNetwork, so outputs match
+// NeuralNetwork::predictInto / predictBatch on a network loaded from the same
+// file bit for bit. Version 1 files cannot be mapped; load them into a
+// NeuralNetwork and save them again to convert.
+class MappedNetwork {
+public:
+    MappedNetwork() = default;
+    ~MappedNetwork();
+
+    MappedNetwork(const MappedNetwork&) = delete;
+    MappedNetwork& operator=(const MappedNetwork&) = delete;
+
+    // Map a model file. verifyChecksum reads the whole file once up front;
+    // without it only the header and layer table are validated.
+    bool open(const std::string& filename, bool verifyChecksum = true, bool verbose = true);
+    void close();
+    bool isOpen() const { return image != nullptr; }
+
+    // Allocation-free inference on one state (uses per-thread scratch buffers)
+    void predictInto(const float* input, float* output) const;
+
+    // n contiguous states to n actions, one GEMM per layer per chunk of rows
+    void predictBatch(const float* states, size_t n, float* actions) const;
+    Matrix predict(const Matrix& input) const;
+
+    int inputSize() const { return layers.empty() ? 0 : layers.front().inputs; }
+    int outputSize() const { return layers.empty() ? 0 : layers.back().outputs; }
+    size_t mappedBytes() const { return imageBytes; }
+
+private:
+    std::vector<ModelFormat::LayerBlock> layers;  // weights and biases point into the mapping
+    // Panels of the layers wide enough for Layer to pack (empty for the
+    // rest), packed once at open so batches never repack out of the mapping
+    std::vector<MatrixKernels::PackedPanels> packedWeights;
+    const unsigned char* image = nullptr;
+    size_t imageBytes = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
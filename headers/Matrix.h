@@ -1,16 +1,94 @@
 #pragma once
-#include <vector>
+#include <cstddef>
+#include <initializer_list>
 
+namespace MatrixExpr {
+template <typename E> struct Expr;
+}
+
+// Non-owning view of one matrix row (contiguous floats)
+template <typename T>
+struct MatrixRowView {
+    T* ptr;
+    int size;
+
+    T& operator[](int j) const { return ptr[j]; }
+    T* begin() const { return ptr; }
+    T* end() const { return ptr + size; }
+};
+
+// Non-owning view of one matrix column (floats spaced one row apart)
+template <typename T>
+struct MatrixColumnView {
+    T* ptr;
+    int size;
+    int stride;
+
+    T& operator[](int i) const { return ptr[static_cast<size_t>(i) * stride]; }
+};
+
+// Dense row-major float matrix stored in one 64-byte aligned buffer.
+// Shapes up to SMALL_CAPACITY elements (the 1x12 sensor and 1x4 action
+// vectors) live inside the object and never touch the heap.
 class Matrix {
 public:
+    static const size_t ALIGNMENT = 64;
+    static const int SMALL_CAPACITY = 16;
+
     int rows, cols;
-    std::vector<std::vector<float>> data;
 
+    Matrix();
     Matrix(int rows, int cols);
+    Matrix(int rows, int cols, std::initializer_list<float> values);
+    Matrix(const Matrix& other);
+    Matrix(Matrix&& other) noexcept;
+    Matrix& operator=(const Matrix& other);
+    Matrix& operator=(Matrix&& other) noexcept;
+    ~Matrix();
+
+    // Evaluate a lazy expression in one pass (defined in MatrixExpr.h)
+    template <typename E> Matrix(const MatrixExpr::Expr<E>& expr);
+    template <typename E> Matrix& operator=(const MatrixExpr::Expr<E>& expr);
+    template <typename E> Matrix& operator+=(const MatrixExpr::Expr<E>& expr);
+    template <typename E> Matrix& operator-=(const MatrixExpr::Expr<E>& expr);
+
+    // Raw row-major storage
+    float* data() { return storage; }
+    const float* data() const { return storage; }
+    int size() const { return rows * cols; }
+
+    float& operator()(int i, int j) { return storage[static_cast<size_t>(i) * cols + j]; }
+    float operator()(int i, int j) const { return storage[static_cast<size_t>(i) * cols + j]; }
+
+    MatrixRowView<float> row(int i) { return {storage + static_cast<size_t>(i) * cols, cols}; }
+    MatrixRowView<const float> row(int i) const { return {storage + static_cast<size_t>(i) * cols, cols}; }
+    MatrixColumnView<float> column(int j) { return {storage + j, rows, cols}; }
+    MatrixColumnView<const float> column(int j) const { return {storage + j, rows, cols}; }
+
+    // Change shape, reusing the existing buffer when it is large enough (contents are zeroed)
+    void resize(int rows, int cols);
+    void fill(float value);
+    void setRow(int i, std::initializer_list<float> values);
+
     void randomize(float min = -1.0f, float max = 1.0f);
     Matrix dot(const Matrix& other) const;
+    Matrix dotTransA(const Matrix& other) const;    // this^T * other, without transposing this
+    Matrix dotTransB(const Matrix& other) const;    // this * other^T, without transposing other
+
+    // Same products written into an existing matrix (resized, reusing its buffer)
+    void dotInto(const Matrix& other, Matrix& result) const;
+    void dotTransBInto(const Matrix& other, Matrix& result) const;
+    void rankUpdate(const Matrix& a, const Matrix& b);  // this += a^T * b, in place
     Matrix add(const Matrix& other) const;
     Matrix apply(float (*func)(float)) const;
     Matrix transpose() const;
     void print() const;
-};
\ No newline at end of file
+
+private:
+    float* storage;     // points at smallBuffer or an aligned heap block
+    size_t capacity;    // number of floats storage can hold
+    alignas(ALIGNMENT) float smallBuffer[SMALL_CAPACITY];
+
+    void allocate(size_t count);
+    void release();
+};
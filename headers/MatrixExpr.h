@@ -0,0 +1,141 @@
+#pragma once
+#include "Matrix.h"
+
+// Lazy element-wise matrix algebra for the training loop.
+//
+// Building an expression only records its operands. The arithmetic happens in
+// a single loop when the expression is assigned (=, +=, -=) to a Matrix, so
+// compound updates such as
+//
+//     error = target - lazy(output);
+//     gradient = lazy(error) * learningRate;
+//
+// never build intermediate matrices. Products stay with the eager Matrix
+// methods and MatrixKernels.
+//
+// Operands are held by reference, so evaluate an expression before the
+// matrices it reads go away. An expression may read the matrix it is
+// assigned to.
+namespace MatrixExpr {
+
+// CRTP base for every expression node: rows(), cols() and operator()(i, j)
+template <typename E>
+struct Expr {
+    const E& self() const { return static_cast<const E&>(*this); }
+};
+
+// Leaf: a Matrix held by reference
+struct Ref : Expr<Ref> {
+    const Matrix& m;
+
+    explicit Ref(const Matrix& matrix) : m(matrix) {}
+    int rows() const { return m.rows; }
+    int cols() const { return m.cols; }
+    float operator()(int i, int j) const { return m(i, j); }
+};
+
+template <typename E>
+struct Scale : Expr<Scale<E>> {
+    E e;
+    float factor;
+
+    Scale(const E& inner, float s) : e(inner), factor(s) {}
+    int rows() const { return e.rows(); }
+    int cols() const { return e.cols(); }
+    float operator()(int i, int j) const { return e(i, j) * factor; }
+};
+
+struct MulOp { static float apply(float a, float b) { return a * b; } };
+struct AddOp { static float apply(float a, float b) { return a + b; } };
+struct SubOp { static float apply(float a, float b) { return a - b; } };
+
+// Element-wise combination of two same-shaped expressions
+template <typename L, typename R, typename Op>
+struct Binary : Expr<Binary<L, R, Op>> {
+    L lhs;
+    R rhs;
+
+    Binary(const L& l, const R& r) : lhs(l), rhs(r) {}
+    int rows() const { return lhs.rows(); }
+    int cols() const { return lhs.cols(); }
+    float operator()(int i, int j) const { return Op::apply(lhs(i, j), rhs(i, j)); }
+};
+
+// ---------- Entry points ----------
+
+inline Ref lazy(const Matrix& m) { return Ref(m); }
+
+// ---------- Operators (* between expressions is element-wise) ----------
+
+#define MATRIX_EXPR_BINARY_OPERATOR(SYMBOL, OP)                                                        \
+    template <typename L, typename R>                                                                  \
+    Binary<L, R, OP> operator SYMBOL(const Expr<L>& l, const Expr<R>& r) {                             \
+        return Binary<L, R, OP>(l.self(), r.self());                                                   \
+    }                                                                                                  \
+    template <typename L>                                                                              \
+    Binary<L, Ref, OP> operator SYMBOL(const Expr<L>& l, const Matrix& r) {                            \
+        return Binary<L, Ref, OP>(l.self(), Ref(r));                                                   \
+    }                                                                                                  \
+    template <typename R>                                                                              \
+    Binary<Ref, R, OP> operator SYMBOL(const Matrix& l, const Expr<R>& r) {                            \
+        return Binary<Ref, R, OP>(Ref(l), r.self());                                                   \
+    }
+
+MATRIX_EXPR_BINARY_OPERATOR(*, MulOp)
+MATRIX_EXPR_BINARY_OPERATOR(+, AddOp)
+MATRIX_EXPR_BINARY_OPERATOR(-, SubOp)
+
+#undef MATRIX_EXPR_BINARY_OPERATOR
+
+template <typename E>
+Scale<E> operator*(const Expr<E>& e, float s) { return Scale<E>(e.self(), s); }
+
+template <typename E>
+Scale<E> operator*(float s, const Expr<E>& e) { return Scale<E>(e.self(), s); }
+
+}
+
+// ---------- Matrix evaluation (declared in Matrix.h) ----------
+
+template <typename E>
+Matrix::Matrix(const MatrixExpr::Expr<E>& expr) : Matrix(expr.self().rows(), expr.self().cols()) {
+    *this = expr;
+}
+
+template <typename E>
+Matrix& Matrix::operator=(const MatrixExpr::Expr<E>& expr) {
+    const E& e = expr.self();
+    int r = e.rows();
+    int c = e.cols();
+    if (rows != r || cols != c) {
+        resize(r, c);
+    }
+    for (int i = 0; i < r; ++i) {
+        float* out = row(i).begin();
+        for (int j = 0; j < c; ++j)
+            out[j] = e(i, j);
+    }
+    return *this;
+}
+
+template <typename E>
+Matrix& Matrix::operator+=(const MatrixExpr::Expr<E>& expr) {
+    const E& e = expr.self();
+    for (int i = 0; i < rows; ++i) {
+        float* out = row(i).begin();
+        for (int j = 0; j < cols; ++j)
+            out[j] += e(i, j);
+    }
+    return *this;
+}
+
+template <typename E>
+Matrix& Matrix::operator-=(const MatrixExpr::Expr<E>& expr) {
+    const E& e = expr.self();
+    for (int i = 0; i < rows; ++i) {
+        float* out = row(i).begin();
+        for (int j = 0; j < cols; ++j)
+            out[j] -= e(i, j);
+    }
+    return *this;
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Dense float kernels behind Matrix::dot.
+//
+// All matrices are row-major with explicit leading dimensions. Every variant
+// accumulates each output element over k in increasing order, so a row of a
+// GEMM result is bit-identical to the GEMV of that row on the same ISA. The
+// AVX2 and AVX-512 kernels use fused multiply-add and agree with each other
+// exactly; SSE2 and the scalar reference round after every multiply.
+namespace MatrixKernels {
+
+enum class Isa {
+    Scalar,
+    SSE2,
+    AVX2,
+    AVX512
+};
+
+// y[1 x N] = x[1 x K] * B[K x N]
+void gemv(const float* x, const float* B, int ldb, float* y, int K, int N);
+
+// C[M x N] = A[M x K] * B[K x N]
+void gemm(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N);
+
+// Transposed products for backpropagation. The transposed operand is read in
+// its stored layout, so no transposed copy is ever built.
+
+// C[M x N] = A^T * B, with A stored K x M (e.g. layer inputs^T * gradient)
+void gemmTransA(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N);
+
+// C[M x N] = A * B^T, with B stored N x K (e.g. gradient * weights^T).
+// Each element is a dot product of two contiguous rows. The SIMD versions sum
+// in vector lanes first and then add the lanes pairwise in registers
+// (half + half, down to one lane), so they round differently from the scalar
+// reference and from a plain loop over k.
+void gemmTransB(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N);
+
+// C[M x N] += A^T * B in place, with A stored K x M: a rank-K update of C
+// (rank-1 when K == 1, i.e. the outer product of one input row and one gradient row).
+// AVX2 and AVX-512 fuse each multiply into the add. Together with gemmTransB,
+// this means train() agrees with the element-by-element backprop it replaced
+// only to about 1e-6 relative, not bit for bit.
+void rankUpdate(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N);
+
+// Right-hand matrix rearranged into column panels for the blocked GEMM.
+// Panel p holds columns [p * width, p * width + width) for every k, stored
+// k-major and zero padded, so the micro-kernel streams it with unit stride.
+// The panel width depends on the ISA active when it was packed.
+struct PackedPanels {
+    int K = 0;
+    int N = 0;
+    int width = 0;
+    std::vector<float> data;
+
+    bool empty() const { return data.empty(); }
+    int panelCount() const { return width > 0 ? (N + width - 1) / width : 0; }
+};
+
+// Size of B (K * N floats) above which gemv streams B row by row instead of
+// revisiting it once per column block
+const long long GEMV_STREAM_THRESHOLD = 1LL << 13;
+
+// Work (M * K * N multiply-adds) above which gemm packs B and runs blocked
+const long long BLOCKED_GEMM_THRESHOLD = 1LL << 16;
+
+// Work above which the blocked GEMM splits tiles across the shared thread pool
+const long long PARALLEL_GEMM_THRESHOLD = 1LL << 20;
+
+// Cache blocking of the packed GEMM: K is cut into slices whose part of one
+// panel (slice x width floats) fits L1, M into row blocks whose slice of A
+// fits L2. A slice of A is copied with its rows padded apart by
+// GEMM_SLICE_PADDING floats so they do not share L1 sets.
+const int GEMM_PANEL_SLICE_BYTES = 32 * 1024;
+const int GEMM_ROW_BLOCK_BYTES = 256 * 1024;
+const int GEMM_SLICE_PADDING = 16;
+
+// Pack B[K x N] into panels for the active ISA
+void pack(const float* B, int ldb, int K, int N, PackedPanels& out);
+
+// C[M x N] = A[M x K] * B, with B packed ahead of time (e.g. layer weights packed once per update).
+// Tiles are register blocked, cache blocked over K and rows of A and spread
+// over the shared thread pool for large problems. Results match gemm bit-for-bit.
+void gemmPacked(const float* A, int lda, const PackedPanels& B, float* C, int ldc, int M);
+
+// ---------- Reduced-precision weights (quantized inference) ----------
+
+// y[1 x N] = x[1 x K] * W[K x N] in exact 32-bit integer arithmetic; results
+// are identical on every ISA. K must be even. W is int8 with rows interleaved
+// in pairs: row p holds (W[2p][j], W[2p+1][j]) for each j, so one 16-bit
+// multiply-add covers two k at once. x holds int8-range values widened to int16.
+void gemvInt8(const int16_t* x, const int8_t* W, int ldw, int32_t* y, int K, int N);
+
+// Dynamic symmetric quantization of one input row for gemvInt8:
+// q[k] = round(x[k] / scale) with scale = max|x| / 127 (1 for an all-zero row).
+// Returns scale. Rounds to nearest even, so results are identical on every ISA.
+float quantizeInt8(const float* x, int16_t* q, int K);
+
+// y[1 x N] = x[1 x K] * B[K x N] with B stored as IEEE half floats.
+// Accumulates over k in order like gemv; uses F16C conversions where available.
+void gemvHalf(const float* x, const uint16_t* B, int ldb, float* y, int K, int N);
+
+// IEEE 754 binary16 conversions (round to nearest even)
+uint16_t floatToHalf(float value);
+float halfToFloat(uint16_t value);
+
+// Portable reference versions, always compiled in so results can be checked against them
+void gemvScalar(const float* x, const float* B, int ldb, float* y, int K, int N);
+void gemmScalar(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N);
+void gemmTransBScalar(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N);
+void rankUpdateScalar(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N);
+
+// Best instruction set this CPU supports (checked once via cpuid)
+Isa detectedIsa();
+
+// Instruction set the dispatched kernels currently use
+Isa activeIsa();
+
+// Force a specific instruction set (clamped to what the CPU supports).
+// Intended for benchmarks and result comparisons; call before starting worker threads.
+Isa setIsa(Isa isa);
+
+const char* isaName(Isa isa);
+
+}
+
+// The x86 SIMD kernels are compiled into every GCC / Clang x86 build, each
+// function for its own instruction set, and picked at run time by activeIsa().
+// Files with such kernels test MATRIX_KERNELS_X86, include <immintrin.h>
+// themselves and mark each function with one of these targets.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define MATRIX_KERNELS_X86 1
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_SSE42 __attribute__((target("sse4.2")))
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#define TARGET_AVX512 __attribute__((target("avx512f,avx2,fma")))
+#define TARGET_F16C __attribute__((target("avx2,fma,f16c")))
+#endif
@@ -0,0 +1,118 @@
+#pragma once
+#include "Activations.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Version 2 .nn model file layout, shared by NeuralNetwork, StaticNetwork and
+// MappedNetwork. All integers are little-endian.
+//
+//   offset 0   FileHeader (64 bytes)
+//   offset 64  one LayerEntry (32 bytes) per layer
+//   then       each layer's weights (inputs x outputs floats, row-major) and
+//              biases (outputs floats), every block starting on a 64-byte
+//              boundary and zero padded up to the next one
+//
+// The checksum is CRC-32C over the whole file with the checksum field read as
+// zero, so truncation or corruption anywhere is caught before any weight is used.
+// Blocks are aligned so a memory-mapped file can be used in place.
+//
+// Version 1 files (what older builds wrote) have no header: a layer count,
+// then per layer the weight and bias shapes and values, then an optional
+// activation section. Readers tell the two apart by the magic number, which
+// no plausible v1 layer count can equal.
+namespace ModelFormat {
+
+// "NNM2" in little-endian byte order
+const uint32_t MAGIC = 0x324D4E4E;
+const uint32_t VERSION = 2;
+const size_t ALIGNMENT = 64;
+
+// Marks the optional per-layer activation section after the last layer of a
+// version 1 file ("ACTV")
+const int32_t VERSION1_ACTIVATION_TAG = 0x56544341;
+
+enum class DataType : uint32_t {
+    Float32 = 0
+};
+
+struct FileHeader {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t dataType;
+    uint32_t layerCount;
+    uint32_t checksum;
+    uint32_t dataOffset;   // first weight block (header and layer table, rounded up to ALIGNMENT)
+    uint64_t fileBytes;    // total file size, so a short file is caught before the checksum
+    uint8_t reserved[32];
+};
+
+struct LayerEntry {
+    int32_t inputs;
+    int32_t outputs;
+    int32_t activation;    // Activations::Type code
+    int32_t reserved;
+    uint64_t weightsOffset;
+    uint64_t biasesOffset;
+};
+
+static_assert(sizeof(FileHeader) == 64, "FileHeader must stay 64 bytes");
+static_assert(sizeof(LayerEntry) == 32, "LayerEntry must stay 32 bytes");
+
+// One layer's shape and parameters. For a parsed file the pointers refer into the file image.
+struct LayerBlock {
+    int inputs;
+    int outputs;
+    Activations::Type activation;
+    const float* weights;
+    const float* biases;
+};
+
+// Round up to the next multiple of ALIGNMENT
+inline size_t alignUp(size_t bytes) {
+    return (bytes + ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+}
+
+// True when the first four bytes of a file are the v2 magic number
+bool hasMagic(const void* firstBytes);
+
+// Build the complete file image (header, layer table, aligned blocks, checksum) in memory
+void buildImage(const std::vector<LayerBlock>& layers, std::vector<unsigned char>& image);
+
+// Write a finished image with a single write
+bool writeImage(const std::string& filename, const std::vector<unsigned char>& image);
+
+// Build the complete file image and write it with a single write
+bool writeFile(const std::string& filename, const std::vector<LayerBlock>& layers);
+
+// Read a whole file into image with one bulk read
+bool readFile(const std::string& filename, std::vector<unsigned char>& image);
+
+// Validate a complete v2 file image and describe its layers. Checks the header,
+// sizes, alignment, activation codes, that each layer's inputs match the previous
+// layer's outputs and (when verifyChecksum is set) the CRC. On failure returns
+// false with a message in error.
+bool parse(const unsigned char* image, size_t bytes, bool verifyChecksum, std::vector<LayerBlock>& layers,
+           std::string& error);
+
+// Describe the layers of a complete version 1 file image. hasActivations is
+// false for files that end after the last layer (the caller keeps its own).
+bool parseVersion1(const unsigned char* image, size_t bytes, std::vector<LayerBlock>& layers, bool& hasActivations,
+                   std::string& error);
+
+// Read a model file of either version with one bulk read and validate it
+// (parse with the checksum for v2, parseVersion1 otherwise). blocks point into
+// image, which must outlive them; hasActivations is false for a v1 file
+// without an activation section. On failure returns false with a message
+// naming the file in error.
+bool load(const std::string& filename, std::vector<unsigned char>& image, std::vector<LayerBlock>& blocks,
+          bool& hasActivations, std::string& error);
+
+// Write a version 1 file, for tools that still need the old layout
+bool writeVersion1File(const std::string& filename, const std::vector<LayerBlock>& layers);
+
+// CRC-32C (Castagnoli), continuing from crc. Uses the SSE4.2 instruction when available.
+uint32_t crc32c(const void* data, size_t bytes, uint32_t crc = 0);
+
+}
@@ -1,8 +1,11 @@
 #pragma once
 #include "Layer.h"
+#include "ModelFormat.h"
 #include <vector>
 #include <string>
 
+class Optimizer;
+
 // Training example: input-target pair
 struct TrainingExample {
     Matrix input;
@@ -16,21 +19,136 @@ class NeuralNetwork {
 public:
     std::vector<Layer> layers;
 
+    // Ping-pong activation buffers for predictInto. Buffers only grow, so once
+    // sized for a topology every later call reuses them without allocating.
+    struct Scratch {
+        std::vector<float> front;
+        std::vector<float> back;
+        std::vector<float> states;   // calculateLoss: examples stacked for predictBatch
+        std::vector<float> actions;
+    };
+
+    // predictBatch runs at most this many rows through the layers at a time,
+    // so the intermediate activations stay in cache however large n is
+    static const int BATCH_CHUNK_ROWS = 128;
+
+    // Buffers for train() and trainBatch(): every layer's activations for the
+    // batch, plus the error, gradient and stacked targets. Sized from the
+    // topology for the largest batch seen so far and reused by later calls,
+    // so steady-state training never touches the heap.
+    struct TrainingWorkspace {
+        std::vector<Matrix> activations;  // [0] = input rows, [l + 1] = output of layer l
+        Matrix error;                     // rows x layer outputs, then rows x layer inputs while propagating
+        Matrix gradient;
+        Matrix targets;
+        int capacityRows = 0;
+    };
+
+    // Parameter updates with the same shapes as each layer's weights and biases
+    struct Gradients {
+        std::vector<Matrix> weights;
+        std::vector<Matrix> biases;
+    };
+
+    // Sigmoid hidden layers and a tanh output layer
     NeuralNetwork(const std::vector<int>& layer_sizes);
+
+    // One activation per layer (layer_sizes.size() - 1 entries)
+    NeuralNetwork(const std::vector<int>& layer_sizes, const std::vector<Activations::Type>& activations);
     Matrix predict(const Matrix& input) const;
+
+    // Allocation-free inference on one state: reads inputSize() floats from input
+    // and writes outputSize() floats to output
+    void predictInto(const float* input, float* output, Scratch& scratch) const;
+    void predictInto(const float* input, float* output) const { predictInto(input, output, threadScratch()); }
+
+    // Batched inference: n contiguous states (n x inputSize()) to n actions
+    // (n x outputSize()), one GEMM per layer. Row i matches predictInto on
+    // state i bit for bit.
+    void predictBatch(const float* states, size_t n, float* actions, Scratch& scratch) const;
+    void predictBatch(const float* states, size_t n, float* actions) const {
+        predictBatch(states, n, actions, threadScratch());
+    }
+
+    // Scratch owned by the calling thread, shared by every network used on that thread
+    static Scratch& threadScratch();
+
+    int inputSize() const { return layers.front().weights.rows; }
+    int outputSize() const { return layers.back().weights.cols; }
+
+    // How trainBatch applies a batch. A MiniBatch step moves the weights by
+    // the mean of the per-example steps, so matching PerSample's movement per
+    // batch takes learningRate times the batch rows.
+    enum class BatchMode {
+        MiniBatch,  // one stacked GEMM forward/backward pass; gradient averaged over the batch, applied once
+        PerSample   // train() on each example in turn (plain SGD, one update per example)
+    };
+    BatchMode batchMode = BatchMode::MiniBatch;
+
     void train(const Matrix& input, const Matrix& target, float learningRate);
 
-    // Batch training: trains on all examples and returns average loss
+    // Batch training: trains on all examples and returns the average per-example
+    // squared error. In MiniBatch mode the loss comes from the training forward
+    // pass (before the update); in PerSample mode from a prediction after each update.
     float trainBatch(const std::vector<TrainingExample>& batch, float learningRate);
 
-    // Model persistence
-    bool saveModel(const std::string& filename, bool verbose = true) const;
+    // Mini-batch training with an update rule other than plain SGD: the mean
+    // gradient over the batch goes to optimizer.step. Plain SGD optimizers take
+    // the learning-rate path above (batchMode applies), so results match it exactly.
+    float trainBatch(const std::vector<TrainingExample>& batch, Optimizer& optimizer);
+
+    // Backpropagate count examples against the current weights without changing
+    // them, using the caller's workspace. gradients receives the update trainBatch
+    // would apply for these rows with the given step size (learning rate divided
+    // by the rows in the whole batch). Returns the rows' summed squared error.
+    // Safe to call from several threads at once with separate workspaces.
+    float computeGradients(const TrainingExample* examples, size_t count, float stepSize,
+                           TrainingWorkspace& workspace, Gradients& gradients) const;
+
+    // weights += gradients; repack = false leaves packWeights() to the caller
+    void applyGradients(const Gradients& gradients, bool repack = true);
+
+    // Model persistence (see ModelFormat). saveModel writes version 2 unless
+    // version = 1 is asked for; loadModel reads either and rejects truncated,
+    // corrupt or mismatched files without touching the network.
+    bool saveModel(const std::string& filename, bool verbose = true, int version = ModelFormat::VERSION) const;
     bool loadModel(const std::string& filename, bool verbose = true);
 
-    // Calculate loss for evaluation
+    // Every layer's shape, activation and parameters, as stored in model files
+    std::vector<ModelFormat::LayerBlock> layerBlocks() const;
+
+    // Mean squared error per output over the examples (evaluated with predictBatch)
     float calculateLoss(const std::vector<TrainingExample>& examples) const;
 
+    // Summed squared error over count examples (calculateLoss before dividing)
+    float totalSquaredError(const TrainingExample* examples, size_t count) const;
+
+    // Overwrite every weight, bias and activation with other's (same layer
+    // shapes required). Copies buffers and packed panels in place: nothing is
+    // allocated once the two networks have matching shapes.
+    bool copyParametersFrom(const NeuralNetwork& other);
+
     // Blend weights from another network into this one
     // blendRatio: 0.0 = keep this network, 1.0 = fully replace with other
     void blendWeights(const NeuralNetwork& other, float blendRatio);
+
+    // The element-wise blend behind blendWeights, for parameters held outside
+    // a NeuralNetwork (e.g. NeuroEvolution's population arena)
+    static void blendParameters(float* target, const float* other, size_t count, float blendRatio);
+
+    // Size the training workspace for batches of up to batchRows rows
+    // (done automatically on first use; call ahead to keep it out of a timed loop)
+    void reserveWorkspace(int batchRows);
+
+private:
+    TrainingWorkspace workspace;
+    Gradients batchGradients;  // trainBatch with an optimizer
+
+    void sizeWorkspace(TrainingWorkspace& ws, int batchRows) const;
+
+    // Stack the examples into ws, run the forward pass and leave target - output
+    // in ws.error; returns the summed squared error
+    float forwardBatch(const TrainingExample* examples, size_t count, TrainingWorkspace& ws) const;
+
+    float trainPerSample(const std::vector<TrainingExample>& batch, float learningRate);
 };
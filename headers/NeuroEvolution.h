@@ -0,0 +1,117 @@
+#pragma once
+#include "Activations.h"
+#include "CounterRng.h"
+#include "NeuralNetwork.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <vector>
+
+// Neuroevolution: a population of networks scored directly on simulated games
+// (GameLogic::runSimulation) instead of the supervised heuristic targets.
+//
+// Every member has the prototype network's topology and activations. All
+// members' parameters live in one contiguous arena, member after member, each
+// laid out like a model file (per layer: weights, then biases, 64-byte aligned
+// blocks), and are evaluated in place through Member views.
+//
+// Each generation every member plays the same episodes (shared seeds, so
+// members are compared on equal terms), members are scored in parallel, and
+// the next generation is bred from the ranking: elites are copied unchanged,
+// the rest are tournament-selected parents blended with
+// NeuralNetwork::blendParameters (arithmetic crossover) plus Gaussian mutation.
+// Breeding draws from a per-child stream, so a run depends only on the settings,
+// never on the worker count or thread timing.
+class NeuroEvolution {
+public:
+    struct Settings {
+        int populationSize = 64;
+        int eliteCount = 4;             // best members copied unchanged into the next generation
+        int tournamentSize = 3;         // members compared when picking each parent
+        int episodesPerMember = 4;      // fitness = mean simulation loss over these episodes
+        int maxFrames = 2000;
+        float mutationRate = 0.1f;      // chance that each parameter is perturbed
+        float mutationStrength = 0.1f;  // standard deviation of a perturbation
+        uint64_t seed = 1;              // run seed: episodes and breeding are CounterRng streams of it
+    };
+
+    // One member viewed in place in the arena. Has the predictInto and
+    // predictBatch that GameLogic and VecSimulation need from a controller network.
+    class Member {
+    public:
+        void predictInto(const float* input, float* output) const;
+        // Row i matches predictInto on state i bit for bit (same kernels as MappedNetwork)
+        void predictBatch(const float* states, size_t n, float* actions) const;
+
+    private:
+        friend class NeuroEvolution;
+        const NeuroEvolution* engine = nullptr;
+        const float* parameters = nullptr;
+    };
+
+    struct GenerationStats {
+        int generation;
+        float bestFitness;   // lowest mean simulation loss this generation
+        float meanFitness;
+        int bestWins;        // episodes won by the best member
+        int episodes;        // episodes played this generation
+        double seconds;      // evaluation time
+
+        double episodesPerSecond() const { return seconds > 0.0 ? episodes / seconds : 0.0; }
+    };
+
+    // workerCount includes the calling thread; 0 means one per hardware thread.
+    // Member 0 starts as prototype's weights, the others as mutated copies.
+    NeuroEvolution(const NeuralNetwork& prototype, const Settings& settings, int workerCount = 0);
+
+    NeuroEvolution(const NeuroEvolution&) = delete;
+    NeuroEvolution& operator=(const NeuroEvolution&) = delete;
+
+    // Score every member in parallel, then breed the next generation
+    GenerationStats runGeneration();
+
+    // Copy the best member scored so far (over all generations) into network,
+    // which must have the prototype's topology. False before the first generation.
+    bool copyBestTo(NeuralNetwork& network) const;
+    float bestFitness() const { return bestEverFitness; }
+
+    int generation() const { return generationIndex; }
+    int workerCount() const { return pool.size(); }
+    int parameterCount() const { return parameters; }
+    const Settings& settings() const { return config; }
+
+    // Interactive session for the main menu: evolve from network's weights for
+    // a fixed time (Q stops early), keeping best_model.nn up to date, and leave
+    // the best member in network and trained_model.nn
+    static void runSession(NeuralNetwork& network, int workerCount);
+
+private:
+    struct LayerLayout {
+        int inputs;
+        int outputs;
+        Activations::Type activation;
+        size_t weightsOffset;  // floats from the start of a member
+        size_t biasesOffset;
+    };
+
+    Settings config;
+    std::vector<LayerLayout> layout;
+    int parameters = 0;     // weights and biases per member
+    size_t stride = 0;      // floats per member including padding
+    size_t widestLayer = 0;
+
+    std::vector<float> arena;      // populationSize members, stride floats apart
+    std::vector<float> nextArena;  // next generation is bred here, then swapped in
+    std::vector<float> fitness;
+    std::vector<int> wins;
+    std::vector<int> ranking;      // member indices, best first
+
+    std::vector<float> bestParameters;
+    float bestEverFitness;
+    int generationIndex = 0;
+    ThreadPool pool;
+
+    float* memberParameters(std::vector<float>& members, int index) { return members.data() + index * stride; }
+    Member member(int index) const;
+    void mutate(float* member, CounterRng& rng) const;
+    void breed();
+};
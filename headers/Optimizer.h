@@ -0,0 +1,79 @@
+#pragma once
+#include "NeuralNetwork.h"
+#include <string>
+#include <vector>
+
+// Update rules applied to a NeuralNetwork from a batch's descent direction
+// (NeuralNetwork::computeGradients with step size 1 / rows, i.e. minus the
+// mean loss gradient). With d the direction, lr the learning rate and t the
+// step number:
+//
+//   SGD       w += lr * d
+//   Momentum  v = beta1 * v + d;                                  w += lr * v
+//   RMSProp   s = beta2 * s + (1 - beta2) * d^2;                  w += lr * d / (sqrt(s) + eps)
+//   Adam      m = beta1 * m + (1 - beta1) * d;  s as RMSProp;     w += lr_t * m / (sqrt(s) + eps)
+//             with lr_t = lr * sqrt(1 - beta2^t) / (1 - beta1^t) (bias correction)
+//
+// Optimizer state (v / m and s) lives in contiguous buffers laid out like the
+// network's parameters: layer 0 weights, layer 0 biases, layer 1 weights, ...
+// Each step is one fused pass per parameter block following the instruction
+// set selected in MatrixKernels.
+class Optimizer {
+public:
+    // Stored as integers in optimizer state files, so existing values must never change
+    enum class Type : int {
+        SGD = 0,
+        Momentum = 1,
+        RMSProp = 2,
+        Adam = 3
+    };
+
+    struct Settings {
+        Type type = Type::SGD;
+        float learningRate = 0.01f;
+        float beta1 = 0.9f;     // Momentum / Adam first moment decay
+        float beta2 = 0.999f;   // RMSProp / Adam second moment decay
+        float epsilon = 1e-8f;
+    };
+
+    // Usual starting hyperparameters for each rule
+    static Settings defaults(Type type);
+
+    Optimizer() = default;
+    explicit Optimizer(const Settings& settings);
+
+    // Apply one update from direction (same shapes as network's layers) and
+    // repack the weights. State is sized on the first step.
+    void step(NeuralNetwork& network, const NeuralNetwork::Gradients& direction);
+
+    // Forget all accumulated state (the next step starts from zero moments)
+    void reset();
+
+    // State file: header with type, step count and buffer sizes, then the raw
+    // moment buffers. loadState rejects files for another rule or a network of
+    // a different size, leaving the current state untouched.
+    bool saveState(const std::string& filename, bool verbose = true) const;
+    bool loadState(const std::string& filename, const NeuralNetwork& network, bool verbose = true);
+
+    // True once there is state worth saving (never for plain SGD)
+    bool hasState() const { return !firstMoment.empty() || !secondMoment.empty(); }
+
+    const Settings& settings() const { return config; }
+    long long steps() const { return stepCount; }
+
+    static const char* name(Type type);
+
+    // Parse "sgd", "momentum", "rmsprop" or "adam"; false for anything else
+    static bool parse(const std::string& text, Type& type);
+
+    // Parameter count of a network (weights and biases of every layer)
+    static size_t parameterCount(const NeuralNetwork& network);
+
+private:
+    Settings config;
+    long long stepCount = 0;
+    std::vector<float> firstMoment;   // Momentum velocity / Adam m
+    std::vector<float> secondMoment;  // RMSProp / Adam s
+
+    void sizeState(size_t parameters);
+};
@@ -0,0 +1,147 @@
+#pragma once
+#include "NeuralNetwork.h"
+#include "Optimizer.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iosfwd>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Data-parallel mini-batch training for a NeuralNetwork.
+//
+// Each batch is split into contiguous shards, one per worker. Each worker runs
+// the forward and backward pass for its shard into its own workspace and
+// gradient buffers.
+//
+// Synchronous: workers read the shared master weights (read only, so no
+// per-worker copy of the model is needed). Once every shard is done the
+// gradients are summed in shard order and applied once. The result depends only
+// on the worker count, never on thread timing, so runs are repeatable.
+//
+// Hogwild: the workers keep training in the background, across batches.
+// trainBatch splits the batch into shards, queues them and returns. Each worker
+// takes the next shard, computes its gradient against the shared network's
+// current weights and adds it to them straight away, with no lock and no wait
+// for the other workers. A worker may read weights another is updating; the
+// stale or lost updates are the price of never stopping at a barrier, so runs
+// are not repeatable. Only plain SGD runs this way.
+class ParallelTrainer {
+public:
+    enum class Mode {
+        Synchronous,
+        Hogwild
+    };
+
+    // workerCount includes the calling thread; 0 means one per hardware thread
+    explicit ParallelTrainer(NeuralNetwork& network, int workerCount = 0, Mode mode = Mode::Synchronous);
+    ~ParallelTrainer();
+
+    ParallelTrainer(const ParallelTrainer&) = delete;
+    ParallelTrainer& operator=(const ParallelTrainer&) = delete;
+
+    // Same contract as NeuralNetwork::trainBatch in MiniBatch mode: the gradient
+    // is averaged over the whole batch and the average per-example loss from the
+    // training forward pass is returned. With one worker this is trainBatch itself.
+    // Hogwild returns once the batch is queued (or, when the queue is full, once
+    // there is room), with the average loss of the examples the workers finished
+    // since the previous call.
+    float trainBatch(const std::vector<TrainingExample>& batch, float learningRate);
+
+    // NeuralNetwork::trainBatch with an optimizer. Optimizer state needs the
+    // whole batch's gradient, so rules other than plain SGD always step
+    // synchronously; in Hogwild mode they wait for the queue and run on the
+    // calling thread alone.
+    float trainBatch(const std::vector<TrainingExample>& batch, Optimizer& optimizer);
+
+    // NeuralNetwork::calculateLoss with the examples split across the workers.
+    // Hogwild evaluates the weights as they are, on the calling thread, while
+    // the workers carry on.
+    float calculateLoss(const std::vector<TrainingExample>& examples);
+
+    // Hogwild: wait until the workers have trained every queued shard. Call
+    // before reading or changing the network directly; the optimizer trainBatch
+    // and the destructor do it themselves. Does nothing in synchronous mode.
+    void synchronize();
+
+    int workerCount() const { return workers; }
+    Mode mode() const { return updateMode; }
+    static const char* modeName(Mode mode);
+
+    // Examples trained per second of training so far: time spent in trainBatch,
+    // or for Hogwild, time with shards queued or in training
+    double throughput() const;
+
+    // Train the same batch with 1, 2, 4, ... up to maxWorkers workers (maxWorkers
+    // itself included) on copies of network and print examples/s, speedup over
+    // one worker and parallel efficiency (speedup / workers) for each. Returns
+    // the one-worker examples/s.
+    static double reportScaling(const NeuralNetwork& network, const std::vector<TrainingExample>& batch,
+                                float learningRate, int maxWorkers, Mode mode, std::ostream& out);
+
+    // reportScaling for this trainer's network, up to its worker count
+    double reportScaling(const std::vector<TrainingExample>& batch, float learningRate, std::ostream& out) const {
+        return reportScaling(network, batch, learningRate, workerCount(), updateMode, out);
+    }
+
+private:
+    // Per-worker buffers, reused across batches
+    struct Replica {
+        NeuralNetwork::TrainingWorkspace workspace;
+        NeuralNetwork::Gradients gradients;
+        float loss = 0.0f;
+    };
+
+    // Hogwild: part of a queued batch, with the step size for the whole batch
+    struct Shard {
+        std::vector<TrainingExample> examples;
+        float stepSize = 0.0f;
+    };
+
+    // Parameters below which the shard gradients are summed on one thread
+    static const long long PARALLEL_REDUCE_THRESHOLD = 1LL << 16;
+
+    // Hogwild shards waiting per worker before trainBatch blocks
+    static const int HOGWILD_QUEUE_DEPTH = 2;
+
+    NeuralNetwork& network;
+    Mode updateMode;
+    int workers;
+    ThreadPool pool;  // synchronous mode only
+    std::vector<Replica> replicas;
+
+    // Hogwild workers and their queue. The mutex guards the queue and the
+    // counters only, never the weights.
+    std::vector<std::thread> hogwildThreads;
+    mutable std::mutex queueMutex;
+    std::condition_variable shardReady;    // workers wait for a shard
+    std::condition_variable queueChanged;  // trainBatch waits for room, synchronize for idle workers
+    std::deque<Shard> queue;
+    int busyWorkers = 0;
+    bool training = false;  // shards queued since the last synchronize
+    bool stopping = false;
+    float finishedLoss = 0.0f;
+    size_t finishedExamples = 0;
+    float lastLoss = 0.0f;
+
+    // For throughput(); Hogwild updates them under queueMutex
+    using Clock = std::chrono::steady_clock;
+    long long trainedExamples = 0;
+    double trainingSeconds = 0.0;
+    Clock::time_point busySince;  // Hogwild: when the queue last went from idle to busy
+
+    static int batchRows(const std::vector<TrainingExample>& batch);
+
+    // Backpropagate each shard on its own worker with the given step size and
+    // return the summed loss
+    float runShards(const std::vector<TrainingExample>& batch, int shards, float stepSize);
+
+    // Hogwild: queue the batch's shards for the background workers
+    float queueShards(const std::vector<TrainingExample>& batch, int shards, float stepSize);
+    void hogwildLoop(int worker);
+
+    // Sum every replica's gradients into replicas[0], in shard order
+    void reduceGradients(int shards);
+};
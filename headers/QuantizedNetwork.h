@@ -0,0 +1,80 @@
+#pragma once
+#include "NeuralNetwork.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Post-training quantized copy of a trained NeuralNetwork. This is a
+// size-only storage format: the weights take a quarter (int8) or half (fp16)
+// of the fp32 bytes, but it does not speed up evaluation, so runSimulation,
+// validateModel and game mode keep running the fp32 network.
+//
+// Int8: each output channel (weight column) gets its own scale, max|w| / 127.
+// At inference the layer input is quantized on the fly to the same range,
+// the product runs in exact integer arithmetic (MatrixKernels::gemvInt8) and
+// is rescaled to float before the bias and activation.
+//
+// Float16: weights are stored as IEEE half floats and widened during the
+// product (MatrixKernels::gemvHalf); inputs and accumulation stay float.
+//
+// Biases, scales and activations stay float in both modes.
+//
+// On the {12, 32, 16, 4} controller benchmarkQuantized measures int8 at about
+// 570 ns and fp16 at about 440 ns per predictInto, against about 350 ns for
+// NeuralNetwork, and int8 loses about 4 points of win rate over seeds 0-199.
+// At these widths the integer product is no cheaper than the fp32 FMA one
+// (gemvInt8 and gemv both take about 40 ns a layer), so static activation
+// scales, which would only drop the per-layer quantizeInt8, cannot close the
+// gap. The parity harness stays so that a wider network can be measured.
+//
+// main --quantize writes a .qnn file; game mode does not fly one.
+class QuantizedNetwork {
+public:
+    enum class Precision : int {
+        Int8 = 0,
+        Float16 = 1
+    };
+
+    struct QuantizedLayer {
+        int inputs = 0;
+        int outputs = 0;
+        int paddedInputs = 0;               // Int8: inputs rounded up to even
+        Activations::Type activation = Activations::Type::Sigmoid;
+        std::vector<int8_t> weights;        // Int8: paddedInputs / 2 pair rows of 2 x outputs (see gemvInt8)
+        std::vector<float> scales;          // Int8: per output channel
+        std::vector<uint16_t> halfWeights;  // Float16: inputs x outputs, same layout as Layer::weights
+        std::vector<float> biases;
+    };
+
+    QuantizedNetwork() = default;
+
+    // Quantize every layer of a trained network
+    static QuantizedNetwork quantize(const NeuralNetwork& network, Precision precision);
+
+    // Allocation-free inference on one state (uses per-thread scratch buffers)
+    void predictInto(const float* input, float* output) const;
+
+    // n contiguous states to n actions, one predictInto per row
+    void predictBatch(const float* states, size_t n, float* actions) const;
+    Matrix predict(const Matrix& input) const;
+
+    // Compact model file: header, then per layer its shape, activation,
+    // scales/biases and raw int8 or half weights
+    bool saveModel(const std::string& filename, bool verbose = true) const;
+    bool loadModel(const std::string& filename, bool verbose = true);
+
+    Precision precision() const { return weightPrecision; }
+    int inputSize() const { return layers.empty() ? 0 : layers.front().inputs; }
+    int outputSize() const { return layers.empty() ? 0 : layers.back().outputs; }
+
+    // Bytes taken by the weights alone (for comparing against 4 bytes per fp32 weight)
+    size_t weightBytes() const;
+
+    static const char* precisionName(Precision precision);
+
+private:
+    Precision weightPrecision = Precision::Int8;
+    std::vector<QuantizedLayer> layers;
+
+    void forwardLayer(const QuantizedLayer& layer, const float* input, float* output) const;
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+// Wald's sequential probability ratio test on a win rate, for accepting a
+// model from as few episodes as the evidence allows.
+//
+// Episodes are fed in one at a time. The test weighs "the true win rate is
+// nullWinRate or lower" against "it is altWinRate or higher" and stops as soon
+// as the log-likelihood ratio crosses a bound:
+//
+//   accept when LLR >= log((1 - beta) / alpha)
+//   reject when LLR <= log(beta / (1 - alpha))
+//
+// alpha is the chance of accepting a model whose win rate is nullWinRate,
+// beta the chance of rejecting one whose win rate is altWinRate. A clear
+// winner or loser is decided in a handful of episodes; models between the
+// two rates take longer, up to maxEpisodes, where the test is cut off and
+// decided by whether the observed win rate reaches the midpoint of the two.
+class SequentialTest {
+public:
+    enum class Decision {
+        Continue,
+        Accept,
+        Reject
+    };
+
+    struct Settings {
+        double nullWinRate = 0.5;  // a model this good or worse should be rejected...
+        double altWinRate = 0.8;   // ...and one this good or better accepted
+        double alpha = 0.05;       // false accept rate at nullWinRate
+        double beta = 0.10;        // false reject rate at altWinRate
+        int maxEpisodes = 40;      // budget; the test is truncated here
+    };
+
+    // Invalid settings (rates outside 0 < null < alt < 1, error rates outside
+    // (0, 0.5), a budget below 1) are reported and replaced by the defaults
+    explicit SequentialTest(const Settings& settings);
+    SequentialTest() : SequentialTest(Settings()) {}
+
+    // Record one episode and return the decision so far. Results after a
+    // decision are ignored.
+    Decision addResult(bool won);
+
+    void reset();
+
+    Decision decision() const { return state; }
+    bool decided() const { return state != Decision::Continue; }
+    int episodes() const { return played; }
+    int wins() const { return won; }
+    double logLikelihoodRatio() const { return llr; }
+    double acceptBound() const { return upper; }
+    double rejectBound() const { return lower; }
+    const Settings& settings() const { return config; }
+
+    static const char* decisionName(Decision decision);
+
+private:
+    Settings config;
+    double winStep;   // LLR change for a win
+    double lossStep;  // and for a loss
+    double upper;
+    double lower;
+
+    Decision state = Decision::Continue;
+    int played = 0;
+    int won = 0;
+    double llr = 0.0;
+};
@@ -0,0 +1,254 @@
+#pragma once
+#include <cmath>
+#include <type_traits>
+
+// Ship physics for the simulation's inner loop.
+//
+// step() runs one frame of flight as a single inline pass: thrust and strafe
+// along the nose, turn, drag and brake, speed clamp, move and wrap. It comes
+// in two precisions:
+//
+//   ShipBody<float>   the fast path. Thrust and strafe read sin/cos of the
+//                     integer angle from a 360-entry table built at compile
+//                     time, thrust and strafe are one fused update, drag and
+//                     brake one multiply, and the clamp compares squared speeds
+//                     so most frames take no sqrt. Every product that feeds a
+//                     sum is an explicit fused multiply-add, so the rounding
+//                     does not depend on the compiler's contraction flags.
+//   ShipBody<double>  the reference: SpaceShip's original double math (cos/sin
+//                     of the angle in radians on every call, each force applied
+//                     on its own), kept to check the float path's trajectories.
+//
+// Both precisions turn the ship the same way (the angle is an int, truncated
+// like SpaceShip's), so their trajectories only drift apart by rounding.
+//
+// The float path also steps ships kept as structure-of-arrays (ShipArrays),
+// for simulators that hold many ships side by side. That step lives in
+// ShipPhysics.cpp with AVX2 and AVX-512 passes that fly 8 or 16 ships per
+// instruction (picked from MatrixKernels::activeIsa), and it lands each ship
+// exactly where the ShipBody<float> step would.
+
+template <typename Real>
+struct Vec2 {
+    Real x;
+    Real y;
+
+    constexpr Vec2 operator+(const Vec2& other) const { return {x + other.x, y + other.y}; }
+    constexpr Vec2 operator-(const Vec2& other) const { return {x - other.x, y - other.y}; }
+    constexpr Vec2 operator*(Real scale) const { return {x * scale, y * scale}; }
+    constexpr Vec2& operator+=(const Vec2& other) {
+        x += other.x;
+        y += other.y;
+        return *this;
+    }
+    constexpr Vec2& operator*=(Real scale) {
+        x *= scale;
+        y *= scale;
+        return *this;
+    }
+    constexpr Real dot(const Vec2& other) const { return x * other.x + y * other.y; }
+    constexpr Real lengthSquared() const { return dot(*this); }
+};
+
+template <typename Real>
+struct ShipBody {
+    Vec2<Real> position;
+    Vec2<Real> velocity;
+    int rotation;  // degrees, 0 = nose up (north)
+};
+
+// Whole-degree sin and cos, computed at compile time
+class ShipTrig {
+public:
+    static constexpr double PI = 3.14159265358979323846;
+
+    // sin and cos of every whole degree, correctly rounded to float
+    struct Table {
+        float sin[360];
+        float cos[360];
+    };
+
+    static constexpr int wrapDegrees(int degrees) {
+        int wrapped = degrees % 360;
+        return wrapped < 0 ? wrapped + 360 : wrapped;
+    }
+
+    static constexpr double sinDegrees(int degrees) {
+        // Fold into [0, 90] with sin(x + 180) = -sin(x) and sin(180 - x) = sin(x),
+        // then use a series on at most 45 degrees
+        int d = wrapDegrees(degrees);
+        double sign = 1.0;
+        if (d >= 180) {
+            d -= 180;
+            sign = -1.0;
+        }
+        if (d > 90) d = 180 - d;
+        return sign * (d <= 45 ? sinSeries(d * RADIANS_PER_DEGREE) : cosSeries((90 - d) * RADIANS_PER_DEGREE));
+    }
+
+    static constexpr double cosDegrees(int degrees) { return sinDegrees(wrapDegrees(degrees) + 90); }
+
+    static constexpr Table makeTable() {
+        Table table = {};
+        for (int d = 0; d < 360; ++d) {
+            table.sin[d] = static_cast<float>(sinDegrees(d));
+            table.cos[d] = static_cast<float>(cosDegrees(d));
+        }
+        return table;
+    }
+
+private:
+    static constexpr double RADIANS_PER_DEGREE = PI / 180.0;
+
+    // Taylor series, accurate to double rounding for |x| <= pi / 4
+    static constexpr double sinSeries(double x) {
+        double term = x;
+        double sum = x;
+        for (int n = 1; n < 12; ++n) {
+            term *= -x * x / ((2 * n) * (2 * n + 1));
+            sum += term;
+        }
+        return sum;
+    }
+
+    static constexpr double cosSeries(double x) {
+        double term = 1.0;
+        double sum = 1.0;
+        for (int n = 1; n < 12; ++n) {
+            term *= -x * x / ((2 * n - 1) * (2 * n));
+            sum += term;
+        }
+        return sum;
+    }
+};
+
+// Float ships side by side: ship i is at (posX[i], posY[i]), moving at
+// (velX[i], velY[i]), turned rotation[i] degrees
+struct ShipArrays {
+    float* posX;
+    float* posY;
+    float* velX;
+    float* velY;
+    int* rotation;
+};
+
+class ShipPhysics {
+public:
+    // Constants of the arena and the ship
+    struct Settings {
+        float dragFactor;  // velocity multiplier applied every frame
+        float maxSpeed;
+        float width;       // the ship wraps to the opposite edge when it leaves 0 .. width
+        float height;
+    };
+
+    // One frame's input, after the controller's dead zones
+    struct Command {
+        float thrust;   // acceleration along the nose, 0 for none
+        float strafe;   // acceleration to the right (negative: left), 0 for none
+        double turn;    // degrees added to the angle before truncation, 0 for none
+        float brake;    // extra velocity multiplier, 1 for none
+    };
+
+    // One Command per ship, side by side like ShipArrays
+    struct CommandArrays {
+        const float* thrust;
+        const float* strafe;
+        const double* turn;
+        const float* brake;
+    };
+
+    static constexpr ShipTrig::Table TRIG = ShipTrig::makeTable();
+
+    // Unit vector of the nose at this angle (north at 0, clockwise in screen coordinates)
+    static constexpr Vec2<float> heading(int rotation) {
+        int d = ShipTrig::wrapDegrees(rotation);
+        return {TRIG.sin[d], -TRIG.cos[d]};
+    }
+
+    template <typename Real>
+    static void step(ShipBody<Real>& ship, const Command& command, const Settings& settings) {
+        if constexpr (std::is_same<Real, float>::value) {
+            stepFast(ship, command, settings);
+        } else {
+            stepReference(ship, command, settings);
+        }
+    }
+
+    // One frame for ships 0 .. count - 1 of ships, ship i flying command i;
+    // ships whose flying entry is 0 keep their state
+    static void step(const ShipArrays& ships, const CommandArrays& commands, const int* flying, int count,
+                     const Settings& settings);
+
+    // The same in portable scalar code, for checking the SIMD versions
+    static void stepScalar(const ShipArrays& ships, const CommandArrays& commands, const int* flying, int count,
+                           const Settings& settings);
+
+private:
+    static void stepFast(ShipBody<float>& ship, const Command& command, const Settings& settings) {
+        stepFast(ship.position.x, ship.position.y, ship.velocity.x, ship.velocity.y, ship.rotation, command,
+                 settings);
+    }
+
+    static void stepFast(float& x, float& y, float& velX, float& velY, int& rotation, const Command& command,
+                         const Settings& settings) {
+        // Nose (s, -c) and right wing (c, s) of the angle the frame starts with
+        int d = ShipTrig::wrapDegrees(rotation);
+        float s = TRIG.sin[d];
+        float c = TRIG.cos[d];
+        velX += std::fma(s, command.thrust, c * command.strafe);
+        velY += std::fma(s, command.strafe, -(c * command.thrust));
+
+        rotation = static_cast<int>(rotation + command.turn);
+        float damping = settings.dragFactor * command.brake;
+        velX *= damping;
+        velY *= damping;
+
+        float speedSquared = std::fma(velY, velY, velX * velX);
+        if (speedSquared > settings.maxSpeed * settings.maxSpeed) {
+            float scale = settings.maxSpeed / std::sqrt(speedSquared);
+            velX *= scale;
+            velY *= scale;
+        }
+
+        wrapPosition(x, y, velX, velY, settings);
+    }
+
+    static void stepReference(ShipBody<double>& ship, const Command& command, const Settings& settings) {
+        Vec2<double>& v = ship.velocity;
+        double angleRad = (ship.rotation - 90.0) * (ShipTrig::PI / 180.0);
+        if (command.thrust != 0.0f) {
+            double power = command.thrust;
+            v += Vec2<double>{std::cos(angleRad) * power, std::sin(angleRad) * power};
+        }
+        if (command.strafe != 0.0f) {
+            int direction = command.strafe > 0.0f ? 1 : -1;
+            double power = std::abs(command.strafe);
+            double strafeAngle = angleRad + direction * (ShipTrig::PI / 2.0);
+            v += Vec2<double>{std::cos(strafeAngle) * power, std::sin(strafeAngle) * power};
+        }
+
+        ship.rotation = static_cast<int>(ship.rotation + command.turn);
+        v *= settings.dragFactor;
+        v *= command.brake;
+
+        float speed = std::sqrt(v.lengthSquared());
+        if (speed > settings.maxSpeed) {
+            float scale = settings.maxSpeed / speed;
+            v *= scale;
+        }
+
+        wrapPosition(ship.position.x, ship.position.y, ship.velocity.x, ship.velocity.y, settings);
+    }
+
+    // Move, then jump to the opposite edge on leaving the arena (SpaceShip's wrap)
+    template <typename Real>
+    static void wrapPosition(Real& x, Real& y, Real velX, Real velY, const Settings& settings) {
+        x += velX;
+        y += velY;
+        if (x < 0) x = settings.width;
+        else if (x > settings.width) x = 0;
+        if (y < 0) y = settings.height;
+        else if (y > settings.height) y = 0;
+    }
+};
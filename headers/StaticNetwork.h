@@ -0,0 +1,400 @@
+#pragma once
+#include "Activations.h"
+#include "MatrixKernels.h"
+#include "ModelFormat.h"
+#include "NeuralNetwork.h"
+#include <algorithm>
+#include <array>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Fixed-width layer kernels for StaticNetwork (StaticNetwork.cpp), one per
+// layer shape: the layer's outputs stay in AVX2 / AVX-512 registers from the
+// first multiply-add through the bias add and activation (forward), or
+// through the weight update and the error sums (backward). Both return false
+// on instruction sets without vector code (Scalar, SSE2) and for the Exact
+// tier's sigmoid and tanh; the network then runs its generic path.
+namespace StaticKernels {
+
+// Shapes with a kernel: ProductionNetwork's layers. Adding one takes a line
+// here and an INSTANTIATE_STATIC_KERNELS line in StaticNetwork.cpp.
+template <int In, int Out>
+constexpr bool HAS_KERNEL = false;
+template <>
+constexpr bool HAS_KERNEL<12, 32> = true;
+template <>
+constexpr bool HAS_KERNEL<32, 16> = true;
+template <>
+constexpr bool HAS_KERNEL<16, 4> = true;
+
+// out = act(in * w + bias) for one row, the same bits as MatrixKernels::gemv
+// followed by Activations::forward
+template <int In, int Out>
+bool forward(Activations::Type type, const float* in, const float* w, const float* bias, float* out);
+
+// StaticNetwork's per-example SGD step for one layer: gradient = error *
+// learningRate * act'(out), w += in^T gradient, bias += gradient, then (when
+// errorIn is not null) errorIn = w * gradient with the updated weights.
+// errorIn may be error. Rounds like NeuralNetwork's kernels, not the generic loops.
+template <int In, int Out>
+bool backward(Activations::Type type, const float* in, const float* out, const float* error, float learningRate,
+              float* w, float* bias, float* errorIn);
+
+}
+
+// Fixed-topology network with the layer sizes as template parameters,
+// e.g. StaticNetwork<12, 32, 16, 4>.
+//
+// All weights and biases live in one std::array and every loop bound is a
+// compile-time constant, so training needs no heap allocations, and layers
+// with a StaticKernels kernel run it instead of the dispatched gemv and
+// activation calls. Behaviour matches NeuralNetwork: sigmoid hidden layers,
+// tanh output layer, the same initial weights, predictions equal bit for bit,
+// the same per-example SGD update and the same .nn file format, so models
+// move freely between the two.
+template <int... Sizes>
+class StaticNetwork {
+public:
+    static constexpr int LAYER_COUNT = sizeof...(Sizes) - 1;
+    static constexpr std::array<int, sizeof...(Sizes)> SIZES = {Sizes...};
+    static constexpr int INPUT_SIZE = SIZES[0];
+    static constexpr int OUTPUT_SIZE = SIZES[LAYER_COUNT];
+
+    static_assert(LAYER_COUNT >= 1, "StaticNetwork needs at least an input and an output size");
+
+    // Hidden layers use sigmoid, the output layer tanh (same rule as NeuralNetwork)
+    static constexpr Activations::Type activationOf(int layer) {
+        return layer == LAYER_COUNT - 1 ? Activations::Type::Tanh : Activations::Type::Sigmoid;
+    }
+
+    // Parameters are stored layer by layer: weights (in x out, row-major) then biases (out)
+    static constexpr int weightOffset(int layer) {
+        int offset = 0;
+        for (int l = 0; l < layer; ++l)
+            offset += SIZES[l] * SIZES[l + 1] + SIZES[l + 1];
+        return offset;
+    }
+    static constexpr int biasOffset(int layer) { return weightOffset(layer) + SIZES[layer] * SIZES[layer + 1]; }
+    static constexpr int PARAMETER_COUNT = weightOffset(LAYER_COUNT);
+
+    // Outputs of every layer are stored one after another (layer 0 reads the
+    // caller's input where it is), each starting on a 64-byte boundary so the
+    // kernels' full-width stores never straddle two cache lines
+    static constexpr int ACTIVATION_ALIGNMENT = 16;  // floats
+    static constexpr int activationOffset(int layer) {
+        int offset = 0;
+        for (int l = 1; l < layer; ++l)
+            offset += (SIZES[l] + ACTIVATION_ALIGNMENT - 1) / ACTIVATION_ALIGNMENT * ACTIVATION_ALIGNMENT;
+        return offset;
+    }
+    static constexpr int ACTIVATION_COUNT = activationOffset(LAYER_COUNT + 1);
+
+    static constexpr int maxWidth() {
+        int widest = 0;
+        for (int size : SIZES)
+            widest = std::max(widest, size);
+        return widest;
+    }
+    static constexpr int MAX_WIDTH = maxWidth();
+
+    std::array<float, PARAMETER_COUNT> parameters;
+
+    // Same initial weights as NeuralNetwork (each block drawn from a fresh seed-42 stream)
+    StaticNetwork() {
+        for (int l = 0; l < LAYER_COUNT; ++l) {
+            randomizeBlock(parameters.data() + weightOffset(l), SIZES[l] * SIZES[l + 1]);
+            randomizeBlock(parameters.data() + biasOffset(l), SIZES[l + 1]);
+        }
+    }
+
+    explicit StaticNetwork(const NeuralNetwork& network) : StaticNetwork() {
+        copyFrom(network);
+    }
+
+    int inputSize() const { return INPUT_SIZE; }
+    int outputSize() const { return OUTPUT_SIZE; }
+
+    float* weights(int layer) { return parameters.data() + weightOffset(layer); }
+    const float* weights(int layer) const { return parameters.data() + weightOffset(layer); }
+    float* biases(int layer) { return parameters.data() + biasOffset(layer); }
+    const float* biases(int layer) const { return parameters.data() + biasOffset(layer); }
+
+    // Allocation-free inference on one state
+    void predictInto(const float* input, float* output) const {
+        alignas(64) std::array<float, ACTIVATION_COUNT> activations;
+        forwardAll(input, activations.data(), output, std::make_index_sequence<LAYER_COUNT>());
+    }
+
+    // n contiguous states to n actions. Each row already runs the fixed-width
+    // layer kernels, so the rows simply run back to back.
+    void predictBatch(const float* states, size_t n, float* actions) const {
+        for (size_t i = 0; i < n; ++i)
+            predictInto(states + i * INPUT_SIZE, actions + i * OUTPUT_SIZE);
+    }
+
+    Matrix predict(const Matrix& input) const {
+        Matrix result(input.rows, OUTPUT_SIZE);
+        predictBatch(input.data(), input.rows, result.data());
+        return result;
+    }
+
+    // One SGD step on a single example
+    void train(const float* input, const float* target, float learningRate) {
+        alignas(64) std::array<float, ACTIVATION_COUNT> activations;
+        float* output = activations.data() + activationOffset(LAYER_COUNT);
+        forwardAll(input, activations.data(), output, std::make_index_sequence<LAYER_COUNT>());
+
+        // Error at output layer
+        alignas(64) std::array<float, MAX_WIDTH> error;
+        for (int j = 0; j < OUTPUT_SIZE; ++j)
+            error[j] = target[j] - output[j];
+
+        backwardAll(input, activations.data(), error.data(), learningRate, std::make_index_sequence<LAYER_COUNT>());
+    }
+
+    void train(const Matrix& input, const Matrix& target, float learningRate) {
+        for (int i = 0; i < input.rows; ++i)
+            train(input.row(i).begin(), target.row(i).begin(), learningRate);
+    }
+
+    // Batch training: trains on all examples and returns average loss
+    float trainBatch(const std::vector<TrainingExample>& batch, float learningRate) {
+        float totalLoss = 0.0f;
+        for (const auto& example : batch) {
+            train(example.input, example.target, learningRate);
+            totalLoss += squaredError(example);
+        }
+        return totalLoss / batch.size();
+    }
+
+    // Calculate loss for evaluation
+    float calculateLoss(const std::vector<TrainingExample>& examples) const {
+        float totalLoss = 0.0f;
+        int totalOutputs = 0;
+        for (const auto& example : examples) {
+            totalLoss += squaredError(example);
+            totalOutputs += example.target.size();
+        }
+        return totalOutputs > 0 ? totalLoss / totalOutputs : 0.0f;
+    }
+
+    // Blend weights from another network into this one
+    // blendRatio: 0.0 = keep this network, 1.0 = fully replace with other
+    void blendWeights(const StaticNetwork& other, float blendRatio) {
+        for (int i = 0; i < PARAMETER_COUNT; ++i)
+            parameters[i] = parameters[i] * (1.0f - blendRatio) + other.parameters[i] * blendRatio;
+    }
+
+    // Overwrite every parameter with other's: one contiguous copy
+    bool copyParametersFrom(const StaticNetwork& other) {
+        parameters = other.parameters;
+        return true;
+    }
+
+    // Conversion to and from the dynamic network (topologies must match)
+    bool copyFrom(const NeuralNetwork& network) {
+        if (!sameTopology(network)) {
+            return false;
+        }
+        for (int l = 0; l < LAYER_COUNT; ++l) {
+            std::copy_n(network.layers[l].weights.data(), SIZES[l] * SIZES[l + 1], weights(l));
+            std::copy_n(network.layers[l].biases.data(), SIZES[l + 1], biases(l));
+        }
+        return true;
+    }
+
+    bool copyTo(NeuralNetwork& network) const {
+        if (!sameTopology(network)) {
+            return false;
+        }
+        for (int l = 0; l < LAYER_COUNT; ++l) {
+            std::copy_n(weights(l), SIZES[l] * SIZES[l + 1], network.layers[l].weights.data());
+            std::copy_n(biases(l), SIZES[l + 1], network.layers[l].biases.data());
+            network.layers[l].packWeights();
+        }
+        return true;
+    }
+
+    // Model persistence (same files as NeuralNetwork::saveModel / loadModel, see ModelFormat)
+    bool saveModel(const std::string& filename, bool verbose = true) const {
+        if (!ModelFormat::writeFile(filename, layerBlocks())) {
+            if (verbose) {
+                std::cerr << "Error: Could not write model file: " << filename << std::endl;
+            }
+            return false;
+        }
+        if (verbose) {
+            std::cout << "Model saved to: " << filename << std::endl;
+        }
+        return true;
+    }
+
+    // Every layer's shape, activation and parameters, as stored in model files
+    std::vector<ModelFormat::LayerBlock> layerBlocks() const {
+        std::vector<ModelFormat::LayerBlock> blocks;
+        for (int l = 0; l < LAYER_COUNT; ++l)
+            blocks.push_back({SIZES[l], SIZES[l + 1], activationOf(l), weights(l), biases(l)});
+        return blocks;
+    }
+
+    bool loadModel(const std::string& filename, bool verbose = true) {
+        std::vector<unsigned char> image;
+        std::vector<ModelFormat::LayerBlock> blocks;
+        bool hasActivations;
+        std::string error;
+        if (!ModelFormat::load(filename, image, blocks, hasActivations, error)) {
+            if (verbose) {
+                std::cerr << "Error: " << error << std::endl;
+            }
+            return false;
+        }
+        if (static_cast<int>(blocks.size()) != LAYER_COUNT) {
+            if (verbose) {
+                std::cerr << "Error: Model file has " << blocks.size() << " layers but network has "
+                          << LAYER_COUNT << " layers" << std::endl;
+            }
+            return false;
+        }
+
+        // Shapes and (when the file has them) activations are fixed by the type
+        for (int l = 0; l < LAYER_COUNT; ++l) {
+            if (blocks[l].inputs != SIZES[l] || blocks[l].outputs != SIZES[l + 1]) {
+                if (verbose) {
+                    std::cerr << "Error: Layer " << l << " dimensions mismatch" << std::endl;
+                }
+                return false;
+            }
+            if (hasActivations && blocks[l].activation != activationOf(l)) {
+                if (verbose) {
+                    std::cerr << "Error: Layer " << l << " activation does not match this network" << std::endl;
+                }
+                return false;
+            }
+        }
+
+        for (int l = 0; l < LAYER_COUNT; ++l) {
+            std::copy_n(blocks[l].weights, SIZES[l] * SIZES[l + 1], weights(l));
+            std::copy_n(blocks[l].biases, SIZES[l + 1], biases(l));
+        }
+
+        if (verbose) {
+            std::cout << "Model loaded from: " << filename << std::endl;
+        }
+        return true;
+    }
+
+private:
+    static void randomizeBlock(float* block, int count) {
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> dist(-0.5f, 0.5f);
+        for (int i = 0; i < count; ++i)
+            block[i] = dist(rng);
+    }
+
+    bool sameTopology(const NeuralNetwork& network) const {
+        if (static_cast<int>(network.layers.size()) != LAYER_COUNT) {
+            return false;
+        }
+        for (int l = 0; l < LAYER_COUNT; ++l) {
+            if (network.layers[l].weights.rows != SIZES[l] || network.layers[l].weights.cols != SIZES[l + 1] ||
+                network.layers[l].activation != activationOf(l)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    float squaredError(const TrainingExample& example) const {
+        std::array<float, OUTPUT_SIZE> prediction;
+        predictInto(example.input.data(), prediction.data());
+        float total = 0.0f;
+        for (int j = 0; j < OUTPUT_SIZE; ++j) {
+            float error = example.target(0, j) - prediction[j];
+            total += error * error;
+        }
+        return total;
+    }
+
+    template <int L>
+    void forwardLayer(const float* in, float* out) const {
+        constexpr int In = SIZES[L];
+        constexpr int Out = SIZES[L + 1];
+        const float* w = weights(L);
+        const float* b = biases(L);
+
+        if constexpr (StaticKernels::HAS_KERNEL<In, Out>) {
+            if (StaticKernels::forward<In, Out>(activationOf(L), in, w, b, out)) {
+                return;
+            }
+        }
+
+        // The product goes through the ISA-dispatched kernel, so outputs match
+        // NeuralNetwork::predictInto bit-for-bit on the same machine
+        MatrixKernels::gemv(in, w, Out, out, In, Out);
+        Activations::forward(activationOf(L), out, b, Out);
+    }
+
+    // Layer L's input: the caller's for the first layer, the previous layer's output after
+    template <int L>
+    static const float* layerInput(const float* input, const float* activations) {
+        return L == 0 ? input : activations + activationOffset(L);
+    }
+
+    template <size_t... L>
+    void forwardAll(const float* input, float* activations, float* output, std::index_sequence<L...>) const {
+        (forwardLayer<L>(layerInput<L>(input, activations),
+                         L + 1 == LAYER_COUNT ? output : activations + activationOffset(L + 1)), ...);
+    }
+
+    // Update layer L from its output error, then overwrite error with the
+    // error of layer L's input (computed with the updated weights, as in NeuralNetwork)
+    template <int L>
+    void backwardLayer(const float* input, const float* activations, float* error, float learningRate) {
+        constexpr int In = SIZES[L];
+        constexpr int Out = SIZES[L + 1];
+        const float* in = layerInput<L>(input, activations);
+        const float* out = activations + activationOffset(L + 1);
+        float* w = weights(L);
+        float* b = biases(L);
+
+        if constexpr (StaticKernels::HAS_KERNEL<In, Out>) {
+            if (StaticKernels::backward<In, Out>(activationOf(L), in, out, error, learningRate, w, b,
+                                                 L > 0 ? error : nullptr)) {
+                return;
+            }
+        }
+
+        float gradient[Out];
+        for (int j = 0; j < Out; ++j)
+            gradient[j] = error[j] * learningRate;
+        Activations::backward(activationOf(L), out, gradient, Out);
+
+        for (int i = 0; i < In; ++i)
+            for (int j = 0; j < Out; ++j)
+                w[i * Out + j] += in[i] * gradient[j];
+        for (int j = 0; j < Out; ++j)
+            b[j] += gradient[j];
+
+        if constexpr (L > 0) {
+            for (int i = 0; i < In; ++i) {
+                float acc = 0.0f;
+                for (int j = 0; j < Out; ++j)
+                    acc += gradient[j] * w[i * Out + j];
+                error[i] = acc;
+            }
+        }
+    }
+
+    template <size_t... L>
+    void backwardAll(const float* input, const float* activations, float* error, float learningRate,
+                     std::index_sequence<L...>) {
+        // Fold runs left to right, so this visits the output layer first
+        (backwardLayer<LAYER_COUNT - 1 - static_cast<int>(L)>(input, activations, error, learningRate), ...);
+    }
+};
+
+// The controller topology built in main.cpp
+using ProductionNetwork = StaticNetwork<12, 32, 16, 4>;
@@ -0,0 +1,61 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data-parallel loops.
+// The calling thread takes part in the work, so a pool of size 1 has no workers
+// and simply runs everything inline.
+class ThreadPool {
+public:
+    // threadCount includes the calling thread; 0 means one per hardware thread
+    explicit ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Number of threads that execute tasks (workers + caller)
+    int size() const { return static_cast<int>(workers.size()) + 1; }
+
+    // Run task(i) for every i in [0, count) and wait for all of them.
+    // Calls made from inside a pool task run serially on that thread.
+    template <typename Task>
+    void parallelFor(int count, const Task& task) {
+        run(count, [](const void* context, int index) { (*static_cast<const Task*>(context))(index); }, &task);
+    }
+
+    // Process-wide pool used by the matrix kernels and trainers
+    static ThreadPool& shared();
+
+    // Rebuild the shared pool with a new thread count (0 = hardware threads).
+    // Must not be called while the shared pool is running work.
+    static void setSharedThreadCount(int threadCount);
+
+    // Number of hardware threads (at least 1)
+    static int hardwareThreads();
+
+private:
+    using TaskFunction = void (*)(const void* context, int index);
+
+    std::vector<std::thread> workers;
+    std::mutex submitMutex;             // one parallelFor at a time
+    std::mutex stateMutex;
+    std::condition_variable workReady;
+    std::condition_variable workDone;
+
+    // Current job (valid while activeWorkers > 0)
+    TaskFunction jobFunction = nullptr;
+    const void* jobContext = nullptr;
+    int jobCount = 0;
+    std::atomic<int> nextIndex{0};
+    int activeWorkers = 0;
+    unsigned long long generation = 0;
+    bool stopping = false;
+
+    void run(int count, TaskFunction function, const void* context);
+    void workerLoop();
+    void drainJob();
+};
@@ -1,23 +1,40 @@
 #pragma once
+#include "AsyncFileWriter.h"
+#include "CounterRng.h"
 #include "NeuralNetwork.h"
+#include "Optimizer.h"
+#include "SequentialTest.h"
+#include <memory>
 #include <string>
 #include <vector>
 #include <limits>
 
+// Templated on the network type so training can run on either the dynamic
+// NeuralNetwork or a fixed-size StaticNetwork. Member definitions live in
+// TrainingManager.cpp, explicitly instantiated for both.
+template <typename Network = NeuralNetwork>
 class TrainingManager {
 private:
-    NeuralNetwork* network;
+    Network* network;
     float bestLoss;
     int bestBatch;
     int totalBatches;
+
+    // Every random draw of a session comes from CounterRng streams of runSeed:
+    // simulated episodes use stream nextEpisode (fitness checks and validation
+    // alike), generateBatchData the stream DATA_STREAM
+    uint64_t runSeed;
+    uint64_t nextEpisode = 0;
+    static const uint64_t DATA_STREAM = ~0ULL;
+    CounterRng dataRng;
     bool lastSimWon = false;
     bool lastSimHit = false;
     bool hasWinningModel = false;  // Track if we've ever saved a winning model
+    int firstWinBatch = 0;         // Batch of this session's first validated win (0 = none yet)
     float bestWinLoss = std::numeric_limits<float>::max();  // Best loss among winning models
     const std::string BEST_MODEL_FILE = "best_model.nn";
     const std::string TRAINING_LOG_FILE = "training_log.txt";
     const int EXAMPLES_PER_BATCH = 32;  // Smaller batches = more iterations
-    const float LEARNING_RATE = 0.01f;  // Lower for more stable learning
     const int TRAINING_TIME_SECONDS = 30;  // 30 minutes
     const int DISPLAY_INTERVAL_BATCHES = 5000;
 
@@ -30,28 +47,75 @@ private:
     // Save progress to log file
     void logBatchProgress(float batchLoss, float validationLoss, float improvement);
 
-    // Load best model for batch training
+    // Log a validation as "Validation,batch,wins,episodes,decision", so the
+    // episodes each decision took can be read back from the log
+    void logValidation(const SequentialTest& test);
+
+    // Restore the best weights for batch training (a copy from bestSnapshot)
     void loadBestModel();
 
     // Check and save new best model if validation loss improves
     void updateBestModel(float validationLoss);
 
+    // Make the current weights the best: snapshot them in memory and queue the checkpoint
+    void saveBestModel();
+
     // Simulate game and calculate fitness score
     float simulateGameFitness(int simulationFrames = 1000);
 
-    // Validate model by running multiple simulations
-    // Returns true if model wins enough times to be considered consistent
-    bool validateModel(int numTests, int requiredWins, int maxFrames);
+    // Validate model by running simulations (concurrently, one seed each) until
+    // acceptanceTest decides. Returns true if the model's win rate is judged
+    // good enough to be considered consistent.
+    bool validateModel(int maxFrames);
 
     // Validation settings
-    const int VALIDATION_TESTS = 10;           // Number of test runs
-    const int VALIDATION_REQUIRED_WINS = 7;   // Must win 3/5 (60%) to pass
+    SequentialTest::Settings acceptanceTest;
     const int VALIDATION_MAX_FRAMES = 2000;   // Shorter sims for validation
+    const int GAME_EVALUATION_INTERVAL = 100;  // Batches between game simulations
+    int validationDecisions = 0;               // for the end-of-session summary
+    int validationEpisodes = 0;
+
+    // Update rule (plain SGD at 0.01 unless setOptimizer says otherwise).
+    // Its state is saved next to every model checkpoint as <model>.opt.
+    // loadBestModel runs after every batch and puts bestOptimizer back with
+    // the weights, so a stateful optimizer's moments only build up across
+    // batches that improve on the best loss; a batch that does not is undone
+    // along with the moments it added.
+    Optimizer optimizer;
+
+    // Best weights and the optimizer state that went with them, kept in memory
+    // so restoring them every batch never touches the disk
+    std::unique_ptr<Network> bestSnapshot;
+    Optimizer bestOptimizer;
+    bool hasBestOptimizer = false;
+
+    // Checkpoints are written on this thread (temp file, sync, rename)
+    AsyncFileWriter modelWriter;
+
+    // Queue the model and, when there is any, the optimizer state beside it.
+    // The parameters are captured now; call modelWriter.flush() to wait for the files.
+    void saveCheckpoint(const std::string& filename);
+
+    // Data-parallel training (NeuralNetwork only, see ParallelTrainer)
+    int trainingWorkers = 1;
+    bool hogwildTraining = false;
 
 public:
-    TrainingManager(NeuralNetwork* nn);
+    TrainingManager(Network* nn);
     ~TrainingManager();
 
+    // Split each batch across workers threads (0 = one per hardware thread).
+    // hogwild lets the workers train asynchronously across batches (see
+    // ParallelTrainer); it needs the sgd optimizer and falls back to
+    // synchronous updates with any other.
+    void setParallelTraining(int workers, bool hogwild);
+
+    // Choose the update rule. Fixed-size StaticNetworks only support plain SGD.
+    void setOptimizer(const Optimizer::Settings& settings);
+
+    // Win rates, error rates and episode budget for accepting a winning model
+    void setAcceptanceTest(const SequentialTest::Settings& settings) { acceptanceTest = settings; }
+
     // Run continuous training session
     void train();
 
@@ -59,4 +123,5 @@ public:
     float getBestLoss() const { return bestLoss; }
     int getBestBatch() const { return bestBatch; }
     int getTotalBatches() const { return totalBatches; }
+    int getFirstWinBatch() const { return firstWinBatch; }
 };
@@ -0,0 +1,102 @@
+#pragma once
+#include "BulletLanes.h"
+#include "GameLogic.h"
+#include <cstdint>
+#include <vector>
+
+// Steps many independent episodes together so the controller network sees
+// one predictBatch per frame instead of one predictInto per ship.
+//
+// Each lane is one ship. Ship state lives in structure-of-arrays float
+// buffers (positions, velocities, angles) and every lane's bullets in one
+// BulletLanes, so a frame is a handful of passes across all lanes: one
+// BulletLanes::scan moves and measures every lane's bullets, one
+// predictBatch runs the network on every live lane's inputs (packed into
+// consecutive rows, the actions coming back in the same order), and one
+// ShipPhysics::step flies every ship, 16 or 8 lanes per instruction. The
+// inputs are encoded the same way, 16 or 8 rows at a time by the batched
+// GameLogic::buildInputs. Only firing, gathering each lane's encoder inputs
+// and scoring stay a loop over lanes. A lane whose episode ends is
+// immediately given the next unplayed episode, so the batch stays full until
+// the episodes run out.
+//
+// What to expect: on one thread benchmarkVecSimulation measures 64 lanes at
+// about 2.3x runSimulation's episodes per second with {32, 16} hidden layers
+// and about 3.5x with {256, 256}, not an order of magnitude. The
+// batched forward pass does the same arithmetic per row as predictInto and
+// is about half of a lane-frame; the bullet scan and the per-lane loops take
+// most of the rest. So the speedup is bounded by the network, not by the
+// per-lane loops.
+//
+// Every lane reproduces GameLogic::runSimulation exactly: the same start
+// position stream, the same bullets (BulletLanes scans each lane as its
+// BulletField would),
+// the same ShipPhysics float step and the same scoring, so result i is bit
+// for bit runSimulation(network, maxFrames, runSeed, firstEpisode + i) for
+// every network whose predictBatch rows match its predictInto.
+//
+// Definitions live in VecSimulation.cpp, explicitly instantiated for the same
+// networks as GameLogic.
+template <typename Network>
+class VecSimulation {
+public:
+    static const int DEFAULT_LANES = 64;
+
+    VecSimulation(Network* network, int maxFrames, int lanes = DEFAULT_LANES);
+
+    // Play episodes firstEpisode .. firstEpisode + count - 1 of runSeed on the
+    // calling thread; results must have room for count entries
+    void run(uint64_t runSeed, uint64_t firstEpisode, int count, SimulationResult* results);
+    void run(uint64_t runSeed, uint64_t firstEpisode, int count, std::vector<SimulationResult>& results);
+
+    int laneCount() const { return lanes; }
+
+    // predictBatch calls and rows sent through them by the last run
+    long long batchCalls() const { return batches; }
+    long long batchRows() const { return rows; }
+
+private:
+    Network* network;
+    int maxFrames;
+    int lanes;
+
+    ShipPhysics::Settings settings;
+
+    // Per-lane ship and episode state
+    std::vector<float> posX;
+    std::vector<float> posY;
+    std::vector<float> velX;
+    std::vector<float> velY;
+    std::vector<int> rotation;          // degrees, 0 = nose up
+    std::vector<int> fireCounter;
+    std::vector<int> frame;
+    std::vector<float> totalLoss;
+    std::vector<float> previousDistance;
+    std::vector<float> closestDistance;
+    std::vector<int> slot;              // index into results of the lane's episode; -1 = idle
+    BulletLanes bullets;
+    std::vector<BulletField::Scan> scans;
+
+    // 1 for lanes playing this frame: all live lanes for the bullet scan,
+    // then only those not hit for the physics step
+    std::vector<int> flying;
+
+    // Lanes still flying this frame, in predictBatch row order, and their
+    // encoder inputs in the same order
+    std::vector<int> stepping;
+    GameLogic::InputArrays encoding;
+    std::vector<float> states;
+    std::vector<float> actions;
+
+    // Each flying lane's decoded command, by lane
+    std::vector<float> thrust;
+    std::vector<float> strafe;
+    std::vector<double> turn;
+    std::vector<float> brake;
+
+    long long batches = 0;
+    long long rows = 0;
+
+    void startEpisode(int lane, int index, uint64_t runSeed, uint64_t firstEpisode);
+    void finishEpisode(int lane, bool won, bool hit, SimulationResult* results);
+};
@@ -14,7 +14,7 @@ public:
     * @brief Creates a 2D Vector with x and y maginitudes set to 0
     *
     *************************************/
-    Vector2D();
+    Vector2D() : x(0), y(0) {}
     /*************************************
     * Creates a vector vector with x and y maginitudes
     * set to parameters
@@ -22,7 +22,7 @@ public:
     * @param x horizontal speed or a
     * @param y vertical speed or b
     *************************************/
-    Vector2D(double x, double y);
+    Vector2D(double x, double y) : x(x), y(y) {}
 
     /*************************************
     * Adds other vector2d to self vector2d
@@ -31,20 +31,23 @@ public:
     *
     * @param vector Vector of vector to add to self
     *************************************/
-    void add(const Vector2D vector);
+    void add(const Vector2D& vector) {
+        x += vector.x;
+        y += vector.y;
+    }
     
     /*************************************
     * @brief Gets the horizontal or x component of
     * self vector
     *
     *************************************/
-    double getX() const;
+    double getX() const { return x; }
     /*************************************
     * @brief Gets the vertical or y component of
     * self vector
     *
     *************************************/
-    double getY() const;
+    double getY() const { return y; }
 
     /*************************************
     * @brief Checks if compared vector equals
@@ -9,7 +9,7 @@ private:
     Vector2D velocity;
     int rotationAngle;
     int targetAngle;
-    void addVelocity(const Vector2D);
+    void addVelocity(const Vector2D& vel);
 
 public:
     SpaceShip();
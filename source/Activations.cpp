@@ -0,0 +1,331 @@
+#include "Activations.h"
+#include "ActivationKernels.h"
+#include "MatrixKernels.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+namespace Activations {
+
+// One spare entry past the end lets the last step interpolate without a branch
+const float* sigmoidTable() {
+    static const std::array<float, TABLE_STEPS + 2> table = [] {
+        std::array<float, TABLE_STEPS + 2> values{};
+        for (int i = 0; i <= TABLE_STEPS; ++i) {
+            double x = -TABLE_RANGE + i / static_cast<double>(TABLE_SCALE);
+            values[i] = static_cast<float>(1.0 / (1.0 + std::exp(-x)));
+        }
+        values[TABLE_STEPS + 1] = values[TABLE_STEPS];
+        return values;
+    }();
+    return table.data();
+}
+
+namespace {
+
+Accuracy currentAccuracy = Accuracy::Polynomial;
+
+// ---------- Scalar implementations ----------
+
+float sigmoidExact(float x) {
+    return 1.0f / (1.0f + std::exp(-x));
+}
+
+float tanhExact(float x) {
+    return std::tanh(x);
+}
+
+float expPolynomial(float x) {
+    x = std::min(std::max(x, EXP_MIN_INPUT), EXP_MAX_INPUT);
+    float n = std::nearbyint(x * LOG2E);
+    float r = x - n * LN2_HI;
+    r = r - n * LN2_LO;
+
+    float p = EXP_P0;
+    p = p * r + EXP_P1;
+    p = p * r + EXP_P2;
+    p = p * r + EXP_P3;
+    p = p * r + EXP_P4;
+    p = p * r + EXP_P5;
+    p = p * (r * r) + (r + 1.0f);
+
+    // 2^n built directly in the exponent bits
+    int32_t bits = (static_cast<int32_t>(n) + 127) << 23;
+    float scale;
+    std::memcpy(&scale, &bits, sizeof(scale));
+    return p * scale;
+}
+
+float sigmoidPolynomial(float x) {
+    return 1.0f / (1.0f + expPolynomial(-x));
+}
+
+float tanhPolynomial(float x) {
+    x = std::min(std::max(x, -TANH_LIMIT), TANH_LIMIT);
+    return 1.0f - 2.0f / (expPolynomial(2.0f * x) + 1.0f);
+}
+
+float sigmoidLookup(float x) {
+    float t = (std::min(std::max(x, -TABLE_RANGE), TABLE_RANGE) + TABLE_RANGE) * TABLE_SCALE;
+    int i = static_cast<int>(t);
+    float f = t - static_cast<float>(i);
+    const float* table = sigmoidTable();
+    return table[i] + f * (table[i + 1] - table[i]);
+}
+
+float tanhLookup(float x) {
+    return 2.0f * sigmoidLookup(2.0f * x) - 1.0f;
+}
+
+float relu(float x) {
+    return std::max(x, 0.0f);
+}
+
+float leakyRelu(float x) {
+    return std::max(x, x * LEAKY_RELU_SLOPE);
+}
+
+float hardTanh(float x) {
+    return std::min(std::max(x, -1.0f), 1.0f);
+}
+
+using ScalarFunction = float (*)(float);
+
+ScalarFunction scalarFunction(Type type, Accuracy tier) {
+    switch (type) {
+        case Type::Sigmoid:
+            return tier == Accuracy::Exact ? sigmoidExact : tier == Accuracy::Table ? sigmoidLookup : sigmoidPolynomial;
+        case Type::Tanh:
+            return tier == Accuracy::Exact ? tanhExact : tier == Accuracy::Table ? tanhLookup : tanhPolynomial;
+        case Type::ReLU: return relu;
+        case Type::LeakyReLU: return leakyRelu;
+        case Type::HardTanh: return hardTanh;
+    }
+    return sigmoidExact;
+}
+
+void forwardScalar(Type type, Accuracy tier, float* values, const float* bias, int count) {
+    ScalarFunction function = scalarFunction(type, tier);
+    if (bias) {
+        for (int i = 0; i < count; ++i)
+            values[i] = function(values[i] + bias[i]);
+    } else {
+        for (int i = 0; i < count; ++i)
+            values[i] = function(values[i]);
+    }
+}
+
+void backwardScalar(Type type, const float* outputs, float* gradient, int count) {
+    for (int i = 0; i < count; ++i)
+        gradient[i] *= derivative(type, outputs[i]);
+}
+
+}
+
+// ---------- Vector implementations ----------
+
+#ifdef MATRIX_KERNELS_X86
+
+// Loops over rows of values around ActivationKernels.h's per-vector math. The
+// element count need not be a multiple of the vector width: the tail runs
+// through a padded block so every element sees exactly the same arithmetic.
+#define DEFINE_ACTIVATION_KERNELS(TARGET)                                                             \
+    template <int KERNEL>                                                                             \
+    TARGET static void forwardLoop(float* values, const float* bias, int count, const float* table) { \
+        int i = 0;                                                                                    \
+        for (; i + Ops::WIDTH <= count; i += Ops::WIDTH) {                                            \
+            V x = Ops::load(values + i);                                                              \
+            if (bias) x = Ops::add(x, Ops::load(bias + i));                                           \
+            Ops::store(values + i, activate<KERNEL>(x, table));                                       \
+        }                                                                                             \
+        if (i < count) {                                                                              \
+            alignas(64) float block[Ops::WIDTH] = {};                                                 \
+            int rest = count - i;                                                                     \
+            for (int j = 0; j < rest; ++j)                                                            \
+                block[j] = bias ? values[i + j] + bias[i + j] : values[i + j];                        \
+            Ops::store(block, activate<KERNEL>(Ops::load(block), table));                             \
+            std::copy_n(block, rest, values + i);                                                     \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    template <int KERNEL>                                                                             \
+    TARGET static void backwardLoop(const float* outputs, float* gradient, int count) {               \
+        int i = 0;                                                                                    \
+        for (; i + Ops::WIDTH <= count; i += Ops::WIDTH) {                                            \
+            V g = Ops::load(gradient + i);                                                            \
+            Ops::store(gradient + i, Ops::mul(g, derive<KERNEL>(Ops::load(outputs + i))));            \
+        }                                                                                             \
+        if (i < count) {                                                                              \
+            alignas(64) float y[Ops::WIDTH] = {};                                                     \
+            alignas(64) float g[Ops::WIDTH] = {};                                                     \
+            int rest = count - i;                                                                     \
+            std::copy_n(outputs + i, rest, y);                                                        \
+            std::copy_n(gradient + i, rest, g);                                                       \
+            Ops::store(g, Ops::mul(Ops::load(g), derive<KERNEL>(Ops::load(y))));                      \
+            std::copy_n(g, rest, gradient + i);                                                       \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    /* values[r][j] += bias[j] for a block of rows, ahead of one activation pass */                   \
+    TARGET static void addBiasRows(float* values, const float* bias, int rows, int cols) {            \
+        for (int r = 0; r < rows; ++r) {                                                              \
+            float* row = values + static_cast<size_t>(r) * cols;                                      \
+            int j = 0;                                                                                \
+            for (; j + Ops::WIDTH <= cols; j += Ops::WIDTH)                                           \
+                Ops::store(row + j, Ops::add(Ops::load(row + j), Ops::load(bias + j)));               \
+            for (; j < cols; ++j)                                                                     \
+                row[j] += bias[j];                                                                    \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    TARGET static void forwardVector(Kernel kernel, float* values, const float* bias, int count) {    \
+        const float* table = sigmoidTable();                                                          \
+        switch (kernel) {                                                                             \
+            case SIGMOID_POLYNOMIAL: forwardLoop<SIGMOID_POLYNOMIAL>(values, bias, count, table); break; \
+            case TANH_POLYNOMIAL: forwardLoop<TANH_POLYNOMIAL>(values, bias, count, table); break;    \
+            case SIGMOID_TABLE: forwardLoop<SIGMOID_TABLE>(values, bias, count, table); break;        \
+            case TANH_TABLE: forwardLoop<TANH_TABLE>(values, bias, count, table); break;              \
+            case RELU: forwardLoop<RELU>(values, bias, count, table); break;                          \
+            case LEAKY_RELU: forwardLoop<LEAKY_RELU>(values, bias, count, table); break;              \
+            case HARD_TANH: forwardLoop<HARD_TANH>(values, bias, count, table); break;                \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    TARGET static void backwardVector(Type type, const float* outputs, float* gradient, int count) {  \
+        switch (type) {                                                                               \
+            case Type::Sigmoid: backwardLoop<SIGMOID_POLYNOMIAL>(outputs, gradient, count); break;    \
+            case Type::Tanh: backwardLoop<TANH_POLYNOMIAL>(outputs, gradient, count); break;          \
+            case Type::ReLU: backwardLoop<RELU>(outputs, gradient, count); break;                     \
+            case Type::LeakyReLU: backwardLoop<LEAKY_RELU>(outputs, gradient, count); break;          \
+            case Type::HardTanh: backwardLoop<HARD_TANH>(outputs, gradient, count); break;            \
+        }                                                                                             \
+    }
+
+namespace avx2 {
+
+DEFINE_ACTIVATION_KERNELS(TARGET_AVX2)
+
+}
+
+namespace avx512 {
+
+DEFINE_ACTIVATION_KERNELS(TARGET_AVX512)
+
+}
+
+#undef DEFINE_ACTIVATION_KERNELS
+
+#endif // MATRIX_KERNELS_X86
+
+void forward(Type type, float* values, const float* bias, int count) {
+    Accuracy tier = currentAccuracy;
+    bool transcendental = (type == Type::Sigmoid || type == Type::Tanh);
+    if (transcendental && tier == Accuracy::Exact) {
+        forwardScalar(type, tier, values, bias, count);
+        return;
+    }
+
+    switch (MatrixKernels::activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+        case MatrixKernels::Isa::AVX512:
+            avx512::forwardVector(vectorKernel(type, tier), values, bias, count);
+            return;
+        case MatrixKernels::Isa::AVX2:
+            avx2::forwardVector(vectorKernel(type, tier), values, bias, count);
+            return;
+#endif
+        default:
+            forwardScalar(type, tier, values, bias, count);
+    }
+}
+
+void forwardRows(Type type, float* values, const float* bias, int rows, int cols) {
+    Accuracy tier = currentAccuracy;
+    bool transcendental = (type == Type::Sigmoid || type == Type::Tanh);
+    if (!(transcendental && tier == Accuracy::Exact)) {
+        // Adding the bias first and activating the whole block in one call gives
+        // the same values as the fused per-row pass, without a call per short row
+        switch (MatrixKernels::activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+            case MatrixKernels::Isa::AVX512:
+                avx512::addBiasRows(values, bias, rows, cols);
+                avx512::forwardVector(vectorKernel(type, tier), values, nullptr, rows * cols);
+                return;
+            case MatrixKernels::Isa::AVX2:
+                avx2::addBiasRows(values, bias, rows, cols);
+                avx2::forwardVector(vectorKernel(type, tier), values, nullptr, rows * cols);
+                return;
+#endif
+            default:
+                break;
+        }
+    }
+    for (int r = 0; r < rows; ++r)
+        forwardScalar(type, tier, values + static_cast<size_t>(r) * cols, bias, cols);
+}
+
+void backward(Type type, const float* outputs, float* gradient, int count) {
+    switch (MatrixKernels::activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+        case MatrixKernels::Isa::AVX512:
+            avx512::backwardVector(type, outputs, gradient, count);
+            return;
+        case MatrixKernels::Isa::AVX2:
+            avx2::backwardVector(type, outputs, gradient, count);
+            return;
+#endif
+        default:
+            backwardScalar(type, outputs, gradient, count);
+    }
+}
+
+float apply(Type type, float x) {
+    return scalarFunction(type, Accuracy::Exact)(x);
+}
+
+float derivative(Type type, float y) {
+    switch (type) {
+        case Type::Sigmoid: return y * (1.0f - y);
+        case Type::Tanh: return 1.0f - y * y;
+        case Type::ReLU: return y > 0.0f ? 1.0f : 0.0f;
+        case Type::LeakyReLU: return y > 0.0f ? 1.0f : LEAKY_RELU_SLOPE;
+        case Type::HardTanh: return (1.0f - std::abs(y)) > 0.0f ? 1.0f : 0.0f;
+    }
+    return 0.0f;
+}
+
+Accuracy accuracy() {
+    return currentAccuracy;
+}
+
+void setAccuracy(Accuracy tier) {
+    currentAccuracy = tier;
+}
+
+const char* name(Type type) {
+    switch (type) {
+        case Type::Sigmoid: return "sigmoid";
+        case Type::Tanh: return "tanh";
+        case Type::ReLU: return "relu";
+        case Type::LeakyReLU: return "leaky_relu";
+        case Type::HardTanh: return "hard_tanh";
+    }
+    return "unknown";
+}
+
+const char* accuracyName(Accuracy tier) {
+    switch (tier) {
+        case Accuracy::Exact: return "exact";
+        case Accuracy::Polynomial: return "polynomial";
+        case Accuracy::Table: return "table";
+    }
+    return "unknown";
+}
+
+bool isValid(int code) {
+    return code >= 0 && code < TYPE_COUNT;
+}
+
+}
@@ -0,0 +1,133 @@
+#include "AsyncFileWriter.h"
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Push a written file's data (and on POSIX its directory entry) to stable storage
+bool syncFile(const std::string& path) {
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    bool synced = FlushFileBuffers(file) != 0;
+    CloseHandle(file);
+    return synced;
+#else
+    int descriptor = ::open(path.c_str(), O_WRONLY);
+    if (descriptor < 0) {
+        return false;
+    }
+    bool synced = fsync(descriptor) == 0;
+    ::close(descriptor);
+    return synced;
+#endif
+}
+
+bool replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+    if (std::rename(from.c_str(), to.c_str()) != 0) {
+        return false;
+    }
+    // Make the rename itself durable
+    size_t slash = to.find_last_of('/');
+    std::string directory = slash == std::string::npos ? "." : to.substr(0, slash + 1);
+    int descriptor = ::open(directory.c_str(), O_RDONLY);
+    if (descriptor >= 0) {
+        fsync(descriptor);
+        ::close(descriptor);
+    }
+    return true;
+#endif
+}
+
+}
+
+AsyncFileWriter::AsyncFileWriter() : worker(&AsyncFileWriter::workerLoop, this) {
+}
+
+AsyncFileWriter::~AsyncFileWriter() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    worker.join();
+}
+
+bool AsyncFileWriter::writeFileAtomically(const std::string& filename, const WriteFunction& write) {
+    std::string temporary = filename + ".tmp";
+    if (!write(temporary) || !syncFile(temporary) || !replaceFile(temporary, filename)) {
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+void AsyncFileWriter::submit(const std::string& filename, WriteFunction write) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& job : pending) {
+            if (job.filename == filename) {
+                job.write = std::move(write);
+                ++coalesced;
+                return;
+            }
+        }
+        pending.push_back({filename, std::move(write)});
+    }
+    workReady.notify_one();
+}
+
+void AsyncFileWriter::flush() {
+    std::unique_lock<std::mutex> lock(mutex);
+    workDone.wait(lock, [this] { return pending.empty() && !busy; });
+}
+
+long long AsyncFileWriter::completedWrites() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return completed;
+}
+
+long long AsyncFileWriter::coalescedWrites() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return coalesced;
+}
+
+long long AsyncFileWriter::failedWrites() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return failed;
+}
+
+void AsyncFileWriter::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        workReady.wait(lock, [this] { return stopping || !pending.empty(); });
+        if (pending.empty()) {
+            return;  // stopping, and everything has been written
+        }
+
+        Job job = std::move(pending.front());
+        pending.erase(pending.begin());
+        busy = true;
+        lock.unlock();
+
+        bool written = writeFileAtomically(job.filename, job.write);
+
+        lock.lock();
+        busy = false;
+        ++(written ? completed : failed);
+        workDone.notify_all();
+    }
+}
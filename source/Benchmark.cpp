@@ -0,0 +1,1748 @@
+#include "Benchmark.h"
+#include "Activations.h"
+#include "AsyncFileWriter.h"
+#include "BulletField.h"
+#include "BulletGrid.h"
+#include "BulletLanes.h"
+#include "CounterRng.h"
+#include "GameLogic.h"
+#include "MappedNetwork.h"
+#include "StaticNetwork.h"
+#include "MatrixKernels.h"
+#include "NeuroEvolution.h"
+#include "Optimizer.h"
+#include "ParallelTrainer.h"
+#include "QuantizedNetwork.h"
+#include "SequentialTest.h"
+#include "ShipPhysics.h"
+#include "ThreadPool.h"
+#include "VecSimulation.h"
+#include <algorithm>
+#include <cmath>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+using BenchClock = std::chrono::steady_clock;
+
+// Deterministic 1x12 sensor vector in the same ranges the game produces
+Matrix makeSampleState(int seed) {
+    Matrix state(1, 12);
+    for (int j = 0; j < state.cols; ++j) {
+        state(0, j) = static_cast<float>((seed * 31 + j * 17) % 100) / 100.0f;
+    }
+    return state;
+}
+
+Matrix makeRandomMatrix(int rows, int cols, float min, float max) {
+    Matrix m(rows, cols);
+    m.randomize(min, max);
+    return m;
+}
+
+float maxAbsDifference(const Matrix& a, const Matrix& b) {
+    float worst = 0.0f;
+    for (int i = 0; i < a.size(); ++i)
+        worst = std::max(worst, std::abs(a.data()[i] - b.data()[i]));
+    return worst;
+}
+
+double elapsedNanoseconds(BenchClock::time_point start) {
+    return std::chrono::duration<double, std::nano>(BenchClock::now() - start).count();
+}
+
+// Average time of one call, repeated for at least ~20 ms
+template <typename Call>
+double averageCallNanoseconds(const Call& call) {
+    int calls = 0;
+    auto start = BenchClock::now();
+    double total = 0.0;
+    do {
+        call();
+        ++calls;
+        total = elapsedNanoseconds(start);
+    } while (total < 2e7);
+    return total / calls;
+}
+
+// Keeps the optimizer from discarding benchmark results
+volatile float benchmarkSink = 0.0f;
+
+// Per-frame bullet work as GameLogic did it before BulletField: an array of
+// double structs walked three times (move and wrap; collision with a sqrt per
+// bullet; nearest with a sqrt per bullet and an atan2 per closer one).
+// Returns the nearest bullet's angle.
+struct LegacyBullet {
+    double x, y;
+    double velX, velY;
+};
+
+float legacyBulletFrame(std::vector<LegacyBullet>& bullets, double shipX, double shipY, bool& hit) {
+    for (auto& bullet : bullets) {
+        bullet.x += bullet.velX;
+        bullet.y += bullet.velY;
+        if (bullet.x < 0) bullet.x += WINDOW_WIDTH;
+        else if (bullet.x > WINDOW_WIDTH) bullet.x -= WINDOW_WIDTH;
+        if (bullet.y < 0) bullet.y += WINDOW_HEIGHT;
+        else if (bullet.y > WINDOW_HEIGHT) bullet.y -= WINDOW_HEIGHT;
+    }
+
+    hit = false;
+    for (const auto& bullet : bullets) {
+        double dx = bullet.x - shipX;
+        double dy = bullet.y - shipY;
+        if (std::sqrt(dx * dx + dy * dy) < BULLET_COLLISION_RADIUS) {
+            hit = true;
+            break;
+        }
+    }
+
+    float closestDistance = 1000.0f;
+    float closestAngle = 0.0f;
+    for (const auto& bullet : bullets) {
+        double dx = bullet.x - shipX;
+        double dy = bullet.y - shipY;
+        float distance = std::sqrt(dx * dx + dy * dy);
+        if (distance < closestDistance) {
+            closestDistance = distance;
+            closestAngle = std::atan2(dy, dx);
+        }
+    }
+    return closestAngle;
+}
+
+}
+
+double Benchmark::benchmarkPredict(const NeuralNetwork& network, int iterations) {
+    Matrix state = makeSampleState(1);
+    float checksum = 0.0f;
+
+    auto start = BenchClock::now();
+    for (int i = 0; i < iterations; ++i) {
+        state(0, 0) = static_cast<float>(i % 100) / 100.0f;
+        checksum += network.predict(state)(0, 0);
+    }
+    double total = elapsedNanoseconds(start);
+
+    benchmarkSink = checksum;
+    return total / iterations;
+}
+
+double Benchmark::benchmarkPredictInto(const NeuralNetwork& network, int iterations) {
+    Matrix state = makeSampleState(1);
+    std::vector<float> action(network.outputSize());
+    NeuralNetwork::Scratch scratch;
+    float checksum = 0.0f;
+
+    auto start = BenchClock::now();
+    for (int i = 0; i < iterations; ++i) {
+        state(0, 0) = static_cast<float>(i % 100) / 100.0f;
+        network.predictInto(state.data(), action.data(), scratch);
+        checksum += action[0];
+    }
+    double total = elapsedNanoseconds(start);
+
+    benchmarkSink = checksum;
+    return total / iterations;
+}
+
+double Benchmark::benchmarkTrain(NeuralNetwork& network, int iterations) {
+    Matrix state = makeSampleState(2);
+    Matrix target(1, network.layers.back().weights.cols, {0.5f, -0.5f, 0.25f, -1.0f});
+
+    auto start = BenchClock::now();
+    for (int i = 0; i < iterations; ++i) {
+        state(0, 0) = static_cast<float>(i % 100) / 100.0f;
+        network.train(state, target, 0.01f);
+    }
+    double total = elapsedNanoseconds(start);
+
+    benchmarkSink = network.layers.back().biases(0, 0);
+    return total / iterations;
+}
+
+namespace {
+
+template <typename Network>
+double timePredictInto(const Network& network, int iterations) {
+    Matrix state = makeSampleState(1);
+    float action[4];
+    float checksum = 0.0f;
+
+    auto start = BenchClock::now();
+    for (int i = 0; i < iterations; ++i) {
+        state(0, 0) = static_cast<float>(i % 100) / 100.0f;
+        network.predictInto(state.data(), action);
+        checksum += action[0];
+    }
+    double total = elapsedNanoseconds(start);
+
+    benchmarkSink = checksum;
+    return total / iterations;
+}
+
+template <typename Network>
+double timeTrain(Network& network, int iterations) {
+    Matrix state = makeSampleState(2);
+    Matrix target(1, 4, {0.5f, -0.5f, 0.25f, -1.0f});
+
+    auto start = BenchClock::now();
+    for (int i = 0; i < iterations; ++i) {
+        state(0, 0) = static_cast<float>(i % 100) / 100.0f;
+        network.train(state, target, 0.01f);
+    }
+    return elapsedNanoseconds(start) / iterations;
+}
+
+// Nanoseconds per simulated frame over a fixed number of episodes
+template <typename Network>
+double timeSimulationFrame(Network& network, int episodes) {
+    long long frames = 0;
+    auto start = BenchClock::now();
+    for (int i = 0; i < episodes; ++i)
+        frames += GameLogic::runSimulation(&network, 2000).framesPlayed + 1;
+    return elapsedNanoseconds(start) / frames;
+}
+
+struct ParityResult {
+    int wins = 0;
+    int hits = 0;
+    double totalLoss = 0.0;
+};
+
+// Play the same seeded episodes with any controller
+const uint64_t PARITY_RUN_SEED = 0;
+
+template <typename Network>
+ParityResult playSeeds(Network& network, int episodes, int maxFrames) {
+    ParityResult result;
+    for (int seed = 0; seed < episodes; ++seed) {
+        SimulationResult sim = GameLogic::runSimulation(&network, maxFrames, PARITY_RUN_SEED, seed);
+        result.wins += sim.won ? 1 : 0;
+        result.hits += sim.hit ? 1 : 0;
+        result.totalLoss += sim.totalLoss;
+    }
+    return result;
+}
+
+long long fileSize(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    return file.is_open() ? static_cast<long long>(file.tellg()) : -1;
+}
+
+}
+
+bool Benchmark::benchmarkQuantized() {
+    const int PARITY_EPISODES = 200;
+    const int PARITY_FRAMES = 2000;
+
+    // Prefer the trained model; quantization error on random weights says little
+    NeuralNetwork network({12, 32, 16, 4});
+    bool trained = network.loadModel("best_model.nn", false);
+
+    QuantizedNetwork int8Network = QuantizedNetwork::quantize(network, QuantizedNetwork::Precision::Int8);
+    QuantizedNetwork halfNetwork = QuantizedNetwork::quantize(network, QuantizedNetwork::Precision::Float16);
+
+    std::cout << "Quantized inference, size-only format ("
+              << (trained ? "best_model.nn" : "untrained {12, 32, 16, 4}") << "):" << std::endl;
+
+    float fp32Action[4];
+    float int8Action[4];
+    float halfAction[4];
+    float int8Worst = 0.0f;
+    float halfWorst = 0.0f;
+    for (int seed = 0; seed < 1000; ++seed) {
+        Matrix state = makeSampleState(seed);
+        network.predictInto(state.data(), fp32Action);
+        int8Network.predictInto(state.data(), int8Action);
+        halfNetwork.predictInto(state.data(), halfAction);
+        for (int j = 0; j < 4; ++j) {
+            int8Worst = std::max(int8Worst, std::abs(int8Action[j] - fp32Action[j]));
+            halfWorst = std::max(halfWorst, std::abs(halfAction[j] - fp32Action[j]));
+        }
+    }
+
+    // Model files, written to scratch names and removed again
+    network.saveModel("benchmark_fp32.tmp", false);
+    int8Network.saveModel("benchmark_int8.tmp", false);
+    halfNetwork.saveModel("benchmark_fp16.tmp", false);
+    long long fp32File = fileSize("benchmark_fp32.tmp");
+    long long int8File = fileSize("benchmark_int8.tmp");
+    long long halfFile = fileSize("benchmark_fp16.tmp");
+
+    // Round trip: a reloaded .qnn must predict bit for bit like the network
+    // that wrote it, and the same file cut short must be rejected
+    auto roundTrips = [](const QuantizedNetwork& saved, const std::string& filename) {
+        QuantizedNetwork loaded;
+        if (!loaded.loadModel(filename, false) || loaded.precision() != saved.precision()) {
+            return false;
+        }
+        float expected[4];
+        float actual[4];
+        for (int seed = 0; seed < 1000; ++seed) {
+            Matrix state = makeSampleState(seed);
+            saved.predictInto(state.data(), expected);
+            loaded.predictInto(state.data(), actual);
+            if (std::memcmp(expected, actual, sizeof(expected)) != 0) {
+                return false;
+            }
+        }
+        std::vector<unsigned char> image;
+        ModelFormat::readFile(filename, image);
+        image.resize(image.size() - 1);
+        ModelFormat::writeImage("benchmark_truncated.tmp", image);
+        QuantizedNetwork truncated;
+        bool rejected = !truncated.loadModel("benchmark_truncated.tmp", false);
+        std::remove("benchmark_truncated.tmp");
+        return rejected;
+    };
+    bool int8RoundTrip = roundTrips(int8Network, "benchmark_int8.tmp");
+    bool halfRoundTrip = roundTrips(halfNetwork, "benchmark_fp16.tmp");
+    std::remove("benchmark_fp32.tmp");
+    std::remove("benchmark_int8.tmp");
+    std::remove("benchmark_fp16.tmp");
+
+    auto sizeNote = [](long long bytes, float worst) {
+        std::ostringstream note;
+        note << bytes << " byte file";
+        if (worst >= 0.0f) {
+            note << ", max |diff| vs fp32 " << std::scientific << std::setprecision(1) << worst;
+        }
+        return note.str();
+    };
+    printResult("fp32 predictInto", timePredictInto(network, 200000), "call", sizeNote(fp32File, -1.0f));
+    printResult("int8 predictInto", timePredictInto(int8Network, 200000), "call", sizeNote(int8File, int8Worst));
+    printResult("fp16 predictInto", timePredictInto(halfNetwork, 200000), "call", sizeNote(halfFile, halfWorst));
+
+    // Win-rate parity: identical episodes, only the controller differs
+    ParityResult fp32 = playSeeds(network, PARITY_EPISODES, PARITY_FRAMES);
+    ParityResult int8 = playSeeds(int8Network, PARITY_EPISODES, PARITY_FRAMES);
+    ParityResult half = playSeeds(halfNetwork, PARITY_EPISODES, PARITY_FRAMES);
+
+    std::cout << "  Parity over seeds 0-" << (PARITY_EPISODES - 1) << " (" << PARITY_FRAMES << " frames):" << std::endl;
+    auto printParity = [&](const char* name, const ParityResult& result) {
+        double winRate = 100.0 * result.wins / PARITY_EPISODES;
+        double baseline = 100.0 * fp32.wins / PARITY_EPISODES;
+        std::cout << "    " << std::left << std::setw(6) << name << std::right << std::fixed << std::setprecision(1)
+                  << " wins " << std::setw(5) << winRate << "%  hits " << std::setw(4) << result.hits
+                  << "  avg loss " << std::setprecision(3) << std::setw(9) << result.totalLoss / PARITY_EPISODES
+                  << "  win-rate diff " << std::showpos << std::setprecision(1) << winRate - baseline
+                  << std::noshowpos << " pts" << std::endl;
+    };
+    printParity("fp32", fp32);
+    printParity("int8", int8);
+    printParity("fp16", half);
+    std::cout << "  .qnn save/load round trip: int8 " << (int8RoundTrip ? "exact" : "FAILED") << ", fp16 "
+              << (halfRoundTrip ? "exact" : "FAILED") << std::endl;
+    std::cout << std::endl;
+    return int8RoundTrip && halfRoundTrip;
+}
+
+void Benchmark::benchmarkTrainBatch() {
+    struct Case {
+        std::vector<int> sizes;
+        int batchSize;
+        int batches;
+    };
+    const Case cases[] = {
+        {{12, 32, 16, 4}, 32, 2000},
+        {{12, 32, 16, 4}, 256, 250},
+        {{12, 512, 512, 4}, 32, 20},
+    };
+
+    std::cout << "trainBatch throughput:" << std::endl;
+    for (const auto& c : cases) {
+        std::vector<TrainingExample> batch;
+        for (int i = 0; i < c.batchSize; ++i)
+            batch.emplace_back(makeSampleState(i), Matrix(1, 4, {0.5f, -0.5f, 0.25f, -1.0f}));
+
+        for (auto mode : {NeuralNetwork::BatchMode::PerSample, NeuralNetwork::BatchMode::MiniBatch}) {
+            NeuralNetwork network(c.sizes);
+            network.batchMode = mode;
+            float loss = 0.0f;
+
+            auto start = BenchClock::now();
+            for (int b = 0; b < c.batches; ++b)
+                loss += network.trainBatch(batch, 0.01f);
+            double perExample = elapsedNanoseconds(start) / (static_cast<double>(c.batches) * c.batchSize);
+            benchmarkSink = loss;
+
+            std::ostringstream name;
+            name << (mode == NeuralNetwork::BatchMode::MiniBatch ? "mini-batch" : "per-sample") << " {"
+                 << c.sizes[1] << ", " << c.sizes[2] << "} B=" << c.batchSize;
+            std::ostringstream note;
+            note << std::fixed << std::setprecision(0) << 1e9 / perExample << " examples/s";
+            printResult(name.str(), perExample, "example", note.str());
+        }
+    }
+    std::cout << std::endl;
+}
+
+bool Benchmark::benchmarkParallelTraining() {
+    const int WORKERS = 4;
+    const int STEPS = 20;
+    const float HOGWILD_TOLERANCE = 0.1f;  // of the synchronous weight change
+
+    std::vector<TrainingExample> batch;
+    for (int i = 0; i < 256; ++i)
+        batch.emplace_back(makeSampleState(i), Matrix(1, 4, {0.5f, -0.5f, 0.25f, -1.0f}));
+
+    // Two synchronous runs from the same start must agree bit for bit;
+    // against one thread only the summation order of the gradient differs
+    NeuralNetwork initial({12, 32, 16, 4});
+    NeuralNetwork serial = initial;
+    NeuralNetwork first = initial;
+    NeuralNetwork second = initial;
+    ParallelTrainer firstTrainer(first, WORKERS);
+    ParallelTrainer secondTrainer(second, WORKERS);
+    for (int step = 0; step < STEPS; ++step) {
+        serial.trainBatch(batch, 0.01f);
+        firstTrainer.trainBatch(batch, 0.01f);
+        secondTrainer.trainBatch(batch, 0.01f);
+    }
+
+    float repeatDifference = 0.0f;
+    float serialDifference = 0.0f;
+    for (size_t l = 0; l < initial.layers.size(); ++l) {
+        repeatDifference = std::max(repeatDifference, maxAbsDifference(first.layers[l].weights, second.layers[l].weights));
+        repeatDifference = std::max(repeatDifference, maxAbsDifference(first.layers[l].biases, second.layers[l].biases));
+        serialDifference = std::max(serialDifference, maxAbsDifference(first.layers[l].weights, serial.layers[l].weights));
+    }
+    bool passed = repeatDifference == 0.0f;
+    std::cout << "Parallel training (" << WORKERS << " workers, " << STEPS << " batches of " << batch.size()
+              << "): repeat difference " << repeatDifference << (passed ? "" : "  FAILED")
+              << ", vs one thread " << std::scientific << std::setprecision(2) << serialDifference
+              << std::defaultfloat << std::endl;
+
+    // Hogwild workers update the shared weights as they go, so runs do not
+    // repeat; check that the result stays close to synchronous training,
+    // measured against how far synchronous training moved the weights
+    NeuralNetwork hogwild = initial;
+    {
+        ParallelTrainer hogwildTrainer(hogwild, WORKERS, ParallelTrainer::Mode::Hogwild);
+        for (int step = 0; step < STEPS; ++step)
+            hogwildTrainer.trainBatch(batch, 0.01f);
+    }
+    float hogwildDifference = 0.0f;
+    float movement = 0.0f;
+    for (size_t l = 0; l < initial.layers.size(); ++l) {
+        hogwildDifference = std::max(hogwildDifference, maxAbsDifference(hogwild.layers[l].weights, first.layers[l].weights));
+        movement = std::max(movement, maxAbsDifference(first.layers[l].weights, initial.layers[l].weights));
+    }
+    bool hogwildPassed = hogwildDifference <= HOGWILD_TOLERANCE * movement;
+    std::cout << "Hogwild training (" << WORKERS << " workers, " << STEPS << " batches): vs synchronous "
+              << std::scientific << std::setprecision(2) << hogwildDifference << ", synchronous moved "
+              << movement << std::defaultfloat << (hogwildPassed ? "" : "  FAILED") << std::endl;
+    passed = passed && hogwildPassed;
+
+    int maxWorkers = std::max(WORKERS, ThreadPool::hardwareThreads());
+    for (auto mode : {ParallelTrainer::Mode::Synchronous, ParallelTrainer::Mode::Hogwild})
+        ParallelTrainer::reportScaling(initial, batch, 0.01f, maxWorkers, mode, std::cout);
+
+    NeuralNetwork wide({12, 512, 512, 4});
+    batch.resize(32);
+    ParallelTrainer::reportScaling(wide, batch, 0.01f, maxWorkers, ParallelTrainer::Mode::Synchronous, std::cout);
+    std::cout << std::endl;
+    return passed;
+}
+
+void Benchmark::benchmarkOptimizers() {
+    const int checkpoints[] = {100, 500, 2000};
+    const int BATCH_SIZE = 32;
+
+    // Targets come from a fixed "teacher" network with sharper first-layer
+    // weights, so the student has a smooth but non-trivial function to fit
+    NeuralNetwork teacher({12, 16, 4});
+    for (int i = 0; i < teacher.layers[0].weights.size(); ++i)
+        teacher.layers[0].weights.data()[i] *= 3.0f;
+    teacher.layers[0].packWeights();
+
+    std::vector<TrainingExample> pool;
+    for (int i = 0; i < 1024; ++i) {
+        Matrix state = makeSampleState(i * 7 + 3);
+        pool.emplace_back(state, teacher.predict(state));
+    }
+    std::vector<TrainingExample> validation(pool.begin(), pool.begin() + 256);
+
+    std::cout << "Optimizer convergence ({12, 32, 16, 4}, B=" << BATCH_SIZE << ", validation loss after N batches):"
+              << std::endl;
+    std::vector<TrainingExample> batch(BATCH_SIZE);
+    for (auto type : {Optimizer::Type::SGD, Optimizer::Type::Momentum, Optimizer::Type::RMSProp,
+                      Optimizer::Type::Adam}) {
+        Optimizer optimizer(Optimizer::defaults(type));
+        NeuralNetwork network({12, 32, 16, 4});
+        std::ostringstream losses;
+        int next = 0;
+        for (int b = 1; b <= checkpoints[2]; ++b) {
+            for (int i = 0; i < BATCH_SIZE; ++i)
+                batch[i] = pool[256 + (b * BATCH_SIZE + i) % 768];
+            network.trainBatch(batch, optimizer);
+            if (b == checkpoints[next]) {
+                losses << "  " << std::setw(5) << b << ": " << std::scientific << std::setprecision(2)
+                       << network.calculateLoss(validation);
+                ++next;
+            }
+        }
+        std::cout << "  " << std::left << std::setw(10) << Optimizer::name(type) << std::right << losses.str()
+                  << std::defaultfloat << std::endl;
+    }
+
+    // Cost of the update itself on a large network
+    NeuralNetwork wide({12, 512, 512, 4});
+    NeuralNetwork::Gradients direction;
+    for (const auto& layer : wide.layers) {
+        direction.weights.push_back(makeRandomMatrix(layer.weights.rows, layer.weights.cols, -1e-3f, 1e-3f));
+        direction.biases.push_back(makeRandomMatrix(1, layer.weights.cols, -1e-3f, 1e-3f));
+    }
+    double parameters = static_cast<double>(Optimizer::parameterCount(wide));
+    for (auto type : {Optimizer::Type::SGD, Optimizer::Type::Momentum, Optimizer::Type::RMSProp,
+                      Optimizer::Type::Adam}) {
+        Optimizer optimizer(Optimizer::defaults(type));
+        optimizer.step(wide, direction);
+        const int STEPS = 50;
+        auto start = BenchClock::now();
+        for (int i = 0; i < STEPS; ++i)
+            optimizer.step(wide, direction);
+        double perStep = elapsedNanoseconds(start) / STEPS;
+        std::ostringstream note;
+        note << std::fixed << std::setprecision(2) << perStep / parameters << " ns/parameter";
+        printResult(std::string(Optimizer::name(type)) + " step {12, 512, 512, 4}", perStep, "step", note.str());
+    }
+    std::cout << std::endl;
+}
+
+bool Benchmark::benchmarkModelLoading() {
+    const char* V1_FILE = "benchmark_v1.tmp";
+    const char* V2_FILE = "benchmark_v2.tmp";
+    const char* BAD_FILE = "benchmark_bad.tmp";
+
+    // Files stay in the OS cache between calls
+    auto timeCall = [](const auto& call) { return averageCallNanoseconds(call); };
+
+    std::cout << "Model loading (warm file cache):" << std::endl;
+    bool passed = true;
+    for (const auto& sizes : {std::vector<int>{12, 32, 16, 4}, std::vector<int>{12, 512, 512, 4}}) {
+        NeuralNetwork network(sizes);
+        network.saveModel(V1_FILE, false, 1);
+        network.saveModel(V2_FILE, false);
+        std::ostringstream shape;
+        shape << "{" << sizes[1] << ", " << sizes[2] << "}";
+
+        NeuralNetwork loaded(sizes);
+        MappedNetwork mapped;
+        printResult("load v1 " + shape.str(), timeCall([&] { loaded.loadModel(V1_FILE, false); }), "load",
+                    std::to_string(fileSize(V1_FILE)) + " bytes");
+        printResult("load v2 " + shape.str(), timeCall([&] { loaded.loadModel(V2_FILE, false); }), "load",
+                    std::to_string(fileSize(V2_FILE)) + " bytes");
+        printResult("mmap v2 + checksum " + shape.str(), timeCall([&] { mapped.open(V2_FILE, true, false); }), "load");
+        printResult("mmap v2, header only " + shape.str(), timeCall([&] { mapped.open(V2_FILE, false, false); }),
+                    "load");
+
+        // Mapped inference must agree with the network the file came from
+        std::vector<float> states(static_cast<size_t>(256) * network.inputSize());
+        for (int i = 0; i < 256; ++i) {
+            Matrix state = makeSampleState(i);
+            std::copy_n(state.data(), state.size(), states.data() + static_cast<size_t>(i) * network.inputSize());
+        }
+        std::vector<float> expected(static_cast<size_t>(256) * network.outputSize());
+        std::vector<float> actual(expected.size());
+        network.predictBatch(states.data(), 256, expected.data());
+        mapped.predictBatch(states.data(), 256, actual.data());
+        bool same = mapped.isOpen() && expected == actual;
+        std::cout << "  mapped predictBatch matches NeuralNetwork: " << (same ? "yes" : "NO  FAILED") << std::endl;
+        passed = passed && same;
+        mapped.close();
+    }
+
+    // A truncated copy and a copy with one flipped weight byte must both be rejected
+    std::vector<unsigned char> image;
+    ModelFormat::readFile(V2_FILE, image);
+    NeuralNetwork target({12, 512, 512, 4});
+    auto writeBad = [&](size_t bytes, size_t flip) {
+        std::vector<unsigned char> bad(image.begin(), image.begin() + bytes);
+        if (flip < bad.size()) {
+            bad[flip] ^= 0x40;
+        }
+        std::ofstream(BAD_FILE, std::ios::binary).write(reinterpret_cast<const char*>(bad.data()), bad.size());
+        MappedNetwork mapped;
+        return !target.loadModel(BAD_FILE, false) && !mapped.open(BAD_FILE, true, false);
+    };
+    bool truncatedRejected = writeBad(image.size() - 100, image.size());
+    bool corruptRejected = writeBad(image.size(), image.size() / 2);
+    std::cout << "  truncated file rejected: " << (truncatedRejected ? "yes" : "NO  FAILED")
+              << ", corrupted file rejected: " << (corruptRejected ? "yes" : "NO  FAILED") << std::endl;
+    passed = passed && truncatedRejected && corruptRejected;
+
+    std::remove(V1_FILE);
+    std::remove(V2_FILE);
+    std::remove(BAD_FILE);
+    std::cout << std::endl;
+    return passed;
+}
+
+bool Benchmark::benchmarkCheckpointing() {
+    const char* CHECKPOINT_FILE = "benchmark_checkpoint.tmp";
+    const int BURST = 50;
+
+    std::cout << "Best-model checkpointing {12, 512, 512, 4}:" << std::endl;
+    NeuralNetwork network({12, 512, 512, 4});
+    NeuralNetwork snapshot(network);
+    NeuralNetwork restored({12, 512, 512, 4});
+    network.saveModel(CHECKPOINT_FILE, false);
+
+    // Restoring the best weights each batch: from the file vs from the in-memory copy
+    printResult("restore by loadModel", averageCallNanoseconds([&] { restored.loadModel(CHECKPOINT_FILE, false); }),
+                "restore");
+    printResult("restore by copyParametersFrom", averageCallNanoseconds([&] { restored.copyParametersFrom(snapshot); }),
+                "restore");
+
+    // What the training loop waits for per save: a synchronous crash-safe write
+    // vs building the image and handing it to the writer thread
+    auto writeNow = [&](const std::string& path) { return network.saveModel(path, false); };
+    printResult("save: temp + sync + rename", averageCallNanoseconds([&] {
+                    AsyncFileWriter::writeFileAtomically(CHECKPOINT_FILE, writeNow);
+                }),
+                "save");
+
+    AsyncFileWriter writer;
+    auto queueSave = [&] {
+        auto image = std::make_shared<std::vector<unsigned char>>();
+        ModelFormat::buildImage(network.layerBlocks(), *image);
+        writer.submit(CHECKPOINT_FILE, [image](const std::string& path) { return ModelFormat::writeImage(path, *image); });
+    };
+    printResult("save: queue on writer thread", averageCallNanoseconds(queueSave), "save");
+    writer.flush();
+
+    // A burst of saves should mostly coalesce, and the file must end up holding the last one
+    long long writtenBefore = writer.completedWrites();
+    long long coalescedBefore = writer.coalescedWrites();
+    for (int i = 0; i < BURST; ++i) {
+        network.layers[1].weights(0, 0) = static_cast<float>(i);
+        queueSave();
+    }
+    writer.flush();
+    std::cout << "  burst of " << BURST << " saves: " << (writer.completedWrites() - writtenBefore) << " written, "
+              << (writer.coalescedWrites() - coalescedBefore) << " coalesced" << std::endl;
+
+    bool latest = restored.loadModel(CHECKPOINT_FILE, false) &&
+                  restored.layers[1].weights(0, 0) == static_cast<float>(BURST - 1);
+    bool noTemporary = !std::ifstream(std::string(CHECKPOINT_FILE) + ".tmp").good();
+    bool noFailures = writer.failedWrites() == 0;
+    std::cout << "  file holds the latest save: " << (latest ? "yes" : "NO  FAILED")
+              << ", no temporary left: " << (noTemporary ? "yes" : "NO  FAILED")
+              << ", write failures: " << writer.failedWrites() << std::endl;
+
+    std::remove(CHECKPOINT_FILE);
+    std::cout << std::endl;
+    return latest && noTemporary && noFailures;
+}
+
+bool Benchmark::benchmarkNeuroEvolution() {
+    const int GENERATIONS = 3;
+    NeuroEvolution::Settings settings;
+    settings.populationSize = 32;
+    settings.episodesPerMember = 2;
+    settings.maxFrames = 1000;
+    settings.seed = 7;
+
+    // Same seed with different worker counts must evolve the same population
+    std::cout << "Neuroevolution {12, 32, 16, 4}, population " << settings.populationSize << ", "
+              << settings.episodesPerMember << " episodes per member:" << std::endl;
+    NeuralNetwork prototype({12, 32, 16, 4});
+    NeuralNetwork reference({12, 32, 16, 4});
+    NeuralNetwork evolved({12, 32, 16, 4});
+    float referenceFitness = 0.0f;
+    bool repeatable = true;
+    std::vector<int> workerCounts = {1, 2, 4};
+    if (ThreadPool::hardwareThreads() > 4) {
+        workerCounts.push_back(ThreadPool::hardwareThreads());
+    }
+    for (int workers : workerCounts) {
+        NeuroEvolution evolution(prototype, settings, workers);
+        long long episodes = 0;
+        double seconds = 0.0;
+        for (int g = 0; g < GENERATIONS; ++g) {
+            NeuroEvolution::GenerationStats stats = evolution.runGeneration();
+            episodes += stats.episodes;
+            seconds += stats.seconds;
+        }
+        std::cout << "  " << std::setw(3) << workers << " workers: " << std::setw(8) << std::fixed
+                  << std::setprecision(0) << episodes / seconds << " episodes/s, best fitness "
+                  << std::setprecision(2) << evolution.bestFitness() << std::endl;
+
+        NeuralNetwork& target = workers == 1 ? reference : evolved;
+        evolution.copyBestTo(target);
+        if (workers == 1) {
+            referenceFitness = evolution.bestFitness();
+        } else {
+            bool same = evolution.bestFitness() == referenceFitness;
+            for (size_t l = 0; l < target.layers.size(); ++l)
+                same = same && maxAbsDifference(target.layers[l].weights, reference.layers[l].weights) == 0.0f &&
+                       maxAbsDifference(target.layers[l].biases, reference.layers[l].biases) == 0.0f;
+            repeatable = repeatable && same;
+        }
+    }
+    std::cout << "  same result for every worker count: " << (repeatable ? "yes" : "NO  FAILED") << std::endl;
+    std::cout << std::endl;
+    return repeatable;
+}
+
+void Benchmark::benchmarkRandomStreams() {
+    const int DRAWS = 16;  // about what one episode start or training example uses
+    uint64_t stream = 0;
+    auto drawAll = [&](auto& rng) {
+        uint32_t sum = 0;
+        for (int i = 0; i < DRAWS; ++i)
+            sum += static_cast<uint32_t>(rng());
+        benchmarkSink = benchmarkSink + static_cast<float>(sum & 1);
+    };
+
+    std::cout << "Random streams (construct + " << DRAWS << " draws):" << std::endl;
+    printResult("mt19937 from random_device", averageCallNanoseconds([&] {
+                    std::mt19937 rng(std::random_device{}());
+                    drawAll(rng);
+                }),
+                "stream");
+    printResult("mt19937 from a seed", averageCallNanoseconds([&] {
+                    std::mt19937 rng(static_cast<uint32_t>(++stream));
+                    drawAll(rng);
+                }),
+                "stream");
+    printResult("CounterRng (run seed, index)", averageCallNanoseconds([&] {
+                    CounterRng rng(12345, ++stream);
+                    drawAll(rng);
+                }),
+                "stream");
+
+    CounterRng rng(12345);
+    printResult("CounterRng draw", averageCallNanoseconds([&] {
+                    uint32_t sum = 0;
+                    for (int i = 0; i < 1024; ++i)
+                        sum += rng();
+                    benchmarkSink = benchmarkSink + static_cast<float>(sum & 1);
+                }) / 1024,
+                "draw");
+    std::cout << std::endl;
+}
+
+bool Benchmark::benchmarkParallelValidation() {
+    const int EPISODES = 10;  // TrainingManager's validation round
+    const int MAX_FRAMES = 2000;
+    const uint64_t RUN_SEED = 1000;
+    NeuralNetwork network({12, 32, 16, 4});
+
+    std::vector<SimulationResult> sequential(EPISODES);
+    std::vector<SimulationResult> parallel;
+    double sequentialTime = averageCallNanoseconds([&] {
+        for (int i = 0; i < EPISODES; ++i)
+            sequential[i] = GameLogic::runSimulation(&network, MAX_FRAMES, RUN_SEED, i);
+    });
+    double parallelTime = averageCallNanoseconds([&] {
+        GameLogic::runSimulations(&network, MAX_FRAMES, RUN_SEED, 0, EPISODES, parallel);
+    });
+
+    bool identical = parallel.size() == sequential.size();
+    for (size_t i = 0; identical && i < parallel.size(); ++i)
+        identical = parallel[i].won == sequential[i].won && parallel[i].hit == sequential[i].hit &&
+                    parallel[i].totalLoss == sequential[i].totalLoss &&
+                    parallel[i].framesPlayed == sequential[i].framesPlayed;
+
+    std::cout << "Validation round (" << EPISODES << " seeded episodes, " << ThreadPool::shared().size()
+              << " threads):" << std::endl;
+    printResult("sequential runSimulation", sequentialTime, "round");
+    printResult("runSimulations", parallelTime, "round");
+    std::cout << "  speedup " << std::fixed << std::setprecision(2) << sequentialTime / parallelTime
+              << "x, results identical: " << (identical ? "yes" : "NO  FAILED") << std::endl;
+    std::cout << std::endl;
+    return identical;
+}
+
+bool Benchmark::benchmarkVecSimulation() {
+    const int EPISODES = 256;
+    const int MAX_FRAMES = 2000;
+    const uint64_t RUN_SEED = 2000;
+
+    auto sameResults = [](const std::vector<SimulationResult>& a, const std::vector<SimulationResult>& b) {
+        bool identical = a.size() == b.size();
+        for (size_t i = 0; identical && i < a.size(); ++i)
+            identical = a[i].won == b[i].won && a[i].hit == b[i].hit && a[i].totalLoss == b[i].totalLoss &&
+                        a[i].framesPlayed == b[i].framesPlayed;
+        return identical;
+    };
+
+    std::cout << "Vectorized simulation (" << EPISODES << " seeded episodes, " << MAX_FRAMES
+              << " frames, one thread):" << std::endl;
+    bool passed = true;
+    for (const auto& sizes : {std::vector<int>{12, 32, 16, 4}, std::vector<int>{12, 256, 256, 4}}) {
+        NeuralNetwork network(sizes);
+        std::cout << "  Network {" << sizes[1] << ", " << sizes[2] << "}:" << std::endl;
+
+        std::vector<SimulationResult> reference(EPISODES);
+        double referenceTime = averageCallNanoseconds([&] {
+            for (int i = 0; i < EPISODES; ++i)
+                reference[i] = GameLogic::runSimulation(&network, MAX_FRAMES, RUN_SEED, i);
+        });
+        std::cout << "    runSimulation          " << std::setw(10) << std::fixed << std::setprecision(0)
+                  << EPISODES / (referenceTime * 1e-9) << " episodes/s" << std::endl;
+
+        for (int lanes : {1, 8, 64, 256}) {
+            VecSimulation<NeuralNetwork> simulation(&network, MAX_FRAMES, lanes);
+            std::vector<SimulationResult> results;
+            double time = averageCallNanoseconds([&] { simulation.run(RUN_SEED, 0, EPISODES, results); });
+            bool identical = sameResults(results, reference);
+            passed = passed && identical;
+            std::cout << "    VecSimulation " << std::setw(3) << lanes << " lanes " << std::setw(10)
+                      << std::setprecision(0) << EPISODES / (time * 1e-9) << " episodes/s  " << std::setw(5)
+                      << std::setprecision(2) << referenceTime / time << "x  rows/batch " << std::setw(6)
+                      << std::setprecision(1)
+                      << static_cast<double>(simulation.batchRows()) / std::max(1LL, simulation.batchCalls())
+                      << "  identical: " << (identical ? "yes" : "NO  FAILED") << std::endl;
+        }
+    }
+
+    // The fixed-size network takes the same path
+    ProductionNetwork production;
+    std::vector<SimulationResult> reference(EPISODES);
+    for (int i = 0; i < EPISODES; ++i)
+        reference[i] = GameLogic::runSimulation(&production, MAX_FRAMES, RUN_SEED, i);
+    std::vector<SimulationResult> results;
+    VecSimulation<ProductionNetwork>(&production, MAX_FRAMES).run(RUN_SEED, 0, EPISODES, results);
+    bool identical = sameResults(results, reference);
+    passed = passed && identical;
+    std::cout << "  ProductionNetwork results identical: " << (identical ? "yes" : "NO  FAILED") << std::endl;
+
+    // The batched encoder, bullet scan and physics have a pass per ISA; each
+    // must replay runSimulation under the same ISA
+    NeuralNetwork network({12, 32, 16, 4});
+    MatrixKernels::Isa original = MatrixKernels::activeIsa();
+    std::cout << "  Identical per ISA:";
+    for (int isa = 0; isa <= static_cast<int>(MatrixKernels::detectedIsa()); ++isa) {
+        MatrixKernels::setIsa(static_cast<MatrixKernels::Isa>(isa));
+        for (int i = 0; i < EPISODES; ++i)
+            reference[i] = GameLogic::runSimulation(&network, MAX_FRAMES, RUN_SEED, i);
+        VecSimulation<NeuralNetwork>(&network, MAX_FRAMES).run(RUN_SEED, 0, EPISODES, results);
+        identical = sameResults(results, reference);
+        passed = passed && identical;
+        std::cout << " " << MatrixKernels::isaName(MatrixKernels::activeIsa()) << " "
+                  << (identical ? "yes" : "NO  FAILED");
+    }
+    MatrixKernels::setIsa(original);
+    std::cout << std::endl << std::endl;
+    return passed;
+}
+
+bool Benchmark::benchmarkBulletScan() {
+    const int COUNTS[] = {16, 64, 256, 1024, 4096};
+    const int CHECK_FRAMES = 50;
+    const float SHIP_X = 123.0f;
+    const float SHIP_Y = 456.0f;
+
+    MatrixKernels::Isa original = MatrixKernels::activeIsa();
+    MatrixKernels::Isa best = MatrixKernels::detectedIsa();
+    std::cout << "Bullet pass per frame (move, wrap, collision, nearest bullet):" << std::endl;
+    std::cout << "  bullets   three passes";
+    for (int isa = 0; isa <= static_cast<int>(best); ++isa) {
+        if (static_cast<MatrixKernels::Isa>(isa) == MatrixKernels::Isa::SSE2) continue;  // runs the scalar pass
+        std::cout << std::setw(12) << MatrixKernels::isaName(static_cast<MatrixKernels::Isa>(isa));
+    }
+    std::cout << "   (ns/frame)" << std::endl;
+
+    bool identical = true;
+    for (int count : COUNTS) {
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        BulletField field(count);
+        std::vector<LegacyBullet> legacy;
+        for (int i = 0; i < count; ++i) {
+            float angle = unit(rng) * 6.2831853f;
+            float x = unit(rng) * WINDOW_WIDTH;
+            float y = unit(rng) * WINDOW_HEIGHT;
+            float velX = std::cos(angle) * BULLET_SPEED;
+            float velY = std::sin(angle) * BULLET_SPEED;
+            field.add(x, y, velX, velY);
+            legacy.push_back({x, y, velX, velY});
+        }
+
+        bool hit;
+        double legacyTime = averageCallNanoseconds([&] {
+            benchmarkSink = benchmarkSink + legacyBulletFrame(legacy, SHIP_X, SHIP_Y, hit);
+        });
+        std::cout << "  " << std::setw(7) << count << std::setw(15) << std::fixed << std::setprecision(0)
+                  << legacyTime;
+
+        // Every ISA runs the same frames from the same start and must match the scalar pass exactly
+        double activeTime = legacyTime;
+        BulletField reference = field;
+        std::vector<BulletField::Scan> expected;
+        for (int frame = 0; frame < CHECK_FRAMES; ++frame)
+            expected.push_back(reference.scanScalar(SHIP_X, SHIP_Y));
+
+        for (int isa = 0; isa <= static_cast<int>(best); ++isa) {
+            if (static_cast<MatrixKernels::Isa>(isa) == MatrixKernels::Isa::SSE2) continue;
+            MatrixKernels::setIsa(static_cast<MatrixKernels::Isa>(isa));
+
+            BulletField copy = field;
+            for (int frame = 0; frame < CHECK_FRAMES; ++frame) {
+                BulletField::Scan scan = copy.scan(SHIP_X, SHIP_Y);
+                identical = identical && scan.hit == expected[frame].hit &&
+                            scan.nearest == expected[frame].nearest &&
+                            scan.nearestDistanceSquared == expected[frame].nearestDistanceSquared;
+            }
+            for (int i = 0; i < count; ++i)
+                identical = identical && copy.x(i) == reference.x(i) && copy.y(i) == reference.y(i);
+
+            // The fused pass plus the one sqrt and atan2 buildInputs spends on the winner
+            double time = averageCallNanoseconds([&] {
+                BulletField::Scan scan = copy.scan(SHIP_X, SHIP_Y);
+                if (scan.nearest >= 0) {
+                    float distance = std::sqrt(scan.nearestDistanceSquared);
+                    float angle = GameLogic::angleOf(copy.y(scan.nearest) - SHIP_Y, copy.x(scan.nearest) - SHIP_X);
+                    benchmarkSink = benchmarkSink + distance + angle;
+                }
+            });
+            std::cout << std::setw(12) << time;
+            if (MatrixKernels::activeIsa() == original) activeTime = time;
+        }
+        std::cout << std::setw(9) << std::setprecision(1) << legacyTime / activeTime << "x" << std::endl;
+    }
+    MatrixKernels::setIsa(original);
+    std::cout << "  (last column: speedup of the fused pass on the active ISA, " << MatrixKernels::isaName(original)
+              << ")" << std::endl;
+    std::cout << "  every ISA matches the scalar pass: " << (identical ? "yes" : "NO  FAILED") << std::endl;
+
+    // VecSimulation's BulletLanes against one BulletField per lane: LANES
+    // games (a partial SIMD block) with random spawns, lifetimes, clears and
+    // lanes sitting frames out, on every instruction set
+    const int LANES = 37;
+    const int LANE_CAPACITY = 96;
+    const int LANE_FRAMES = 2000;
+    bool lanesMatch = true;
+    double fieldsTime = 0.0;
+    double lanesTime = 0.0;
+    for (int isa = 0; isa <= static_cast<int>(best); ++isa) {
+        MatrixKernels::setIsa(static_cast<MatrixKernels::Isa>(isa));
+        std::mt19937 rng(21);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        BulletLanes lanes(LANES, LANE_CAPACITY);
+        std::vector<BulletField> fields(LANES, BulletField(LANE_CAPACITY));
+        std::vector<float> shipX(LANES), shipY(LANES);
+        std::vector<int> flying(LANES);
+        std::vector<BulletField::Scan> scans(LANES);
+        for (int frame = 0; frame < LANE_FRAMES; ++frame) {
+            for (int lane = 0; lane < LANES; ++lane) {
+                if (unit(rng) < 0.002f) {
+                    lanes.clear(lane);
+                    fields[lane].clear();
+                }
+                if (unit(rng) < 0.3f) {
+                    float x = unit(rng) * WINDOW_WIDTH, y = unit(rng) * WINDOW_HEIGHT;
+                    float velX = (unit(rng) - 0.5f) * 2.0f * BULLET_SPEED;
+                    float velY = (unit(rng) - 0.5f) * 2.0f * BULLET_SPEED;
+                    int lifetime = unit(rng) < 0.5f ? 1 + static_cast<int>(unit(rng) * 300) : BulletField::FOREVER;
+                    int added = fields[lane].full() ? -1 : fields[lane].add(x, y, velX, velY, lifetime);
+                    lanesMatch = lanesMatch && lanes.add(lane, x, y, velX, velY, lifetime) ==
+                                                   (added < 0 ? -1 : fields[lane].indexOf(added));
+                }
+                shipX[lane] = unit(rng) * WINDOW_WIDTH;
+                shipY[lane] = unit(rng) * WINDOW_HEIGHT;
+                flying[lane] = unit(rng) < 0.9f;
+            }
+            lanes.scan(shipX.data(), shipY.data(), flying.data(), scans.data());
+            for (int lane = 0; lane < LANES; ++lane) {
+                if (!flying[lane]) continue;
+                BulletField::Scan expected = fields[lane].scanScalar(shipX[lane], shipY[lane]);
+                lanesMatch = lanesMatch && scans[lane].hit == expected.hit &&
+                             scans[lane].nearest == expected.nearest &&
+                             scans[lane].nearestDistanceSquared == expected.nearestDistanceSquared &&
+                             lanes.size(lane) == fields[lane].size();
+                for (int i = 0; i < fields[lane].size() && lanesMatch; ++i)
+                    lanesMatch = lanes.x(lane, i) == fields[lane].x(i) && lanes.y(lane, i) == fields[lane].y(i);
+            }
+        }
+
+        // Cost per lane-frame once every lane is full and flying
+        if (static_cast<MatrixKernels::Isa>(isa) == original) {
+            std::fill(flying.begin(), flying.end(), 1);
+            for (int lane = 0; lane < LANES; ++lane) {
+                while (fields[lane].size() < LANE_CAPACITY) {
+                    float x = unit(rng) * WINDOW_WIDTH, y = unit(rng) * WINDOW_HEIGHT;
+                    fields[lane].add(x, y, BULLET_SPEED, 0.0f);
+                    lanes.add(lane, x, y, BULLET_SPEED, 0.0f);
+                }
+            }
+            fieldsTime = averageCallNanoseconds([&] {
+                for (int lane = 0; lane < LANES; ++lane)
+                    benchmarkSink = benchmarkSink + fields[lane].scan(shipX[lane], shipY[lane]).nearestDistanceSquared;
+            }) / LANES;
+            lanesTime = averageCallNanoseconds([&] {
+                lanes.scan(shipX.data(), shipY.data(), flying.data(), scans.data());
+                benchmarkSink = benchmarkSink + scans[0].nearestDistanceSquared;
+            }) / LANES;
+        }
+    }
+    MatrixKernels::setIsa(original);
+    std::ostringstream note;
+    note << std::fixed << std::setprecision(1) << fieldsTime / lanesTime << "x vs a BulletField per lane";
+    printResult("BulletLanes, " + std::to_string(LANE_CAPACITY) + " bullets a lane", lanesTime, "lane-frame",
+                note.str());
+    std::cout << "  BulletLanes matches a BulletField per lane on every ISA: " << (lanesMatch ? "yes" : "NO  FAILED")
+              << std::endl;
+    std::cout << std::endl;
+    return identical && lanesMatch;
+}
+
+bool Benchmark::benchmarkBulletPool() {
+    const int CAPACITY = 64;
+    const int CHECK_FRAMES = 5000;
+    const int POPULATIONS[] = {16, 64, 256, 1024};
+    const int PAIRS = 256;  // per timed call, so the clock read does not dominate
+
+    // A bullet as the reference model keeps it: by handle, in a plain array
+    struct PooledBullet {
+        int handle;
+        float x, y, velX, velY;
+        int scansLeft;  // -1: unlimited
+    };
+
+    // Random spawns (some with a lifetime), despawns and scans, replayed on a
+    // list of structs that moves, wraps and expires bullets the same way
+    std::mt19937 rng(24);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    BulletField pool(CAPACITY);
+    std::vector<PooledBullet> model;
+    bool passed = true;
+    for (int frame = 0; frame < CHECK_FRAMES && passed; ++frame) {
+        int spawns = static_cast<int>(unit(rng) * 4.0f);
+        for (int s = 0; s < spawns; ++s) {
+            float angle = unit(rng) * 6.2831853f;
+            int lifetime = unit(rng) < 0.5f ? BulletField::FOREVER : 1 + static_cast<int>(unit(rng) * 100.0f);
+            PooledBullet bullet = {-1, unit(rng) * WINDOW_WIDTH, unit(rng) * WINDOW_HEIGHT,
+                                   std::cos(angle) * BULLET_SPEED, std::sin(angle) * BULLET_SPEED,
+                                   lifetime == BulletField::FOREVER ? -1 : lifetime};
+            bool wasFull = pool.full();
+            bullet.handle = pool.add(bullet.x, bullet.y, bullet.velX, bullet.velY, lifetime);
+            passed = passed && wasFull == (bullet.handle < 0) && wasFull == (static_cast<int>(model.size()) == CAPACITY);
+            if (bullet.handle >= 0) model.push_back(bullet);
+        }
+        if (!model.empty() && unit(rng) < 0.5f) {
+            size_t victim = static_cast<size_t>(unit(rng) * model.size()) % model.size();
+            if (unit(rng) < 0.5f) pool.remove(model[victim].handle);
+            else pool.removeAt(pool.indexOf(model[victim].handle));
+            passed = passed && pool.indexOf(model[victim].handle) < 0;
+            model.erase(model.begin() + victim);
+        }
+
+        const float shipX = unit(rng) * WINDOW_WIDTH;
+        const float shipY = unit(rng) * WINDOW_HEIGHT;
+        BulletField::Scan scan = pool.scan(shipX, shipY);
+        model.erase(std::remove_if(model.begin(), model.end(), [](const PooledBullet& b) { return b.scansLeft == 0; }),
+                    model.end());
+        float nearest = BulletField::NEAREST_RANGE * BulletField::NEAREST_RANGE;
+        bool hit = false;
+        for (auto& bullet : model) {
+            if (bullet.scansLeft > 0) --bullet.scansLeft;
+            bullet.x += bullet.velX;
+            bullet.y += bullet.velY;
+            if (bullet.x < 0.0f) bullet.x += WINDOW_WIDTH;
+            else if (bullet.x > WINDOW_WIDTH) bullet.x -= WINDOW_WIDTH;
+            if (bullet.y < 0.0f) bullet.y += WINDOW_HEIGHT;
+            else if (bullet.y > WINDOW_HEIGHT) bullet.y -= WINDOW_HEIGHT;
+            float dx = bullet.x - shipX;
+            float dy = bullet.y - shipY;
+            float distanceSquared = std::fma(dy, dy, dx * dx);
+            hit = hit || distanceSquared < BULLET_COLLISION_RADIUS * BULLET_COLLISION_RADIUS;
+            nearest = std::min(nearest, distanceSquared);
+        }
+
+        // Same live bullets, densely packed, each reachable through its handle
+        passed = passed && pool.size() == static_cast<int>(model.size()) && pool.capacity() == CAPACITY &&
+                 scan.hit == hit && scan.nearestDistanceSquared == nearest;
+        for (const auto& bullet : model) {
+            int i = pool.indexOf(bullet.handle);
+            passed = passed && i >= 0 && i < pool.size() && pool.handle(i) == bullet.handle &&
+                     pool.x(i) == bullet.x && pool.y(i) == bullet.y && pool.velX(i) == bullet.velX &&
+                     pool.velY(i) == bullet.velY;
+        }
+    }
+    pool.clear();
+    passed = passed && pool.empty() && pool.add(0.0f, 0.0f, 0.0f, 0.0f) == 0 && pool.add(0.0f, 0.0f, 0.0f, 0.0f) == 1;
+
+    std::cout << "Bullet pool (spawn + despawn of a random bullet at a steady population):" << std::endl;
+    std::cout << "  bullets   vector + erase      pool   (ns/pair)" << std::endl;
+    for (int population : POPULATIONS) {
+        // The old game loop's container: push_back, then erase by predicate
+        std::vector<LegacyBullet> legacy;
+        BulletField field(population + 1);
+        std::vector<int> live;
+        for (int i = 0; i < population; ++i) {
+            legacy.push_back({unit(rng) * WINDOW_WIDTH, unit(rng) * WINDOW_HEIGHT, 0.0, 0.0});
+            live.push_back(field.add(unit(rng) * WINDOW_WIDTH, unit(rng) * WINDOW_HEIGHT, 0.0f, 0.0f));
+        }
+        int next = 0;
+        double vectorTime = averageCallNanoseconds([&] {
+            for (int pair = 0; pair < PAIRS; ++pair) {
+                legacy.push_back({0.0, 0.0, 1.0, 1.0});
+                size_t victim = static_cast<size_t>(next++ * 7919) % legacy.size();
+                const LegacyBullet* target = &legacy[victim];
+                legacy.erase(std::remove_if(legacy.begin(), legacy.end(),
+                                            [target](const LegacyBullet& b) { return &b == target; }),
+                             legacy.end());
+            }
+        }) / PAIRS;
+        double poolTime = averageCallNanoseconds([&] {
+            for (int pair = 0; pair < PAIRS; ++pair) {
+                int handle = field.add(0.0f, 0.0f, 1.0f, 1.0f);
+                size_t victim = static_cast<size_t>(next++ * 7919) % live.size();
+                field.remove(live[victim]);
+                live[victim] = handle;
+            }
+        }) / PAIRS;
+        std::cout << "  " << std::setw(7) << population << std::setw(17) << std::fixed << std::setprecision(1)
+                  << vectorTime << std::setw(10) << poolTime << std::endl;
+    }
+
+    int episodeCapacity = GameLogic::bulletCapacity(MAX_FRAMES);
+    std::cout << "  a " << MAX_FRAMES << "-frame episode reserves " << episodeCapacity << " bullets ("
+              << episodeCapacity * (4 * sizeof(float) + 4 * sizeof(int)) << " bytes) up front" << std::endl;
+    std::cout << "  pool matches a reference list under spawn, despawn and expiry: " << (passed ? "yes" : "NO  FAILED")
+              << std::endl;
+    std::cout << std::endl;
+    return passed;
+}
+
+bool Benchmark::benchmarkBulletGrid() {
+    const int COUNTS[] = {100, 1000, 10000, 100000};
+    const float WIDTH = 4.0f * WINDOW_WIDTH;
+    const float HEIGHT = 4.0f * WINDOW_HEIGHT;
+    const int QUERIES = 256;
+    const int K = 8;
+    const float RANGE = 1000.0f;
+
+    std::cout << "Bullet grid (" << WIDTH << " x " << HEIGHT << " arena, " << QUERIES
+              << " queries, collision radius " << BULLET_COLLISION_RADIUS << ", nearest " << K << "):" << std::endl;
+    std::cout << "  bullets   cell   rebuild   collide   nearest   linear collide   linear nearest   (ns)" << std::endl;
+
+    bool passed = true;
+    for (int count : COUNTS) {
+        std::mt19937 rng(count);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        BulletField field(WIDTH, HEIGHT, count);
+        for (int i = 0; i < count; ++i)
+            field.add(unit(rng) * WIDTH, unit(rng) * HEIGHT, 0.0f, 0.0f);
+        std::vector<float> queryX(QUERIES), queryY(QUERIES);
+        for (int q = 0; q < QUERIES; ++q) {
+            queryX[q] = unit(rng) * WIDTH;
+            queryY[q] = unit(rng) * HEIGHT;
+        }
+
+        float cellSize = BulletGrid::cellSizeFor(WIDTH, HEIGHT, count, 2.0f * BULLET_COLLISION_RADIUS);
+        for (BulletGrid::Metric metric : {BulletGrid::Metric::Planar, BulletGrid::Metric::Toroidal}) {
+            BulletGrid grid(WIDTH, HEIGHT, cellSize, metric);
+            grid.rebuild(field);
+
+            // Every query must agree with a linear search under the same metric
+            std::vector<std::pair<float, int>> all;
+            int indices[K];
+            float distances[K];
+            for (int q = 0; q < QUERIES; ++q) {
+                float radius = q % 2 == 0 ? BULLET_COLLISION_RADIUS : 0.25f * cellSize * (q % 7);
+                bool expectedHit = false;
+                all.clear();
+                for (int i = 0; i < count; ++i) {
+                    float distance = grid.distanceSquared(queryX[q], queryY[q], field.x(i), field.y(i));
+                    expectedHit = expectedHit || distance < radius * radius;
+                    if (distance < RANGE * RANGE) all.push_back({distance, i});
+                }
+                int expectedFound = std::min(K, static_cast<int>(all.size()));
+                std::partial_sort(all.begin(), all.begin() + expectedFound, all.end());
+
+                int found = grid.nearest(queryX[q], queryY[q], K, RANGE, indices, distances);
+                bool same = grid.anyWithin(queryX[q], queryY[q], radius) == expectedHit && found == expectedFound;
+                for (int j = 0; same && j < found; ++j)
+                    same = indices[j] == all[j].second && distances[j] == all[j].first;
+                passed = passed && same;
+            }
+
+            if (metric == BulletGrid::Metric::Toroidal) {
+                continue;
+            }
+
+            double rebuildTime = averageCallNanoseconds([&] { grid.rebuild(field); });
+            int query = 0;
+            double collideTime = averageCallNanoseconds([&] {
+                benchmarkSink = benchmarkSink + grid.anyWithin(queryX[query], queryY[query], BULLET_COLLISION_RADIUS);
+                query = (query + 1) % QUERIES;
+            });
+            double nearestTime = averageCallNanoseconds([&] {
+                benchmarkSink = benchmarkSink + grid.nearest(queryX[query], queryY[query], K, RANGE, indices, distances);
+                query = (query + 1) % QUERIES;
+            });
+            double linearCollideTime = averageCallNanoseconds([&] {
+                bool hit = false;
+                float radiusSquared = BULLET_COLLISION_RADIUS * BULLET_COLLISION_RADIUS;
+                for (int i = 0; i < count && !hit; ++i)
+                    hit = grid.distanceSquared(queryX[query], queryY[query], field.x(i), field.y(i)) < radiusSquared;
+                benchmarkSink = benchmarkSink + hit;
+                query = (query + 1) % QUERIES;
+            });
+            double linearNearestTime = averageCallNanoseconds([&] {
+                // Linear top-k with the same insertion the grid uses
+                int found = 0;
+                for (int i = 0; i < count; ++i) {
+                    float distance = grid.distanceSquared(queryX[query], queryY[query], field.x(i), field.y(i));
+                    if (!(distance < RANGE * RANGE) || (found == K && distance >= distances[K - 1])) continue;
+                    int position = found < K ? found++ : K - 1;
+                    for (; position > 0 && distances[position - 1] > distance; --position) {
+                        distances[position] = distances[position - 1];
+                        indices[position] = indices[position - 1];
+                    }
+                    distances[position] = distance;
+                    indices[position] = i;
+                }
+                benchmarkSink = benchmarkSink + found;
+                query = (query + 1) % QUERIES;
+            });
+
+            std::cout << "  " << std::setw(7) << count << std::setw(7) << std::fixed << std::setprecision(0)
+                      << cellSize << std::setw(10) << rebuildTime << std::setw(10) << collideTime << std::setw(10)
+                      << nearestTime << std::setw(17) << linearCollideTime << std::setw(17) << linearNearestTime
+                      << std::endl;
+        }
+    }
+    std::cout << "  planar and toroidal queries match a linear search: " << (passed ? "yes" : "NO  FAILED")
+              << std::endl;
+
+    std::cout << std::endl;
+    return passed;
+}
+
+bool Benchmark::benchmarkShipPhysics() {
+    const int SHIPS = 64;
+    const int FRAMES = MAX_FRAMES;
+    const int HOLD = 30;                // frames each random control is held for
+    const double TOLERANCE = 0.05;      // pixels, after a whole episode
+
+    // Every table entry is within half a float epsilon of libm's sin / cos of
+    // the whole degree (libm's own error at the zeros is far below that)
+    bool tableMatches = true;
+    const double TABLE_TOLERANCE = 0.5 * std::numeric_limits<float>::epsilon();
+    for (int d = 0; d < 360; ++d) {
+        double radians = d * (ShipTrig::PI / 180.0);
+        tableMatches = tableMatches && std::abs(ShipPhysics::TRIG.sin[d] - std::sin(radians)) <= TABLE_TOLERANCE &&
+                       std::abs(ShipPhysics::TRIG.cos[d] - std::cos(radians)) <= TABLE_TOLERANCE;
+    }
+
+    // The same random commands through both precisions; positions compared
+    // the short way around the wrapped arena
+    std::mt19937 rng(25);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    std::vector<ShipPhysics::Command> commands(FRAMES / HOLD + 1);
+    const ShipPhysics::Settings settings = GameLogic::shipSettings();
+    double worstDrift = 0.0;
+    double totalDrift = 0.0;
+    bool sameTurns = true;
+    for (int s = 0; s < SHIPS; ++s) {
+        for (auto& command : commands) {
+            float decision[GameLogic::OUTPUT_COUNT] = {unit(rng), unit(rng), unit(rng), unit(rng)};
+            command = GameLogic::shipCommand(GameLogic::decodeOutputs(decision));
+        }
+        float startX = (unit(rng) + 1.0f) * 0.5f * WINDOW_WIDTH;
+        float startY = (unit(rng) + 1.0f) * 0.5f * WINDOW_HEIGHT;
+        ShipBody<float> fast = {{startX, startY}, {0.0f, 0.0f}, 0};
+        ShipBody<double> reference = {{startX, startY}, {0.0, 0.0}, 0};
+        double drift = 0.0;
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            ShipPhysics::step(fast, commands[frame / HOLD], settings);
+            ShipPhysics::step(reference, commands[frame / HOLD], settings);
+            double dx = std::abs(fast.position.x - reference.position.x);
+            double dy = std::abs(fast.position.y - reference.position.y);
+            dx = std::min(dx, WINDOW_WIDTH - dx);
+            dy = std::min(dy, WINDOW_HEIGHT - dy);
+            drift = std::max(drift, std::sqrt(dx * dx + dy * dy));
+            sameTurns = sameTurns && fast.rotation == reference.rotation;
+        }
+        worstDrift = std::max(worstDrift, drift);
+        totalDrift += drift;
+    }
+
+    // The structure-of-arrays step against ShipBody<float> ships on every
+    // instruction set: SHIPS + 3 lanes (a partial SIMD block), each sitting
+    // out some frames, one turned past the angles the vector passes wrap
+    const int LANES = SHIPS + 3;
+    const MatrixKernels::Isa original = MatrixKernels::activeIsa();
+    bool arraysMatch = true;
+    for (int isa = 0; isa <= static_cast<int>(MatrixKernels::detectedIsa()); ++isa) {
+        MatrixKernels::setIsa(static_cast<MatrixKernels::Isa>(isa));
+        std::mt19937 laneRng(25);
+        std::vector<ShipBody<float>> bodies(LANES);
+        std::vector<float> posX(LANES), posY(LANES), velX(LANES), velY(LANES);
+        std::vector<int> rotation(LANES), flying(LANES);
+        std::vector<float> thrust(LANES), strafe(LANES), brake(LANES);
+        std::vector<double> turn(LANES);
+        for (int lane = 0; lane < LANES; ++lane) {
+            float startX = (unit(laneRng) + 1.0f) * 0.5f * WINDOW_WIDTH;
+            float startY = (unit(laneRng) + 1.0f) * 0.5f * WINDOW_HEIGHT;
+            bodies[lane] = {{startX, startY}, {0.0f, 0.0f}, lane == 5 ? (1 << 25) : 0};
+            posX[lane] = startX;
+            posY[lane] = startY;
+            velX[lane] = 0.0f;
+            velY[lane] = 0.0f;
+            rotation[lane] = bodies[lane].rotation;
+        }
+        ShipArrays arrays = {posX.data(), posY.data(), velX.data(), velY.data(), rotation.data()};
+        ShipPhysics::CommandArrays arrayCommands = {thrust.data(), strafe.data(), turn.data(), brake.data()};
+        for (int frame = 0; frame < FRAMES; ++frame) {
+            for (int lane = 0; lane < LANES; ++lane) {
+                float decision[GameLogic::OUTPUT_COUNT] = {unit(laneRng), unit(laneRng), unit(laneRng),
+                                                           unit(laneRng)};
+                ShipPhysics::Command command = GameLogic::shipCommand(GameLogic::decodeOutputs(decision));
+                thrust[lane] = command.thrust;
+                strafe[lane] = command.strafe;
+                turn[lane] = command.turn;
+                brake[lane] = command.brake;
+                flying[lane] = (frame + lane) % 7 != 0;
+                if (flying[lane]) ShipPhysics::step(bodies[lane], command, settings);
+            }
+            ShipPhysics::step(arrays, arrayCommands, flying.data(), LANES, settings);
+            for (int lane = 0; lane < LANES; ++lane) {
+                arraysMatch = arraysMatch && posX[lane] == bodies[lane].position.x &&
+                              posY[lane] == bodies[lane].position.y && velX[lane] == bodies[lane].velocity.x &&
+                              velY[lane] == bodies[lane].velocity.y && rotation[lane] == bodies[lane].rotation;
+            }
+        }
+    }
+    MatrixKernels::setIsa(original);
+
+
+    // Cost of one ship-frame: the SpaceShip calls runSimulation used to make,
+    // the double reference step, the float step, and the structure-of-arrays
+    // step over every ship at once
+    std::vector<SpaceShip> spaceShips(SHIPS);
+    std::vector<ShipBody<double>> references(SHIPS, ShipBody<double>{{400.0, 300.0}, {0.0, 0.0}, 0});
+    std::vector<ShipBody<float>> ships(SHIPS, ShipBody<float>{{400.0f, 300.0f}, {0.0f, 0.0f}, 0});
+    for (auto& ship : spaceShips) ship.setPosition(Vector2D(400.0, 300.0));
+    int frame = 0;
+    double spaceShipTime = averageCallNanoseconds([&] {
+        const ShipPhysics::Command& command = commands[frame++ % commands.size()];
+        for (auto& ship : spaceShips) {
+            if (command.thrust != 0.0f) ship.thrust(command.thrust);
+            if (command.strafe != 0.0f) ship.strafe(command.strafe > 0.0f ? 1 : -1, std::abs(command.strafe));
+            if (command.turn != 0.0) ship.setRotationAngle(ship.getRotationAngle() + command.turn);
+            ship.applyDrag(settings.dragFactor);
+            if (command.brake != 1.0f) ship.applyDrag(command.brake);
+            ship.clampVelocity(settings.maxSpeed);
+            ship.updatePosition();
+            Vector2D position = ship.getPosition();
+            double x = position.getX();
+            double y = position.getY();
+            if (x < 0) x = WINDOW_WIDTH;
+            else if (x > WINDOW_WIDTH) x = 0;
+            if (y < 0) y = WINDOW_HEIGHT;
+            else if (y > WINDOW_HEIGHT) y = 0;
+            ship.setPosition(Vector2D(x, y));
+        }
+        benchmarkSink = benchmarkSink + static_cast<float>(spaceShips[0].getPosition().getX());
+    }) / SHIPS;
+    double referenceTime = averageCallNanoseconds([&] {
+        const ShipPhysics::Command& command = commands[frame++ % commands.size()];
+        for (auto& ship : references) ShipPhysics::step(ship, command, settings);
+        benchmarkSink = benchmarkSink + static_cast<float>(references[0].position.x);
+    }) / SHIPS;
+    double fastTime = averageCallNanoseconds([&] {
+        const ShipPhysics::Command& command = commands[frame++ % commands.size()];
+        for (auto& ship : ships) ShipPhysics::step(ship, command, settings);
+        benchmarkSink = benchmarkSink + ships[0].position.x;
+    }) / SHIPS;
+
+    std::vector<float> soaX(SHIPS, 400.0f), soaY(SHIPS, 300.0f), soaVelX(SHIPS, 0.0f), soaVelY(SHIPS, 0.0f);
+    std::vector<int> soaRotation(SHIPS, 0), allFlying(SHIPS, 1);
+    std::vector<float> soaThrust(SHIPS), soaStrafe(SHIPS), soaBrake(SHIPS);
+    std::vector<double> soaTurn(SHIPS);
+    ShipArrays soaShips = {soaX.data(), soaY.data(), soaVelX.data(), soaVelY.data(), soaRotation.data()};
+    ShipPhysics::CommandArrays soaCommands = {soaThrust.data(), soaStrafe.data(), soaTurn.data(), soaBrake.data()};
+    double arraysTime = averageCallNanoseconds([&] {
+        const ShipPhysics::Command& command = commands[frame++ % commands.size()];
+        std::fill(soaThrust.begin(), soaThrust.end(), command.thrust);
+        std::fill(soaStrafe.begin(), soaStrafe.end(), command.strafe);
+        std::fill(soaTurn.begin(), soaTurn.end(), command.turn);
+        std::fill(soaBrake.begin(), soaBrake.end(), command.brake);
+        ShipPhysics::step(soaShips, soaCommands, allFlying.data(), SHIPS, settings);
+        benchmarkSink = benchmarkSink + soaX[0];
+    }) / SHIPS;
+
+    bool passed = tableMatches && sameTurns && worstDrift <= TOLERANCE && arraysMatch;
+    std::cout << "Ship physics (one frame: thrust, strafe, turn, drag, clamp, move, wrap):" << std::endl;
+    std::ostringstream note;
+    note << std::fixed << std::setprecision(1) << referenceTime / fastTime << "x vs the reference";
+    printResult("SpaceShip methods", spaceShipTime, "ship-frame");
+    printResult("ShipPhysics double reference", referenceTime, "ship-frame");
+    printResult("ShipPhysics float step", fastTime, "ship-frame", note.str());
+    std::ostringstream arraysNote;
+    arraysNote << std::fixed << std::setprecision(1) << fastTime / arraysTime << "x vs the float step, "
+               << MatrixKernels::isaName(original);
+    printResult("ShipPhysics structure-of-arrays step", arraysTime, "ship-frame", arraysNote.str());
+    std::cout << "  float vs double trajectory drift over " << FRAMES << " frames (" << SHIPS
+              << " ships, random controls): max " << std::scientific << std::setprecision(2) << worstDrift
+              << " px, mean " << totalDrift / SHIPS << " px" << std::fixed << std::endl;
+    std::cout << "  structure-of-arrays step matches ShipBody<float> bit for bit on every ISA: " << (arraysMatch ? "yes" : "NO")
+              << std::endl;
+    std::cout << "  trig table matches libm, same turns, drift within " << TOLERANCE
+              << " px: " << (passed ? "yes" : "NO  FAILED") << std::endl;
+    std::cout << std::endl;
+    return passed;
+}
+
+bool Benchmark::benchmarkSequentialTest() {
+    const int TRIALS = 20000;
+    SequentialTest::Settings settings;
+    std::mt19937 rng(11);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    std::cout << "Model acceptance (win rate " << settings.nullWinRate << " vs " << settings.altWinRate << ", alpha "
+              << settings.alpha << ", beta " << settings.beta << ", budget " << settings.maxEpisodes
+              << "; simulated models, " << TRIALS << " trials each):" << std::endl;
+    std::cout << "  true win rate   SPRT accepts   episodes   fixed 7/10 accepts" << std::endl;
+    bool passed = true;
+    for (double rate : {0.3, 0.5, 0.65, 0.8, 0.95}) {
+        int accepted = 0;
+        long long episodes = 0;
+        int fixedAccepted = 0;
+        for (int t = 0; t < TRIALS; ++t) {
+            SequentialTest test(settings);
+            while (!test.decided())
+                test.addResult(unit(rng) < rate);
+            accepted += test.decision() == SequentialTest::Decision::Accept ? 1 : 0;
+            episodes += test.episodes();
+
+            int wins = 0;
+            for (int e = 0; e < 10; ++e)
+                wins += unit(rng) < rate ? 1 : 0;
+            fixedAccepted += wins >= 7 ? 1 : 0;
+        }
+        double acceptRate = static_cast<double>(accepted) / TRIALS;
+        std::cout << "  " << std::fixed << std::setprecision(2) << std::setw(13) << rate << std::setw(14)
+                  << std::setprecision(3) << acceptRate << std::setw(11) << std::setprecision(1)
+                  << static_cast<double>(episodes) / TRIALS << std::setw(21) << std::setprecision(3)
+                  << static_cast<double>(fixedAccepted) / TRIALS << std::endl;
+
+        // The error rates at the two hypotheses must hold (with sampling slack)
+        if (rate == settings.nullWinRate) {
+            passed = passed && acceptRate <= settings.alpha + 0.01;
+        } else if (rate == settings.altWinRate) {
+            passed = passed && 1.0 - acceptRate <= settings.beta + 0.01;
+        }
+    }
+    std::cout << "  error rates within alpha and beta: " << (passed ? "yes" : "NO  FAILED") << std::endl;
+    std::cout << std::endl;
+    return passed;
+}
+
+void Benchmark::benchmarkPredictBatch() {
+    const int TOTAL_STATES = 1 << 17;
+    const int batchSizes[] = {1, 8, 64, 1024};
+
+    std::cout << "predictBatch throughput:" << std::endl;
+    for (const auto& sizes : {std::vector<int>{12, 32, 16, 4}, std::vector<int>{12, 512, 512, 4}}) {
+        NeuralNetwork network(sizes);
+        int totalStates = sizes[1] > 64 ? TOTAL_STATES / 64 : TOTAL_STATES;
+
+        std::vector<float> states(static_cast<size_t>(1024) * network.inputSize());
+        std::vector<float> actions(static_cast<size_t>(1024) * network.outputSize());
+        for (int i = 0; i < 1024; ++i) {
+            Matrix state = makeSampleState(i);
+            std::copy_n(state.data(), state.size(), states.data() + static_cast<size_t>(i) * network.inputSize());
+        }
+
+        // Check the batched rows against single-state inference
+        float worst = 0.0f;
+        network.predictBatch(states.data(), 1024, actions.data());
+        std::vector<float> single(network.outputSize());
+        for (int i = 0; i < 1024; ++i) {
+            network.predictInto(states.data() + static_cast<size_t>(i) * network.inputSize(), single.data());
+            for (int j = 0; j < network.outputSize(); ++j)
+                worst = std::max(worst, std::abs(single[j] - actions[static_cast<size_t>(i) * network.outputSize() + j]));
+        }
+
+        for (int n : batchSizes) {
+            int calls = totalStates / n;
+            auto start = BenchClock::now();
+            for (int c = 0; c < calls; ++c)
+                network.predictBatch(states.data(), n, actions.data());
+            double perState = elapsedNanoseconds(start) / (static_cast<double>(calls) * n);
+            benchmarkSink = actions[0];
+
+            std::ostringstream name;
+            name << "{" << sizes[1] << ", " << sizes[2] << "} N=" << n;
+            std::ostringstream note;
+            note << std::fixed << std::setprecision(2) << 1e3 / perState << " M states/s";
+            if (n == 1024) {
+                note << ", max |diff| vs predictInto " << std::scientific << std::setprecision(1) << worst;
+            }
+            printResult(name.str(), perState, "state", note.str());
+        }
+    }
+    std::cout << std::endl;
+}
+
+bool Benchmark::benchmarkStaticNetwork() {
+    const float TRAIN_TOLERANCE = 1e-4f;  // after 1000 steps; the backward kernels sum in another order
+    const Activations::Accuracy tiers[] = {Activations::Accuracy::Exact, Activations::Accuracy::Polynomial,
+                                           Activations::Accuracy::Table};
+    MatrixKernels::Isa best = MatrixKernels::detectedIsa();
+    Activations::Accuracy previous = Activations::accuracy();
+
+    // On every ISA and tier both start from the same weights: check they predict
+    // the same bit for bit, and still agree after training on the same examples
+    bool passed = true;
+    float worstTrained = 0.0f;
+    for (int isa = 0; isa <= static_cast<int>(best); ++isa) {
+        MatrixKernels::setIsa(static_cast<MatrixKernels::Isa>(isa));
+        for (Activations::Accuracy tier : tiers) {
+            Activations::setAccuracy(tier);
+            NeuralNetwork dynamicNetwork({12, 32, 16, 4});
+            ProductionNetwork staticNetwork;
+            float worst = 0.0f;
+            for (int seed = 0; seed < 100; ++seed) {
+                Matrix state = makeSampleState(seed);
+                worst = std::max(worst, maxAbsDifference(dynamicNetwork.predict(state), staticNetwork.predict(state)));
+            }
+            timeTrain(dynamicNetwork, 1000);
+            timeTrain(staticNetwork, 1000);
+            float trained = 0.0f;
+            for (int seed = 0; seed < 100; ++seed) {
+                Matrix state = makeSampleState(seed);
+                Matrix difference = dynamicNetwork.predict(state);
+                trained = std::max(trained, maxAbsDifference(difference, staticNetwork.predict(state)));
+            }
+            worstTrained = std::max(worstTrained, trained);
+            passed = passed && worst == 0.0f && trained <= TRAIN_TOLERANCE;
+        }
+    }
+    MatrixKernels::setIsa(best);
+    Activations::setAccuracy(previous);
+
+    NeuralNetwork dynamicNetwork({12, 32, 16, 4});
+    ProductionNetwork staticNetwork;
+    std::cout << "StaticNetwork<12, 32, 16, 4> vs NeuralNetwork:" << std::endl;
+    std::ostringstream note;
+    note << "max |diff| after 1000 steps " << std::scientific << std::setprecision(1) << worstTrained;
+    printResult("dynamic predictInto", timePredictInto(dynamicNetwork, 200000));
+    printResult("static predictInto", timePredictInto(staticNetwork, 200000));
+    printResult("dynamic train (single example)", timeTrain(dynamicNetwork, 50000));
+    printResult("static train (single example)", timeTrain(staticNetwork, 50000), "call", note.str());
+    printResult("dynamic simulation", timeSimulationFrame(dynamicNetwork, 20), "frame");
+    printResult("static simulation", timeSimulationFrame(staticNetwork, 20), "frame");
+    std::cout << "  same predictions on every ISA and tier, training within " << std::scientific
+              << std::setprecision(0) << TRAIN_TOLERANCE << std::fixed << ": "
+              << (passed ? "yes" : "NO  FAILED") << std::endl;
+    std::cout << std::endl;
+    return passed;
+}
+
+void Benchmark::benchmarkActivations() {
+    const Activations::Type types[] = {Activations::Type::Sigmoid, Activations::Type::Tanh, Activations::Type::ReLU,
+                                       Activations::Type::LeakyReLU, Activations::Type::HardTanh};
+    const Activations::Accuracy tiers[] = {Activations::Accuracy::Exact, Activations::Accuracy::Polynomial,
+                                           Activations::Accuracy::Table};
+    const int count = 4096;
+    const int iterations = 2000;
+
+    // Dense sweep over [-20, 20] for the error check, plus a row of typical pre-activations to time
+    std::vector<float> sweep(400001);
+    for (size_t i = 0; i < sweep.size(); ++i)
+        sweep[i] = -20.0f + static_cast<float>(i) * 1e-4f;
+    Matrix inputs = makeRandomMatrix(1, count, -4.0f, 4.0f);
+    std::vector<float> values(count);
+
+    Activations::Accuracy previous = Activations::accuracy();
+    std::cout << "Activations (" << MatrixKernels::isaName(MatrixKernels::activeIsa()) << ", "
+              << count << " values per call):" << std::endl;
+
+    for (Activations::Type type : types) {
+        for (Activations::Accuracy tier : tiers) {
+            bool piecewiseLinear = type != Activations::Type::Sigmoid && type != Activations::Type::Tanh;
+            if (piecewiseLinear && tier != Activations::Accuracy::Exact) {
+                continue;  // identical in every tier
+            }
+            Activations::setAccuracy(tier);
+
+            std::vector<float> result = sweep;
+            Activations::forward(type, result.data(), nullptr, static_cast<int>(result.size()));
+            float worst = 0.0f;
+            for (size_t i = 0; i < sweep.size(); ++i)
+                worst = std::max(worst, std::abs(result[i] - Activations::apply(type, sweep[i])));
+
+            auto start = BenchClock::now();
+            for (int i = 0; i < iterations; ++i) {
+                std::copy_n(inputs.data(), count, values.data());
+                Activations::forward(type, values.data(), nullptr, count);
+            }
+            double perValue = elapsedNanoseconds(start) / (static_cast<double>(iterations) * count);
+            benchmarkSink = values[0];
+
+            std::string name = std::string(Activations::name(type)) + " " +
+                               (piecewiseLinear ? "(all tiers)" : Activations::accuracyName(tier));
+            std::ostringstream note;
+            note << "max |err| " << std::scientific << std::setprecision(1) << worst;
+            printResult(name, perValue, "value", note.str());
+        }
+
+        // Derivative of outputs in (0, 1); the gradient is reset each call so it never goes denormal
+        Matrix outputs = makeRandomMatrix(1, count, 0.0f, 1.0f);
+        std::vector<float> gradient(count);
+        auto start = BenchClock::now();
+        for (int i = 0; i < iterations; ++i) {
+            std::fill(gradient.begin(), gradient.end(), 1.0f);
+            Activations::backward(type, outputs.data(), gradient.data(), count);
+        }
+        benchmarkSink = gradient[0];
+        printResult(std::string(Activations::name(type)) + " derivative",
+                    elapsedNanoseconds(start) / (static_cast<double>(iterations) * count), "value");
+    }
+    Activations::setAccuracy(previous);
+    std::cout << std::endl;
+}
+
+void Benchmark::benchmarkKernels() {
+    struct Shape { int m, k, n; };
+    const Shape shapes[] = {{1, 12, 32}, {1, 32, 16}, {1, 16, 4}, {32, 12, 32}, {32, 32, 16}, {1, 512, 512}, {64, 512, 512}};
+
+    MatrixKernels::Isa best = MatrixKernels::detectedIsa();
+    std::cout << "Matrix kernels (detected ISA: " << MatrixKernels::isaName(best) << "):" << std::endl;
+
+    for (const Shape& shape : shapes) {
+        Matrix a = makeRandomMatrix(shape.m, shape.k, -1.0f, 1.0f);
+        Matrix b = makeRandomMatrix(shape.k, shape.n, -0.5f, 0.5f);
+        Matrix reference(shape.m, shape.n);
+        MatrixKernels::gemmScalar(a.data(), a.cols, b.data(), b.cols, reference.data(), reference.cols,
+                                  shape.m, shape.k, shape.n);
+
+        // Enough repetitions for roughly 50M multiply-adds per measurement
+        long long work = static_cast<long long>(shape.m) * shape.k * shape.n;
+        int iterations = static_cast<int>(std::max(10LL, 50000000LL / work));
+
+        for (int isa = 0; isa <= static_cast<int>(best); ++isa) {
+            MatrixKernels::setIsa(static_cast<MatrixKernels::Isa>(isa));
+            Matrix result;
+            auto start = BenchClock::now();
+            for (int i = 0; i < iterations; ++i)
+                result = a.dot(b);
+            double perCall = elapsedNanoseconds(start) / iterations;
+
+            std::string name = std::to_string(shape.m) + "x" + std::to_string(shape.k) + " * " +
+                               std::to_string(shape.k) + "x" + std::to_string(shape.n) + " " +
+                               MatrixKernels::isaName(static_cast<MatrixKernels::Isa>(isa));
+            std::ostringstream note;
+            note << "max |diff| vs scalar " << std::scientific << std::setprecision(1)
+                 << maxAbsDifference(result, reference);
+            printResult(name, perCall, "call", note.str());
+        }
+    }
+    MatrixKernels::setIsa(best);
+    std::cout << std::endl;
+}
+
+void Benchmark::benchmarkGemmScaling() {
+    const int sizes[] = {64, 128, 256, 512, 1024};
+
+    std::vector<int> threadCounts;
+    for (int threads = 1; threads < ThreadPool::hardwareThreads(); threads *= 2)
+        threadCounts.push_back(threads);
+    threadCounts.push_back(ThreadPool::hardwareThreads());
+
+    std::cout << "Blocked GEMM scaling (square n x n, " << MatrixKernels::isaName(MatrixKernels::activeIsa())
+              << "):" << std::endl;
+    std::cout << "  " << std::left << std::setw(8) << "n";
+    for (int threads : threadCounts)
+        std::cout << std::right << std::setw(10) << (std::to_string(threads) + "T");
+    std::cout << "   GFLOP/s" << std::endl;
+
+    for (int n : sizes) {
+        Matrix a = makeRandomMatrix(n, n, -1.0f, 1.0f);
+        Matrix b = makeRandomMatrix(n, n, -1.0f, 1.0f);
+        Matrix c(n, n);
+        MatrixKernels::PackedPanels packed;
+        MatrixKernels::pack(b.data(), n, n, n, packed);
+
+        double flops = 2.0 * n * n * n;
+        int iterations = static_cast<int>(std::max(3.0, 2e9 / flops));
+
+        std::cout << "  " << std::left << std::setw(8) << n << std::right;
+        for (int threads : threadCounts) {
+            ThreadPool::setSharedThreadCount(threads);
+            MatrixKernels::gemmPacked(a.data(), n, packed, c.data(), n, n); // warm up
+            auto start = BenchClock::now();
+            for (int i = 0; i < iterations; ++i)
+                MatrixKernels::gemmPacked(a.data(), n, packed, c.data(), n, n);
+            double seconds = elapsedNanoseconds(start) * 1e-9 / iterations;
+            std::cout << std::setw(10) << std::fixed << std::setprecision(1) << flops / seconds * 1e-9;
+        }
+        std::cout << std::endl;
+        benchmarkSink = c(0, 0);
+    }
+    ThreadPool::setSharedThreadCount(0);
+    std::cout << std::endl;
+}
+
+void Benchmark::printResult(const std::string& name, double nanoseconds, const std::string& unit,
+                            const std::string& note) {
+    std::cout << "  " << std::left << std::setw(40) << name << std::right
+              << std::fixed << std::setprecision(1) << std::setw(12) << nanoseconds
+              << " ns/" << unit;
+    if (!note.empty()) {
+        std::cout << "  (" << note << ")";
+    }
+    std::cout << std::endl;
+}
+
+bool Benchmark::runAll() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  Benchmarks" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    NeuralNetwork network({12, 32, 16, 4});
+
+    std::cout << "Network {12, 32, 16, 4}:" << std::endl;
+    printResult("predict (1x12)", benchmarkPredict(network, 200000));
+    printResult("predictInto (1x12, no allocations)", benchmarkPredictInto(network, 200000));
+    printResult("train (single example)", benchmarkTrain(network, 50000));
+    std::cout << std::endl;
+
+    NeuralNetwork wideNetwork({12, 512, 512, 4});
+    std::cout << "Network {12, 512, 512, 4}:" << std::endl;
+    printResult("predict (1x12)", benchmarkPredict(wideNetwork, 5000));
+    printResult("predictInto (1x12, no allocations)", benchmarkPredictInto(wideNetwork, 5000));
+    printResult("train (single example)", benchmarkTrain(wideNetwork, 500));
+    std::cout << std::endl;
+
+    benchmarkPredictBatch();
+    benchmarkTrainBatch();
+    bool passed = benchmarkParallelTraining();
+    passed = benchmarkModelLoading() && passed;
+    passed = benchmarkCheckpointing() && passed;
+    benchmarkRandomStreams();
+    passed = benchmarkParallelValidation() && passed;
+    passed = benchmarkVecSimulation() && passed;
+    passed = benchmarkBulletScan() && passed;
+    passed = benchmarkBulletPool() && passed;
+    passed = benchmarkBulletGrid() && passed;
+    passed = benchmarkShipPhysics() && passed;
+    passed = benchmarkSequentialTest() && passed;
+    passed = benchmarkNeuroEvolution() && passed;
+    benchmarkOptimizers();
+    passed = benchmarkStaticNetwork() && passed;
+    passed = benchmarkQuantized() && passed;
+    benchmarkActivations();
+    benchmarkKernels();
+    benchmarkGemmScaling();
+    return passed;
+}
@@ -0,0 +1,318 @@
+#include "BulletField.h"
+#include "GameSettings.h"
+#include "MatrixKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#ifdef MATRIX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Everything one pass needs besides the arrays
+struct ScanParameters {
+    float width;
+    float height;
+    float shipX;
+    float shipY;
+    float radiusSquared;
+};
+
+// Bullets [first, last) one at a time: the reference pass, and the one used
+// without AVX2. The vector passes run the same operations in the same order
+// (the squared distance is one multiply then one fused multiply-add), so
+// they agree with it bit for bit.
+void scanRange(float* x, float* y, const float* vx, const float* vy, int first, int last,
+               const ScanParameters& p, BulletField::Scan& scan) {
+    for (int i = first; i < last; ++i) {
+        float px = x[i] + vx[i];
+        float py = y[i] + vy[i];
+        if (px < 0.0f) px += p.width;
+        else if (px > p.width) px -= p.width;
+        if (py < 0.0f) py += p.height;
+        else if (py > p.height) py -= p.height;
+        x[i] = px;
+        y[i] = py;
+
+        float dx = px - p.shipX;
+        float dy = py - p.shipY;
+        float distanceSquared = std::fma(dy, dy, dx * dx);
+        if (distanceSquared < p.radiusSquared) {
+            scan.hit = true;
+        }
+        if (distanceSquared < scan.nearestDistanceSquared) {
+            scan.nearestDistanceSquared = distanceSquared;
+            scan.nearest = i;
+        }
+    }
+}
+
+// Fold per-lane nearest candidates into scan: smallest distance, lowest index on ties
+void mergeLanes(const float* distances, const int* indices, int lanes, BulletField::Scan& scan) {
+    for (int lane = 0; lane < lanes; ++lane) {
+        if (indices[lane] < 0) {
+            continue;
+        }
+        if (distances[lane] < scan.nearestDistanceSquared ||
+            (distances[lane] == scan.nearestDistanceSquared && indices[lane] < scan.nearest)) {
+            scan.nearestDistanceSquared = distances[lane];
+            scan.nearest = indices[lane];
+        }
+    }
+}
+
+#ifdef MATRIX_KERNELS_X86
+
+// One block of eight bullets; lanes outside valid are neither hits nor nearest
+TARGET_AVX2 inline void scanBlockAvx2(float* x, float* y, const float* vx, const float* vy, const ScanParameters& p,
+                                      __m256i index, __m256 valid, __m256& hits, __m256& best,
+                                      __m256i& bestIndex) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 width = _mm256_set1_ps(p.width);
+    const __m256 height = _mm256_set1_ps(p.height);
+
+    __m256 px = _mm256_add_ps(_mm256_loadu_ps(x), _mm256_loadu_ps(vx));
+    __m256 py = _mm256_add_ps(_mm256_loadu_ps(y), _mm256_loadu_ps(vy));
+    // Masks come from the moved position; below zero and past the edge never both hold
+    __m256 left = _mm256_cmp_ps(px, zero, _CMP_LT_OQ);
+    __m256 right = _mm256_cmp_ps(px, width, _CMP_GT_OQ);
+    __m256 top = _mm256_cmp_ps(py, zero, _CMP_LT_OQ);
+    __m256 bottom = _mm256_cmp_ps(py, height, _CMP_GT_OQ);
+    px = _mm256_blendv_ps(px, _mm256_add_ps(px, width), left);
+    px = _mm256_blendv_ps(px, _mm256_sub_ps(px, width), right);
+    py = _mm256_blendv_ps(py, _mm256_add_ps(py, height), top);
+    py = _mm256_blendv_ps(py, _mm256_sub_ps(py, height), bottom);
+    _mm256_storeu_ps(x, px);
+    _mm256_storeu_ps(y, py);
+
+    __m256 dx = _mm256_sub_ps(px, _mm256_set1_ps(p.shipX));
+    __m256 dy = _mm256_sub_ps(py, _mm256_set1_ps(p.shipY));
+    __m256 distanceSquared = _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx));
+    hits = _mm256_or_ps(hits, _mm256_and_ps(valid, _mm256_cmp_ps(distanceSquared, _mm256_set1_ps(p.radiusSquared),
+                                                                  _CMP_LT_OQ)));
+
+    __m256 closer = _mm256_and_ps(valid, _mm256_cmp_ps(distanceSquared, best, _CMP_LT_OQ));
+    best = _mm256_blendv_ps(best, distanceSquared, closer);
+    bestIndex = _mm256_castps_si256(
+        _mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(index), closer));
+}
+
+TARGET_AVX2 void scanAvx2(float* x, float* y, const float* vx, const float* vy, int n, const ScanParameters& p,
+                          BulletField::Scan& scan) {
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    const __m256 all = _mm256_castsi256_ps(_mm256_cmpeq_epi32(lanes, lanes));
+    __m256 hits = _mm256_setzero_ps();
+    __m256 best = _mm256_set1_ps(scan.nearestDistanceSquared);
+    __m256i bestIndex = _mm256_set1_epi32(-1);
+
+    int i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i index = _mm256_add_epi32(lanes, _mm256_set1_epi32(i));
+        scanBlockAvx2(x + i, y + i, vx + i, vy + i, p, index, all, hits, best, bestIndex);
+    }
+
+    // The last few bullets go through a zero-padded copy of the block
+    int remaining = n - i;
+    if (remaining > 0) {
+        alignas(32) float tailX[8] = {};
+        alignas(32) float tailY[8] = {};
+        alignas(32) float tailVelX[8] = {};
+        alignas(32) float tailVelY[8] = {};
+        std::copy_n(x + i, remaining, tailX);
+        std::copy_n(y + i, remaining, tailY);
+        std::copy_n(vx + i, remaining, tailVelX);
+        std::copy_n(vy + i, remaining, tailVelY);
+        __m256 valid = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(remaining), lanes));
+        __m256i index = _mm256_add_epi32(lanes, _mm256_set1_epi32(i));
+        scanBlockAvx2(tailX, tailY, tailVelX, tailVelY, p, index, valid, hits, best, bestIndex);
+        std::copy_n(tailX, remaining, x + i);
+        std::copy_n(tailY, remaining, y + i);
+    }
+
+    scan.hit = _mm256_movemask_ps(hits) != 0;
+    alignas(32) float distances[8];
+    alignas(32) int indices[8];
+    _mm256_store_ps(distances, best);
+    _mm256_store_si256(reinterpret_cast<__m256i*>(indices), bestIndex);
+    _mm256_zeroupper();
+    mergeLanes(distances, indices, 8, scan);
+}
+
+// Masked loads and stores cover the last partial block, so there is no scalar tail
+TARGET_AVX512 void scanAvx512(float* x, float* y, const float* vx, const float* vy, int n, const ScanParameters& p,
+                              BulletField::Scan& scan) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 width = _mm512_set1_ps(p.width);
+    const __m512 height = _mm512_set1_ps(p.height);
+    const __m512 shipX = _mm512_set1_ps(p.shipX);
+    const __m512 shipY = _mm512_set1_ps(p.shipY);
+    const __m512 radiusSquared = _mm512_set1_ps(p.radiusSquared);
+    const __m512i step = _mm512_set1_epi32(16);
+    __m512 best = _mm512_set1_ps(scan.nearestDistanceSquared);
+    __m512i bestIndex = _mm512_set1_epi32(-1);
+    __m512i index = _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    __mmask16 hits = 0;
+
+    for (int i = 0; i < n; i += 16) {
+        int remaining = n - i;
+        __mmask16 valid = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                          : static_cast<__mmask16>((1u << remaining) - 1);
+        __m512 px = _mm512_add_ps(_mm512_maskz_loadu_ps(valid, x + i), _mm512_maskz_loadu_ps(valid, vx + i));
+        __m512 py = _mm512_add_ps(_mm512_maskz_loadu_ps(valid, y + i), _mm512_maskz_loadu_ps(valid, vy + i));
+        __mmask16 left = _mm512_cmp_ps_mask(px, zero, _CMP_LT_OQ);
+        __mmask16 right = _mm512_cmp_ps_mask(px, width, _CMP_GT_OQ);
+        __mmask16 top = _mm512_cmp_ps_mask(py, zero, _CMP_LT_OQ);
+        __mmask16 bottom = _mm512_cmp_ps_mask(py, height, _CMP_GT_OQ);
+        px = _mm512_mask_add_ps(px, left, px, width);
+        px = _mm512_mask_sub_ps(px, right, px, width);
+        py = _mm512_mask_add_ps(py, top, py, height);
+        py = _mm512_mask_sub_ps(py, bottom, py, height);
+        _mm512_mask_storeu_ps(x + i, valid, px);
+        _mm512_mask_storeu_ps(y + i, valid, py);
+
+        __m512 dx = _mm512_sub_ps(px, shipX);
+        __m512 dy = _mm512_sub_ps(py, shipY);
+        __m512 distanceSquared = _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx));
+        hits |= _mm512_mask_cmp_ps_mask(valid, distanceSquared, radiusSquared, _CMP_LT_OQ);
+
+        __mmask16 closer = _mm512_mask_cmp_ps_mask(valid, distanceSquared, best, _CMP_LT_OQ);
+        best = _mm512_mask_mov_ps(best, closer, distanceSquared);
+        bestIndex = _mm512_mask_mov_epi32(bestIndex, closer, index);
+        index = _mm512_add_epi32(index, step);
+    }
+
+    scan.hit = hits != 0;
+    alignas(64) float distances[16];
+    alignas(64) int indices[16];
+    _mm512_store_ps(distances, best);
+    _mm512_store_si512(indices, bestIndex);
+    _mm256_zeroupper();
+    mergeLanes(distances, indices, 16, scan);
+}
+
+#endif // MATRIX_KERNELS_X86
+
+}
+
+BulletField::BulletField(int capacity)
+    : BulletField(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT), capacity) {}
+
+BulletField::BulletField(float width, float height, int capacity) : width(width), height(height) {
+    if (capacity < 0) {
+        std::cerr << "Error: Bullet pool capacity must not be negative, got " << capacity << "; using 0" << std::endl;
+        capacity = 0;
+    }
+    xs.resize(capacity);
+    ys.resize(capacity);
+    vxs.resize(capacity);
+    vys.resize(capacity);
+    expiry.resize(capacity);
+    handles.resize(capacity);
+    indices.resize(capacity);
+    freeHandles.resize(capacity);
+    clear();
+}
+
+int BulletField::add(float x, float y, float velX, float velY, int lifetime) {
+    if (full()) {
+        return -1;
+    }
+    int handle = freeHandles[capacity() - count - 1];
+    int i = count++;
+    xs[i] = x;
+    ys[i] = y;
+    vxs[i] = velX;
+    vys[i] = velY;
+    if (lifetime > 0) {
+        expiry[i] = frame + lifetime;
+        ++mortal;
+    } else {
+        expiry[i] = std::numeric_limits<int>::max();
+    }
+    handles[i] = handle;
+    indices[handle] = i;
+    return handle;
+}
+
+void BulletField::remove(int handle) {
+    int i = indexOf(handle);
+    if (i >= 0) {
+        removeAt(i);
+    }
+}
+
+void BulletField::removeAt(int i) {
+    int last = --count;
+    if (expiry[i] != std::numeric_limits<int>::max()) {
+        --mortal;
+    }
+    indices[handles[i]] = -1;
+    freeHandles[capacity() - count - 1] = handles[i];
+    if (i != last) {
+        xs[i] = xs[last];
+        ys[i] = ys[last];
+        vxs[i] = vxs[last];
+        vys[i] = vys[last];
+        expiry[i] = expiry[last];
+        handles[i] = handles[last];
+        indices[handles[i]] = i;
+    }
+}
+
+void BulletField::clear() {
+    // Free handles are popped from the back, so spawning hands out 0, 1, 2, ...
+    int n = capacity();
+    for (int h = 0; h < n; ++h) {
+        freeHandles[h] = n - 1 - h;
+        indices[h] = -1;
+    }
+    count = 0;
+    mortal = 0;
+    frame = 0;
+}
+
+void BulletField::expire() {
+    // Downwards, so the bullet moved into a freed index has already been checked
+    for (int i = count - 1; i >= 0; --i) {
+        if (expiry[i] < frame) {
+            removeAt(i);
+        }
+    }
+}
+
+BulletField::Scan BulletField::scan(float shipX, float shipY) {
+    ++frame;
+    if (mortal > 0) {
+        expire();
+    }
+    ScanParameters p = {width, height, shipX, shipY, BULLET_COLLISION_RADIUS * BULLET_COLLISION_RADIUS};
+    Scan result = {false, -1, NEAREST_RANGE * NEAREST_RANGE};
+    int n = size();
+    switch (MatrixKernels::activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+        case MatrixKernels::Isa::AVX512:
+            scanAvx512(xs.data(), ys.data(), vxs.data(), vys.data(), n, p, result);
+            break;
+        case MatrixKernels::Isa::AVX2:
+            scanAvx2(xs.data(), ys.data(), vxs.data(), vys.data(), n, p, result);
+            break;
+#endif
+        default:
+            scanRange(xs.data(), ys.data(), vxs.data(), vys.data(), 0, n, p, result);
+    }
+    return result;
+}
+
+BulletField::Scan BulletField::scanScalar(float shipX, float shipY) {
+    ++frame;
+    if (mortal > 0) {
+        expire();
+    }
+    ScanParameters p = {width, height, shipX, shipY, BULLET_COLLISION_RADIUS * BULLET_COLLISION_RADIUS};
+    Scan result = {false, -1, NEAREST_RANGE * NEAREST_RANGE};
+    scanRange(xs.data(), ys.data(), vxs.data(), vys.data(), 0, size(), p, result);
+    return result;
+}
@@ -0,0 +1,187 @@
+#include "BulletGrid.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+BulletGrid::BulletGrid(float width, float height, float cellSize, Metric metric)
+    : width(width), height(height), metric(metric) {
+    if (!(cellSize > 0.0f)) {
+        std::cerr << "Error: Bullet grid cell size must be positive, got " << cellSize
+                  << "; using one cell for the whole arena" << std::endl;
+        cellSize = std::max(width, height);
+    }
+    // Whole cells that tile the arena exactly, each at least cellSize across
+    columnCount = std::max(1, static_cast<int>(width / cellSize));
+    rowCount = std::max(1, static_cast<int>(height / cellSize));
+    cellWidth = width / columnCount;
+    cellHeight = height / rowCount;
+    inverseCellWidth = columnCount / width;
+    inverseCellHeight = rowCount / height;
+    cellStart.assign(static_cast<size_t>(columnCount) * rowCount + 1, 0);
+}
+
+float BulletGrid::cellSizeFor(float width, float height, int bullets, float minimumSize, float bulletsPerCell) {
+    float size = std::sqrt(width * height * bulletsPerCell / std::max(1, bullets));
+    return std::min(std::max(size, minimumSize), std::max(width, height));
+}
+
+int BulletGrid::column(float x) const {
+    return std::min(std::max(static_cast<int>(x * inverseCellWidth), 0), columnCount - 1);
+}
+
+int BulletGrid::row(float y) const {
+    return std::min(std::max(static_cast<int>(y * inverseCellHeight), 0), rowCount - 1);
+}
+
+int BulletGrid::lowestColumnOffset(int column) const {
+    return metric == Metric::Toroidal ? -(columnCount - 1) / 2 : -column;
+}
+
+int BulletGrid::highestColumnOffset(int column) const {
+    return metric == Metric::Toroidal ? columnCount / 2 : columnCount - 1 - column;
+}
+
+int BulletGrid::lowestRowOffset(int row) const {
+    return metric == Metric::Toroidal ? -(rowCount - 1) / 2 : -row;
+}
+
+int BulletGrid::highestRowOffset(int row) const {
+    return metric == Metric::Toroidal ? rowCount / 2 : rowCount - 1 - row;
+}
+
+float BulletGrid::distanceSquared(float x, float y, float bulletX, float bulletY) const {
+    float dx = bulletX - x;
+    float dy = bulletY - y;
+    if (metric == Metric::Toroidal) {
+        if (dx > 0.5f * width) dx -= width;
+        else if (dx < -0.5f * width) dx += width;
+        if (dy > 0.5f * height) dy -= height;
+        else if (dy < -0.5f * height) dy += height;
+    }
+    // Same rounding as BulletField::scan
+    return std::fma(dy, dy, dx * dx);
+}
+
+void BulletGrid::rebuild(const BulletField& bullets) {
+    int n = bullets.size();
+    int cells = columnCount * rowCount;
+    cellOf.resize(n);
+    order.resize(n);
+    sortedX.resize(n);
+    sortedY.resize(n);
+
+    // Counting sort: histogram, prefix sum, then scatter in index order
+    std::fill(cellStart.begin(), cellStart.end(), 0);
+    for (int i = 0; i < n; ++i) {
+        int cell = row(bullets.y(i)) * columnCount + column(bullets.x(i));
+        cellOf[i] = cell;
+        cellStart[cell + 1]++;
+    }
+    for (int cell = 0; cell < cells; ++cell)
+        cellStart[cell + 1] += cellStart[cell];
+
+    cursor.assign(cellStart.begin(), cellStart.end() - 1);
+    for (int i = 0; i < n; ++i) {
+        int slot = cursor[cellOf[i]]++;
+        order[slot] = i;
+        sortedX[slot] = bullets.x(i);
+        sortedY[slot] = bullets.y(i);
+    }
+}
+
+bool BulletGrid::anyWithin(float x, float y, float radius) const {
+    float radiusSquared = radius * radius;
+    int centerColumn = column(x);
+    int centerRow = row(y);
+    int firstColumn = std::max(lowestColumnOffset(centerColumn),
+                               static_cast<int>(std::floor((x - radius) * inverseCellWidth)) - centerColumn);
+    int lastColumn = std::min(highestColumnOffset(centerColumn),
+                              static_cast<int>(std::floor((x + radius) * inverseCellWidth)) - centerColumn);
+    int firstRow = std::max(lowestRowOffset(centerRow),
+                            static_cast<int>(std::floor((y - radius) * inverseCellHeight)) - centerRow);
+    int lastRow = std::min(highestRowOffset(centerRow),
+                           static_cast<int>(std::floor((y + radius) * inverseCellHeight)) - centerRow);
+
+    for (int rowOffset = firstRow; rowOffset <= lastRow; ++rowOffset) {
+        int cellRow = wrap(centerRow + rowOffset, rowCount);
+        for (int columnOffset = firstColumn; columnOffset <= lastColumn; ++columnOffset) {
+            int cell = cellRow * columnCount + wrap(centerColumn + columnOffset, columnCount);
+            for (int slot = cellStart[cell]; slot < cellStart[cell + 1]; ++slot) {
+                if (distanceSquared(x, y, sortedX[slot], sortedY[slot]) < radiusSquared) {
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+void BulletGrid::collectCell(int cell, float x, float y, int k, float rangeSquared, int* indices,
+                             float* distancesSquared, int& found) const {
+    for (int slot = cellStart[cell]; slot < cellStart[cell + 1]; ++slot) {
+        float distance = distanceSquared(x, y, sortedX[slot], sortedY[slot]);
+        int index = order[slot];
+        if (!(distance < rangeSquared)) {
+            continue;
+        }
+        if (found == k && (distance > distancesSquared[k - 1] ||
+                           (distance == distancesSquared[k - 1] && index > indices[k - 1]))) {
+            continue;
+        }
+
+        // Insertion into the short sorted list, ordered by (distance, index)
+        int position = found < k ? found++ : k - 1;
+        while (position > 0 && (distancesSquared[position - 1] > distance ||
+                                (distancesSquared[position - 1] == distance && indices[position - 1] > index))) {
+            distancesSquared[position] = distancesSquared[position - 1];
+            indices[position] = indices[position - 1];
+            --position;
+        }
+        distancesSquared[position] = distance;
+        indices[position] = index;
+    }
+}
+
+int BulletGrid::nearest(float x, float y, int k, float maxRange, int* indices, float* distancesSquared) const {
+    if (k <= 0) {
+        return 0;
+    }
+    float rangeSquared = maxRange * maxRange;
+    float smallestCell = std::min(cellWidth, cellHeight);
+    int centerColumn = column(x);
+    int centerRow = row(y);
+    int firstColumn = lowestColumnOffset(centerColumn);
+    int lastColumn = highestColumnOffset(centerColumn);
+    int firstRow = lowestRowOffset(centerRow);
+    int lastRow = highestRowOffset(centerRow);
+    int lastRing = std::max(std::max(-firstColumn, lastColumn), std::max(-firstRow, lastRow));
+
+    // Rings of cells at Chebyshev distance 0, 1, 2, ... from the query's cell.
+    // Every cell beyond ring r is at least r cells away, so the search stops
+    // once the k-th candidate is closer than that (or nothing in range is left).
+    int found = 0;
+    for (int ring = 0; ring <= lastRing; ++ring) {
+        int rowFrom = std::max(firstRow, -ring);
+        int rowTo = std::min(lastRow, ring);
+        for (int rowOffset = rowFrom; rowOffset <= rowTo; ++rowOffset) {
+            int cellRow = wrap(centerRow + rowOffset, rowCount);
+            bool edgeRow = rowOffset == -ring || rowOffset == ring;
+            int step = edgeRow ? 1 : 2 * ring;
+            for (int columnOffset = -ring; columnOffset <= ring; columnOffset += step) {
+                if (columnOffset < firstColumn || columnOffset > lastColumn) {
+                    continue;
+                }
+                int cell = cellRow * columnCount + wrap(centerColumn + columnOffset, columnCount);
+                collectCell(cell, x, y, k, rangeSquared, indices, distancesSquared, found);
+            }
+        }
+
+        // Slightly under the true bound so rounding can never skip a closer bullet
+        float reach = ring * smallestCell * 0.999f;
+        float reachSquared = reach * reach;
+        if (reachSquared >= rangeSquared || (found == k && distancesSquared[k - 1] < reachSquared)) {
+            break;
+        }
+    }
+    return found;
+}
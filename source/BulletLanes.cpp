@@ -0,0 +1,327 @@
+#include "BulletLanes.h"
+#include "GameSettings.h"
+#include "MatrixKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <limits>
+
+#ifdef MATRIX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Lanes are padded to whole blocks of the widest pass
+const int LANE_BLOCK = 16;
+
+// Everything one pass needs besides the arrays
+struct LaneParameters {
+    float width;
+    float height;
+    float radiusSquared;
+    int stride;
+};
+
+// The largest bullet count among the flying lanes of [first, last)
+int longestLane(const int* counts, const int* flying, int first, int last) {
+    int longest = 0;
+    for (int lane = first; lane < last; ++lane) {
+        if (flying[lane] != 0) {
+            longest = std::max(longest, counts[lane]);
+        }
+    }
+    return longest;
+}
+
+// Lane by lane, bullet by bullet: BulletField's scalar pass for each flying lane
+void scanLanesScalar(float* x, float* y, const float* vx, const float* vy, const int* counts, int lanes,
+                     const float* shipX, const float* shipY, const int* flying, const LaneParameters& p,
+                     BulletField::Scan* scans) {
+    for (int lane = 0; lane < lanes; ++lane) {
+        if (flying[lane] == 0) {
+            continue;
+        }
+        BulletField::Scan scan = {false, -1, BulletField::NEAREST_RANGE * BulletField::NEAREST_RANGE};
+        for (int i = 0; i < counts[lane]; ++i) {
+            int at = i * p.stride + lane;
+            float px = x[at] + vx[at];
+            float py = y[at] + vy[at];
+            if (px < 0.0f) px += p.width;
+            else if (px > p.width) px -= p.width;
+            if (py < 0.0f) py += p.height;
+            else if (py > p.height) py -= p.height;
+            x[at] = px;
+            y[at] = py;
+
+            float dx = px - shipX[lane];
+            float dy = py - shipY[lane];
+            float distanceSquared = std::fma(dy, dy, dx * dx);
+            if (distanceSquared < p.radiusSquared) {
+                scan.hit = true;
+            }
+            if (distanceSquared < scan.nearestDistanceSquared) {
+                scan.nearestDistanceSquared = distanceSquared;
+                scan.nearest = i;
+            }
+        }
+        scans[lane] = scan;
+    }
+}
+
+#ifdef MATRIX_KERNELS_X86
+
+// The vector passes run BulletField's operations in its order (move, wrap,
+// one multiply then one fused multiply-add for the squared distance), each
+// lane in its own vector lane, so they agree with the scalar pass bit for
+// bit. Bullets are visited in index order and a lane's nearest only moves on
+// a strictly smaller distance, so ties go to the lowest index as in
+// BulletField.
+
+TARGET_AVX512 void scanAvx512(float* x, float* y, const float* vx, const float* vy, const int* counts, int lanes,
+                              const float* shipX, const float* shipY, const int* flying, const LaneParameters& p,
+                              BulletField::Scan* scans) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 width = _mm512_set1_ps(p.width);
+    const __m512 height = _mm512_set1_ps(p.height);
+    const __m512 radiusSquared = _mm512_set1_ps(p.radiusSquared);
+
+    for (int first = 0; first < lanes; first += 16) {
+        int remaining = lanes - first;
+        __mmask16 valid = remaining >= 16 ? static_cast<__mmask16>(0xFFFF)
+                                          : static_cast<__mmask16>((1u << remaining) - 1);
+        __mmask16 active = _mm512_mask_cmpneq_epi32_mask(valid, _mm512_maskz_loadu_epi32(valid, flying + first),
+                                                         _mm512_setzero_si512());
+        if (active == 0) {
+            continue;
+        }
+        __m512 shipXs = _mm512_maskz_loadu_ps(active, shipX + first);
+        __m512 shipYs = _mm512_maskz_loadu_ps(active, shipY + first);
+        __m512i laneCounts = _mm512_maskz_loadu_epi32(active, counts + first);
+        int longest = longestLane(counts, flying, first, first + std::min(16, remaining));
+
+        __m512 best = _mm512_set1_ps(BulletField::NEAREST_RANGE * BulletField::NEAREST_RANGE);
+        __m512i bestIndex = _mm512_set1_epi32(-1);
+        __mmask16 hits = 0;
+        for (int i = 0; i < longest; ++i) {
+            __m512i index = _mm512_set1_epi32(i);
+            __mmask16 live = _mm512_mask_cmpgt_epi32_mask(active, laneCounts, index);
+            int at = i * p.stride + first;
+            __m512 px = _mm512_add_ps(_mm512_maskz_loadu_ps(live, x + at), _mm512_maskz_loadu_ps(live, vx + at));
+            __m512 py = _mm512_add_ps(_mm512_maskz_loadu_ps(live, y + at), _mm512_maskz_loadu_ps(live, vy + at));
+            px = _mm512_mask_add_ps(px, _mm512_cmp_ps_mask(px, zero, _CMP_LT_OQ), px, width);
+            px = _mm512_mask_sub_ps(px, _mm512_cmp_ps_mask(px, width, _CMP_GT_OQ), px, width);
+            py = _mm512_mask_add_ps(py, _mm512_cmp_ps_mask(py, zero, _CMP_LT_OQ), py, height);
+            py = _mm512_mask_sub_ps(py, _mm512_cmp_ps_mask(py, height, _CMP_GT_OQ), py, height);
+            _mm512_mask_storeu_ps(x + at, live, px);
+            _mm512_mask_storeu_ps(y + at, live, py);
+
+            __m512 dx = _mm512_sub_ps(px, shipXs);
+            __m512 dy = _mm512_sub_ps(py, shipYs);
+            __m512 distanceSquared = _mm512_fmadd_ps(dy, dy, _mm512_mul_ps(dx, dx));
+            hits |= _mm512_mask_cmp_ps_mask(live, distanceSquared, radiusSquared, _CMP_LT_OQ);
+            __mmask16 closer = _mm512_mask_cmp_ps_mask(live, distanceSquared, best, _CMP_LT_OQ);
+            best = _mm512_mask_mov_ps(best, closer, distanceSquared);
+            bestIndex = _mm512_mask_mov_epi32(bestIndex, closer, index);
+        }
+
+        alignas(64) float distances[16];
+        alignas(64) int indices[16];
+        _mm512_store_ps(distances, best);
+        _mm512_store_si512(indices, bestIndex);
+        for (int lane = 0; lane < 16; ++lane) {
+            if (active & (1u << lane)) {
+                scans[first + lane] = {(hits & (1u << lane)) != 0, indices[lane], distances[lane]};
+            }
+        }
+    }
+    _mm256_zeroupper();
+}
+
+TARGET_AVX2 void scanAvx2(float* x, float* y, const float* vx, const float* vy, const int* counts, int lanes,
+                          const float* shipX, const float* shipY, const int* flying, const LaneParameters& p,
+                          BulletField::Scan* scans) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 width = _mm256_set1_ps(p.width);
+    const __m256 height = _mm256_set1_ps(p.height);
+    const __m256 radiusSquared = _mm256_set1_ps(p.radiusSquared);
+    const __m256i laneIds = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+
+    for (int first = 0; first < lanes; first += 8) {
+        // Lanes past the caller's arrays are masked out of the loads
+        __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(lanes - first), laneIds);
+        __m256i flags = _mm256_maskload_epi32(flying + first, valid);
+        __m256i active = _mm256_andnot_si256(_mm256_cmpeq_epi32(flags, _mm256_setzero_si256()), valid);
+        int activeBits = _mm256_movemask_ps(_mm256_castsi256_ps(active));
+        if (activeBits == 0) {
+            continue;
+        }
+        __m256 shipXs = _mm256_maskload_ps(shipX + first, active);
+        __m256 shipYs = _mm256_maskload_ps(shipY + first, active);
+        __m256i laneCounts = _mm256_and_si256(
+            active, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(counts + first)));
+        int longest = longestLane(counts, flying, first, std::min(first + 8, lanes));
+
+        __m256 best = _mm256_set1_ps(BulletField::NEAREST_RANGE * BulletField::NEAREST_RANGE);
+        __m256i bestIndex = _mm256_set1_epi32(-1);
+        __m256 hits = _mm256_setzero_ps();
+        for (int i = 0; i < longest; ++i) {
+            // The arrays are padded to whole blocks, so full-width loads stay in bounds
+            __m256i index = _mm256_set1_epi32(i);
+            __m256 live = _mm256_castsi256_ps(_mm256_cmpgt_epi32(laneCounts, index));
+            int at = i * p.stride + first;
+            __m256 oldX = _mm256_loadu_ps(x + at);
+            __m256 oldY = _mm256_loadu_ps(y + at);
+            __m256 px = _mm256_add_ps(oldX, _mm256_loadu_ps(vx + at));
+            __m256 py = _mm256_add_ps(oldY, _mm256_loadu_ps(vy + at));
+            __m256 left = _mm256_cmp_ps(px, zero, _CMP_LT_OQ);
+            __m256 right = _mm256_cmp_ps(px, width, _CMP_GT_OQ);
+            __m256 top = _mm256_cmp_ps(py, zero, _CMP_LT_OQ);
+            __m256 bottom = _mm256_cmp_ps(py, height, _CMP_GT_OQ);
+            px = _mm256_blendv_ps(px, _mm256_add_ps(px, width), left);
+            px = _mm256_blendv_ps(px, _mm256_sub_ps(px, width), right);
+            py = _mm256_blendv_ps(py, _mm256_add_ps(py, height), top);
+            py = _mm256_blendv_ps(py, _mm256_sub_ps(py, height), bottom);
+            _mm256_storeu_ps(x + at, _mm256_blendv_ps(oldX, px, live));
+            _mm256_storeu_ps(y + at, _mm256_blendv_ps(oldY, py, live));
+
+            __m256 dx = _mm256_sub_ps(px, shipXs);
+            __m256 dy = _mm256_sub_ps(py, shipYs);
+            __m256 distanceSquared = _mm256_fmadd_ps(dy, dy, _mm256_mul_ps(dx, dx));
+            hits = _mm256_or_ps(hits, _mm256_and_ps(live, _mm256_cmp_ps(distanceSquared, radiusSquared,
+                                                                         _CMP_LT_OQ)));
+            __m256 closer = _mm256_and_ps(live, _mm256_cmp_ps(distanceSquared, best, _CMP_LT_OQ));
+            best = _mm256_blendv_ps(best, distanceSquared, closer);
+            bestIndex = _mm256_castps_si256(
+                _mm256_blendv_ps(_mm256_castsi256_ps(bestIndex), _mm256_castsi256_ps(index), closer));
+        }
+
+        int hitBits = _mm256_movemask_ps(hits);
+        alignas(32) float distances[8];
+        alignas(32) int indices[8];
+        _mm256_store_ps(distances, best);
+        _mm256_store_si256(reinterpret_cast<__m256i*>(indices), bestIndex);
+        for (int lane = 0; lane < 8; ++lane) {
+            if (activeBits & (1 << lane)) {
+                scans[first + lane] = {(hitBits & (1 << lane)) != 0, indices[lane], distances[lane]};
+            }
+        }
+    }
+    _mm256_zeroupper();
+}
+
+#endif // MATRIX_KERNELS_X86
+
+}
+
+BulletLanes::BulletLanes(int lanes, int capacity)
+    : BulletLanes(static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT), lanes, capacity) {}
+
+BulletLanes::BulletLanes(float width, float height, int lanes, int capacity) : width(width), height(height) {
+    if (lanes < 1) {
+        std::cerr << "Error: Bullet lanes need at least one lane, got " << lanes << "; using 1" << std::endl;
+        lanes = 1;
+    }
+    if (capacity < 0) {
+        std::cerr << "Error: Bullet pool capacity must not be negative, got " << capacity << "; using 0" << std::endl;
+        capacity = 0;
+    }
+    this->lanes = lanes;
+    perLane = capacity;
+    laneStride = (lanes + LANE_BLOCK - 1) / LANE_BLOCK * LANE_BLOCK;
+    size_t slots = static_cast<size_t>(laneStride) * capacity;
+    xs.assign(slots, 0.0f);
+    ys.assign(slots, 0.0f);
+    vxs.assign(slots, 0.0f);
+    vys.assign(slots, 0.0f);
+    expiry.assign(slots, 0);
+    counts.assign(laneStride, 0);
+    mortal.assign(laneStride, 0);
+    frames.assign(laneStride, 0);
+}
+
+int BulletLanes::add(int lane, float x, float y, float velX, float velY, int lifetime) {
+    if (counts[lane] == perLane) {
+        return -1;
+    }
+    int i = counts[lane]++;
+    int at = slot(lane, i);
+    xs[at] = x;
+    ys[at] = y;
+    vxs[at] = velX;
+    vys[at] = velY;
+    if (lifetime > 0) {
+        expiry[at] = frames[lane] + lifetime;
+        ++mortal[lane];
+    } else {
+        expiry[at] = std::numeric_limits<int>::max();
+    }
+    return i;
+}
+
+void BulletLanes::clear(int lane) {
+    counts[lane] = 0;
+    mortal[lane] = 0;
+    frames[lane] = 0;
+}
+
+void BulletLanes::removeAt(int lane, int i) {
+    int last = --counts[lane];
+    int at = slot(lane, i);
+    if (expiry[at] != std::numeric_limits<int>::max()) {
+        --mortal[lane];
+    }
+    if (i != last) {
+        int from = slot(lane, last);
+        xs[at] = xs[from];
+        ys[at] = ys[from];
+        vxs[at] = vxs[from];
+        vys[at] = vys[from];
+        expiry[at] = expiry[from];
+    }
+}
+
+void BulletLanes::expire(const int* flying) {
+    for (int lane = 0; lane < lanes; ++lane) {
+        if (flying[lane] == 0) {
+            continue;
+        }
+        int frame = ++frames[lane];
+        if (mortal[lane] == 0) {
+            continue;
+        }
+        // Downwards, so the bullet moved into a freed index has already been checked
+        for (int i = counts[lane] - 1; i >= 0; --i) {
+            if (expiry[slot(lane, i)] < frame) {
+                removeAt(lane, i);
+            }
+        }
+    }
+}
+
+void BulletLanes::scan(const float* shipX, const float* shipY, const int* flying, BulletField::Scan* scans) {
+    expire(flying);
+    LaneParameters p = {width, height, BULLET_COLLISION_RADIUS * BULLET_COLLISION_RADIUS, laneStride};
+    switch (MatrixKernels::activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+        case MatrixKernels::Isa::AVX512:
+            scanAvx512(xs.data(), ys.data(), vxs.data(), vys.data(), counts.data(), lanes, shipX, shipY, flying, p,
+                       scans);
+            break;
+        case MatrixKernels::Isa::AVX2:
+            scanAvx2(xs.data(), ys.data(), vxs.data(), vys.data(), counts.data(), lanes, shipX, shipY, flying, p,
+                     scans);
+            break;
+#endif
+        default:
+            scanLanesScalar(xs.data(), ys.data(), vxs.data(), vys.data(), counts.data(), lanes, shipX, shipY, flying,
+                            p, scans);
+    }
+}
+
+void BulletLanes::scanScalar(const float* shipX, const float* shipY, const int* flying, BulletField::Scan* scans) {
+    expire(flying);
+    LaneParameters p = {width, height, BULLET_COLLISION_RADIUS * BULLET_COLLISION_RADIUS, laneStride};
+    scanLanesScalar(xs.data(), ys.data(), vxs.data(), vys.data(), counts.data(), lanes, shipX, shipY, flying, p,
+                    scans);
+}
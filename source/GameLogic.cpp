@@ -1,29 +1,40 @@
 #include "GameLogic.h"
+#include "CounterRng.h"
+#include "MatrixKernels.h"
+#include "NeuroEvolution.h"
+#include "QuantizedNetwork.h"
+#include "StaticNetwork.h"
+#include "ThreadPool.h"
+#include "VecSimulation.h"
+#include <algorithm>
+#include <atomic>
 #include <random>
 
-SimulationResult GameLogic::runSimulation(NeuralNetwork* network, int maxFrames) {
-    SpaceShip ship;
-    std::vector<SimBullet> bullets;
-    int bulletFireCounter = 0;
+#ifdef MATRIX_KERNELS_X86
+#include <immintrin.h>
+#endif
 
-    // Randomize starting position along edges
-    static std::mt19937 rng(std::random_device{}());
-    std::uniform_int_distribution<int> edgePicker(0, 3);
-    std::uniform_real_distribution<double> distX(50.0, WINDOW_WIDTH - 50.0);
-    std::uniform_real_distribution<double> distY(50.0, WINDOW_HEIGHT - 50.0);
+uint64_t GameLogic::processRunSeed() {
+    static const uint64_t seed = (static_cast<uint64_t>(std::random_device{}()) << 32) ^ std::random_device{}();
+    return seed;
+}
+
+template <typename Network>
+SimulationResult GameLogic::runSimulation(Network* network, int maxFrames) {
+    static std::atomic<uint64_t> nextEpisode{0};
+    return runSimulation(network, maxFrames, processRunSeed(), nextEpisode.fetch_add(1));
+}
+
+template <typename Network>
+SimulationResult GameLogic::runSimulation(Network* network, int maxFrames, uint64_t runSeed, uint64_t episode) {
+    const ShipPhysics::Settings settings = shipSettings();
+    BulletField bullets(bulletCapacity(maxFrames));
+    int bulletFireCounter = 0;
 
     double startX, startY;
-    int edge = edgePicker(rng);
-    switch (edge) {
-        case 0: startX = distX(rng); startY = 50.0; break;
-        case 1: startX = distX(rng); startY = WINDOW_HEIGHT - 50.0; break;
-        case 2: startX = 50.0; startY = distY(rng); break;
-        case 3: startX = WINDOW_WIDTH - 50.0; startY = distY(rng); break;
-    }
+    startPosition(runSeed, episode, startX, startY);
 
-    ship.setPosition(Vector2D(startX, startY));
-    ship.setVelocity(Vector2D(0, 0));
-    ship.setRotationAngle(0);
+    ShipBody<float> ship = {{static_cast<float>(startX), static_cast<float>(startY)}, {0.0f, 0.0f}, 0};
 
     float totalLoss = 0.0f;
     bool won = false;
@@ -38,9 +49,8 @@ SimulationResult GameLogic::runSimulation(NeuralNetwork* network, int maxFrames)
 
     int frame;
     for (frame = 0; frame < maxFrames; ++frame) {
-        Vector2D shipPos = ship.getPosition();
-        double shipX = shipPos.getX();
-        double shipY = shipPos.getY();
+        double shipX = ship.position.x;
+        double shipY = ship.position.y;
 
         // Fire bullets
         bulletFireCounter++;
@@ -51,38 +61,23 @@ SimulationResult GameLogic::runSimulation(NeuralNetwork* network, int maxFrames)
             );
 
             if (distance > SAFE_ZONE_RADIUS) {
-                Vector2D vel = ship.getVelocity();
-                fireAtShip(shipX, shipY, vel.getX(), vel.getY(), bullets);
+                fireAtShip(shipX, shipY, ship.velocity.x, ship.velocity.y, bullets);
                 bulletFireCounter = 0;
             }
         }
 
-        // Update bullets
-        updateBullets(bullets);
-
-        // Check bullet collision
-        if (checkBulletCollision(shipX, shipY, bullets)) {
+        // Update bullets and check collision
+        BulletField::Scan scan = updateBullets(shipX, shipY, bullets);
+        if (scan.hit) {
             hit = true;
             break;
         }
 
-        // Get AI decision and apply
+        // Get AI decision and fly: controls, clamp, move and wrap in one step
         float rotationOutput;
-        applyAIDecision(ship, network, shipX, shipY, bullets, rotationOutput);
-
-        // Update ship physics
-        ship.clampVelocity(MAX_SPEED);
-        ship.updatePosition();
-
-        // Wrap ship around screen
-        shipPos = ship.getPosition();
-        shipX = shipPos.getX();
-        shipY = shipPos.getY();
-        if (shipX < 0) shipX = WINDOW_WIDTH;
-        else if (shipX > WINDOW_WIDTH) shipX = 0;
-        if (shipY < 0) shipY = WINDOW_HEIGHT;
-        else if (shipY > WINDOW_HEIGHT) shipY = 0;
-        ship.setPosition(Vector2D(shipX, shipY));
+        applyAIDecision(ship, network, settings, bullets, scan, rotationOutput);
+        shipX = ship.position.x;
+        shipY = ship.position.y;
 
         // Calculate distance to station
         double dx = STATION_X - shipX;
@@ -111,6 +106,24 @@ SimulationResult GameLogic::runSimulation(NeuralNetwork* network, int maxFrames)
         previousDistance = currentDistance;
     }
 
+    return scoreEpisode(won, hit, totalLoss, closestDistanceReached, previousDistance, frame);
+}
+
+void GameLogic::startPosition(uint64_t runSeed, uint64_t episode, double& startX, double& startY) {
+    // Randomize starting position along edges
+    CounterRng rng(runSeed, episode);
+    startX = 50.0;
+    startY = 50.0;
+    switch (rng.below(4)) {
+        case 0: startX = 50.0 + rng.uniform() * (WINDOW_WIDTH - 100.0); startY = 50.0; break;
+        case 1: startX = 50.0 + rng.uniform() * (WINDOW_WIDTH - 100.0); startY = WINDOW_HEIGHT - 50.0; break;
+        case 2: startX = 50.0; startY = 50.0 + rng.uniform() * (WINDOW_HEIGHT - 100.0); break;
+        case 3: startX = WINDOW_WIDTH - 50.0; startY = 50.0 + rng.uniform() * (WINDOW_HEIGHT - 100.0); break;
+    }
+}
+
+SimulationResult GameLogic::scoreEpisode(bool won, bool hit, float totalLoss, float closestDistanceReached,
+                                         float finalDistance, int frames) {
     // End-of-game scoring based on closest distance reached (ONE-TIME, not per-frame)
     if (closestDistanceReached < 200.0f) totalLoss -= 5.0f;
     if (closestDistanceReached < 150.0f) totalLoss -= 10.0f;
@@ -119,7 +132,7 @@ SimulationResult GameLogic::runSimulation(NeuralNetwork* network, int maxFrames)
 
     // Timeout penalty - harsh for not reaching station
     if (!won && !hit) {
-        totalLoss += previousDistance * 0.3f;  // Increased timeout penalty
+        totalLoss += finalDistance * 0.3f;  // Increased timeout penalty
     }
 
     // Death penalty - significant but still allows learning from near-misses
@@ -127,14 +140,43 @@ SimulationResult GameLogic::runSimulation(NeuralNetwork* network, int maxFrames)
         totalLoss += 50.0f;
     }
 
-    return {won, hit, totalLoss, frame};
+    return {won, hit, totalLoss, frames};
+}
+
+template <typename Network>
+void GameLogic::runSimulations(Network* network, int maxFrames, uint64_t runSeed, uint64_t firstEpisode, int count,
+                               std::vector<SimulationResult>& results) {
+    results.resize(count);
+    if (count <= 0) {
+        return;
+    }
+
+    // Split the episodes into one contiguous range per thread (more if a range
+    // would exceed a full batch) and step each range as one VecSimulation
+    ThreadPool& pool = ThreadPool::shared();
+    int chunkSize = std::min((count + pool.size() - 1) / pool.size(),
+                             static_cast<int>(VecSimulation<Network>::DEFAULT_LANES));
+    int chunks = (count + chunkSize - 1) / chunkSize;
+    pool.parallelFor(chunks, [&](int chunk) {
+        int first = chunk * chunkSize;
+        int episodes = std::min(chunkSize, count - first);
+        VecSimulation<Network> simulation(network, maxFrames, episodes);
+        simulation.run(runSeed, firstEpisode + first, episodes, results.data() + first);
+    });
 }
 
 void GameLogic::fireAtShip(
     double shipX, double shipY,
     double shipVelX, double shipVelY,
-    std::vector<SimBullet>& bullets
+    BulletField& bullets
 ) {
+    float velX, velY;
+    if (aimAtShip(shipX, shipY, shipVelX, shipVelY, velX, velY)) {
+        bullets.add(STATION_X, STATION_Y, velX, velY, BULLET_LIFETIME);
+    }
+}
+
+bool GameLogic::aimAtShip(double shipX, double shipY, double shipVelX, double shipVelY, float& velX, float& velY) {
     double dx = shipX - STATION_X;
     double dy = shipY - STATION_Y;
     double distance = std::sqrt(dx * dx + dy * dy);
@@ -153,43 +195,22 @@ void GameLogic::fireAtShip(
         double pDist = std::sqrt(pdx * pdx + pdy * pdy);
 
         if (pDist > 0) {
-            SimBullet bullet;
-            bullet.x = STATION_X;
-            bullet.y = STATION_Y;
-            bullet.velX = (pdx / pDist) * BULLET_SPEED;
-            bullet.velY = (pdy / pDist) * BULLET_SPEED;
-            bullets.push_back(bullet);
+            velX = static_cast<float>((pdx / pDist) * BULLET_SPEED);
+            velY = static_cast<float>((pdy / pDist) * BULLET_SPEED);
+            return true;
         }
     }
+    return false;
 }
 
-void GameLogic::updateBullets(std::vector<SimBullet>& bullets) {
-    for (auto& bullet : bullets) {
-        bullet.x += bullet.velX;
-        bullet.y += bullet.velY;
-
-        // Wrap around screen
-        if (bullet.x < 0) bullet.x += WINDOW_WIDTH;
-        else if (bullet.x > WINDOW_WIDTH) bullet.x -= WINDOW_WIDTH;
-        if (bullet.y < 0) bullet.y += WINDOW_HEIGHT;
-        else if (bullet.y > WINDOW_HEIGHT) bullet.y -= WINDOW_HEIGHT;
-    }
+int GameLogic::bulletCapacity(int maxFrames) {
+    // At most one shot per BULLET_FIRE_RATE + 1 frames, each alive for at most its lifetime
+    int frames = BULLET_LIFETIME > 0 ? std::min(maxFrames, BULLET_LIFETIME + 1) : maxFrames;
+    return std::max(0, frames) / (BULLET_FIRE_RATE + 1) + 1;
 }
 
-bool GameLogic::checkBulletCollision(
-    double shipX, double shipY,
-    const std::vector<SimBullet>& bullets
-) {
-    for (const auto& bullet : bullets) {
-        double dx = bullet.x - shipX;
-        double dy = bullet.y - shipY;
-        double distance = std::sqrt(dx * dx + dy * dy);
-
-        if (distance < BULLET_COLLISION_RADIUS) {
-            return true;
-        }
-    }
-    return false;
+BulletField::Scan GameLogic::updateBullets(double shipX, double shipY, BulletField& bullets) {
+    return bullets.scan(static_cast<float>(shipX), static_cast<float>(shipY));
 }
 
 bool GameLogic::checkWin(double shipX, double shipY) {
@@ -199,90 +220,386 @@ bool GameLogic::checkWin(double shipX, double shipY) {
     return distance < 50.0;
 }
 
-void GameLogic::applyAIDecision(
-    SpaceShip& ship,
-    NeuralNetwork* network,
-    double shipX, double shipY,
-    const std::vector<SimBullet>& bullets,
-    float& rotationOutput
+void GameLogic::buildInputs(
+    float shipX, float shipY,
+    float shipVelX, float shipVelY,
+    int rotationAngle,
+    const BulletField& bullets,
+    const BulletField::Scan& scan,
+    float state[INPUT_COUNT]
+) {
+    BulletSense sense = {bullets.size(), scan.nearest >= 0, 0.0f, 0.0f, 0.0f, 0.0f, scan.nearestDistanceSquared};
+    if (sense.found) {
+        sense.x = bullets.x(scan.nearest);
+        sense.y = bullets.y(scan.nearest);
+        sense.velX = bullets.velX(scan.nearest);
+        sense.velY = bullets.velY(scan.nearest);
+    }
+    buildInputs(shipX, shipY, shipVelX, shipVelY, rotationAngle, sense, state);
+}
+
+namespace {
+
+// Normalizers of the inputs; every SIMD pass divides by the same floats
+const float ENCODE_WIDTH = static_cast<float>(WINDOW_WIDTH);
+const float ENCODE_HEIGHT = static_cast<float>(WINDOW_HEIGHT);
+const float ENCODE_STATION_X = static_cast<float>(STATION_X);
+const float ENCODE_STATION_Y = static_cast<float>(STATION_Y);
+const float ENCODE_ANGLE = 3.14159f;
+const float HALF_PI = 1.57079637f;
+const float PI = 3.14159274f;
+
+// atan(a) = a + a * s * P(s), s = a * a, for a in [0, 1] (highest power first)
+const int ATAN_TERMS = 8;
+const float ATAN_COEFFICIENTS[ATAN_TERMS] = {
+    0.00282363896258175373077393f, -0.0159569028764963150024414f, 0.0425049886107444763183594f,
+    -0.0748900920152664184570312f, 0.106347933411598205566406f, -0.142027363181114196777344f,
+    0.199926957488059997558594f, -0.333331018686294555664062f};
+
+}
+
+float GameLogic::angleOf(float y, float x) {
+    // Reduce to a = min / max of |x| and |y| in [0, 1], then unfold the octant
+    float ax = std::abs(x);
+    float ay = std::abs(y);
+    bool steep = ay > ax;
+    float numerator = steep ? ax : ay;
+    float denominator = steep ? ay : ax;
+    float a = denominator > 0.0f ? numerator / denominator : 0.0f;
+
+    float s = a * a;
+    float p = ATAN_COEFFICIENTS[0];
+    for (int i = 1; i < ATAN_TERMS; ++i)
+        p = std::fma(p, s, ATAN_COEFFICIENTS[i]);
+    float angle = std::fma(s * p, a, a);
+
+    if (steep) angle = HALF_PI - angle;
+    if (x < 0.0f) angle = PI - angle;
+    return y < 0.0f ? -angle : angle;
+}
+
+void GameLogic::buildInputs(
+    float shipX, float shipY,
+    float shipVelX, float shipVelY,
+    int rotationAngle,
+    const BulletSense& bullets,
+    float state[INPUT_COUNT]
 ) {
     // Calculate station info
-    double stationDx = STATION_X - shipX;
-    double stationDy = STATION_Y - shipY;
-    float stationDistance = std::sqrt(stationDx * stationDx + stationDy * stationDy);
-    float stationAngle = std::atan2(stationDy, stationDx);
+    float stationDx = ENCODE_STATION_X - shipX;
+    float stationDy = ENCODE_STATION_Y - shipY;
+    float stationDistance = std::sqrt(std::fma(stationDy, stationDy, stationDx * stationDx));
+    float stationAngle = angleOf(stationDy, stationDx);
 
-    // Find closest bullet
-    float closestBulletDistance = 1000.0f;
+    // Closest bullet, found by the scan: one sqrt and one angle for it alone
+    float closestBulletDistance = BulletField::NEAREST_RANGE;
     float closestBulletAngle = 0.0f;
     float closestBulletVelX = 0.0f;
     float closestBulletVelY = 0.0f;
 
-    for (const auto& bullet : bullets) {
-        double bdx = bullet.x - shipX;
-        double bdy = bullet.y - shipY;
-        float bDist = std::sqrt(bdx * bdx + bdy * bdy);
+    if (bullets.found) {
+        closestBulletDistance = std::sqrt(bullets.distanceSquared);
+        closestBulletAngle = angleOf(bullets.y - shipY, bullets.x - shipX);
+        closestBulletVelX = bullets.velX;
+        closestBulletVelY = bullets.velY;
+    }
 
-        if (bDist < closestBulletDistance) {
-            closestBulletDistance = bDist;
-            closestBulletAngle = std::atan2(bdy, bdx);
-            closestBulletVelX = bullet.velX;
-            closestBulletVelY = bullet.velY;
-        }
+    state[0] = shipX / ENCODE_WIDTH;
+    state[1] = shipY / ENCODE_HEIGHT;
+    state[2] = shipVelX / 10.0f;
+    state[3] = shipVelY / 10.0f;
+    state[4] = static_cast<float>(rotationAngle) / 360.0f;
+    state[5] = stationDistance / 500.0f;
+    state[6] = stationAngle / ENCODE_ANGLE;
+    state[7] = closestBulletDistance / 500.0f;
+    state[8] = closestBulletAngle / ENCODE_ANGLE;
+    state[9] = closestBulletVelX / 10.0f;
+    state[10] = closestBulletVelY / 10.0f;
+    state[11] = static_cast<float>(bullets.count) / 10.0f;
+}
+
+void GameLogic::InputArrays::resize(int count) {
+    for (std::vector<float>* values : {&shipX, &shipY, &velX, &velY, &bulletX, &bulletY, &bulletVelX, &bulletVelY,
+                                       &bulletDistanceSquared})
+        values->resize(count);
+    rotation.resize(count);
+    bulletCount.resize(count);
+    found.resize(count);
+}
+
+namespace {
+
+// Row i of states from entry i of the arrays, through the scalar encoder
+void buildInputsScalar(const GameLogic::InputArrays& inputs, int first, int count, float* states) {
+    for (int i = first; i < count; ++i) {
+        GameLogic::BulletSense sense = {inputs.bulletCount[i], inputs.found[i] != 0, inputs.bulletX[i],
+                                        inputs.bulletY[i], inputs.bulletVelX[i], inputs.bulletVelY[i],
+                                        inputs.bulletDistanceSquared[i]};
+        GameLogic::buildInputs(inputs.shipX[i], inputs.shipY[i], inputs.velX[i], inputs.velY[i], inputs.rotation[i],
+                               sense, states + static_cast<size_t>(i) * GameLogic::INPUT_COUNT);
+    }
+}
+
+#ifdef MATRIX_KERNELS_X86
+
+// Both passes run buildInputs' operations in its order: the same divisions by
+// the same normalizers, a correctly rounded sqrt of the same fused sum, and
+// angleOf's reduction, polynomial and octant unfolding step for step. Each
+// pass encodes whole blocks of rows into a column tile, copies the tile out
+// row by row, and leaves the last few rows to the scalar encoder.
+
+TARGET_AVX512 inline __m512 angleOfAvx512(__m512 y, __m512 x) {
+    const __m512i signBit = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+    __m512 ax = _mm512_abs_ps(x);
+    __m512 ay = _mm512_abs_ps(y);
+    __mmask16 steep = _mm512_cmp_ps_mask(ay, ax, _CMP_GT_OQ);
+    __m512 numerator = _mm512_mask_blend_ps(steep, ay, ax);
+    __m512 denominator = _mm512_mask_blend_ps(steep, ax, ay);
+    __mmask16 positive = _mm512_cmp_ps_mask(denominator, _mm512_setzero_ps(), _CMP_GT_OQ);
+    __m512 a = _mm512_maskz_div_ps(positive, numerator, denominator);
+
+    __m512 s = _mm512_mul_ps(a, a);
+    __m512 p = _mm512_set1_ps(ATAN_COEFFICIENTS[0]);
+    for (int i = 1; i < ATAN_TERMS; ++i)
+        p = _mm512_fmadd_ps(p, s, _mm512_set1_ps(ATAN_COEFFICIENTS[i]));
+    __m512 angle = _mm512_fmadd_ps(_mm512_mul_ps(s, p), a, a);
+
+    angle = _mm512_mask_sub_ps(angle, steep, _mm512_set1_ps(HALF_PI), angle);
+    angle = _mm512_mask_sub_ps(angle, _mm512_cmp_ps_mask(x, _mm512_setzero_ps(), _CMP_LT_OQ), _mm512_set1_ps(PI),
+                               angle);
+    __mmask16 below = _mm512_cmp_ps_mask(y, _mm512_setzero_ps(), _CMP_LT_OQ);
+    return _mm512_castsi512_ps(_mm512_mask_xor_epi32(_mm512_castps_si512(angle), below, _mm512_castps_si512(angle),
+                                                     signBit));
+}
+
+TARGET_AVX512 int buildInputsAvx512(const GameLogic::InputArrays& inputs, int count, float* states) {
+    const __mmask16 ALL = 0xFFFF;
+    alignas(64) float columns[GameLogic::INPUT_COUNT][16];
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m512 shipX = _mm512_loadu_ps(inputs.shipX.data() + i);
+        __m512 shipY = _mm512_loadu_ps(inputs.shipY.data() + i);
+        __m512 velX = _mm512_loadu_ps(inputs.velX.data() + i);
+        __m512 velY = _mm512_loadu_ps(inputs.velY.data() + i);
+        __m512i rotation = _mm512_loadu_si512(inputs.rotation.data() + i);
+        __m512i bulletCount = _mm512_loadu_si512(inputs.bulletCount.data() + i);
+        __mmask16 found = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512(inputs.found.data() + i),
+                                                   _mm512_setzero_si512());
+
+        __m512 stationDx = _mm512_sub_ps(_mm512_set1_ps(ENCODE_STATION_X), shipX);
+        __m512 stationDy = _mm512_sub_ps(_mm512_set1_ps(ENCODE_STATION_Y), shipY);
+        __m512 stationDistance = _mm512_maskz_sqrt_ps(
+            ALL, _mm512_fmadd_ps(stationDy, stationDy, _mm512_mul_ps(stationDx, stationDx)));
+        __m512 stationAngle = angleOfAvx512(stationDy, stationDx);
+
+        __m512 bulletDistance = _mm512_mask_blend_ps(
+            found, _mm512_set1_ps(BulletField::NEAREST_RANGE),
+            _mm512_maskz_sqrt_ps(ALL, _mm512_loadu_ps(inputs.bulletDistanceSquared.data() + i)));
+        __m512 bulletAngle = _mm512_maskz_mov_ps(
+            found, angleOfAvx512(_mm512_sub_ps(_mm512_loadu_ps(inputs.bulletY.data() + i), shipY),
+                                 _mm512_sub_ps(_mm512_loadu_ps(inputs.bulletX.data() + i), shipX)));
+        __m512 bulletVelX = _mm512_maskz_loadu_ps(found, inputs.bulletVelX.data() + i);
+        __m512 bulletVelY = _mm512_maskz_loadu_ps(found, inputs.bulletVelY.data() + i);
+
+        const __m512 ten = _mm512_set1_ps(10.0f);
+        const __m512 fiveHundred = _mm512_set1_ps(500.0f);
+        const __m512 angleScale = _mm512_set1_ps(ENCODE_ANGLE);
+        _mm512_store_ps(columns[0], _mm512_div_ps(shipX, _mm512_set1_ps(ENCODE_WIDTH)));
+        _mm512_store_ps(columns[1], _mm512_div_ps(shipY, _mm512_set1_ps(ENCODE_HEIGHT)));
+        _mm512_store_ps(columns[2], _mm512_div_ps(velX, ten));
+        _mm512_store_ps(columns[3], _mm512_div_ps(velY, ten));
+        _mm512_store_ps(columns[4], _mm512_div_ps(_mm512_maskz_cvtepi32_ps(ALL, rotation), _mm512_set1_ps(360.0f)));
+        _mm512_store_ps(columns[5], _mm512_div_ps(stationDistance, fiveHundred));
+        _mm512_store_ps(columns[6], _mm512_div_ps(stationAngle, angleScale));
+        _mm512_store_ps(columns[7], _mm512_div_ps(bulletDistance, fiveHundred));
+        _mm512_store_ps(columns[8], _mm512_div_ps(bulletAngle, angleScale));
+        _mm512_store_ps(columns[9], _mm512_div_ps(bulletVelX, ten));
+        _mm512_store_ps(columns[10], _mm512_div_ps(bulletVelY, ten));
+        _mm512_store_ps(columns[11], _mm512_div_ps(_mm512_maskz_cvtepi32_ps(ALL, bulletCount), ten));
+
+        float* rows = states + static_cast<size_t>(i) * GameLogic::INPUT_COUNT;
+        for (int r = 0; r < 16; ++r)
+            for (int f = 0; f < GameLogic::INPUT_COUNT; ++f)
+                rows[r * GameLogic::INPUT_COUNT + f] = columns[f][r];
     }
+    return i;
+}
 
-    // Build input
-    Vector2D vel = ship.getVelocity();
-    Matrix gameState(1, 12);
-    gameState.data[0] = {
-        static_cast<float>(shipX / WINDOW_WIDTH),
-        static_cast<float>(shipY / WINDOW_HEIGHT),
-        static_cast<float>(vel.getX() / 10.0f),
-        static_cast<float>(vel.getY() / 10.0f),
-        static_cast<float>(ship.getRotationAngle() / 360.0f),
-        static_cast<float>(stationDistance / 500.0f),
-        static_cast<float>(stationAngle / 3.14159f),
-        static_cast<float>(closestBulletDistance / 500.0f),
-        static_cast<float>(closestBulletAngle / 3.14159f),
-        closestBulletVelX / 10.0f,
-        closestBulletVelY / 10.0f,
-        static_cast<float>(bullets.size() / 10.0f)
-    };
+TARGET_AVX2 inline __m256 angleOfAvx2(__m256 y, __m256 x) {
+    const __m256 signBit = _mm256_castsi256_ps(_mm256_set1_epi32(static_cast<int>(0x80000000u)));
+    const __m256 zero = _mm256_setzero_ps();
+    __m256 ax = _mm256_andnot_ps(signBit, x);
+    __m256 ay = _mm256_andnot_ps(signBit, y);
+    __m256 steep = _mm256_cmp_ps(ay, ax, _CMP_GT_OQ);
+    __m256 numerator = _mm256_blendv_ps(ay, ax, steep);
+    __m256 denominator = _mm256_blendv_ps(ax, ay, steep);
+    __m256 positive = _mm256_cmp_ps(denominator, zero, _CMP_GT_OQ);
+    __m256 a = _mm256_and_ps(_mm256_div_ps(numerator, denominator), positive);
+
+    __m256 s = _mm256_mul_ps(a, a);
+    __m256 p = _mm256_set1_ps(ATAN_COEFFICIENTS[0]);
+    for (int i = 1; i < ATAN_TERMS; ++i)
+        p = _mm256_fmadd_ps(p, s, _mm256_set1_ps(ATAN_COEFFICIENTS[i]));
+    __m256 angle = _mm256_fmadd_ps(_mm256_mul_ps(s, p), a, a);
+
+    angle = _mm256_blendv_ps(angle, _mm256_sub_ps(_mm256_set1_ps(HALF_PI), angle), steep);
+    angle = _mm256_blendv_ps(angle, _mm256_sub_ps(_mm256_set1_ps(PI), angle), _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+    return _mm256_xor_ps(angle, _mm256_and_ps(_mm256_cmp_ps(y, zero, _CMP_LT_OQ), signBit));
+}
 
-    // Get prediction
-    Matrix decision = network->predict(gameState);
+TARGET_AVX2 int buildInputsAvx2(const GameLogic::InputArrays& inputs, int count, float* states) {
+    alignas(32) float columns[GameLogic::INPUT_COUNT][8];
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 shipX = _mm256_loadu_ps(inputs.shipX.data() + i);
+        __m256 shipY = _mm256_loadu_ps(inputs.shipY.data() + i);
+        __m256 velX = _mm256_loadu_ps(inputs.velX.data() + i);
+        __m256 velY = _mm256_loadu_ps(inputs.velY.data() + i);
+        __m256i rotation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputs.rotation.data() + i));
+        __m256i bulletCount = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputs.bulletCount.data() + i));
+        __m256 found = _mm256_castsi256_ps(_mm256_xor_si256(
+            _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(inputs.found.data() + i)),
+                               _mm256_setzero_si256()),
+            _mm256_set1_epi32(-1)));
+
+        __m256 stationDx = _mm256_sub_ps(_mm256_set1_ps(ENCODE_STATION_X), shipX);
+        __m256 stationDy = _mm256_sub_ps(_mm256_set1_ps(ENCODE_STATION_Y), shipY);
+        __m256 stationDistance = _mm256_sqrt_ps(_mm256_fmadd_ps(stationDy, stationDy,
+                                                                _mm256_mul_ps(stationDx, stationDx)));
+        __m256 stationAngle = angleOfAvx2(stationDy, stationDx);
+
+        __m256 bulletDistance = _mm256_blendv_ps(
+            _mm256_set1_ps(BulletField::NEAREST_RANGE),
+            _mm256_sqrt_ps(_mm256_loadu_ps(inputs.bulletDistanceSquared.data() + i)), found);
+        __m256 bulletAngle = _mm256_and_ps(
+            found, angleOfAvx2(_mm256_sub_ps(_mm256_loadu_ps(inputs.bulletY.data() + i), shipY),
+                               _mm256_sub_ps(_mm256_loadu_ps(inputs.bulletX.data() + i), shipX)));
+        __m256 bulletVelX = _mm256_and_ps(found, _mm256_loadu_ps(inputs.bulletVelX.data() + i));
+        __m256 bulletVelY = _mm256_and_ps(found, _mm256_loadu_ps(inputs.bulletVelY.data() + i));
+
+        const __m256 ten = _mm256_set1_ps(10.0f);
+        const __m256 fiveHundred = _mm256_set1_ps(500.0f);
+        const __m256 angleScale = _mm256_set1_ps(ENCODE_ANGLE);
+        _mm256_store_ps(columns[0], _mm256_div_ps(shipX, _mm256_set1_ps(ENCODE_WIDTH)));
+        _mm256_store_ps(columns[1], _mm256_div_ps(shipY, _mm256_set1_ps(ENCODE_HEIGHT)));
+        _mm256_store_ps(columns[2], _mm256_div_ps(velX, ten));
+        _mm256_store_ps(columns[3], _mm256_div_ps(velY, ten));
+        _mm256_store_ps(columns[4], _mm256_div_ps(_mm256_cvtepi32_ps(rotation), _mm256_set1_ps(360.0f)));
+        _mm256_store_ps(columns[5], _mm256_div_ps(stationDistance, fiveHundred));
+        _mm256_store_ps(columns[6], _mm256_div_ps(stationAngle, angleScale));
+        _mm256_store_ps(columns[7], _mm256_div_ps(bulletDistance, fiveHundred));
+        _mm256_store_ps(columns[8], _mm256_div_ps(bulletAngle, angleScale));
+        _mm256_store_ps(columns[9], _mm256_div_ps(bulletVelX, ten));
+        _mm256_store_ps(columns[10], _mm256_div_ps(bulletVelY, ten));
+        _mm256_store_ps(columns[11], _mm256_div_ps(_mm256_cvtepi32_ps(bulletCount), ten));
+
+        float* rows = states + static_cast<size_t>(i) * GameLogic::INPUT_COUNT;
+        for (int r = 0; r < 8; ++r)
+            for (int f = 0; f < GameLogic::INPUT_COUNT; ++f)
+                rows[r * GameLogic::INPUT_COUNT + f] = columns[f][r];
+    }
+    return i;
+}
+
+#endif
 
+}
+
+void GameLogic::buildInputs(const InputArrays& inputs, int count, float* states) {
+    int done = 0;
+    switch (MatrixKernels::activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+        case MatrixKernels::Isa::AVX512:
+            done = buildInputsAvx512(inputs, count, states);
+            break;
+        case MatrixKernels::Isa::AVX2:
+            done = buildInputsAvx2(inputs, count, states);
+            break;
+#endif
+        default:
+            break;
+    }
+    buildInputsScalar(inputs, done, count, states);
+}
+
+GameLogic::Controls GameLogic::decodeOutputs(const float decision[OUTPUT_COUNT]) {
     // Extract outputs - tanh gives -1 to +1 directly
-    float thrustVal = (decision.data[0][0] + 1.0f) / 2.0f;
-    thrustVal = std::max(0.0f, std::min(1.0f, thrustVal));
+    Controls controls;
+    controls.thrust = (decision[0] + 1.0f) / 2.0f;
+    controls.thrust = std::max(0.0f, std::min(1.0f, controls.thrust));
 
-    float strafeVal = std::max(-1.0f, std::min(1.0f, decision.data[0][1]));
-    float rotationVal = std::max(-1.0f, std::min(1.0f, decision.data[0][2]));
+    controls.strafe = std::max(-1.0f, std::min(1.0f, decision[1]));
+    controls.rotation = std::max(-1.0f, std::min(1.0f, decision[2]));
 
-    float brakeVal = (decision.data[0][3] + 1.0f) / 2.0f;
-    brakeVal = std::max(0.0f, std::min(1.0f, brakeVal));
+    controls.brake = (decision[3] + 1.0f) / 2.0f;
+    controls.brake = std::max(0.0f, std::min(1.0f, controls.brake));
+    return controls;
+}
 
-    rotationOutput = rotationVal;
+ShipPhysics::Settings GameLogic::shipSettings() {
+    return {DRAG_FACTOR, MAX_SPEED, static_cast<float>(WINDOW_WIDTH), static_cast<float>(WINDOW_HEIGHT)};
+}
 
-    // Apply to ship
-    if (thrustVal > 0.1f) {
-        ship.thrust(thrustVal * THRUST_POWER);
+ShipPhysics::Command GameLogic::shipCommand(const Controls& controls) {
+    ShipPhysics::Command command = {0.0f, 0.0f, 0.0, 1.0f};
+    if (controls.thrust > 0.1f) {
+        command.thrust = controls.thrust * THRUST_POWER;
     }
 
-    if (std::abs(strafeVal) > 0.1f) {
-        ship.strafe(strafeVal > 0 ? 1 : -1, std::abs(strafeVal) * STRAFE_POWER);
+    if (std::abs(controls.strafe) > 0.1f) {
+        float power = std::abs(controls.strafe) * STRAFE_POWER;
+        command.strafe = controls.strafe > 0 ? power : -power;
     }
 
     // Dead zone: -0.3 to 0.3 = go straight, outside that range = turn
-    if (std::abs(rotationVal) > 0.3f) {
-        ship.setRotationAngle(ship.getRotationAngle() + rotationVal * 6.0);
+    if (std::abs(controls.rotation) > 0.3f) {
+        command.turn = controls.rotation * 6.0;
     }
 
-    // Apply constant drag (ship slows down when not thrusting)
-    ship.applyDrag(DRAG_FACTOR);
-
-    // Additional braking on top of drag
-    if (brakeVal > 0.1f) {
-        ship.applyDrag(1.0f - brakeVal * 0.1f);
+    // Additional braking on top of the constant drag
+    if (controls.brake > 0.1f) {
+        command.brake = 1.0f - controls.brake * 0.1f;
     }
+    return command;
 }
+
+template <typename Network>
+void GameLogic::applyAIDecision(
+    ShipBody<float>& ship,
+    Network* network,
+    const ShipPhysics::Settings& settings,
+    const BulletField& bullets,
+    const BulletField::Scan& scan,
+    float& rotationOutput
+) {
+    // Build input
+    float gameState[INPUT_COUNT];
+    buildInputs(ship.position.x, ship.position.y, ship.velocity.x, ship.velocity.y, ship.rotation, bullets, scan,
+                gameState);
+
+    // Get prediction
+    float decision[OUTPUT_COUNT];
+    network->predictInto(gameState, decision);
+    Controls controls = decodeOutputs(decision);
+
+    rotationOutput = controls.rotation;
+    ShipPhysics::step(ship, shipCommand(controls), settings);
+}
+
+#define INSTANTIATE_GAME_LOGIC(NETWORK)                                                              \
+    template SimulationResult GameLogic::runSimulation<NETWORK>(NETWORK*, int);                      \
+    template SimulationResult GameLogic::runSimulation<NETWORK>(NETWORK*, int, uint64_t, uint64_t);  \
+    template void GameLogic::runSimulations<NETWORK>(                                                \
+        NETWORK*, int, uint64_t, uint64_t, int, std::vector<SimulationResult>&);                     \
+    template void GameLogic::applyAIDecision<NETWORK>(                                               \
+        ShipBody<float>&, NETWORK*, const ShipPhysics::Settings&, const BulletField&,                \
+        const BulletField::Scan&, float&);
+
+INSTANTIATE_GAME_LOGIC(NeuralNetwork)
+INSTANTIATE_GAME_LOGIC(ProductionNetwork)
+INSTANTIATE_GAME_LOGIC(QuantizedNetwork)
+INSTANTIATE_GAME_LOGIC(NeuroEvolution::Member)
+
+#undef INSTANTIATE_GAME_LOGIC
@@ -155,7 +155,7 @@ Gdiplus::Image* GameWindow::getShipImage(ShipState state)
 }
 
 void GameWindow::render(double shipX, double shipY, float shipRotation, const SpaceStation& station,
-                        const std::vector<Bullet>& bullets, int frameCount, const std::string& status,
+                        const BulletField& bullets, int frameCount, const std::string& status,
                         ShipState shipState)
 {
     if (!hwnd || !backBufferDC) return;
@@ -212,9 +212,8 @@ void GameWindow::render(double shipX, double shipY, float shipRotation, const Sp
     // Draw bullets (size matches collision radius of 35)
     Gdiplus::SolidBrush bulletBrush(Gdiplus::Color(255, 100, 100));
     const int BULLET_RADIUS = 17;  // Half of collision radius 35
-    for (const auto& bullet : bullets) {
-        Vector2D bPos = bullet.getPosition();
-        graphics.FillEllipse(&bulletBrush, (INT)(bPos.getX() - BULLET_RADIUS), (INT)(bPos.getY() - BULLET_RADIUS), BULLET_RADIUS * 2, BULLET_RADIUS * 2);
+    for (int i = 0; i < bullets.size(); ++i) {
+        graphics.FillEllipse(&bulletBrush, (INT)(bullets.x(i) - BULLET_RADIUS), (INT)(bullets.y(i) - BULLET_RADIUS), BULLET_RADIUS * 2, BULLET_RADIUS * 2);
     }
 
     // Draw UI text
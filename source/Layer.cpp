@@ -1,23 +1,48 @@
 #include "Layer.h"
-#include <cmath>
 
-static float sigmoid(float x) {
-    return 1.0f / (1.0f + std::exp(-x));
+Layer::Layer(int input_size, int output_size, Activations::Type activation)
+    : weights(input_size, output_size), biases(1, output_size), outputs(1, output_size), activation(activation) {
+    weights.randomize(-0.5f, 0.5f);
+    biases.randomize(-0.5f, 0.5f);
+    packWeights();
 }
 
-static float tanhActivation(float x) {
-    return std::tanh(x);
+void Layer::packWeights() {
+    if (weights.size() >= PACK_MIN_WEIGHTS) {
+        MatrixKernels::pack(weights.data(), weights.cols, weights.rows, weights.cols, packedWeights);
+    } else {
+        packedWeights = MatrixKernels::PackedPanels();
+    }
 }
 
-Layer::Layer(int input_size, int output_size, bool useTanh)
-    : weights(input_size, output_size), biases(1, output_size), outputs(1, output_size), useTanh(useTanh) {
-    weights.randomize(-0.5f, 0.5f);
-    biases.randomize(-0.5f, 0.5f);
+Matrix Layer::forward(const Matrix& input) const {
+    Matrix z;
+    forward(input, z);
+    return z;
 }
 
-Matrix Layer::forward(const Matrix& input) const {
-    if (useTanh) {
-        return input.dot(weights).add(biases).apply(tanhActivation);
+void Layer::forward(const Matrix& input, Matrix& z) const {
+    z.resize(input.rows, weights.cols);
+    forwardRows(input.data(), input.rows, z.data());
+}
+
+void Layer::forwardRows(const float* input, int rows, float* output) const {
+    int inputs = weights.rows;
+    int outputs = weights.cols;
+    if (rows == 1) {
+        MatrixKernels::gemv(input, weights.data(), outputs, output, inputs, outputs);
+    } else if (!packedWeights.empty()) {
+        // Batch through a wide layer: blocked (and for big batches multithreaded) GEMM on the pre-packed panels
+        MatrixKernels::gemmPacked(input, inputs, packedWeights, output, outputs, rows);
+    } else {
+        MatrixKernels::gemm(input, inputs, weights.data(), outputs, output, outputs, rows, inputs, outputs);
     }
-    return input.dot(weights).add(biases).apply(sigmoid);
+
+    // Bias add and activation for the whole block of rows
+    Activations::forwardRows(activation, output, biases.data(), rows, outputs);
+}
+
+void Layer::forwardInto(const float* input, float* output) const {
+    MatrixKernels::gemv(input, weights.data(), weights.cols, output, weights.rows, weights.cols);
+    Activations::forward(activation, output, biases.data(), weights.cols);
 }
@@ -0,0 +1,204 @@
+#include "MappedNetwork.h"
+#include "Activations.h"
+#include "Layer.h"
+#include "MatrixKernels.h"
+#include "NeuralNetwork.h"
+#include <algorithm>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Per-thread ping-pong buffers; they only grow, so steady state never allocates
+struct MappedScratch {
+    std::vector<float> front;
+    std::vector<float> back;
+};
+
+MappedScratch& threadScratch() {
+    thread_local MappedScratch scratch;
+    return scratch;
+}
+
+}
+
+MappedNetwork::~MappedNetwork() {
+    close();
+}
+
+bool MappedNetwork::open(const std::string& filename, bool verifyChecksum, bool verbose) {
+    close();
+
+    const unsigned char* mapped = nullptr;
+    size_t bytes = 0;
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER size;
+    if (file == INVALID_HANDLE_VALUE || !GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+        if (file != INVALID_HANDLE_VALUE) {
+            CloseHandle(file);
+        }
+        if (verbose) {
+            std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+        }
+        return false;
+    }
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) {
+            CloseHandle(mapping);
+        }
+        CloseHandle(file);
+        if (verbose) {
+            std::cerr << "Error: Could not map file: " << filename << std::endl;
+        }
+        return false;
+    }
+    fileHandle = file;
+    mappingHandle = mapping;
+    mapped = static_cast<const unsigned char*>(view);
+    bytes = static_cast<size_t>(size.QuadPart);
+#else
+    int descriptor = ::open(filename.c_str(), O_RDONLY);
+    struct stat status;
+    if (descriptor < 0 || fstat(descriptor, &status) != 0 || status.st_size <= 0) {
+        if (descriptor >= 0) {
+            ::close(descriptor);
+        }
+        if (verbose) {
+            std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+        }
+        return false;
+    }
+    bytes = static_cast<size_t>(status.st_size);
+    void* view = mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, descriptor, 0);
+    ::close(descriptor);  // the mapping keeps the file alive
+    if (view == MAP_FAILED) {
+        if (verbose) {
+            std::cerr << "Error: Could not map file: " << filename << std::endl;
+        }
+        return false;
+    }
+    mapped = static_cast<const unsigned char*>(view);
+#endif
+
+    image = mapped;
+    imageBytes = bytes;
+    std::string error;
+    if (!ModelFormat::parse(image, imageBytes, verifyChecksum, layers, error)) {
+        if (verbose) {
+            std::cerr << "Error: " << filename << ": " << error << std::endl;
+        }
+        close();
+        return false;
+    }
+    packedWeights.resize(layers.size());
+    for (size_t l = 0; l < layers.size(); ++l) {
+        const ModelFormat::LayerBlock& layer = layers[l];
+        if (layer.inputs * layer.outputs >= Layer::PACK_MIN_WEIGHTS) {
+            MatrixKernels::pack(layer.weights, layer.outputs, layer.inputs, layer.outputs, packedWeights[l]);
+        }
+    }
+    if (verbose) {
+        std::cout << "Model mapped from: " << filename << std::endl;
+    }
+    return true;
+}
+
+void MappedNetwork::close() {
+    layers.clear();
+    packedWeights.clear();
+    if (!image) {
+        return;
+    }
+#ifdef _WIN32
+    UnmapViewOfFile(image);
+    CloseHandle(static_cast<HANDLE>(mappingHandle));
+    CloseHandle(static_cast<HANDLE>(fileHandle));
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    munmap(const_cast<unsigned char*>(image), imageBytes);
+#endif
+    image = nullptr;
+    imageBytes = 0;
+}
+
+void MappedNetwork::predictInto(const float* input, float* output) const {
+    MappedScratch& scratch = threadScratch();
+    size_t widest = 0;
+    for (const auto& layer : layers)
+        widest = std::max(widest, static_cast<size_t>(layer.outputs));
+    if (scratch.front.size() < widest) {
+        scratch.front.resize(widest);
+        scratch.back.resize(widest);
+    }
+
+    // Same ping-pong scheme and kernels as NeuralNetwork::predictInto
+    const float* current = input;
+    float* buffers[2] = {scratch.front.data(), scratch.back.data()};
+    for (size_t l = 0; l < layers.size(); ++l) {
+        const ModelFormat::LayerBlock& layer = layers[l];
+        float* next = (l + 1 == layers.size()) ? output : buffers[l % 2];
+        MatrixKernels::gemv(current, layer.weights, layer.outputs, next, layer.inputs, layer.outputs);
+        Activations::forward(layer.activation, next, layer.biases, layer.outputs);
+        current = next;
+    }
+}
+
+void MappedNetwork::predictBatch(const float* states, size_t n, float* actions) const {
+    if (n == 1) {
+        predictInto(states, actions);
+        return;
+    }
+
+    MappedScratch& scratch = threadScratch();
+    size_t chunkRows = std::min(n, static_cast<size_t>(NeuralNetwork::BATCH_CHUNK_ROWS));
+    size_t widest = 0;
+    for (const auto& layer : layers)
+        widest = std::max(widest, static_cast<size_t>(layer.outputs));
+    if (scratch.front.size() < chunkRows * widest) {
+        scratch.front.resize(chunkRows * widest);
+        scratch.back.resize(chunkRows * widest);
+    }
+
+    // Wide layers go through the panels packed at open, like Layer::forwardRows;
+    // gemm and gemmPacked agree bit for bit, so either way matches NeuralNetwork
+    float* buffers[2] = {scratch.front.data(), scratch.back.data()};
+    for (size_t first = 0; first < n; first += chunkRows) {
+        int rows = static_cast<int>(std::min(chunkRows, n - first));
+        const float* current = states + first * inputSize();
+        for (size_t l = 0; l < layers.size(); ++l) {
+            const ModelFormat::LayerBlock& layer = layers[l];
+            float* next = (l + 1 == layers.size()) ? actions + first * outputSize() : buffers[l % 2];
+            if (rows == 1) {
+                MatrixKernels::gemv(current, layer.weights, layer.outputs, next, layer.inputs, layer.outputs);
+            } else if (!packedWeights[l].empty()) {
+                MatrixKernels::gemmPacked(current, layer.inputs, packedWeights[l], next, layer.outputs, rows);
+            } else {
+                MatrixKernels::gemm(current, layer.inputs, layer.weights, layer.outputs, next, layer.outputs, rows,
+                                    layer.inputs, layer.outputs);
+            }
+            Activations::forwardRows(layer.activation, next, layer.biases, rows, layer.outputs);
+            current = next;
+        }
+    }
+}
+
+Matrix MappedNetwork::predict(const Matrix& input) const {
+    Matrix result(input.rows, outputSize());
+    predictBatch(input.data(), input.rows, result.data());
+    return result;
+}
@@ -1,44 +1,190 @@
 #include "Matrix.h"
+#include "MatrixKernels.h"
+#include <algorithm>
 #include <iostream>
+#include <new>
 #include <random>
 
+// Point storage at a buffer that holds at least count floats
+void Matrix::allocate(size_t count) {
+    if (count <= static_cast<size_t>(SMALL_CAPACITY)) {
+        storage = smallBuffer;
+        capacity = SMALL_CAPACITY;
+    } else {
+        storage = static_cast<float*>(::operator new(count * sizeof(float), std::align_val_t(ALIGNMENT)));
+        capacity = count;
+    }
+}
+
+// Free the heap block (if any) and fall back to the inline buffer
+void Matrix::release() {
+    if (storage != smallBuffer) {
+        ::operator delete(storage, std::align_val_t(ALIGNMENT));
+    }
+    storage = smallBuffer;
+    capacity = SMALL_CAPACITY;
+}
+
+Matrix::Matrix() : rows(0), cols(0), storage(smallBuffer), capacity(SMALL_CAPACITY) {}
+
 // Constructor: creates a matrix with given rows and columns, filled with 0.0
-Matrix::Matrix(int r, int c) : rows(r), cols(c), data(r, std::vector<float>(c, 0.0f)) {}
+Matrix::Matrix(int r, int c) : rows(r), cols(c) {
+    allocate(static_cast<size_t>(r) * c);
+    std::fill(storage, storage + size(), 0.0f);
+}
+
+// Constructor: creates a matrix from row-major values (missing values are 0.0)
+Matrix::Matrix(int r, int c, std::initializer_list<float> values) : Matrix(r, c) {
+    std::copy_n(values.begin(), std::min<size_t>(values.size(), size()), storage);
+}
+
+Matrix::Matrix(const Matrix& other) : rows(other.rows), cols(other.cols) {
+    allocate(other.size());
+    std::copy_n(other.storage, size(), storage);
+}
+
+Matrix::Matrix(Matrix&& other) noexcept : rows(other.rows), cols(other.cols) {
+    if (other.storage == other.smallBuffer) {
+        storage = smallBuffer;
+        capacity = SMALL_CAPACITY;
+        std::copy_n(other.smallBuffer, size(), smallBuffer);
+    } else {
+        // Steal the heap block
+        storage = other.storage;
+        capacity = other.capacity;
+        other.storage = other.smallBuffer;
+        other.capacity = SMALL_CAPACITY;
+    }
+    other.rows = 0;
+    other.cols = 0;
+}
+
+Matrix& Matrix::operator=(const Matrix& other) {
+    if (this != &other) {
+        if (capacity < static_cast<size_t>(other.size())) {
+            release();
+            allocate(other.size());
+        }
+        rows = other.rows;
+        cols = other.cols;
+        std::copy_n(other.storage, size(), storage);
+    }
+    return *this;
+}
+
+Matrix& Matrix::operator=(Matrix&& other) noexcept {
+    if (this != &other) {
+        if (other.storage == other.smallBuffer) {
+            // Small matrices are cheaper to copy than to swap buffers
+            rows = other.rows;
+            cols = other.cols;
+            std::copy_n(other.smallBuffer, size(), storage);
+        } else {
+            release();
+            rows = other.rows;
+            cols = other.cols;
+            storage = other.storage;
+            capacity = other.capacity;
+            other.storage = other.smallBuffer;
+            other.capacity = SMALL_CAPACITY;
+        }
+        other.rows = 0;
+        other.cols = 0;
+    }
+    return *this;
+}
+
+Matrix::~Matrix() {
+    release();
+}
+
+// Change shape without reallocating unless the new shape needs more room
+void Matrix::resize(int r, int c) {
+    size_t count = static_cast<size_t>(r) * c;
+    if (capacity < count) {
+        release();
+        allocate(count);
+    }
+    rows = r;
+    cols = c;
+    std::fill(storage, storage + count, 0.0f);
+}
+
+// Set every element to value
+void Matrix::fill(float value) {
+    std::fill(storage, storage + size(), value);
+}
+
+// Overwrite row i with the given values
+void Matrix::setRow(int i, std::initializer_list<float> values) {
+    std::copy_n(values.begin(), std::min<size_t>(values.size(), cols), row(i).begin());
+}
 
 // Fill the matrix with random values between min and max
 void Matrix::randomize(float min, float max) {
     std::mt19937 rng(42); // fixed seed for reproducibility
     std::uniform_real_distribution<float> dist(min, max);
-    for (auto& row : data)
-        for (auto& val : row)
-            val = dist(rng); // assign random value to each cell
+    for (int i = 0; i < size(); ++i)
+        storage[i] = dist(rng); // assign random value to each cell
 }
 
 // Matrix multiplication: this * other
 Matrix Matrix::dot(const Matrix& other) const {
-    Matrix result(rows, other.cols); // result size: rows of this × cols of other
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < other.cols; ++j)
-            for (int k = 0; k < cols; ++k)
-                result.data[i][j] += data[i][k] * other.data[k][j]; // sum of products
+    Matrix result; // sized rows of this × cols of other by dotInto
+    dotInto(other, result);
+    return result;
+}
+
+void Matrix::dotInto(const Matrix& other, Matrix& result) const {
+    result.resize(rows, other.cols);
+    if (rows == 1) {
+        // Single state (inference): vector-matrix product
+        MatrixKernels::gemv(storage, other.storage, other.cols, result.storage, cols, other.cols);
+    } else {
+        MatrixKernels::gemm(storage, cols, other.storage, other.cols, result.storage, result.cols,
+                            rows, cols, other.cols);
+    }
+}
+
+// Transposed multiplication: this^T * other (both share the same row count)
+Matrix Matrix::dotTransA(const Matrix& other) const {
+    Matrix result(cols, other.cols);
+    MatrixKernels::gemmTransA(storage, cols, other.storage, other.cols, result.storage, result.cols,
+                              cols, rows, other.cols);
+    return result;
+}
+
+// Transposed multiplication: this * other^T (both share the same column count)
+Matrix Matrix::dotTransB(const Matrix& other) const {
+    Matrix result;
+    dotTransBInto(other, result);
     return result;
 }
 
+void Matrix::dotTransBInto(const Matrix& other, Matrix& result) const {
+    result.resize(rows, other.rows);
+    MatrixKernels::gemmTransB(storage, cols, other.storage, other.cols, result.storage, result.cols,
+                              rows, cols, other.rows);
+}
+
+// In-place rank-k update: this += a^T * b (a rank-1 outer product when a and b are single rows)
+void Matrix::rankUpdate(const Matrix& a, const Matrix& b) {
+    MatrixKernels::rankUpdate(a.storage, a.cols, b.storage, b.cols, storage, cols, a.cols, a.rows, b.cols);
+}
+
 // Element-wise addition: this + other
 Matrix Matrix::add(const Matrix& other) const {
     Matrix result(rows, cols);
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j)
-            result.data[i][j] = data[i][j] + other.data[i][j]; // add each element
+    for (int i = 0; i < size(); ++i)
+        result.storage[i] = storage[i] + other.storage[i]; // add each element
     return result;
 }
 
 // Apply a function to every element (e.g., sigmoid)
 Matrix Matrix::apply(float (*func)(float)) const {
     Matrix result(rows, cols);
-    for (int i = 0; i < rows; ++i)
-        for (int j = 0; j < cols; ++j)
-            result.data[i][j] = func(data[i][j]); // apply function to each cell
+    for (int i = 0; i < size(); ++i)
+        result.storage[i] = func(storage[i]); // apply function to each cell
     return result;
 }
 
@@ -47,14 +193,14 @@ Matrix Matrix::transpose() const {
     Matrix result(cols, rows); // new shape: cols × rows
     for (int i = 0; i < rows; ++i)
         for (int j = 0; j < cols; ++j)
-            result.data[j][i] = data[i][j]; // swap row and column
+            result(j, i) = (*this)(i, j); // swap row and column
     return result;
 }
 
 // Print the matrix to console (for debugging)
 void Matrix::print() const {
-    for (const auto& row : data) {
-        for (float val : row)
+    for (int i = 0; i < rows; ++i) {
+        for (float val : row(i))
             std::cout << val << " "; // print each value in row
         std::cout << "\n"; // new line after each row
     }
@@ -0,0 +1,996 @@
+#include "MatrixKernels.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#ifdef MATRIX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace MatrixKernels {
+
+// ---------- Scalar reference ----------
+
+void gemmScalar(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            float acc = 0.0f;
+            for (int k = 0; k < K; ++k)
+                acc += A[i * lda + k] * B[k * ldb + j];
+            C[i * ldc + j] = acc;
+        }
+    }
+}
+
+void gemvScalar(const float* x, const float* B, int ldb, float* y, int K, int N) {
+    gemmScalar(x, K, B, ldb, y, N, 1, K, N);
+}
+
+void gemmTransBScalar(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        for (int j = 0; j < N; ++j) {
+            float acc = 0.0f;
+            for (int k = 0; k < K; ++k)
+                acc += A[i * lda + k] * B[j * ldb + k];
+            C[i * ldc + j] = acc;
+        }
+    }
+}
+
+void rankUpdateScalar(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        float* cRow = C + i * ldc;
+        for (int k = 0; k < K; ++k) {
+            float a = A[k * lda + i];
+            const float* bRow = B + k * ldb;
+            for (int j = 0; j < N; ++j)
+                cRow[j] += a * bRow[j];
+        }
+    }
+}
+
+// Packed panel micro-kernels compute R rows of C against one panel of B.
+// columns is how many of the panel's width columns are real (the last panel
+// of a matrix may be zero padded).
+using PanelFunction = void (*)(const float* A, int lda, const float* panel, int width,
+                               float* C, int ldc, int K, int columns, bool accumulate);
+
+const int SCALAR_PANEL_WIDTH = 8;
+
+template <int R>
+static void panelScalar(const float* A, int lda, const float* panel, int width, float* C, int ldc, int K, int columns,
+                        bool accumulate) {
+    for (int r = 0; r < R; ++r) {
+        for (int j = 0; j < columns; ++j) {
+            float acc = accumulate ? C[r * ldc + j] : 0.0f;
+            for (int k = 0; k < K; ++k)
+                acc += A[r * lda + k] * panel[k * width + j];
+            C[r * ldc + j] = acc;
+        }
+    }
+}
+
+#ifdef MATRIX_KERNELS_X86
+
+// Each kernel computes R rows of C at once so every load of B is shared across
+// R rows, and CB vector-wide column blocks at once so independent FMA chains
+// hide each other's latency. Leftover columns fall through to narrower widths.
+// The R x CB loops are unrolled explicitly: left rolled (GCC -O2 does), the
+// accumulators live on the stack and every multiply-add becomes load, FMA, store.
+// Accumulate starts from the values already in C instead of zero, so a product
+// split over slices of K gives the same rounding as one pass over all of K.
+#define KERNEL_UNROLL _Pragma("GCC unroll 16")
+
+// ---------- SSE2 (4 floats, separate multiply and add) ----------
+
+template <int R, int CB, bool Accumulate = false>
+TARGET_SSE2 static inline void blockSse2(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int K, int j) {
+    __m128 acc[R][CB];
+    KERNEL_UNROLL
+    for (int r = 0; r < R; ++r)
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            acc[r][c] = Accumulate ? _mm_loadu_ps(C + r * ldc + j + c * 4) : _mm_setzero_ps();
+
+    for (int k = 0; k < K; ++k) {
+        const float* bRow = B + k * ldb + j;
+        __m128 b[CB];
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            b[c] = _mm_loadu_ps(bRow + c * 4);
+        KERNEL_UNROLL
+        for (int r = 0; r < R; ++r) {
+            __m128 a = _mm_set1_ps(A[r * lda + k]);
+            KERNEL_UNROLL
+            for (int c = 0; c < CB; ++c)
+                acc[r][c] = _mm_add_ps(acc[r][c], _mm_mul_ps(a, b[c]));
+        }
+    }
+
+    KERNEL_UNROLL
+    for (int r = 0; r < R; ++r)
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            _mm_storeu_ps(C + r * ldc + j + c * 4, acc[r][c]);
+}
+
+template <int R>
+TARGET_SSE2 static void rowsSse2(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int K, int N) {
+    const int CB = (R == 1) ? 4 : 2;
+    int j = 0;
+    for (; j + 4 * CB <= N; j += 4 * CB)
+        blockSse2<R, CB>(A, lda, B, ldb, C, ldc, K, j);
+    for (; j + 4 <= N; j += 4)
+        blockSse2<R, 1>(A, lda, B, ldb, C, ldc, K, j);
+    for (; j < N; ++j) {
+        for (int r = 0; r < R; ++r) {
+            float acc = 0.0f;
+            for (int k = 0; k < K; ++k)
+                acc += A[r * lda + k] * B[k * ldb + j];
+            C[r * ldc + j] = acc;
+        }
+    }
+}
+
+// ---------- AVX2 + FMA (8 floats) ----------
+
+template <int R, int CB, bool Accumulate = false>
+TARGET_AVX2 static inline void blockAvx2(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int K, int j) {
+    __m256 acc[R][CB];
+    KERNEL_UNROLL
+    for (int r = 0; r < R; ++r)
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            acc[r][c] = Accumulate ? _mm256_loadu_ps(C + r * ldc + j + c * 8) : _mm256_setzero_ps();
+
+    for (int k = 0; k < K; ++k) {
+        const float* bRow = B + k * ldb + j;
+        __m256 b[CB];
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            b[c] = _mm256_loadu_ps(bRow + c * 8);
+        KERNEL_UNROLL
+        for (int r = 0; r < R; ++r) {
+            __m256 a = _mm256_set1_ps(A[r * lda + k]);
+            KERNEL_UNROLL
+            for (int c = 0; c < CB; ++c)
+                acc[r][c] = _mm256_fmadd_ps(a, b[c], acc[r][c]);
+        }
+    }
+
+    KERNEL_UNROLL
+    for (int r = 0; r < R; ++r)
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            _mm256_storeu_ps(C + r * ldc + j + c * 8, acc[r][c]);
+}
+
+// 4-wide and scalar column tails shared by the FMA kernels
+template <int R>
+TARGET_AVX2 static inline void tailFma(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int K, int j, int N) {
+    for (; j + 4 <= N; j += 4) {
+        __m128 acc[R];
+        for (int r = 0; r < R; ++r)
+            acc[r] = _mm_setzero_ps();
+        for (int k = 0; k < K; ++k) {
+            __m128 b = _mm_loadu_ps(B + k * ldb + j);
+            for (int r = 0; r < R; ++r)
+                acc[r] = _mm_fmadd_ps(_mm_set1_ps(A[r * lda + k]), b, acc[r]);
+        }
+        for (int r = 0; r < R; ++r)
+            _mm_storeu_ps(C + r * ldc + j, acc[r]);
+    }
+    for (; j < N; ++j) {
+        for (int r = 0; r < R; ++r) {
+            float acc = 0.0f;
+            for (int k = 0; k < K; ++k)
+                acc = std::fma(A[r * lda + k], B[k * ldb + j], acc);
+            C[r * ldc + j] = acc;
+        }
+    }
+}
+
+template <int R>
+TARGET_AVX2 static void rowsAvx2(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int K, int N) {
+    const int CB = (R == 1) ? 4 : 2;
+    int j = 0;
+    for (; j + 8 * CB <= N; j += 8 * CB)
+        blockAvx2<R, CB>(A, lda, B, ldb, C, ldc, K, j);
+    for (; j + 8 <= N; j += 8)
+        blockAvx2<R, 1>(A, lda, B, ldb, C, ldc, K, j);
+    tailFma<R>(A, lda, B, ldb, C, ldc, K, j, N);
+}
+
+// ---------- AVX-512 (16 floats) ----------
+
+template <int R, int CB, bool Accumulate = false>
+TARGET_AVX512 static inline void blockAvx512(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int K, int j) {
+    __m512 acc[R][CB];
+    KERNEL_UNROLL
+    for (int r = 0; r < R; ++r)
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            acc[r][c] = Accumulate ? _mm512_loadu_ps(C + r * ldc + j + c * 16) : _mm512_setzero_ps();
+
+    for (int k = 0; k < K; ++k) {
+        const float* bRow = B + k * ldb + j;
+        __m512 b[CB];
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            b[c] = _mm512_loadu_ps(bRow + c * 16);
+        KERNEL_UNROLL
+        for (int r = 0; r < R; ++r) {
+            __m512 a = _mm512_set1_ps(A[r * lda + k]);
+            KERNEL_UNROLL
+            for (int c = 0; c < CB; ++c)
+                acc[r][c] = _mm512_fmadd_ps(a, b[c], acc[r][c]);
+        }
+    }
+
+    KERNEL_UNROLL
+    for (int r = 0; r < R; ++r)
+        KERNEL_UNROLL
+        for (int c = 0; c < CB; ++c)
+            _mm512_storeu_ps(C + r * ldc + j + c * 16, acc[r][c]);
+}
+
+template <int R>
+TARGET_AVX512 static void rowsAvx512(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int K, int N) {
+    const int CB = (R == 1) ? 4 : 2;
+    int j = 0;
+    for (; j + 16 * CB <= N; j += 16 * CB)
+        blockAvx512<R, CB>(A, lda, B, ldb, C, ldc, K, j);
+    for (; j + 16 <= N; j += 16)
+        blockAvx512<R, 1>(A, lda, B, ldb, C, ldc, K, j);
+    for (; j + 8 <= N; j += 8)
+        blockAvx2<R, 1>(A, lda, B, ldb, C, ldc, K, j);
+    tailFma<R>(A, lda, B, ldb, C, ldc, K, j, N);
+}
+
+// Walk M in blocks of four rows, then finish the remaining one to three rows
+#define DEFINE_GEMM(NAME, ROWS)                                                                              \
+    static void NAME(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) { \
+        int i = 0;                                                                                           \
+        for (; i + 4 <= M; i += 4)                                                                           \
+            ROWS<4>(A + i * lda, lda, B, ldb, C + i * ldc, ldc, K, N);                                       \
+        switch (M - i) {                                                                                     \
+            case 3: ROWS<3>(A + i * lda, lda, B, ldb, C + i * ldc, ldc, K, N); break;                        \
+            case 2: ROWS<2>(A + i * lda, lda, B, ldb, C + i * ldc, ldc, K, N); break;                        \
+            case 1: ROWS<1>(A + i * lda, lda, B, ldb, C + i * ldc, ldc, K, N); break;                        \
+            default: break;                                                                                  \
+        }                                                                                                    \
+    }
+
+DEFINE_GEMM(gemmSse2, rowsSse2)
+DEFINE_GEMM(gemmAvx2, rowsAvx2)
+DEFINE_GEMM(gemmAvx512, rowsAvx512)
+
+#undef DEFINE_GEMM
+
+// Streaming GEMV for matrices too big for L1: walk B once row by row and keep
+// the running sums in y. Each y[j] still accumulates over k in order, so the
+// result matches the register-blocked kernels exactly.
+TARGET_SSE2 static void gemvStreamSse2(const float* x, const float* B, int ldb, float* y, int K, int N) {
+    std::fill(y, y + N, 0.0f);
+    for (int k = 0; k < K; ++k) {
+        const float* bRow = B + k * ldb;
+        __m128 a = _mm_set1_ps(x[k]);
+        int j = 0;
+        for (; j + 4 <= N; j += 4)
+            _mm_storeu_ps(y + j, _mm_add_ps(_mm_loadu_ps(y + j), _mm_mul_ps(a, _mm_loadu_ps(bRow + j))));
+        for (; j < N; ++j)
+            y[j] += x[k] * bRow[j];
+    }
+}
+
+TARGET_AVX2 static void gemvStreamAvx2(const float* x, const float* B, int ldb, float* y, int K, int N) {
+    std::fill(y, y + N, 0.0f);
+    for (int k = 0; k < K; ++k) {
+        const float* bRow = B + k * ldb;
+        __m256 a = _mm256_set1_ps(x[k]);
+        int j = 0;
+        for (; j + 8 <= N; j += 8)
+            _mm256_storeu_ps(y + j, _mm256_fmadd_ps(a, _mm256_loadu_ps(bRow + j), _mm256_loadu_ps(y + j)));
+        for (; j < N; ++j)
+            y[j] = std::fma(x[k], bRow[j], y[j]);
+    }
+}
+
+TARGET_AVX512 static void gemvStreamAvx512(const float* x, const float* B, int ldb, float* y, int K, int N) {
+    std::fill(y, y + N, 0.0f);
+    for (int k = 0; k < K; ++k) {
+        const float* bRow = B + k * ldb;
+        __m512 a = _mm512_set1_ps(x[k]);
+        int j = 0;
+        for (; j + 16 <= N; j += 16)
+            _mm512_storeu_ps(y + j, _mm512_fmadd_ps(a, _mm512_loadu_ps(bRow + j), _mm512_loadu_ps(y + j)));
+        for (; j < N; ++j)
+            y[j] = std::fma(x[k], bRow[j], y[j]);
+    }
+}
+
+// ---------- Transposed products ----------
+
+// Rank-K update, one row of C at a time: row i of C stays in cache while the
+// K rows of B stream past it, each scaled by A[k][i] (column i of A).
+// Every element still accumulates over k in order.
+TARGET_SSE2 static void rankUpdateSse2(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        float* cRow = C + i * ldc;
+        for (int k = 0; k < K; ++k) {
+            const float* bRow = B + k * ldb;
+            __m128 a = _mm_set1_ps(A[k * lda + i]);
+            int j = 0;
+            for (; j + 4 <= N; j += 4)
+                _mm_storeu_ps(cRow + j, _mm_add_ps(_mm_loadu_ps(cRow + j), _mm_mul_ps(a, _mm_loadu_ps(bRow + j))));
+            for (; j < N; ++j)
+                cRow[j] += A[k * lda + i] * bRow[j];
+        }
+    }
+}
+
+TARGET_AVX2 static void rankUpdateAvx2(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        float* cRow = C + i * ldc;
+        for (int k = 0; k < K; ++k) {
+            const float* bRow = B + k * ldb;
+            __m256 a = _mm256_set1_ps(A[k * lda + i]);
+            int j = 0;
+            for (; j + 8 <= N; j += 8)
+                _mm256_storeu_ps(cRow + j, _mm256_fmadd_ps(a, _mm256_loadu_ps(bRow + j), _mm256_loadu_ps(cRow + j)));
+            for (; j < N; ++j)
+                cRow[j] = std::fma(A[k * lda + i], bRow[j], cRow[j]);
+        }
+    }
+}
+
+TARGET_AVX512 static void rankUpdateAvx512(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        float* cRow = C + i * ldc;
+        for (int k = 0; k < K; ++k) {
+            const float* bRow = B + k * ldb;
+            __m512 a = _mm512_set1_ps(A[k * lda + i]);
+            int j = 0;
+            for (; j + 16 <= N; j += 16)
+                _mm512_storeu_ps(cRow + j, _mm512_fmadd_ps(a, _mm512_loadu_ps(bRow + j), _mm512_loadu_ps(cRow + j)));
+            for (; j < N; ++j)
+                cRow[j] = std::fma(A[k * lda + i], bRow[j], cRow[j]);
+        }
+    }
+}
+
+// A * B^T: every element is the dot product of row i of A and row j of B,
+// both contiguous. Lanes accumulate separately and are summed at the end.
+TARGET_SSE2 static void gemmTransBSse2(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        const float* aRow = A + i * lda;
+        for (int j = 0; j < N; ++j) {
+            const float* bRow = B + j * ldb;
+            __m128 acc = _mm_setzero_ps();
+            int k = 0;
+            for (; k + 4 <= K; k += 4)
+                acc = _mm_add_ps(acc, _mm_mul_ps(_mm_loadu_ps(aRow + k), _mm_loadu_ps(bRow + k)));
+            float sum = 0.0f;
+            if (k > 0) {
+                __m128 pairs = _mm_add_ps(acc, _mm_shuffle_ps(acc, acc, _MM_SHUFFLE(2, 3, 0, 1)));
+                sum = _mm_cvtss_f32(pairs) + _mm_cvtss_f32(_mm_movehl_ps(pairs, pairs));
+            }
+            for (; k < K; ++k)
+                sum += aRow[k] * bRow[k];
+            C[i * ldc + j] = sum;
+        }
+    }
+}
+
+TARGET_AVX2 static void gemmTransBAvx2(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        const float* aRow = A + i * lda;
+        for (int j = 0; j < N; ++j) {
+            const float* bRow = B + j * ldb;
+            __m256 acc = _mm256_setzero_ps();
+            int k = 0;
+            for (; k + 8 <= K; k += 8)
+                acc = _mm256_fmadd_ps(_mm256_loadu_ps(aRow + k), _mm256_loadu_ps(bRow + k), acc);
+            // (l0 + l1) + (l2 + l3) of the folded halves, kept in registers; skipped
+            // when K is shorter than one vector and acc is still zero
+            float sum = 0.0f;
+            if (k > 0) {
+                __m128 half = _mm_add_ps(_mm256_castps256_ps128(acc), _mm256_extractf128_ps(acc, 1));
+                __m128 pairs = _mm_add_ps(half, _mm_shuffle_ps(half, half, _MM_SHUFFLE(2, 3, 0, 1)));
+                sum = _mm_cvtss_f32(pairs) + _mm_cvtss_f32(_mm_movehl_ps(pairs, pairs));
+            }
+            for (; k < K; ++k)
+                sum = std::fma(aRow[k], bRow[k], sum);
+            C[i * ldc + j] = sum;
+        }
+    }
+}
+
+TARGET_AVX512 static void gemmTransBAvx512(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i) {
+        const float* aRow = A + i * lda;
+        for (int j = 0; j < N; ++j) {
+            const float* bRow = B + j * ldb;
+            __m512 acc = _mm512_setzero_ps();
+            int k = 0;
+            for (; k + 16 <= K; k += 16)
+                acc = _mm512_fmadd_ps(_mm512_loadu_ps(aRow + k), _mm512_loadu_ps(bRow + k), acc);
+            // Pairwise tree: lane l adds lane l + 8, then l + 4, l + 2, l + 1.
+            // maskz forms avoid GCC's false uninitialized warnings on the plain intrinsics.
+            float sum = 0.0f;
+            if (k > 0) {
+                const __mmask16 ALL = 0xFFFF;
+                acc = _mm512_add_ps(acc, _mm512_maskz_shuffle_f32x4(ALL, acc, acc, _MM_SHUFFLE(1, 0, 3, 2)));
+                acc = _mm512_add_ps(acc, _mm512_maskz_shuffle_f32x4(ALL, acc, acc, _MM_SHUFFLE(2, 3, 0, 1)));
+                acc = _mm512_add_ps(acc, _mm512_maskz_permute_ps(ALL, acc, _MM_SHUFFLE(1, 0, 3, 2)));
+                acc = _mm512_add_ps(acc, _mm512_maskz_permute_ps(ALL, acc, _MM_SHUFFLE(2, 3, 0, 1)));
+                sum = _mm512_cvtss_f32(acc);
+            }
+            for (; k < K; ++k)
+                sum = std::fma(aRow[k], bRow[k], sum);
+            C[i * ldc + j] = sum;
+        }
+    }
+}
+
+// ---------- Reduced-precision weights ----------
+
+// Each pair row is widened to int16 and multiplied against the broadcast
+// input pair (x[2p], x[2p+1]); madd sums the two products into int32 lanes
+TARGET_SSE2 static void gemvInt8Sse2(const int16_t* x, const int8_t* W, int ldw, int32_t* y, int K, int N) {
+    int j = 0;
+    for (; j + 4 <= N; j += 4) {
+        __m128i acc = _mm_setzero_si128();
+        for (int p = 0; p < K / 2; ++p) {
+            int32_t pair;
+            std::memcpy(&pair, x + 2 * p, sizeof(pair));
+            __m128i bytes = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(W + p * ldw + 2 * j));
+            __m128i w = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(w, _mm_set1_epi32(pair)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y + j), acc);
+    }
+    for (; j < N; ++j) {
+        int32_t sum = 0;
+        for (int p = 0; p < K / 2; ++p)
+            sum += x[2 * p] * W[p * ldw + 2 * j] + x[2 * p + 1] * W[p * ldw + 2 * j + 1];
+        y[j] = sum;
+    }
+}
+
+TARGET_AVX2 static void gemvInt8Avx2(const int16_t* x, const int8_t* W, int ldw, int32_t* y, int K, int N) {
+    int j = 0;
+    for (; j + 16 <= N; j += 16) {
+        __m256i acc0 = _mm256_setzero_si256();
+        __m256i acc1 = _mm256_setzero_si256();
+        for (int p = 0; p < K / 2; ++p) {
+            int32_t pair;
+            std::memcpy(&pair, x + 2 * p, sizeof(pair));
+            __m256i xp = _mm256_set1_epi32(pair);
+            const int8_t* row = W + p * ldw + 2 * j;
+            __m256i w0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row)));
+            __m256i w1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row + 16)));
+            acc0 = _mm256_add_epi32(acc0, _mm256_madd_epi16(w0, xp));
+            acc1 = _mm256_add_epi32(acc1, _mm256_madd_epi16(w1, xp));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + j), acc0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + j + 8), acc1);
+    }
+    for (; j + 8 <= N; j += 8) {
+        __m256i acc = _mm256_setzero_si256();
+        for (int p = 0; p < K / 2; ++p) {
+            int32_t pair;
+            std::memcpy(&pair, x + 2 * p, sizeof(pair));
+            __m256i w = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(W + p * ldw + 2 * j)));
+            acc = _mm256_add_epi32(acc, _mm256_madd_epi16(w, _mm256_set1_epi32(pair)));
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(y + j), acc);
+    }
+    for (; j + 4 <= N; j += 4) {
+        __m128i acc = _mm_setzero_si128();
+        for (int p = 0; p < K / 2; ++p) {
+            int32_t pair;
+            std::memcpy(&pair, x + 2 * p, sizeof(pair));
+            __m128i w = _mm_cvtepi8_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(W + p * ldw + 2 * j)));
+            acc = _mm_add_epi32(acc, _mm_madd_epi16(w, _mm_set1_epi32(pair)));
+        }
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(y + j), acc);
+    }
+    for (; j < N; ++j) {
+        int32_t sum = 0;
+        for (int p = 0; p < K / 2; ++p)
+            sum += x[2 * p] * W[p * ldw + 2 * j] + x[2 * p + 1] * W[p * ldw + 2 * j + 1];
+        y[j] = sum;
+    }
+}
+
+// Largest |x| with independent vector maxima, then a round-to-nearest-even
+// conversion; packs keep only the low 16 bits, which hold every int8 level
+TARGET_SSE2 static float quantizeInt8Sse2(const float* x, int16_t* q, int K) {
+    const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7FFFFFFF));
+    __m128 maxima = _mm_setzero_ps();
+    int k = 0;
+    for (; k + 4 <= K; k += 4)
+        maxima = _mm_max_ps(maxima, _mm_and_ps(_mm_loadu_ps(x + k), absMask));
+    alignas(16) float lanes[4];
+    _mm_store_ps(lanes, maxima);
+    float maxAbs = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+    for (; k < K; ++k)
+        maxAbs = std::max(maxAbs, std::abs(x[k]));
+
+    if (maxAbs == 0.0f) {
+        std::fill(q, q + K, static_cast<int16_t>(0));
+        return 1.0f;
+    }
+    float inverse = 127.0f / maxAbs;
+    __m128 scale = _mm_set1_ps(inverse);
+    k = 0;
+    for (; k + 4 <= K; k += 4) {
+        __m128i levels = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(x + k), scale));
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(q + k), _mm_packs_epi32(levels, levels));
+    }
+    for (; k < K; ++k)
+        q[k] = static_cast<int16_t>(std::nearbyint(x[k] * inverse));
+    return maxAbs / 127.0f;
+}
+
+TARGET_AVX2 static float quantizeInt8Avx2(const float* x, int16_t* q, int K) {
+    const __m256 absMask = _mm256_castsi256_ps(_mm256_set1_epi32(0x7FFFFFFF));
+    __m256 maxima = _mm256_setzero_ps();
+    int k = 0;
+    for (; k + 8 <= K; k += 8)
+        maxima = _mm256_max_ps(maxima, _mm256_and_ps(_mm256_loadu_ps(x + k), absMask));
+    alignas(32) float lanes[8];
+    _mm256_store_ps(lanes, maxima);
+    float maxAbs = 0.0f;
+    for (int lane = 0; lane < 8; ++lane)
+        maxAbs = std::max(maxAbs, lanes[lane]);
+    for (; k < K; ++k)
+        maxAbs = std::max(maxAbs, std::abs(x[k]));
+
+    if (maxAbs == 0.0f) {
+        std::fill(q, q + K, static_cast<int16_t>(0));
+        return 1.0f;
+    }
+    float inverse = 127.0f / maxAbs;
+    __m256 scale = _mm256_set1_ps(inverse);
+    k = 0;
+    for (; k + 8 <= K; k += 8) {
+        __m256i levels = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_loadu_ps(x + k), scale));
+        __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(levels), _mm256_extracti128_si256(levels, 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(q + k), packed);
+    }
+    for (; k < K; ++k)
+        q[k] = static_cast<int16_t>(std::nearbyint(x[k] * inverse));
+    return maxAbs / 127.0f;
+}
+
+// Column blocks stay in registers across k; each y[j] still accumulates in k order
+TARGET_F16C static void gemvHalfF16c(const float* x, const uint16_t* B, int ldb, float* y, int K, int N) {
+    int j = 0;
+    for (; j + 8 <= N; j += 8) {
+        __m256 acc = _mm256_setzero_ps();
+        for (int k = 0; k < K; ++k) {
+            __m256 b = _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(B + k * ldb + j)));
+            acc = _mm256_fmadd_ps(_mm256_set1_ps(x[k]), b, acc);
+        }
+        _mm256_storeu_ps(y + j, acc);
+    }
+    for (; j + 4 <= N; j += 4) {
+        __m128 acc = _mm_setzero_ps();
+        for (int k = 0; k < K; ++k) {
+            __m128 b = _mm_cvtph_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(B + k * ldb + j)));
+            acc = _mm_fmadd_ps(_mm_set1_ps(x[k]), b, acc);
+        }
+        _mm_storeu_ps(y + j, acc);
+    }
+    for (; j < N; ++j) {
+        float sum = 0.0f;
+        for (int k = 0; k < K; ++k)
+            sum = std::fma(x[k], _cvtsh_ss(B[k * ldb + j]), sum);
+        y[j] = sum;
+    }
+}
+
+// Full panels are written straight into C; a partial last panel goes through
+// a stack tile so the padding columns are never stored.
+#define DEFINE_PANEL(NAME, TARGET, BLOCK, WIDTH)                                                     \
+    template <int R>                                                                                 \
+    TARGET static void NAME(const float* A, int lda, const float* panel, int, float* C, int ldc,     \
+                            int K, int columns, bool accumulate) {                                   \
+        if (columns == WIDTH) {                                                                      \
+            if (accumulate) {                                                                        \
+                BLOCK<R, 2, true>(A, lda, panel, WIDTH, C, ldc, K, 0);                               \
+            } else {                                                                                 \
+                BLOCK<R, 2>(A, lda, panel, WIDTH, C, ldc, K, 0);                                     \
+            }                                                                                        \
+            return;                                                                                  \
+        }                                                                                            \
+        alignas(64) float tile[R * WIDTH];                                                           \
+        if (accumulate) {                                                                            \
+            for (int r = 0; r < R; ++r)                                                              \
+                for (int j = 0; j < WIDTH; ++j)                                                      \
+                    tile[r * WIDTH + j] = j < columns ? C[r * ldc + j] : 0.0f;                       \
+            BLOCK<R, 2, true>(A, lda, panel, WIDTH, tile, WIDTH, K, 0);                              \
+        } else {                                                                                     \
+            BLOCK<R, 2>(A, lda, panel, WIDTH, tile, WIDTH, K, 0);                                    \
+        }                                                                                            \
+        for (int r = 0; r < R; ++r)                                                                  \
+            for (int j = 0; j < columns; ++j)                                                        \
+                C[r * ldc + j] = tile[r * WIDTH + j];                                                \
+    }
+
+DEFINE_PANEL(panelSse2, TARGET_SSE2, blockSse2, 8)
+DEFINE_PANEL(panelAvx2, TARGET_AVX2, blockAvx2, 16)
+DEFINE_PANEL(panelAvx512, TARGET_AVX512, blockAvx512, 32)
+
+#undef DEFINE_PANEL
+#undef KERNEL_UNROLL
+
+#endif // MATRIX_KERNELS_X86
+
+// ---------- Runtime dispatch ----------
+
+namespace {
+
+using GemmFunction = void (*)(const float*, int, const float*, int, float*, int, int, int, int);
+using GemvFunction = void (*)(const float*, const float*, int, float*, int, int);
+
+// Register tile of the blocked GEMM: rows x width, with one kernel per row count 1..rows
+struct PanelKernel {
+    int rows;
+    int width;
+    PanelFunction byRows[9];
+};
+
+struct KernelTable {
+    Isa isa;
+    GemmFunction gemm;
+    GemvFunction gemvStream;
+    GemmFunction gemmTransB;
+    GemmFunction rankUpdate;
+    PanelKernel panel;
+};
+
+const PanelKernel SCALAR_PANEL = {4, SCALAR_PANEL_WIDTH,
+    {nullptr, panelScalar<1>, panelScalar<2>, panelScalar<3>, panelScalar<4>}};
+
+KernelTable makeTable(Isa isa) {
+    switch (isa) {
+#ifdef MATRIX_KERNELS_X86
+        case Isa::AVX512:
+            return {Isa::AVX512, gemmAvx512, gemvStreamAvx512, gemmTransBAvx512, rankUpdateAvx512, {8, 32, {nullptr, panelAvx512<1>, panelAvx512<2>, panelAvx512<3>,
+                    panelAvx512<4>, panelAvx512<5>, panelAvx512<6>, panelAvx512<7>, panelAvx512<8>}}};
+        case Isa::AVX2:
+            return {Isa::AVX2, gemmAvx2, gemvStreamAvx2, gemmTransBAvx2, rankUpdateAvx2, {6, 16, {nullptr, panelAvx2<1>, panelAvx2<2>, panelAvx2<3>,
+                    panelAvx2<4>, panelAvx2<5>, panelAvx2<6>}}};
+        case Isa::SSE2:
+            return {Isa::SSE2, gemmSse2, gemvStreamSse2, gemmTransBSse2, rankUpdateSse2, {4, 8, {nullptr, panelSse2<1>, panelSse2<2>, panelSse2<3>, panelSse2<4>}}};
+#endif
+        default:
+            return {Isa::Scalar, gemmScalar, gemvScalar, gemmTransBScalar, rankUpdateScalar, SCALAR_PANEL};
+    }
+}
+
+KernelTable& activeTable() {
+    static KernelTable table = makeTable(detectedIsa());
+    return table;
+}
+
+}
+
+Isa detectedIsa() {
+    static const Isa isa = [] {
+#ifdef MATRIX_KERNELS_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) return Isa::AVX512;
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return Isa::AVX2;
+        if (__builtin_cpu_supports("sse2")) return Isa::SSE2;
+#endif
+        return Isa::Scalar;
+    }();
+    return isa;
+}
+
+Isa activeIsa() {
+    return activeTable().isa;
+}
+
+Isa setIsa(Isa isa) {
+    if (static_cast<int>(isa) > static_cast<int>(detectedIsa())) {
+        isa = detectedIsa();
+    }
+    activeTable() = makeTable(isa);
+    return activeTable().isa;
+}
+
+const char* isaName(Isa isa) {
+    switch (isa) {
+        case Isa::AVX512: return "AVX-512";
+        case Isa::AVX2: return "AVX2";
+        case Isa::SSE2: return "SSE2";
+        default: return "Scalar";
+    }
+}
+
+void gemv(const float* x, const float* B, int ldb, float* y, int K, int N) {
+    if (static_cast<long long>(K) * N >= GEMV_STREAM_THRESHOLD) {
+        activeTable().gemvStream(x, B, ldb, y, K, N);
+        return;
+    }
+    activeTable().gemm(x, K, B, ldb, y, N, 1, K, N);
+}
+
+void gemm(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    long long work = static_cast<long long>(M) * K * N;
+    if (work >= BLOCKED_GEMM_THRESHOLD) {
+        // Large product: pack B into a per-thread scratch and run the blocked
+        // kernel. Callers whose B stays fixed across calls (layer weights) keep
+        // their own PackedPanels and call gemmPacked instead of repacking here.
+        thread_local PackedPanels scratch;
+        pack(B, ldb, K, N, scratch);
+        gemmPacked(A, lda, scratch, C, ldc, M);
+        return;
+    }
+    activeTable().gemm(A, lda, B, ldb, C, ldc, M, K, N);
+}
+
+// Rows of C are independent in both transposed products, so large ones are
+// split into row blocks across the shared thread pool
+static void runByRows(GemmFunction kernel, const float* A, int lda, const float* B, int ldb, float* C, int ldc,
+                      int M, int K, int N, bool rowsOfATransposed) {
+    long long work = static_cast<long long>(M) * K * N;
+    if (work < PARALLEL_GEMM_THRESHOLD || M < 2) {
+        kernel(A, lda, B, ldb, C, ldc, M, K, N);
+        return;
+    }
+
+    const int rowBlock = 16;
+    int blocks = (M + rowBlock - 1) / rowBlock;
+    ThreadPool::shared().parallelFor(blocks, [&](int block) {
+        int firstRow = block * rowBlock;
+        int rows = std::min(rowBlock, M - firstRow);
+        // Row i of C reads row i of A, or column i when A is stored transposed
+        const float* aBlock = rowsOfATransposed ? A + firstRow : A + firstRow * lda;
+        kernel(aBlock, lda, B, ldb, C + firstRow * ldc, ldc, rows, K, N);
+    });
+}
+
+void gemmTransA(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    for (int i = 0; i < M; ++i)
+        std::fill(C + i * ldc, C + i * ldc + N, 0.0f);
+    rankUpdate(A, lda, B, ldb, C, ldc, M, K, N);
+}
+
+void gemmTransB(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    runByRows(activeTable().gemmTransB, A, lda, B, ldb, C, ldc, M, K, N, false);
+}
+
+void rankUpdate(const float* A, int lda, const float* B, int ldb, float* C, int ldc, int M, int K, int N) {
+    runByRows(activeTable().rankUpdate, A, lda, B, ldb, C, ldc, M, K, N, true);
+}
+
+static void gemvInt8Scalar(const int16_t* x, const int8_t* W, int ldw, int32_t* y, int K, int N) {
+    for (int j = 0; j < N; ++j) {
+        int32_t sum = 0;
+        for (int p = 0; p < K / 2; ++p)
+            sum += x[2 * p] * W[p * ldw + 2 * j] + x[2 * p + 1] * W[p * ldw + 2 * j + 1];
+        y[j] = sum;
+    }
+}
+
+static float quantizeInt8Scalar(const float* x, int16_t* q, int K) {
+    float maxAbs = 0.0f;
+    for (int k = 0; k < K; ++k)
+        maxAbs = std::max(maxAbs, std::abs(x[k]));
+    if (maxAbs == 0.0f) {
+        std::fill(q, q + K, static_cast<int16_t>(0));
+        return 1.0f;
+    }
+    float inverse = 127.0f / maxAbs;
+    for (int k = 0; k < K; ++k)
+        q[k] = static_cast<int16_t>(std::nearbyint(x[k] * inverse));
+    return maxAbs / 127.0f;
+}
+
+static void gemvHalfScalar(const float* x, const uint16_t* B, int ldb, float* y, int K, int N) {
+    std::fill(y, y + N, 0.0f);
+    for (int k = 0; k < K; ++k) {
+        const uint16_t* bRow = B + k * ldb;
+        for (int j = 0; j < N; ++j)
+            y[j] += x[k] * halfToFloat(bRow[j]);
+    }
+}
+
+void gemvInt8(const int16_t* x, const int8_t* W, int ldw, int32_t* y, int K, int N) {
+    // Byte and word lanes need AVX-512BW, so the AVX-512 tier shares the AVX2 kernel
+    switch (activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+        case Isa::AVX512:
+        case Isa::AVX2:
+            gemvInt8Avx2(x, W, ldw, y, K, N);
+            return;
+        case Isa::SSE2:
+            gemvInt8Sse2(x, W, ldw, y, K, N);
+            return;
+#endif
+        default:
+            gemvInt8Scalar(x, W, ldw, y, K, N);
+    }
+}
+
+float quantizeInt8(const float* x, int16_t* q, int K) {
+#ifdef MATRIX_KERNELS_X86
+    switch (activeIsa()) {
+        case Isa::AVX512:
+        case Isa::AVX2:
+            return quantizeInt8Avx2(x, q, K);
+        case Isa::SSE2:
+            return quantizeInt8Sse2(x, q, K);
+        default:
+            break;
+    }
+#endif
+    return quantizeInt8Scalar(x, q, K);
+}
+
+void gemvHalf(const float* x, const uint16_t* B, int ldb, float* y, int K, int N) {
+#ifdef MATRIX_KERNELS_X86
+    static const bool hasF16c = __builtin_cpu_supports("f16c");
+    if (hasF16c && static_cast<int>(activeIsa()) >= static_cast<int>(Isa::AVX2)) {
+        gemvHalfF16c(x, B, ldb, y, K, N);
+        return;
+    }
+#endif
+    gemvHalfScalar(x, B, ldb, y, K, N);
+}
+
+// Bit-level conversions after F. Giesen's float_to_half_fast3_rtne / half_to_float
+uint16_t floatToHalf(float value) {
+    const uint32_t infinityBits = 255u << 23;
+    const uint32_t halfOverflowBits = (127u + 16u) << 23;
+    const uint32_t denormalMagicBits = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    uint16_t half;
+    if (bits >= halfOverflowBits) {
+        half = (bits > infinityBits) ? 0x7E00 : 0x7C00;  // NaN stays NaN, the rest saturates to infinity
+    } else if (bits < (113u << 23)) {
+        // Subnormal half: let the float adder do the rounding shift
+        float magic, shifted;
+        std::memcpy(&magic, &denormalMagicBits, sizeof(magic));
+        std::memcpy(&shifted, &bits, sizeof(shifted));
+        shifted += magic;
+        uint32_t shiftedBits;
+        std::memcpy(&shiftedBits, &shifted, sizeof(shiftedBits));
+        half = static_cast<uint16_t>(shiftedBits - denormalMagicBits);
+    } else {
+        uint32_t mantissaOdd = (bits >> 13) & 1u;
+        bits += ((15u - 127u) << 23) + 0xFFFu;  // rebias exponent, round half up...
+        bits += mantissaOdd;                    // ...then to even
+        half = static_cast<uint16_t>(bits >> 13);
+    }
+    return static_cast<uint16_t>(half | (sign >> 16));
+}
+
+float halfToFloat(uint16_t value) {
+    const uint32_t magicBits = (254u - 15u) << 23;
+    const uint32_t infNanBits = (127u + 16u) << 23;
+
+    uint32_t bits = static_cast<uint32_t>(value & 0x7FFF) << 13;
+    float magnitude, magic, infNan;
+    std::memcpy(&magnitude, &bits, sizeof(magnitude));
+    std::memcpy(&magic, &magicBits, sizeof(magic));
+    std::memcpy(&infNan, &infNanBits, sizeof(infNan));
+
+    magnitude *= magic;  // rebias the exponent; also normalizes subnormals
+    std::memcpy(&bits, &magnitude, sizeof(bits));
+    if (magnitude >= infNan) {
+        bits |= 255u << 23;
+    }
+    bits |= static_cast<uint32_t>(value & 0x8000) << 16;
+
+    float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+}
+
+void pack(const float* B, int ldb, int K, int N, PackedPanels& out) {
+    int width = activeTable().panel.width;
+    out.K = K;
+    out.N = N;
+    out.width = width;
+    // Every float is written below, so a reused buffer is resized, not cleared
+    out.data.resize(static_cast<size_t>(out.panelCount()) * K * width);
+
+    float* dst = out.data.data();
+    for (int p = 0; p < out.panelCount(); ++p) {
+        int firstColumn = p * width;
+        int columns = std::min(width, N - firstColumn);
+        for (int k = 0; k < K; ++k) {
+            std::copy_n(B + k * ldb + firstColumn, columns, dst + k * width);
+            std::fill(dst + k * width + columns, dst + (k + 1) * width, 0.0f);
+        }
+        dst += static_cast<size_t>(K) * width;
+    }
+}
+
+void gemmPacked(const float* A, int lda, const PackedPanels& B, float* C, int ldc, int M) {
+    // Panels packed under a different ISA still work, just through the portable kernel
+    const PanelKernel& active = activeTable().panel;
+    PanelKernel fallback = SCALAR_PANEL;
+    fallback.width = B.width;
+    const PanelKernel& kernel = (B.width == active.width) ? active : fallback;
+
+    // K is cut into slices whose part of a panel stays in L1 while every
+    // micro-tile of a row block reuses it, and M into row blocks whose slice of
+    // A stays in L2 while the panels stream past it. Slices run in k order and
+    // each one continues the sums the previous one left in C, so the result
+    // is the same as one pass over all of K.
+    const int sliceDepth = std::max(1, GEMM_PANEL_SLICE_BYTES / static_cast<int>(B.width * sizeof(float)));
+    const int slices = (B.K + sliceDepth - 1) / sliceDepth;
+    const int rowBlockRows = GEMM_ROW_BLOCK_BYTES / static_cast<int>(std::min(sliceDepth, B.K) * sizeof(float));
+    const int rowBlock = std::max(kernel.rows, rowBlockRows / kernel.rows * kernel.rows);
+    const int rowBlocks = (M + rowBlock - 1) / rowBlock;
+    const int panels = B.panelCount();
+    const size_t panelSize = static_cast<size_t>(B.K) * B.width;
+
+    // Enough column groups that every pool thread gets a task
+    long long work = static_cast<long long>(M) * B.K * B.N;
+    bool parallel = work >= PARALLEL_GEMM_THRESHOLD;
+    int threads = parallel ? ThreadPool::shared().size() : 1;
+    const int groups = std::min(panels, std::max(1, (threads + rowBlocks - 1) / rowBlocks));
+    const int panelsPerGroup = (panels + groups - 1) / groups;
+
+    auto tile = [&](int task) {
+        int firstRow = (task / groups) * rowBlock;
+        int lastRow = std::min(M, firstRow + rowBlock);
+        int firstPanel = (task % groups) * panelsPerGroup;
+        int lastPanel = std::min(panels, firstPanel + panelsPerGroup);
+
+        // With more than one slice, rows of A are copied into a contiguous block
+        // so the micro-kernel's row streams do not alias in L1 at power-of-two lda
+        thread_local std::vector<float> sliceOfA;
+        for (int s = 0; s < slices; ++s) {
+            int firstK = s * sliceDepth;
+            int depth = std::min(sliceDepth, B.K - firstK);
+            const float* a = A + static_cast<size_t>(firstRow) * lda + firstK;
+            int aStride = lda;
+            if (slices > 1) {
+                aStride = sliceDepth + GEMM_SLICE_PADDING;
+                sliceOfA.resize(static_cast<size_t>(rowBlock) * aStride);
+                for (int i = firstRow; i < lastRow; ++i)
+                    std::copy_n(A + static_cast<size_t>(i) * lda + firstK, depth,
+                                sliceOfA.data() + static_cast<size_t>(i - firstRow) * aStride);
+                a = sliceOfA.data();
+            }
+
+            for (int p = firstPanel; p < lastPanel; ++p) {
+                int firstColumn = p * B.width;
+                int columns = std::min(B.width, B.N - firstColumn);
+                const float* panel = B.data.data() + p * panelSize + static_cast<size_t>(firstK) * B.width;
+                for (int i = firstRow; i < lastRow; i += kernel.rows) {
+                    int rowCount = std::min(kernel.rows, lastRow - i);
+                    kernel.byRows[rowCount](a + static_cast<size_t>(i - firstRow) * aStride, aStride, panel,
+                                            B.width, C + static_cast<size_t>(i) * ldc + firstColumn, ldc, depth,
+                                            columns, s > 0);
+                }
+            }
+        }
+    };
+
+    int tasks = rowBlocks * groups;
+    if (parallel) {
+        ThreadPool::shared().parallelFor(tasks, tile);
+    } else {
+        for (int task = 0; task < tasks; ++task)
+            tile(task);
+    }
+}
+
+}
@@ -0,0 +1,328 @@
+#include "ModelFormat.h"
+#include "MatrixKernels.h"
+#include <array>
+#include <cstring>
+#include <fstream>
+
+#ifdef MATRIX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace ModelFormat {
+
+namespace {
+
+// Reflected CRC-32C polynomial
+const uint32_t CRC32C_POLYNOMIAL = 0x82F63B78;
+
+const uint32_t* crcTable() {
+    static const std::array<uint32_t, 256> table = [] {
+        std::array<uint32_t, 256> values{};
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc & 1) ? (crc >> 1) ^ CRC32C_POLYNOMIAL : crc >> 1;
+            values[i] = crc;
+        }
+        return values;
+    }();
+    return table.data();
+}
+
+uint32_t crc32cScalar(const unsigned char* data, size_t bytes, uint32_t crc) {
+    const uint32_t* table = crcTable();
+    for (size_t i = 0; i < bytes; ++i)
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef MATRIX_KERNELS_X86
+// The crc32 instruction computes the same CRC-32C, 8 bytes at a time
+TARGET_SSE42 uint32_t crc32cHardware(const unsigned char* data, size_t bytes, uint32_t crc) {
+    size_t i = 0;
+#if defined(__x86_64__)
+    uint64_t wide = crc;
+    for (; i + 8 <= bytes; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, sizeof(word));
+        wide = _mm_crc32_u64(wide, word);
+    }
+    crc = static_cast<uint32_t>(wide);
+#endif
+    for (; i < bytes; ++i)
+        crc = _mm_crc32_u8(crc, data[i]);
+    return crc;
+}
+#endif
+
+}
+
+uint32_t crc32c(const void* data, size_t bytes, uint32_t crc) {
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+#ifdef MATRIX_KERNELS_X86
+    // Every AVX2-capable CPU has SSE4.2
+    if (MatrixKernels::detectedIsa() >= MatrixKernels::Isa::AVX2) {
+        return ~crc32cHardware(p, bytes, crc);
+    }
+#endif
+    return ~crc32cScalar(p, bytes, crc);
+}
+
+namespace {
+
+// CRC of a file image with the header's checksum field taken as zero
+uint32_t imageChecksum(const unsigned char* image, size_t bytes) {
+    const size_t field = offsetof(FileHeader, checksum);
+    const uint32_t zero = 0;
+    uint32_t crc = crc32c(image, field);
+    crc = crc32c(&zero, sizeof(zero), crc);
+    return crc32c(image + field + sizeof(zero), bytes - field - sizeof(zero), crc);
+}
+
+}
+
+bool hasMagic(const void* firstBytes) {
+    uint32_t magic;
+    std::memcpy(&magic, firstBytes, sizeof(magic));
+    return magic == MAGIC;
+}
+
+void buildImage(const std::vector<LayerBlock>& layers, std::vector<unsigned char>& image) {
+    // Lay out every block first so the image can be built in one buffer
+    size_t dataOffset = alignUp(sizeof(FileHeader) + layers.size() * sizeof(LayerEntry));
+    std::vector<LayerEntry> entries(layers.size());
+    size_t offset = dataOffset;
+    for (size_t l = 0; l < layers.size(); ++l) {
+        LayerEntry& entry = entries[l];
+        entry.inputs = layers[l].inputs;
+        entry.outputs = layers[l].outputs;
+        entry.activation = static_cast<int32_t>(layers[l].activation);
+        entry.reserved = 0;
+        entry.weightsOffset = offset;
+        offset = alignUp(offset + sizeof(float) * static_cast<size_t>(entry.inputs) * entry.outputs);
+        entry.biasesOffset = offset;
+        offset = alignUp(offset + sizeof(float) * static_cast<size_t>(entry.outputs));
+    }
+
+    image.assign(offset, 0);
+    FileHeader header = {};
+    header.magic = MAGIC;
+    header.version = VERSION;
+    header.dataType = static_cast<uint32_t>(DataType::Float32);
+    header.layerCount = static_cast<uint32_t>(layers.size());
+    header.dataOffset = static_cast<uint32_t>(dataOffset);
+    header.fileBytes = image.size();
+    std::memcpy(image.data(), &header, sizeof(header));
+    std::memcpy(image.data() + sizeof(header), entries.data(), entries.size() * sizeof(LayerEntry));
+    for (size_t l = 0; l < layers.size(); ++l) {
+        std::memcpy(image.data() + entries[l].weightsOffset, layers[l].weights,
+                    sizeof(float) * static_cast<size_t>(layers[l].inputs) * layers[l].outputs);
+        std::memcpy(image.data() + entries[l].biasesOffset, layers[l].biases, sizeof(float) * layers[l].outputs);
+    }
+
+    header.checksum = imageChecksum(image.data(), image.size());
+    std::memcpy(image.data() + offsetof(FileHeader, checksum), &header.checksum, sizeof(header.checksum));
+}
+
+bool writeImage(const std::string& filename, const std::vector<unsigned char>& image) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(image.data()), image.size());
+    return static_cast<bool>(file);
+}
+
+bool writeFile(const std::string& filename, const std::vector<LayerBlock>& layers) {
+    std::vector<unsigned char> image;
+    buildImage(layers, image);
+    return writeImage(filename, image);
+}
+
+bool readFile(const std::string& filename, std::vector<unsigned char>& image) {
+    std::ifstream file(filename, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::streamoff size = file.tellg();
+    if (size < 0) {
+        return false;
+    }
+    image.resize(static_cast<size_t>(size));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(image.data()), size);
+    return static_cast<bool>(file);
+}
+
+bool load(const std::string& filename, std::vector<unsigned char>& image, std::vector<LayerBlock>& blocks,
+          bool& hasActivations, std::string& error) {
+    if (!readFile(filename, image)) {
+        error = "Could not open file for reading: " + filename;
+        return false;
+    }
+    hasActivations = true;
+    bool parsed = image.size() >= sizeof(MAGIC) && hasMagic(image.data())
+                      ? parse(image.data(), image.size(), true, blocks, error)
+                      : parseVersion1(image.data(), image.size(), blocks, hasActivations, error);
+    if (!parsed) {
+        error = filename + ": " + error;
+    }
+    return parsed;
+}
+
+bool parse(const unsigned char* image, size_t bytes, bool verifyChecksum, std::vector<LayerBlock>& layers,
+           std::string& error) {
+    FileHeader header;
+    if (bytes < sizeof(header)) {
+        error = "file is too short for a model header";
+        return false;
+    }
+    std::memcpy(&header, image, sizeof(header));
+    if (header.magic != MAGIC) {
+        error = "not a version 2 model file";
+        return false;
+    }
+    if (header.version != VERSION) {
+        error = "unsupported model file version " + std::to_string(header.version);
+        return false;
+    }
+    if (header.dataType != static_cast<uint32_t>(DataType::Float32)) {
+        error = "unsupported weight data type " + std::to_string(header.dataType);
+        return false;
+    }
+    if (header.fileBytes != bytes) {
+        error = "file is " + std::to_string(bytes) + " bytes but the header says " + std::to_string(header.fileBytes) +
+                " (truncated?)";
+        return false;
+    }
+    if (header.layerCount == 0 || header.dataOffset > bytes ||
+        header.dataOffset < sizeof(FileHeader) + static_cast<size_t>(header.layerCount) * sizeof(LayerEntry)) {
+        error = "corrupt layer table";
+        return false;
+    }
+    if (verifyChecksum && imageChecksum(image, bytes) != header.checksum) {
+        error = "checksum mismatch (corrupt file)";
+        return false;
+    }
+
+    std::vector<LayerBlock> parsed(header.layerCount);
+    for (uint32_t l = 0; l < header.layerCount; ++l) {
+        LayerEntry entry;
+        std::memcpy(&entry, image + sizeof(FileHeader) + l * sizeof(LayerEntry), sizeof(entry));
+
+        uint64_t weightBytes = sizeof(float) * static_cast<uint64_t>(entry.inputs) * static_cast<uint64_t>(entry.outputs);
+        uint64_t biasBytes = sizeof(float) * static_cast<uint64_t>(entry.outputs);
+        bool valid = entry.inputs > 0 && entry.outputs > 0 && Activations::isValid(entry.activation) &&
+                     entry.weightsOffset % ALIGNMENT == 0 && entry.biasesOffset % ALIGNMENT == 0 &&
+                     entry.weightsOffset >= header.dataOffset && entry.biasesOffset >= header.dataOffset &&
+                     entry.weightsOffset <= bytes && weightBytes <= bytes - entry.weightsOffset &&
+                     entry.biasesOffset <= bytes && biasBytes <= bytes - entry.biasesOffset;
+        if (!valid) {
+            error = "corrupt entry for layer " + std::to_string(l);
+            return false;
+        }
+        if (l > 0 && entry.inputs != parsed[l - 1].outputs) {
+            error = "layer " + std::to_string(l) + " input size does not match the previous layer";
+            return false;
+        }
+
+        parsed[l].inputs = entry.inputs;
+        parsed[l].outputs = entry.outputs;
+        parsed[l].activation = static_cast<Activations::Type>(entry.activation);
+        parsed[l].weights = reinterpret_cast<const float*>(image + entry.weightsOffset);
+        parsed[l].biases = reinterpret_cast<const float*>(image + entry.biasesOffset);
+    }
+
+    layers = std::move(parsed);
+    return true;
+}
+
+bool parseVersion1(const unsigned char* image, size_t bytes, std::vector<LayerBlock>& layers, bool& hasActivations,
+                   std::string& error) {
+    size_t position = 0;
+    auto readInt = [&](int32_t& value) {
+        if (bytes - position < sizeof(value)) {
+            return false;
+        }
+        std::memcpy(&value, image + position, sizeof(value));
+        position += sizeof(value);
+        return true;
+    };
+    // Returns the block's position and skips past it, or null if the file ends first
+    auto takeFloats = [&](size_t count) -> const float* {
+        if ((bytes - position) / sizeof(float) < count) {
+            return nullptr;
+        }
+        const float* block = reinterpret_cast<const float*>(image + position);
+        position += count * sizeof(float);
+        return block;
+    };
+
+    int32_t layerCount = 0;
+    if (!readInt(layerCount) || layerCount <= 0 || static_cast<size_t>(layerCount) > bytes / 16) {
+        error = "not a model file";
+        return false;
+    }
+
+    std::vector<LayerBlock> parsed(layerCount);
+    for (int32_t l = 0; l < layerCount; ++l) {
+        int32_t weightRows = 0, weightCols = 0, biasRows = 0, biasCols = 0;
+        const float* weights = nullptr;
+        const float* biases = nullptr;
+        bool complete = readInt(weightRows) && readInt(weightCols) && weightRows > 0 && weightCols > 0 &&
+                        (weights = takeFloats(static_cast<size_t>(weightRows) * weightCols)) != nullptr &&
+                        readInt(biasRows) && readInt(biasCols) && biasRows == 1 && biasCols == weightCols &&
+                        (biases = takeFloats(static_cast<size_t>(biasCols))) != nullptr;
+        if (!complete) {
+            error = "layer " + std::to_string(l) + " is truncated or has inconsistent shapes";
+            return false;
+        }
+        if (l > 0 && weightRows != parsed[l - 1].outputs) {
+            error = "layer " + std::to_string(l) + " input size does not match the previous layer";
+            return false;
+        }
+        parsed[l] = {weightRows, weightCols, Activations::Type::Sigmoid, weights, biases};
+    }
+
+    // Optional activation section; older files end after the last layer
+    int32_t tag = 0;
+    hasActivations = readInt(tag) && tag == VERSION1_ACTIVATION_TAG;
+    if (hasActivations) {
+        for (int32_t l = 0; l < layerCount; ++l) {
+            int32_t code = -1;
+            if (!readInt(code) || !Activations::isValid(code)) {
+                error = "invalid activation for layer " + std::to_string(l);
+                return false;
+            }
+            parsed[l].activation = static_cast<Activations::Type>(code);
+        }
+    }
+
+    layers = std::move(parsed);
+    return true;
+}
+
+bool writeVersion1File(const std::string& filename, const std::vector<LayerBlock>& layers) {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    auto writeInt = [&](int32_t value) { file.write(reinterpret_cast<const char*>(&value), sizeof(value)); };
+
+    writeInt(static_cast<int32_t>(layers.size()));
+    for (const auto& layer : layers) {
+        writeInt(layer.inputs);
+        writeInt(layer.outputs);
+        file.write(reinterpret_cast<const char*>(layer.weights), sizeof(float) * static_cast<size_t>(layer.inputs) * layer.outputs);
+        writeInt(1);
+        writeInt(layer.outputs);
+        file.write(reinterpret_cast<const char*>(layer.biases), sizeof(float) * layer.outputs);
+    }
+    writeInt(VERSION1_ACTIVATION_TAG);
+    for (const auto& layer : layers)
+        writeInt(static_cast<int32_t>(layer.activation));
+    return static_cast<bool>(file);
+}
+
+}
@@ -1,84 +1,280 @@
 #include "NeuralNetwork.h"
+#include "MatrixExpr.h"
+#include "Optimizer.h"
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
-// Derivative of sigmoid
-static float dsigmoid(float y) {
-    return y * (1.0f - y);
+using MatrixExpr::lazy;
+
+static std::vector<Activations::Type> defaultActivations(size_t layerCount) {
+    // Use tanh for output layer (last layer), sigmoid for hidden layers
+    std::vector<Activations::Type> activations(layerCount, Activations::Type::Sigmoid);
+    if (layerCount > 0) {
+        activations.back() = Activations::Type::Tanh;
+    }
+    return activations;
 }
 
-// Derivative of tanh
-static float dtanh(float y) {
-    return 1.0f - y * y;
+NeuralNetwork::NeuralNetwork(const std::vector<int>& sizes)
+    : NeuralNetwork(sizes, defaultActivations(sizes.empty() ? 0 : sizes.size() - 1)) {
 }
 
-NeuralNetwork::NeuralNetwork(const std::vector<int>& sizes) {
+NeuralNetwork::NeuralNetwork(const std::vector<int>& sizes, const std::vector<Activations::Type>& activations) {
     for (size_t i = 1; i < sizes.size(); ++i) {
-        // Use tanh for output layer (last layer), sigmoid for hidden layers
-        bool isOutputLayer = (i == sizes.size() - 1);
-        layers.emplace_back(sizes[i - 1], sizes[i], isOutputLayer);
+        layers.emplace_back(sizes[i - 1], sizes[i], activations[i - 1]);
     }
+    reserveWorkspace(1);
+}
+
+void NeuralNetwork::reserveWorkspace(int batchRows) {
+    sizeWorkspace(workspace, batchRows);
+}
+
+void NeuralNetwork::sizeWorkspace(TrainingWorkspace& ws, int batchRows) const {
+    if (layers.empty() || batchRows <= ws.capacityRows) {
+        return;
+    }
+
+    // Matrix::resize keeps the buffer when later shapes are smaller, so sizing
+    // each buffer for its largest shape once is enough
+    int widest = inputSize();
+    ws.activations.resize(layers.size() + 1);
+    ws.activations[0].resize(batchRows, inputSize());
+    for (size_t l = 0; l < layers.size(); ++l) {
+        ws.activations[l + 1].resize(batchRows, layers[l].weights.cols);
+        widest = std::max(widest, layers[l].weights.cols);
+    }
+    ws.error.resize(batchRows, widest);
+    ws.gradient.resize(batchRows, widest);
+    ws.targets.resize(batchRows, outputSize());
+    ws.capacityRows = batchRows;
 }
 
 Matrix NeuralNetwork::predict(const Matrix& input) const {
-    Matrix out = input;
+    Matrix result(input.rows, outputSize());
+    predictBatch(input.data(), input.rows, result.data());
+    return result;
+}
+
+NeuralNetwork::Scratch& NeuralNetwork::threadScratch() {
+    thread_local Scratch scratch;
+    return scratch;
+}
+
+void NeuralNetwork::predictInto(const float* input, float* output, Scratch& scratch) const {
+    size_t widest = 0;
     for (const auto& layer : layers)
-        out = layer.forward(out);
-    return out;
+        widest = std::max(widest, static_cast<size_t>(layer.weights.cols));
+    if (scratch.front.size() < widest) {
+        scratch.front.resize(widest);
+        scratch.back.resize(widest);
+    }
+
+    // Hidden layers ping-pong between the scratch buffers; the last one writes straight to output
+    const float* current = input;
+    float* buffers[2] = {scratch.front.data(), scratch.back.data()};
+    for (size_t l = 0; l < layers.size(); ++l) {
+        float* next = (l + 1 == layers.size()) ? output : buffers[l % 2];
+        layers[l].forwardInto(current, next);
+        current = next;
+    }
 }
 
-void NeuralNetwork::train(const Matrix& input, const Matrix& target, float learningRate) {
-    // Forward pass through all layers and store outputs
-    std::vector<Matrix> layerOutputs;
-    layerOutputs.push_back(input);
+void NeuralNetwork::predictBatch(const float* states, size_t n, float* actions, Scratch& scratch) const {
+    if (n == 1) {
+        predictInto(states, actions, scratch);
+        return;
+    }
+
+    size_t chunkRows = std::min(n, static_cast<size_t>(BATCH_CHUNK_ROWS));
+    size_t widest = 0;
+    for (const auto& layer : layers)
+        widest = std::max(widest, static_cast<size_t>(layer.weights.cols));
+    if (scratch.front.size() < chunkRows * widest) {
+        scratch.front.resize(chunkRows * widest);
+        scratch.back.resize(chunkRows * widest);
+    }
 
-    Matrix currentOutput = input;
-    for (auto& layer : layers) {
-        currentOutput = layer.forward(currentOutput);
-        layerOutputs.push_back(currentOutput);
+    // Same ping-pong as predictInto, one chunk of rows at a time
+    float* buffers[2] = {scratch.front.data(), scratch.back.data()};
+    for (size_t first = 0; first < n; first += chunkRows) {
+        int rows = static_cast<int>(std::min(chunkRows, n - first));
+        const float* current = states + first * inputSize();
+        for (size_t l = 0; l < layers.size(); ++l) {
+            float* next = (l + 1 == layers.size()) ? actions + first * outputSize() : buffers[l % 2];
+            layers[l].forwardRows(current, rows, next);
+            current = next;
+        }
     }
+}
+
+void NeuralNetwork::train(const Matrix& input, const Matrix& target, float learningRate) {
+    reserveWorkspace(input.rows);
+    std::vector<Matrix>& layerOutputs = workspace.activations;
+    Matrix& error = workspace.error;
+    Matrix& gradient = workspace.gradient;
 
-    // Backward pass through all layers
+    // Forward pass through all layers, keeping every layer's output
+    layerOutputs[0] = input;
     int numLayers = layers.size();
+    for (int l = 0; l < numLayers; ++l)
+        layers[l].forward(layerOutputs[l], layerOutputs[l + 1]);
 
     // Error at output layer
-    Matrix error(target.rows, target.cols);
-    for (int i = 0; i < target.rows; ++i)
-        for (int j = 0; j < target.cols; ++j)
-            error.data[i][j] = target.data[i][j] - layerOutputs[numLayers].data[i][j];
+    error = target - lazy(layerOutputs[numLayers]);
 
     // Backpropagate through layers in reverse
     for (int l = numLayers - 1; l >= 0; --l) {
-        // Gradient for current layer - use correct derivative based on activation
-        Matrix gradient = layers[l].useTanh
-            ? layerOutputs[l + 1].apply(dtanh)
-            : layerOutputs[l + 1].apply(dsigmoid);
-        for (int i = 0; i < gradient.rows; ++i)
+        // Gradient for current layer: scaled error times the layer's activation derivative
+        gradient = lazy(error) * learningRate;
+        Activations::backward(layers[l].activation, layerOutputs[l + 1].data(), gradient.data(), gradient.size());
+
+        // Update weights with the rank-1 product input^T * gradient, and biases, in place
+        layers[l].weights.rankUpdate(layerOutputs[l], gradient);
+        layers[l].biases += lazy(gradient);
+        layers[l].packWeights();
+
+        // Compute error for previous layer (gradient * weights^T) if not input layer
+        if (l > 0) {
+            gradient.dotTransBInto(layers[l].weights, error);
+        }
+    }
+}
+
+float NeuralNetwork::forwardBatch(const TrainingExample* examples, size_t count, TrainingWorkspace& ws) const {
+    int rows = 0;
+    for (size_t e = 0; e < count; ++e)
+        rows += examples[e].input.rows;
+    sizeWorkspace(ws, rows);
+    std::vector<Matrix>& layerOutputs = ws.activations;
+
+    // Stack the batch into one B x inputs matrix (and B x outputs targets)
+    layerOutputs[0].resize(rows, inputSize());
+    ws.targets.resize(rows, outputSize());
+    int row = 0;
+    for (size_t e = 0; e < count; ++e) {
+        const TrainingExample& example = examples[e];
+        for (int i = 0; i < example.input.rows; ++i, ++row) {
+            std::copy(example.input.row(i).begin(), example.input.row(i).end(), layerOutputs[0].row(row).begin());
+            std::copy(example.target.row(i).begin(), example.target.row(i).end(), ws.targets.row(row).begin());
+        }
+    }
+
+    // Forward pass: one GEMM per layer for the whole batch
+    int numLayers = layers.size();
+    for (int l = 0; l < numLayers; ++l)
+        layers[l].forward(layerOutputs[l], layerOutputs[l + 1]);
+
+    // Loss from the activations we already have
+    ws.error = ws.targets - lazy(layerOutputs[numLayers]);
+    float totalLoss = 0.0f;
+    for (int i = 0; i < ws.error.size(); ++i)
+        totalLoss += ws.error.data()[i] * ws.error.data()[i];
+    return totalLoss;
+}
+
+float NeuralNetwork::trainBatch(const std::vector<TrainingExample>& batch, float learningRate) {
+    if (batch.empty()) {
+        return 0.0f;
+    }
+    if (batchMode == BatchMode::PerSample) {
+        return trainPerSample(batch, learningRate);
+    }
+
+    float totalLoss = forwardBatch(batch.data(), batch.size(), workspace);
+    std::vector<Matrix>& layerOutputs = workspace.activations;
+    Matrix& error = workspace.error;
+    Matrix& gradient = workspace.gradient;
+
+    // Backward pass with the gradient averaged over the batch. Each layer's
+    // error is propagated with its weights from before this update.
+    float stepSize = learningRate / layerOutputs[0].rows;
+    for (int l = static_cast<int>(layers.size()) - 1; l >= 0; --l) {
+        gradient = lazy(error) * stepSize;
+        Activations::backward(layers[l].activation, layerOutputs[l + 1].data(), gradient.data(), gradient.size());
+
+        if (l > 0) {
+            gradient.dotTransBInto(layers[l].weights, error);
+        }
+
+        // weights += input^T * gradient sums every row's rank-1 update in one GEMM
+        layers[l].weights.rankUpdate(layerOutputs[l], gradient);
+        float* bias = layers[l].biases.data();
+        for (int i = 0; i < gradient.rows; ++i) {
+            const float* gradientRow = gradient.row(i).begin();
             for (int j = 0; j < gradient.cols; ++j)
-                gradient.data[i][j] *= error.data[i][j] * learningRate;
+                bias[j] += gradientRow[j];
+        }
+        layers[l].packWeights();
+    }
+
+    return totalLoss / batch.size();
+}
 
-        // Delta weights
-        Matrix inputT = layerOutputs[l].transpose();
-        Matrix delta = inputT.dot(gradient);
+float NeuralNetwork::trainBatch(const std::vector<TrainingExample>& batch, Optimizer& optimizer) {
+    if (optimizer.settings().type == Optimizer::Type::SGD) {
+        return trainBatch(batch, optimizer.settings().learningRate);
+    }
+    if (batch.empty()) {
+        return 0.0f;
+    }
+
+    int rows = 0;
+    for (const auto& example : batch)
+        rows += example.input.rows;
+    float totalLoss = computeGradients(batch.data(), batch.size(), 1.0f / rows, workspace, batchGradients);
+    optimizer.step(*this, batchGradients);
+    return totalLoss / batch.size();
+}
 
-        // Update weights and biases
-        for (int i = 0; i < layers[l].weights.rows; ++i)
-            for (int j = 0; j < layers[l].weights.cols; ++j)
-                layers[l].weights.data[i][j] += delta.data[i][j];
+float NeuralNetwork::computeGradients(const TrainingExample* examples, size_t count, float stepSize,
+                                      TrainingWorkspace& ws, Gradients& gradients) const {
+    gradients.weights.resize(layers.size());
+    gradients.biases.resize(layers.size());
+    for (size_t l = 0; l < layers.size(); ++l) {
+        gradients.weights[l].resize(layers[l].weights.rows, layers[l].weights.cols);
+        gradients.biases[l].resize(1, layers[l].weights.cols);
+    }
+    if (count == 0) {
+        return 0.0f;
+    }
 
-        for (int j = 0; j < layers[l].biases.cols; ++j)
-            layers[l].biases.data[0][j] += gradient.data[0][j];
+    // The same backward pass as trainBatch, accumulated into gradients instead of the weights
+    float totalLoss = forwardBatch(examples, count, ws);
+    for (int l = static_cast<int>(layers.size()) - 1; l >= 0; --l) {
+        ws.gradient = lazy(ws.error) * stepSize;
+        Activations::backward(layers[l].activation, ws.activations[l + 1].data(), ws.gradient.data(),
+                              ws.gradient.size());
 
-        // Compute error for previous layer if not input layer
         if (l > 0) {
-            Matrix weightsT = layers[l].weights.transpose();
-            error = gradient.dot(weightsT);
+            ws.gradient.dotTransBInto(layers[l].weights, ws.error);
+        }
+
+        gradients.weights[l].rankUpdate(ws.activations[l], ws.gradient);
+        float* bias = gradients.biases[l].data();
+        for (int i = 0; i < ws.gradient.rows; ++i) {
+            const float* gradientRow = ws.gradient.row(i).begin();
+            for (int j = 0; j < ws.gradient.cols; ++j)
+                bias[j] += gradientRow[j];
         }
     }
+    return totalLoss;
 }
 
-float NeuralNetwork::trainBatch(const std::vector<TrainingExample>& batch, float learningRate) {
+void NeuralNetwork::applyGradients(const Gradients& gradients, bool repack) {
+    for (size_t l = 0; l < layers.size(); ++l) {
+        layers[l].weights += lazy(gradients.weights[l]);
+        layers[l].biases += lazy(gradients.biases[l]);
+        if (repack) {
+            layers[l].packWeights();
+        }
+    }
+}
+
+float NeuralNetwork::trainPerSample(const std::vector<TrainingExample>& batch, float learningRate) {
     float totalLoss = 0.0f;
 
     // Train on each example in the batch
@@ -89,7 +285,7 @@ float NeuralNetwork::trainBatch(const std::vector<TrainingExample>& batch, float
         Matrix prediction = predict(example.input);
         for (int i = 0; i < example.target.rows; ++i) {
             for (int j = 0; j < example.target.cols; ++j) {
-                float error = example.target.data[i][j] - prediction.data[i][j];
+                float error = example.target(i, j) - prediction(i, j);
                 totalLoss += error * error;
             }
         }
@@ -100,66 +296,65 @@ float NeuralNetwork::trainBatch(const std::vector<TrainingExample>& batch, float
 }
 
 float NeuralNetwork::calculateLoss(const std::vector<TrainingExample>& examples) const {
-    float totalLoss = 0.0f;
     int totalOutputs = 0;
+    for (const auto& example : examples)
+        totalOutputs += example.target.size();
+    return totalOutputs > 0 ? totalSquaredError(examples.data(), examples.size()) / totalOutputs : 0.0f;
+}
 
-    for (const auto& example : examples) {
-        Matrix prediction = predict(example.input);
-        for (int i = 0; i < example.target.rows; ++i) {
-            for (int j = 0; j < example.target.cols; ++j) {
-                float error = example.target.data[i][j] - prediction.data[i][j];
-                totalLoss += error * error;
-                totalOutputs++;
-            }
-        }
+float NeuralNetwork::totalSquaredError(const TrainingExample* examples, size_t count) const {
+    // Stack every example row into one contiguous batch
+    Scratch& scratch = threadScratch();
+    size_t rows = 0;
+    for (size_t e = 0; e < count; ++e)
+        rows += examples[e].input.rows;
+    if (rows == 0) {
+        return 0.0f;
+    }
+    if (scratch.states.size() < rows * inputSize()) {
+        scratch.states.resize(rows * inputSize());
+    }
+    if (scratch.actions.size() < rows * outputSize()) {
+        scratch.actions.resize(rows * outputSize());
     }
 
-    return totalOutputs > 0 ? totalLoss / totalOutputs : 0.0f;
-}
-
-bool NeuralNetwork::saveModel(const std::string& filename, bool verbose) const {
-    std::ofstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
-        if (verbose) {
-            std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
-        }
-        return false;
+    float* state = scratch.states.data();
+    for (size_t e = 0; e < count; ++e) {
+        std::copy_n(examples[e].input.data(), examples[e].input.size(), state);
+        state += examples[e].input.size();
     }
+    predictBatch(scratch.states.data(), rows, scratch.actions.data(), scratch);
 
-    // Save number of layers
-    int numLayers = layers.size();
-    file.write(reinterpret_cast<char*>(&numLayers), sizeof(numLayers));
-
-    // Save each layer's weights and biases
-    for (const auto& layer : layers) {
-        // Save weights
-        int weightRows = layer.weights.rows;
-        int weightCols = layer.weights.cols;
-        file.write(reinterpret_cast<char*>(&weightRows), sizeof(weightRows));
-        file.write(reinterpret_cast<char*>(&weightCols), sizeof(weightCols));
-
-        for (int i = 0; i < weightRows; ++i) {
-            for (int j = 0; j < weightCols; ++j) {
-                float val = layer.weights.data[i][j];
-                file.write(reinterpret_cast<char*>(&val), sizeof(val));
-            }
+    float totalLoss = 0.0f;
+    const float* prediction = scratch.actions.data();
+    for (size_t e = 0; e < count; ++e) {
+        const Matrix& target = examples[e].target;
+        for (int i = 0; i < target.size(); ++i) {
+            float error = target.data()[i] - prediction[i];
+            totalLoss += error * error;
         }
+        prediction += target.size();
+    }
+    return totalLoss;
+}
 
-        // Save biases
-        int biasRows = layer.biases.rows;
-        int biasCols = layer.biases.cols;
-        file.write(reinterpret_cast<char*>(&biasRows), sizeof(biasRows));
-        file.write(reinterpret_cast<char*>(&biasCols), sizeof(biasCols));
+std::vector<ModelFormat::LayerBlock> NeuralNetwork::layerBlocks() const {
+    std::vector<ModelFormat::LayerBlock> blocks;
+    for (const auto& layer : layers)
+        blocks.push_back({layer.weights.rows, layer.weights.cols, layer.activation, layer.weights.data(),
+                          layer.biases.data()});
+    return blocks;
+}
 
-        for (int i = 0; i < biasRows; ++i) {
-            for (int j = 0; j < biasCols; ++j) {
-                float val = layer.biases.data[i][j];
-                file.write(reinterpret_cast<char*>(&val), sizeof(val));
-            }
+bool NeuralNetwork::saveModel(const std::string& filename, bool verbose, int version) const {
+    bool written = version == 1 ? ModelFormat::writeVersion1File(filename, layerBlocks())
+                                : ModelFormat::writeFile(filename, layerBlocks());
+    if (!written) {
+        if (verbose) {
+            std::cerr << "Error: Could not write model file: " << filename << std::endl;
         }
+        return false;
     }
-
-    file.close();
     if (verbose) {
         std::cout << "Model saved to: " << filename << std::endl;
     }
@@ -167,104 +362,96 @@ bool NeuralNetwork::saveModel(const std::string& filename, bool verbose) const {
 }
 
 bool NeuralNetwork::loadModel(const std::string& filename, bool verbose) {
-    std::ifstream file(filename, std::ios::binary);
-    if (!file.is_open()) {
+    // Either format is read with one bulk read and fully validated before
+    // anything is copied, so a bad file leaves this network untouched
+    std::vector<unsigned char> image;
+    std::vector<ModelFormat::LayerBlock> blocks;
+    bool hasActivations;
+    std::string error;
+    if (!ModelFormat::load(filename, image, blocks, hasActivations, error)) {
         if (verbose) {
-            std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+            std::cerr << "Error: " << error << std::endl;
         }
         return false;
     }
 
-    // Load number of layers
-    int numLayers;
-    file.read(reinterpret_cast<char*>(&numLayers), sizeof(numLayers));
-
-    if (numLayers != layers.size()) {
+    if (blocks.size() != layers.size()) {
         if (verbose) {
-            std::cerr << "Error: Model file has " << numLayers << " layers but network has "
+            std::cerr << "Error: Model file has " << blocks.size() << " layers but network has "
                       << layers.size() << " layers" << std::endl;
         }
-        file.close();
         return false;
     }
-
-    // Load each layer's weights and biases
-    for (auto& layer : layers) {
-        // Load weights
-        int weightRows, weightCols;
-        file.read(reinterpret_cast<char*>(&weightRows), sizeof(weightRows));
-        file.read(reinterpret_cast<char*>(&weightCols), sizeof(weightCols));
-
-        if (weightRows != layer.weights.rows || weightCols != layer.weights.cols) {
+    for (size_t l = 0; l < layers.size(); ++l) {
+        if (blocks[l].inputs != layers[l].weights.rows || blocks[l].outputs != layers[l].weights.cols) {
             if (verbose) {
                 std::cerr << "Error: Weight dimensions mismatch" << std::endl;
             }
-            file.close();
             return false;
         }
+    }
 
-        for (int i = 0; i < weightRows; ++i) {
-            for (int j = 0; j < weightCols; ++j) {
-                float val;
-                file.read(reinterpret_cast<char*>(&val), sizeof(val));
-                layer.weights.data[i][j] = val;
-            }
+    for (size_t l = 0; l < layers.size(); ++l) {
+        std::memcpy(layers[l].weights.data(), blocks[l].weights, sizeof(float) * layers[l].weights.size());
+        std::memcpy(layers[l].biases.data(), blocks[l].biases, sizeof(float) * layers[l].biases.size());
+        if (hasActivations) {
+            layers[l].activation = blocks[l].activation;
         }
+        layers[l].packWeights();
+    }
 
-        // Load biases
-        int biasRows, biasCols;
-        file.read(reinterpret_cast<char*>(&biasRows), sizeof(biasRows));
-        file.read(reinterpret_cast<char*>(&biasCols), sizeof(biasCols));
+    if (verbose) {
+        std::cout << "Model loaded from: " << filename << std::endl;
+    }
+    return true;
+}
 
-        if (biasRows != layer.biases.rows || biasCols != layer.biases.cols) {
-            if (verbose) {
-                std::cerr << "Error: Bias dimensions mismatch" << std::endl;
-            }
-            file.close();
+bool NeuralNetwork::copyParametersFrom(const NeuralNetwork& other) {
+    if (layers.size() != other.layers.size()) {
+        std::cerr << "Error: Cannot copy between networks with different layer counts" << std::endl;
+        return false;
+    }
+    for (size_t l = 0; l < layers.size(); ++l) {
+        if (layers[l].weights.rows != other.layers[l].weights.rows ||
+            layers[l].weights.cols != other.layers[l].weights.cols) {
+            std::cerr << "Error: Layer " << l << " dimensions mismatch" << std::endl;
             return false;
         }
-
-        for (int i = 0; i < biasRows; ++i) {
-            for (int j = 0; j < biasCols; ++j) {
-                float val;
-                file.read(reinterpret_cast<char*>(&val), sizeof(val));
-                layer.biases.data[i][j] = val;
-            }
-        }
     }
 
-    file.close();
-    if (verbose) {
-        std::cout << "Model loaded from: " << filename << std::endl;
+    for (size_t l = 0; l < layers.size(); ++l) {
+        Layer& layer = layers[l];
+        const Layer& source = other.layers[l];
+        std::copy_n(source.weights.data(), source.weights.size(), layer.weights.data());
+        std::copy_n(source.biases.data(), source.biases.size(), layer.biases.data());
+        layer.activation = source.activation;
+        // The panels are a pure function of the weights, so copying them saves repacking
+        layer.packedWeights.K = source.packedWeights.K;
+        layer.packedWeights.N = source.packedWeights.N;
+        layer.packedWeights.width = source.packedWeights.width;
+        layer.packedWeights.data.assign(source.packedWeights.data.begin(), source.packedWeights.data.end());
     }
     return true;
 }
 
+void NeuralNetwork::blendParameters(float* target, const float* other, size_t count, float blendRatio) {
+    // target = target * (1 - ratio) + other * ratio
+    for (size_t i = 0; i < count; ++i)
+        target[i] = target[i] * (1.0f - blendRatio) + other[i] * blendRatio;
+}
+
 void NeuralNetwork::blendWeights(const NeuralNetwork& other, float blendRatio) {
-    // Blend weights: this = this * (1 - ratio) + other * ratio
     if (layers.size() != other.layers.size()) {
         std::cerr << "Error: Cannot blend networks with different layer counts" << std::endl;
         return;
     }
 
     for (size_t l = 0; l < layers.size(); ++l) {
-        // Blend weights
-        for (int i = 0; i < layers[l].weights.rows; ++i) {
-            for (int j = 0; j < layers[l].weights.cols; ++j) {
-                layers[l].weights.data[i][j] =
-                    layers[l].weights.data[i][j] * (1.0f - blendRatio) +
-                    other.layers[l].weights.data[i][j] * blendRatio;
-            }
-        }
-
-        // Blend biases
-        for (int i = 0; i < layers[l].biases.rows; ++i) {
-            for (int j = 0; j < layers[l].biases.cols; ++j) {
-                layers[l].biases.data[i][j] =
-                    layers[l].biases.data[i][j] * (1.0f - blendRatio) +
-                    other.layers[l].biases.data[i][j] * blendRatio;
-            }
-        }
+        blendParameters(layers[l].weights.data(), other.layers[l].weights.data(), layers[l].weights.size(),
+                        blendRatio);
+        blendParameters(layers[l].biases.data(), other.layers[l].biases.data(), layers[l].biases.size(),
+                        blendRatio);
+        layers[l].packWeights();
     }
 }
 
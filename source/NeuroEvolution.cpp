@@ -0,0 +1,364 @@
+#include "NeuroEvolution.h"
+#include "AsyncFileWriter.h"
+#include "GameLogic.h"
+#include "MatrixKernels.h"
+#include "VecSimulation.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <conio.h>
+
+namespace {
+
+// Floats per 64-byte block, the alignment of every layer block in a member
+const size_t BLOCK_FLOATS = ModelFormat::ALIGNMENT / sizeof(float);
+
+size_t alignFloats(size_t count) {
+    return (count + BLOCK_FLOATS - 1) / BLOCK_FLOATS * BLOCK_FLOATS;
+}
+
+// Key for the breeding streams, so they never coincide with episode streams
+const uint64_t BREEDING_KEY = 0xB5AD4ECEDA1CE2A9ULL;
+
+struct MemberScratch {
+    std::vector<float> front;
+    std::vector<float> back;
+};
+
+MemberScratch& threadScratch() {
+    thread_local MemberScratch scratch;
+    return scratch;
+}
+
+}
+
+void NeuroEvolution::Member::predictInto(const float* input, float* output) const {
+    MemberScratch& scratch = threadScratch();
+    if (scratch.front.size() < engine->widestLayer) {
+        scratch.front.resize(engine->widestLayer);
+        scratch.back.resize(engine->widestLayer);
+    }
+
+    // Same ping-pong scheme and kernels as NeuralNetwork::predictInto
+    const float* current = input;
+    float* buffers[2] = {scratch.front.data(), scratch.back.data()};
+    const std::vector<LayerLayout>& layers = engine->layout;
+    for (size_t l = 0; l < layers.size(); ++l) {
+        const LayerLayout& layer = layers[l];
+        float* next = (l + 1 == layers.size()) ? output : buffers[l % 2];
+        MatrixKernels::gemv(current, parameters + layer.weightsOffset, layer.outputs, next, layer.inputs,
+                            layer.outputs);
+        Activations::forward(layer.activation, next, parameters + layer.biasesOffset, layer.outputs);
+        current = next;
+    }
+}
+
+void NeuroEvolution::Member::predictBatch(const float* states, size_t n, float* actions) const {
+    if (n == 1) {
+        predictInto(states, actions);
+        return;
+    }
+
+    MemberScratch& scratch = threadScratch();
+    size_t chunkRows = std::min(n, static_cast<size_t>(NeuralNetwork::BATCH_CHUNK_ROWS));
+    if (scratch.front.size() < chunkRows * engine->widestLayer) {
+        scratch.front.resize(chunkRows * engine->widestLayer);
+        scratch.back.resize(chunkRows * engine->widestLayer);
+    }
+
+    // Same chunking and kernels as MappedNetwork::predictBatch
+    float* buffers[2] = {scratch.front.data(), scratch.back.data()};
+    const std::vector<LayerLayout>& layers = engine->layout;
+    size_t inputs = layers.front().inputs;
+    size_t outputs = layers.back().outputs;
+    for (size_t first = 0; first < n; first += chunkRows) {
+        int rows = static_cast<int>(std::min(chunkRows, n - first));
+        const float* current = states + first * inputs;
+        for (size_t l = 0; l < layers.size(); ++l) {
+            const LayerLayout& layer = layers[l];
+            const float* weights = parameters + layer.weightsOffset;
+            float* next = (l + 1 == layers.size()) ? actions + first * outputs : buffers[l % 2];
+            if (rows == 1) {
+                MatrixKernels::gemv(current, weights, layer.outputs, next, layer.inputs, layer.outputs);
+            } else {
+                MatrixKernels::gemm(current, layer.inputs, weights, layer.outputs, next, layer.outputs, rows,
+                                    layer.inputs, layer.outputs);
+            }
+            Activations::forwardRows(layer.activation, next, parameters + layer.biasesOffset, rows, layer.outputs);
+            current = next;
+        }
+    }
+}
+
+NeuroEvolution::NeuroEvolution(const NeuralNetwork& prototype, const Settings& settings, int workerCount)
+    : config(settings), bestEverFitness(std::numeric_limits<float>::max()), pool(workerCount) {
+    config.populationSize = std::max(2, config.populationSize);
+    config.eliteCount = std::max(0, std::min(config.eliteCount, config.populationSize - 1));
+    config.tournamentSize = std::max(1, config.tournamentSize);
+    config.episodesPerMember = std::max(1, config.episodesPerMember);
+
+    size_t offset = 0;
+    for (const auto& layer : prototype.layers) {
+        LayerLayout entry;
+        entry.inputs = layer.weights.rows;
+        entry.outputs = layer.weights.cols;
+        entry.activation = layer.activation;
+        entry.weightsOffset = offset;
+        offset = alignFloats(offset + static_cast<size_t>(entry.inputs) * entry.outputs);
+        entry.biasesOffset = offset;
+        offset = alignFloats(offset + entry.outputs);
+        layout.push_back(entry);
+        parameters += layer.weights.size() + layer.biases.size();
+        widestLayer = std::max(widestLayer, static_cast<size_t>(entry.outputs));
+    }
+    stride = offset;
+
+    // Padding stays zero, so whole members can be blended and copied as one block
+    size_t arenaFloats = stride * config.populationSize;
+    arena.assign(arenaFloats, 0.0f);
+    nextArena.assign(arenaFloats, 0.0f);
+    fitness.assign(config.populationSize, 0.0f);
+    wins.assign(config.populationSize, 0);
+    ranking.resize(config.populationSize);
+    bestParameters.assign(stride, 0.0f);
+
+    float* first = memberParameters(arena, 0);
+    for (size_t l = 0; l < layout.size(); ++l) {
+        const Layer& layer = prototype.layers[l];
+        std::copy_n(layer.weights.data(), layer.weights.size(), first + layout[l].weightsOffset);
+        std::copy_n(layer.biases.data(), layer.biases.size(), first + layout[l].biasesOffset);
+    }
+    for (int m = 1; m < config.populationSize; ++m) {
+        float* target = memberParameters(arena, m);
+        std::copy_n(first, stride, target);
+        CounterRng rng(config.seed ^ BREEDING_KEY, m);
+        mutate(target, rng);
+    }
+}
+
+NeuroEvolution::Member NeuroEvolution::member(int index) const {
+    Member view;
+    view.engine = this;
+    view.parameters = arena.data() + index * stride;
+    return view;
+}
+
+void NeuroEvolution::mutate(float* target, CounterRng& rng) const {
+    std::normal_distribution<float> perturbation(0.0f, config.mutationStrength);
+    for (const auto& layer : layout) {
+        float* weights = target + layer.weightsOffset;
+        for (int i = 0; i < layer.inputs * layer.outputs; ++i)
+            if (rng.uniform() < config.mutationRate) weights[i] += perturbation(rng);
+        float* biases = target + layer.biasesOffset;
+        for (int i = 0; i < layer.outputs; ++i)
+            if (rng.uniform() < config.mutationRate) biases[i] += perturbation(rng);
+    }
+}
+
+NeuroEvolution::GenerationStats NeuroEvolution::runGeneration() {
+    auto start = std::chrono::steady_clock::now();
+
+    // Members are independent and every episode is seeded, so the scores do not
+    // depend on which thread plays which member. All members play the same
+    // episodes of the run seed.
+    uint64_t firstEpisode = static_cast<uint64_t>(generationIndex) * config.episodesPerMember;
+    // A member's episodes are stepped together, one predictBatch per frame.
+    pool.parallelFor(config.populationSize, [&](int m) {
+        Member view = member(m);
+        std::vector<SimulationResult> results;
+        VecSimulation<Member> simulation(&view, config.maxFrames, config.episodesPerMember);
+        simulation.run(config.seed, firstEpisode, config.episodesPerMember, results);
+
+        float totalLoss = 0.0f;
+        int won = 0;
+        for (const SimulationResult& result : results) {
+            totalLoss += result.totalLoss;
+            if (result.won) won++;
+        }
+        fitness[m] = totalLoss / config.episodesPerMember;
+        wins[m] = won;
+    });
+
+    GenerationStats stats;
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    stats.episodes = config.populationSize * config.episodesPerMember;
+
+    // Lowest loss first; ties keep member order so the ranking is deterministic
+    std::iota(ranking.begin(), ranking.end(), 0);
+    std::stable_sort(ranking.begin(), ranking.end(), [&](int a, int b) { return fitness[a] < fitness[b]; });
+
+    int best = ranking.front();
+    stats.generation = generationIndex;
+    stats.bestFitness = fitness[best];
+    stats.bestWins = wins[best];
+    stats.meanFitness = std::accumulate(fitness.begin(), fitness.end(), 0.0f) / config.populationSize;
+    if (fitness[best] < bestEverFitness) {
+        bestEverFitness = fitness[best];
+        std::copy_n(memberParameters(arena, best), stride, bestParameters.data());
+    }
+
+    breed();
+    ++generationIndex;
+    return stats;
+}
+
+void NeuroEvolution::breed() {
+    for (int e = 0; e < config.eliteCount; ++e)
+        std::copy_n(memberParameters(arena, ranking[e]), stride, memberParameters(nextArena, e));
+
+    // Each child draws from its own stream, so breeding can run on any thread
+    pool.parallelFor(config.populationSize - config.eliteCount, [&](int c) {
+        int child = config.eliteCount + c;
+        CounterRng rng(config.seed ^ BREEDING_KEY, (static_cast<uint64_t>(generationIndex + 1) << 32) | child);
+        uint32_t populationSize = static_cast<uint32_t>(config.populationSize);
+
+        // Tournament: the best-ranked of tournamentSize random members
+        auto selectParent = [&] {
+            uint32_t winner = rng.below(populationSize);
+            for (int t = 1; t < config.tournamentSize; ++t)
+                winner = std::min(winner, rng.below(populationSize));
+            return ranking[winner];
+        };
+        int first = selectParent();
+        int second = selectParent();
+
+        float* target = memberParameters(nextArena, child);
+        std::copy_n(arena.data() + first * stride, stride, target);
+        NeuralNetwork::blendParameters(target, arena.data() + second * stride, stride, rng.uniform());
+        mutate(target, rng);
+    });
+
+    arena.swap(nextArena);
+}
+
+bool NeuroEvolution::copyBestTo(NeuralNetwork& network) const {
+    if (generationIndex == 0 || network.layers.size() != layout.size()) {
+        return false;
+    }
+    for (size_t l = 0; l < layout.size(); ++l) {
+        Layer& layer = network.layers[l];
+        if (layer.weights.rows != layout[l].inputs || layer.weights.cols != layout[l].outputs) {
+            return false;
+        }
+        std::copy_n(bestParameters.data() + layout[l].weightsOffset, layer.weights.size(), layer.weights.data());
+        std::copy_n(bestParameters.data() + layout[l].biasesOffset, layer.biases.size(), layer.biases.data());
+        layer.activation = layout[l].activation;
+        layer.packWeights();
+    }
+    return true;
+}
+
+void NeuroEvolution::runSession(NeuralNetwork& network, int workerCount) {
+    const int SESSION_SECONDS = 60;
+    const std::string BEST_MODEL_FILE = "best_model.nn";
+    const std::string TRAINED_MODEL_FILE = "trained_model.nn";
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "  Neuroevolution Training" << std::endl;
+    std::cout << "   Fitness from simulated games" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Start from the same model game mode would play
+    if (network.loadModel(BEST_MODEL_FILE, false)) {
+        std::cout << "Seeding population from " << BEST_MODEL_FILE << "\n" << std::endl;
+    } else if (network.loadModel(TRAINED_MODEL_FILE, false)) {
+        std::cout << "Seeding population from " << TRAINED_MODEL_FILE << "\n" << std::endl;
+    } else {
+        std::cout << "No existing model found. Seeding population from random weights...\n" << std::endl;
+    }
+
+    Settings settings;
+    settings.seed = GameLogic::processRunSeed();
+    NeuroEvolution evolution(network, settings, workerCount);
+    const Settings& config = evolution.settings();
+
+    std::cout << "Configuration:" << std::endl;
+    std::cout << "  Population: " << config.populationSize << " (" << evolution.parameterCount()
+              << " parameters each), " << config.eliteCount << " elites" << std::endl;
+    std::cout << "  Episodes per member: " << config.episodesPerMember << " x " << config.maxFrames << " frames"
+              << std::endl;
+    std::cout << "  Mutation: rate " << config.mutationRate << ", strength " << config.mutationStrength << std::endl;
+    std::cout << "  Workers: " << evolution.workerCount() << std::endl;
+    std::cout << "  Duration: " << SESSION_SECONDS << " seconds" << std::endl;
+    std::cout << "======================================" << std::endl;
+    std::cout << "  Press 'Q' to stop and save best model" << std::endl;
+    std::cout << "======================================\n" << std::endl;
+
+    AsyncFileWriter writer;
+    auto saveModel = [&](const std::string& filename) {
+        auto image = std::make_shared<std::vector<unsigned char>>();
+        ModelFormat::buildImage(network.layerBlocks(), *image);
+        writer.submit(filename, [image](const std::string& path) { return ModelFormat::writeImage(path, *image); });
+        // Optimizer moments saved beside the file belong to the weights just replaced
+        std::remove((filename + ".opt").c_str());
+    };
+
+    auto startTime = std::chrono::steady_clock::now();
+    long long totalEpisodes = 0;
+    double evaluationSeconds = 0.0;
+    bool stoppedEarly = false;
+    while (true) {
+        if (_kbhit()) {
+            char key = _getch();
+            if (key == 'q' || key == 'Q') {
+                std::cout << "\n*** Stopping early - saving best model... ***\n";
+                stoppedEarly = true;
+                break;
+            }
+        }
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        if (elapsed >= SESSION_SECONDS) {
+            break;
+        }
+
+        float previousBest = evolution.bestFitness();
+        GenerationStats stats = evolution.runGeneration();
+        totalEpisodes += stats.episodes;
+        evaluationSeconds += stats.seconds;
+
+        bool improved = evolution.bestFitness() < previousBest;
+        if (improved) {
+            evolution.copyBestTo(network);
+            saveModel(BEST_MODEL_FILE);
+        }
+
+        std::cout << "Gen " << std::setw(5) << stats.generation << " | "
+                  << "Best: " << std::fixed << std::setprecision(2) << std::setw(8) << stats.bestFitness
+                  << " (" << stats.bestWins << "/" << config.episodesPerMember << " wins) | "
+                  << "Mean: " << std::setw(8) << stats.meanFitness << " | "
+                  << std::setprecision(0) << stats.episodesPerSecond() << " episodes/s"
+                  << (improved ? " | New best" : "") << std::endl;
+    }
+
+    double totalTime = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    std::cout << "\n=======================================" << std::endl;
+    std::cout << (stoppedEarly ? "Evolution Stopped Early (Q pressed)" : "Evolution Complete!") << std::endl;
+    std::cout << "=======================================" << std::endl;
+    std::cout << "Generations: " << evolution.generation() << std::endl;
+    std::cout << "Episodes played: " << totalEpisodes << std::endl;
+    std::cout << "Total time: " << std::setprecision(1) << totalTime << " seconds" << std::endl;
+    std::cout << "Throughput: " << std::setprecision(0)
+              << (evaluationSeconds > 0.0 ? totalEpisodes / evaluationSeconds : 0.0) << " episodes/s on "
+              << evolution.workerCount() << " workers" << std::endl;
+    if (evolution.copyBestTo(network)) {
+        std::cout << "Best fitness: " << std::setprecision(2) << evolution.bestFitness() << std::endl;
+    }
+    std::cout << "=======================================\n" << std::endl;
+
+    if (evolution.generation() > 0) {
+        saveModel(TRAINED_MODEL_FILE);
+    }
+    writer.flush();
+    if (writer.failedWrites() > 0) {
+        std::cerr << "Error: " << writer.failedWrites() << " model file(s) could not be written" << std::endl;
+    } else if (evolution.generation() > 0) {
+        std::cout << "Best evolved model saved as " << BEST_MODEL_FILE << " and " << TRAINED_MODEL_FILE << std::endl;
+    }
+}
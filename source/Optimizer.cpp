@@ -0,0 +1,345 @@
+#include "Optimizer.h"
+#include "MatrixKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#ifdef MATRIX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+// "OPT1" in little-endian byte order
+static const int OPTIMIZER_MAGIC = 0x3154504F;
+static const int OPTIMIZER_VERSION = 1;
+
+namespace {
+
+// Per-step scalars shared by every parameter block
+struct StepConstants {
+    float rate;           // lr, or the bias-corrected lr_t for Adam
+    float beta1;
+    float oneMinusBeta1;
+    float beta2;
+    float oneMinusBeta2;
+    float epsilon;
+};
+
+// ---------- Portable reference ----------
+
+void updateScalar(Optimizer::Type type, const StepConstants& c, float* w, const float* d, float* m, float* s,
+                  int count) {
+    switch (type) {
+        case Optimizer::Type::SGD:
+            for (int i = 0; i < count; ++i)
+                w[i] += c.rate * d[i];
+            break;
+        case Optimizer::Type::Momentum:
+            for (int i = 0; i < count; ++i) {
+                m[i] = c.beta1 * m[i] + d[i];
+                w[i] += c.rate * m[i];
+            }
+            break;
+        case Optimizer::Type::RMSProp:
+            for (int i = 0; i < count; ++i) {
+                s[i] = c.beta2 * s[i] + c.oneMinusBeta2 * d[i] * d[i];
+                w[i] += c.rate * d[i] / (std::sqrt(s[i]) + c.epsilon);
+            }
+            break;
+        case Optimizer::Type::Adam:
+            for (int i = 0; i < count; ++i) {
+                m[i] = c.beta1 * m[i] + c.oneMinusBeta1 * d[i];
+                s[i] = c.beta2 * s[i] + c.oneMinusBeta2 * d[i] * d[i];
+                w[i] += c.rate * m[i] / (std::sqrt(s[i]) + c.epsilon);
+            }
+            break;
+    }
+}
+
+#ifdef MATRIX_KERNELS_X86
+
+// ---------- Vector kernels ----------
+
+// One fused pass per rule: every parameter and its moments are loaded once,
+// updated in registers and stored once. Instantiated for AVX2 and AVX-512
+// below; the tail is handled by the scalar reference.
+#define DEFINE_OPTIMIZER_KERNELS(TARGET)                                                              \
+    using V = Ops::V;                                                                                 \
+                                                                                                      \
+    template <Optimizer::Type TYPE>                                                                   \
+    TARGET static int updateLoop(const StepConstants& c, float* w, const float* d, float* m, float* s, \
+                                 int count) {                                                         \
+        const V rate = Ops::set1(c.rate);                                                             \
+        const V beta1 = Ops::set1(c.beta1);                                                           \
+        const V oneMinusBeta1 = Ops::set1(c.oneMinusBeta1);                                           \
+        const V beta2 = Ops::set1(c.beta2);                                                           \
+        const V oneMinusBeta2 = Ops::set1(c.oneMinusBeta2);                                           \
+        const V epsilon = Ops::set1(c.epsilon);                                                       \
+        int i = 0;                                                                                    \
+        for (; i + Ops::WIDTH <= count; i += Ops::WIDTH) {                                            \
+            V direction = Ops::load(d + i);                                                           \
+            V step = direction;                                                                       \
+            if (TYPE == Optimizer::Type::Momentum) {                                                  \
+                step = Ops::fmadd(beta1, Ops::load(m + i), direction);                                \
+                Ops::store(m + i, step);                                                              \
+            } else if (TYPE == Optimizer::Type::RMSProp || TYPE == Optimizer::Type::Adam) {           \
+                V squared = Ops::mul(Ops::mul(oneMinusBeta2, direction), direction);                  \
+                V second = Ops::fmadd(beta2, Ops::load(s + i), squared);                              \
+                Ops::store(s + i, second);                                                            \
+                if (TYPE == Optimizer::Type::Adam) {                                                  \
+                    step = Ops::fmadd(beta1, Ops::load(m + i), Ops::mul(oneMinusBeta1, direction));   \
+                    Ops::store(m + i, step);                                                          \
+                }                                                                                     \
+                step = Ops::div(step, Ops::add(Ops::sqrt(second), epsilon));                          \
+            }                                                                                         \
+            Ops::store(w + i, Ops::fmadd(rate, step, Ops::load(w + i)));                              \
+        }                                                                                             \
+        return i;                                                                                     \
+    }                                                                                                 \
+                                                                                                      \
+    TARGET static int update(Optimizer::Type type, const StepConstants& c, float* w, const float* d,  \
+                             float* m, float* s, int count) {                                         \
+        switch (type) {                                                                               \
+            case Optimizer::Type::SGD: return updateLoop<Optimizer::Type::SGD>(c, w, d, m, s, count); \
+            case Optimizer::Type::Momentum: return updateLoop<Optimizer::Type::Momentum>(c, w, d, m, s, count); \
+            case Optimizer::Type::RMSProp: return updateLoop<Optimizer::Type::RMSProp>(c, w, d, m, s, count); \
+            case Optimizer::Type::Adam: return updateLoop<Optimizer::Type::Adam>(c, w, d, m, s, count); \
+        }                                                                                             \
+        return 0;                                                                                     \
+    }
+
+namespace avx2 {
+
+struct Ops {
+    using V = __m256;
+    static const int WIDTH = 8;
+
+    TARGET_AVX2 static V load(const float* p) { return _mm256_loadu_ps(p); }
+    TARGET_AVX2 static void store(float* p, V v) { _mm256_storeu_ps(p, v); }
+    TARGET_AVX2 static V set1(float value) { return _mm256_set1_ps(value); }
+    TARGET_AVX2 static V add(V a, V b) { return _mm256_add_ps(a, b); }
+    TARGET_AVX2 static V mul(V a, V b) { return _mm256_mul_ps(a, b); }
+    TARGET_AVX2 static V div(V a, V b) { return _mm256_div_ps(a, b); }
+    TARGET_AVX2 static V sqrt(V a) { return _mm256_sqrt_ps(a); }
+    TARGET_AVX2 static V fmadd(V a, V b, V c) { return _mm256_fmadd_ps(a, b, c); }
+};
+
+DEFINE_OPTIMIZER_KERNELS(TARGET_AVX2)
+
+}
+
+namespace avx512 {
+
+struct Ops {
+    using V = __m512;
+    static const int WIDTH = 16;
+
+    // Zero-masked sqrt with every lane enabled avoids GCC 12's false -Wmaybe-uninitialized
+    static const __mmask16 ALL = 0xFFFF;
+
+    TARGET_AVX512 static V load(const float* p) { return _mm512_loadu_ps(p); }
+    TARGET_AVX512 static void store(float* p, V v) { _mm512_storeu_ps(p, v); }
+    TARGET_AVX512 static V set1(float value) { return _mm512_set1_ps(value); }
+    TARGET_AVX512 static V add(V a, V b) { return _mm512_add_ps(a, b); }
+    TARGET_AVX512 static V mul(V a, V b) { return _mm512_mul_ps(a, b); }
+    TARGET_AVX512 static V div(V a, V b) { return _mm512_div_ps(a, b); }
+    TARGET_AVX512 static V sqrt(V a) { return _mm512_maskz_sqrt_ps(ALL, a); }
+    TARGET_AVX512 static V fmadd(V a, V b, V c) { return _mm512_fmadd_ps(a, b, c); }
+};
+
+DEFINE_OPTIMIZER_KERNELS(TARGET_AVX512)
+
+}
+
+#undef DEFINE_OPTIMIZER_KERNELS
+
+#endif // MATRIX_KERNELS_X86
+
+void update(Optimizer::Type type, const StepConstants& c, float* w, const float* d, float* m, float* s, int count) {
+    int done = 0;
+    switch (MatrixKernels::activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+        case MatrixKernels::Isa::AVX512:
+            done = avx512::update(type, c, w, d, m, s, count);
+            break;
+        case MatrixKernels::Isa::AVX2:
+            done = avx2::update(type, c, w, d, m, s, count);
+            break;
+#endif
+        default:
+            break;
+    }
+    updateScalar(type, c, w + done, d + done, m ? m + done : nullptr, s ? s + done : nullptr, count - done);
+}
+
+template <typename T>
+void writeValues(std::ofstream& file, const T* values, size_t count) {
+    file.write(reinterpret_cast<const char*>(values), sizeof(T) * count);
+}
+
+template <typename T>
+bool readValues(std::ifstream& file, T* values, size_t count) {
+    file.read(reinterpret_cast<char*>(values), sizeof(T) * count);
+    return static_cast<bool>(file);
+}
+
+}
+
+Optimizer::Settings Optimizer::defaults(Type type) {
+    Settings settings;
+    settings.type = type;
+    // Adaptive rules normalize the step per parameter, so they start smaller
+    settings.learningRate = (type == Type::RMSProp || type == Type::Adam) ? 0.001f : 0.01f;
+    return settings;
+}
+
+Optimizer::Optimizer(const Settings& settings) : config(settings) {
+}
+
+size_t Optimizer::parameterCount(const NeuralNetwork& network) {
+    size_t count = 0;
+    for (const auto& layer : network.layers)
+        count += static_cast<size_t>(layer.weights.size()) + layer.biases.size();
+    return count;
+}
+
+void Optimizer::sizeState(size_t parameters) {
+    bool needsFirst = config.type == Type::Momentum || config.type == Type::Adam;
+    bool needsSecond = config.type == Type::RMSProp || config.type == Type::Adam;
+    if (needsFirst && firstMoment.size() != parameters) {
+        firstMoment.assign(parameters, 0.0f);
+    }
+    if (needsSecond && secondMoment.size() != parameters) {
+        secondMoment.assign(parameters, 0.0f);
+    }
+}
+
+void Optimizer::step(NeuralNetwork& network, const NeuralNetwork::Gradients& direction) {
+    sizeState(parameterCount(network));
+    ++stepCount;
+
+    StepConstants constants;
+    constants.rate = config.learningRate;
+    constants.beta1 = config.beta1;
+    constants.oneMinusBeta1 = 1.0f - config.beta1;
+    constants.beta2 = config.beta2;
+    constants.oneMinusBeta2 = 1.0f - config.beta2;
+    constants.epsilon = config.epsilon;
+    if (config.type == Type::Adam) {
+        double t = static_cast<double>(stepCount);
+        constants.rate = static_cast<float>(config.learningRate * std::sqrt(1.0 - std::pow(config.beta2, t)) /
+                                            (1.0 - std::pow(config.beta1, t)));
+    }
+
+    float* m = firstMoment.empty() ? nullptr : firstMoment.data();
+    float* s = secondMoment.empty() ? nullptr : secondMoment.data();
+    auto block = [&](Matrix& parameters, const Matrix& delta) {
+        update(config.type, constants, parameters.data(), delta.data(), m, s, parameters.size());
+        if (m) m += parameters.size();
+        if (s) s += parameters.size();
+    };
+    for (size_t l = 0; l < network.layers.size(); ++l) {
+        block(network.layers[l].weights, direction.weights[l]);
+        block(network.layers[l].biases, direction.biases[l]);
+        network.layers[l].packWeights();
+    }
+}
+
+void Optimizer::reset() {
+    stepCount = 0;
+    firstMoment.clear();
+    secondMoment.clear();
+}
+
+const char* Optimizer::name(Type type) {
+    switch (type) {
+        case Type::SGD: return "sgd";
+        case Type::Momentum: return "momentum";
+        case Type::RMSProp: return "rmsprop";
+        case Type::Adam: return "adam";
+    }
+    return "unknown";
+}
+
+bool Optimizer::parse(const std::string& text, Type& type) {
+    for (Type candidate : {Type::SGD, Type::Momentum, Type::RMSProp, Type::Adam}) {
+        if (text == name(candidate)) {
+            type = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Optimizer::saveState(const std::string& filename, bool verbose) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        if (verbose) {
+            std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
+        }
+        return false;
+    }
+
+    int header[5] = {OPTIMIZER_MAGIC, OPTIMIZER_VERSION, static_cast<int>(config.type),
+                     static_cast<int>(firstMoment.size()), static_cast<int>(secondMoment.size())};
+    writeValues(file, header, 5);
+    writeValues(file, &stepCount, 1);
+    writeValues(file, firstMoment.data(), firstMoment.size());
+    writeValues(file, secondMoment.data(), secondMoment.size());
+
+    file.close();
+    if (verbose) {
+        std::cout << "Optimizer state saved to: " << filename << std::endl;
+    }
+    return true;
+}
+
+bool Optimizer::loadState(const std::string& filename, const NeuralNetwork& network, bool verbose) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        if (verbose) {
+            std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+        }
+        return false;
+    }
+
+    int header[5] = {0, 0, -1, -1, -1};
+    if (!readValues(file, header, 5) || header[0] != OPTIMIZER_MAGIC || header[1] != OPTIMIZER_VERSION) {
+        if (verbose) {
+            std::cerr << "Error: Not an optimizer state file: " << filename << std::endl;
+        }
+        return false;
+    }
+
+    // The moment buffers must be exactly what this rule keeps for this network
+    int parameters = static_cast<int>(parameterCount(network));
+    bool needsFirst = config.type == Type::Momentum || config.type == Type::Adam;
+    bool needsSecond = config.type == Type::RMSProp || config.type == Type::Adam;
+    if (header[2] != static_cast<int>(config.type) || header[3] != (needsFirst ? parameters : 0) ||
+        header[4] != (needsSecond ? parameters : 0)) {
+        if (verbose) {
+            std::cerr << "Error: Optimizer state in " << filename << " does not match " << name(config.type)
+                      << " on this network" << std::endl;
+        }
+        return false;
+    }
+
+    long long steps = 0;
+    std::vector<float> first(header[3]);
+    std::vector<float> second(header[4]);
+    if (!readValues(file, &steps, 1) || !readValues(file, first.data(), first.size()) ||
+        !readValues(file, second.data(), second.size())) {
+        if (verbose) {
+            std::cerr << "Error: Truncated optimizer state file: " << filename << std::endl;
+        }
+        return false;
+    }
+
+    stepCount = steps;
+    firstMoment = std::move(first);
+    secondMoment = std::move(second);
+    if (verbose) {
+        std::cout << "Optimizer state loaded from: " << filename << " (" << stepCount << " steps)" << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,294 @@
+#include "ParallelTrainer.h"
+#include "Optimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <ostream>
+
+ParallelTrainer::ParallelTrainer(NeuralNetwork& network, int workerCount, Mode mode)
+    : network(network),
+      updateMode(mode),
+      workers(workerCount > 0 ? workerCount : ThreadPool::hardwareThreads()),
+      pool(mode == Mode::Hogwild ? 1 : workers) {
+    replicas.resize(workers);
+}
+
+ParallelTrainer::~ParallelTrainer() {
+    synchronize();
+    {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        stopping = true;
+    }
+    shardReady.notify_all();
+    for (auto& thread : hogwildThreads)
+        thread.join();
+}
+
+const char* ParallelTrainer::modeName(Mode mode) {
+    return mode == Mode::Hogwild ? "hogwild" : "synchronous";
+}
+
+float ParallelTrainer::trainBatch(const std::vector<TrainingExample>& batch, float learningRate) {
+    int shards = static_cast<int>(std::min(replicas.size(), batch.size()));
+    if (shards <= 1) {
+        synchronize();
+        Clock::time_point start = Clock::now();
+        NeuralNetwork::BatchMode previous = network.batchMode;
+        network.batchMode = NeuralNetwork::BatchMode::MiniBatch;
+        float loss = network.trainBatch(batch, learningRate);
+        network.batchMode = previous;
+        trainingSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+        trainedExamples += batch.size();
+        return loss;
+    }
+
+    if (updateMode == Mode::Hogwild) {
+        return queueShards(batch, shards, learningRate / batchRows(batch));
+    }
+    Clock::time_point start = Clock::now();
+    float totalLoss = runShards(batch, shards, learningRate / batchRows(batch));
+    reduceGradients(shards);
+    network.applyGradients(replicas[0].gradients);
+    trainingSeconds += std::chrono::duration<double>(Clock::now() - start).count();
+    trainedExamples += batch.size();
+    return totalLoss / batch.size();
+}
+
+float ParallelTrainer::trainBatch(const std::vector<TrainingExample>& batch, Optimizer& optimizer) {
+    if (optimizer.settings().type == Optimizer::Type::SGD) {
+        return trainBatch(batch, optimizer.settings().learningRate);
+    }
+    synchronize();
+    int shards = static_cast<int>(std::min(pool.size(), static_cast<int>(batch.size())));
+    if (shards <= 1) {
+        return network.trainBatch(batch, optimizer);
+    }
+
+    // Optimizer state needs the whole batch's gradient, so this is always synchronous
+    float totalLoss = runShards(batch, shards, 1.0f / batchRows(batch));
+    reduceGradients(shards);
+    optimizer.step(network, replicas[0].gradients);
+    return totalLoss / batch.size();
+}
+
+int ParallelTrainer::batchRows(const std::vector<TrainingExample>& batch) {
+    int rows = 0;
+    for (const auto& example : batch)
+        rows += example.input.rows;
+    return rows;
+}
+
+float ParallelTrainer::runShards(const std::vector<TrainingExample>& batch, int shards, float stepSize) {
+    // Shard s covers examples [count * s / shards, count * (s + 1) / shards);
+    // a batch smaller than the pool leaves the extra replicas idle
+    size_t count = batch.size();
+    auto shardRange = [&](int s) { return count * s / shards; };
+    pool.parallelFor(shards, [&](int s) {
+        Replica& replica = replicas[s];
+        size_t begin = shardRange(s);
+        replica.loss = network.computeGradients(batch.data() + begin, shardRange(s + 1) - begin, stepSize,
+                                                replica.workspace, replica.gradients);
+    });
+
+    float totalLoss = 0.0f;
+    for (int s = 0; s < shards; ++s)
+        totalLoss += replicas[s].loss;
+    return totalLoss;
+}
+
+float ParallelTrainer::queueShards(const std::vector<TrainingExample>& batch, int shards, float stepSize) {
+    if (hogwildThreads.empty()) {
+        for (int w = 0; w < workers; ++w)
+            hogwildThreads.emplace_back(&ParallelTrainer::hogwildLoop, this, w);
+    }
+
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (!training) {
+        // Packed panels cannot follow weights that change under the workers,
+        // so wide layers read the weights directly until synchronize repacks
+        for (auto& layer : network.layers)
+            layer.packedWeights = MatrixKernels::PackedPanels();
+        training = true;
+    }
+
+    if (queue.empty() && busyWorkers == 0) {
+        busySince = Clock::now();
+    }
+    size_t count = batch.size();
+    for (int s = 0; s < shards; ++s) {
+        queueChanged.wait(lock, [&] { return queue.size() < static_cast<size_t>(HOGWILD_QUEUE_DEPTH * workers); });
+        Shard shard;
+        shard.examples.assign(batch.begin() + count * s / shards, batch.begin() + count * (s + 1) / shards);
+        shard.stepSize = stepSize;
+        queue.push_back(std::move(shard));
+        shardReady.notify_one();
+    }
+
+    if (finishedExamples > 0) {
+        lastLoss = finishedLoss / finishedExamples;
+        finishedLoss = 0.0f;
+        finishedExamples = 0;
+    }
+    return lastLoss;
+}
+
+void ParallelTrainer::hogwildLoop(int worker) {
+    Replica& replica = replicas[worker];
+    std::unique_lock<std::mutex> lock(queueMutex);
+    while (true) {
+        shardReady.wait(lock, [&] { return stopping || !queue.empty(); });
+        if (queue.empty()) {
+            return;
+        }
+        Shard shard = std::move(queue.front());
+        queue.pop_front();
+        ++busyWorkers;
+        lock.unlock();
+        queueChanged.notify_all();
+
+        // Read and update the shared weights as they are, without waiting for anyone
+        float loss = network.computeGradients(shard.examples.data(), shard.examples.size(), shard.stepSize,
+                                              replica.workspace, replica.gradients);
+        network.applyGradients(replica.gradients, false);
+
+        lock.lock();
+        --busyWorkers;
+        finishedLoss += loss;
+        finishedExamples += shard.examples.size();
+        trainedExamples += shard.examples.size();
+        if (queue.empty() && busyWorkers == 0) {
+            trainingSeconds += std::chrono::duration<double>(Clock::now() - busySince).count();
+            queueChanged.notify_all();
+        }
+    }
+}
+
+double ParallelTrainer::throughput() const {
+    std::lock_guard<std::mutex> lock(queueMutex);
+    double seconds = trainingSeconds;
+    if (!queue.empty() || busyWorkers > 0) {
+        seconds += std::chrono::duration<double>(Clock::now() - busySince).count();
+    }
+    return seconds > 0.0 ? trainedExamples / seconds : 0.0;
+}
+
+void ParallelTrainer::synchronize() {
+    std::unique_lock<std::mutex> lock(queueMutex);
+    if (!training) {
+        return;
+    }
+    queueChanged.wait(lock, [&] { return queue.empty() && busyWorkers == 0; });
+    training = false;
+    for (auto& layer : network.layers)
+        layer.packWeights();
+}
+
+void ParallelTrainer::reduceGradients(int shards) {
+    NeuralNetwork::Gradients& total = replicas[0].gradients;
+
+    // Every parameter is summed over shards 1..n-1 in order, whichever thread
+    // handles it, so splitting the parameters across threads is deterministic
+    auto sumRange = [&](std::vector<Matrix> NeuralNetwork::Gradients::*part, size_t layer, int begin, int end) {
+        float* sum = (total.*part)[layer].data();
+        for (int s = 1; s < shards; ++s) {
+            const float* shard = (replicas[s].gradients.*part)[layer].data();
+            for (int i = begin; i < end; ++i)
+                sum[i] += shard[i];
+        }
+    };
+
+    long long parameters = 0;
+    for (const auto& weights : total.weights)
+        parameters += weights.size();
+    if (parameters < PARALLEL_REDUCE_THRESHOLD) {
+        for (size_t l = 0; l < total.weights.size(); ++l) {
+            sumRange(&NeuralNetwork::Gradients::weights, l, 0, total.weights[l].size());
+            sumRange(&NeuralNetwork::Gradients::biases, l, 0, total.biases[l].size());
+        }
+        return;
+    }
+
+    // Split each layer's weights into equal chunks, one task per chunk
+    const int CHUNK = 1 << 14;
+    std::vector<int> firstChunk(total.weights.size() + 1, 0);
+    for (size_t l = 0; l < total.weights.size(); ++l)
+        firstChunk[l + 1] = firstChunk[l] + (total.weights[l].size() + CHUNK - 1) / CHUNK;
+
+    pool.parallelFor(firstChunk.back(), [&](int chunk) {
+        size_t l = std::upper_bound(firstChunk.begin(), firstChunk.end(), chunk) - firstChunk.begin() - 1;
+        int begin = (chunk - firstChunk[l]) * CHUNK;
+        int end = std::min(begin + CHUNK, total.weights[l].size());
+        sumRange(&NeuralNetwork::Gradients::weights, l, begin, end);
+        if (begin == 0) {
+            sumRange(&NeuralNetwork::Gradients::biases, l, 0, total.biases[l].size());
+        }
+    });
+}
+
+float ParallelTrainer::calculateLoss(const std::vector<TrainingExample>& examples) {
+    int totalOutputs = 0;
+    for (const auto& example : examples)
+        totalOutputs += example.target.size();
+    if (totalOutputs == 0) {
+        return 0.0f;
+    }
+
+    // In Hogwild mode the pool is just this thread; the workers never touch a replica's loss
+    int shards = static_cast<int>(std::min(static_cast<size_t>(pool.size()), examples.size()));
+    size_t count = examples.size();
+    auto shardRange = [&](int s) { return count * s / shards; };
+    pool.parallelFor(shards, [&](int s) {
+        size_t begin = shardRange(s);
+        replicas[s].loss = network.totalSquaredError(examples.data() + begin, shardRange(s + 1) - begin);
+    });
+
+    float totalLoss = 0.0f;
+    for (int s = 0; s < shards; ++s)
+        totalLoss += replicas[s].loss;
+    return totalLoss / totalOutputs;
+}
+
+double ParallelTrainer::reportScaling(const NeuralNetwork& network, const std::vector<TrainingExample>& batch,
+                                    float learningRate, int maxWorkers, Mode mode, std::ostream& out) {
+    if (maxWorkers <= 0) {
+        maxWorkers = ThreadPool::hardwareThreads();
+    }
+    std::vector<int> counts;
+    for (int workers = 1; workers < maxWorkers; workers *= 2)
+        counts.push_back(workers);
+    counts.push_back(maxWorkers);
+
+    out << "Parallel training scaling (" << modeName(mode) << ", batch " << batch.size() << ", "
+        << ThreadPool::hardwareThreads() << " hardware threads):" << std::endl;
+
+    double baseline = 0.0;
+    for (int workers : counts) {
+        NeuralNetwork copy = network;
+        ParallelTrainer trainer(copy, workers, mode);
+        trainer.trainBatch(batch, learningRate);  // size workspaces outside the timed loop
+        trainer.synchronize();
+
+        // Repeat until at least ~50 ms have passed so small networks time reliably;
+        // Hogwild's time runs until the workers have finished every queued shard
+        long long examples = 0;
+        auto start = std::chrono::steady_clock::now();
+        double seconds = 0.0;
+        do {
+            trainer.trainBatch(batch, learningRate);
+            examples += batch.size();
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < 0.05);
+        trainer.synchronize();
+        seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        double throughput = examples / seconds;
+        if (workers == 1) {
+            baseline = throughput;
+        }
+        double speedup = throughput / baseline;
+        out << "  " << std::setw(3) << workers << " workers: " << std::fixed << std::setprecision(0)
+            << std::setw(10) << throughput << " examples/s, speedup " << std::setprecision(2) << speedup
+            << "x, efficiency " << std::setprecision(0) << 100.0 * speedup / workers << "%" << std::endl;
+    }
+    return baseline;
+}
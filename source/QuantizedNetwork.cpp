@@ -0,0 +1,266 @@
+#include "QuantizedNetwork.h"
+#include "MatrixKernels.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+// "QNN1" in little-endian byte order
+static const int QUANTIZED_MAGIC = 0x314E4E51;
+static const int QUANTIZED_VERSION = 1;
+
+namespace {
+
+// Per-thread buffers for predictInto; they only grow, so steady state never allocates
+struct QuantizedScratch {
+    std::vector<float> front;
+    std::vector<float> back;
+    std::vector<int16_t> quantized;
+    std::vector<int32_t> sums;
+};
+
+QuantizedScratch& threadScratch() {
+    thread_local QuantizedScratch scratch;
+    return scratch;
+}
+
+template <typename T>
+void writeValues(std::ofstream& file, const T* values, size_t count) {
+    file.write(reinterpret_cast<const char*>(values), sizeof(T) * count);
+}
+
+template <typename T>
+bool readValues(std::ifstream& file, T* values, size_t count) {
+    file.read(reinterpret_cast<char*>(values), sizeof(T) * count);
+    return static_cast<bool>(file);
+}
+
+// gemvInt8 consumes inputs two at a time; an odd input count gets a zero row
+int roundUpToEven(int value) {
+    return (value + 1) & ~1;
+}
+
+// Index of weight (k, j) in the pair-interleaved int8 layout
+size_t pairIndex(int k, int j, int outputs) {
+    return static_cast<size_t>(k / 2) * 2 * outputs + 2 * j + (k & 1);
+}
+
+}
+
+QuantizedNetwork QuantizedNetwork::quantize(const NeuralNetwork& network, Precision precision) {
+    QuantizedNetwork result;
+    result.weightPrecision = precision;
+
+    for (const auto& layer : network.layers) {
+        QuantizedLayer q;
+        q.inputs = layer.weights.rows;
+        q.outputs = layer.weights.cols;
+        q.activation = layer.activation;
+        q.biases.assign(layer.biases.data(), layer.biases.data() + q.outputs);
+
+        if (precision == Precision::Int8) {
+            q.paddedInputs = roundUpToEven(q.inputs);
+            q.weights.assign(static_cast<size_t>(q.paddedInputs) * q.outputs, 0);
+            q.scales.resize(q.outputs);
+
+            // Symmetric per-channel scale: the largest weight of each output maps to +-127
+            for (int j = 0; j < q.outputs; ++j) {
+                float maxAbs = 0.0f;
+                for (int k = 0; k < q.inputs; ++k)
+                    maxAbs = std::max(maxAbs, std::abs(layer.weights(k, j)));
+                float scale = maxAbs > 0.0f ? maxAbs / 127.0f : 1.0f;
+                q.scales[j] = scale;
+
+                for (int k = 0; k < q.inputs; ++k) {
+                    long level = std::lrint(layer.weights(k, j) / scale);
+                    q.weights[pairIndex(k, j, q.outputs)] = static_cast<int8_t>(std::max(-127L, std::min(127L, level)));
+                }
+            }
+        } else {
+            q.halfWeights.resize(static_cast<size_t>(q.inputs) * q.outputs);
+            for (int i = 0; i < layer.weights.size(); ++i)
+                q.halfWeights[i] = MatrixKernels::floatToHalf(layer.weights.data()[i]);
+        }
+
+        result.layers.push_back(std::move(q));
+    }
+    return result;
+}
+
+void QuantizedNetwork::forwardLayer(const QuantizedLayer& layer, const float* input, float* output) const {
+    if (weightPrecision == Precision::Float16) {
+        MatrixKernels::gemvHalf(input, layer.halfWeights.data(), layer.outputs, output, layer.inputs, layer.outputs);
+        Activations::forward(layer.activation, output, layer.biases.data(), layer.outputs);
+        return;
+    }
+
+    QuantizedScratch& scratch = threadScratch();
+    if (scratch.quantized.size() < static_cast<size_t>(layer.paddedInputs)) {
+        scratch.quantized.resize(layer.paddedInputs);
+    }
+    if (scratch.sums.size() < static_cast<size_t>(layer.outputs)) {
+        scratch.sums.resize(layer.outputs);
+    }
+
+    // Quantize this input vector to int8 range with its own scale
+    int16_t* quantized = scratch.quantized.data();
+    float inputScale = MatrixKernels::quantizeInt8(input, quantized, layer.inputs);
+    std::fill(quantized + layer.inputs, quantized + layer.paddedInputs, static_cast<int16_t>(0));
+
+    int32_t* sums = scratch.sums.data();
+    MatrixKernels::gemvInt8(quantized, layer.weights.data(), 2 * layer.outputs, sums, layer.paddedInputs,
+                            layer.outputs);
+
+    for (int j = 0; j < layer.outputs; ++j)
+        output[j] = static_cast<float>(sums[j]) * (inputScale * layer.scales[j]);
+    Activations::forward(layer.activation, output, layer.biases.data(), layer.outputs);
+}
+
+void QuantizedNetwork::predictInto(const float* input, float* output) const {
+    QuantizedScratch& scratch = threadScratch();
+    size_t widest = 0;
+    for (const auto& layer : layers)
+        widest = std::max(widest, static_cast<size_t>(layer.outputs));
+    if (scratch.front.size() < widest) {
+        scratch.front.resize(widest);
+        scratch.back.resize(widest);
+    }
+
+    // Same ping-pong scheme as NeuralNetwork::predictInto
+    const float* current = input;
+    float* buffers[2] = {scratch.front.data(), scratch.back.data()};
+    for (size_t l = 0; l < layers.size(); ++l) {
+        float* next = (l + 1 == layers.size()) ? output : buffers[l % 2];
+        forwardLayer(layers[l], current, next);
+        current = next;
+    }
+}
+
+void QuantizedNetwork::predictBatch(const float* states, size_t n, float* actions) const {
+    for (size_t i = 0; i < n; ++i)
+        predictInto(states + i * inputSize(), actions + i * outputSize());
+}
+
+Matrix QuantizedNetwork::predict(const Matrix& input) const {
+    Matrix result(input.rows, outputSize());
+    predictBatch(input.data(), input.rows, result.data());
+    return result;
+}
+
+size_t QuantizedNetwork::weightBytes() const {
+    size_t bytes = 0;
+    for (const auto& layer : layers) {
+        size_t count = static_cast<size_t>(layer.inputs) * layer.outputs;
+        bytes += (weightPrecision == Precision::Int8) ? count : count * sizeof(uint16_t);
+    }
+    return bytes;
+}
+
+const char* QuantizedNetwork::precisionName(Precision precision) {
+    return precision == Precision::Int8 ? "int8" : "fp16";
+}
+
+bool QuantizedNetwork::saveModel(const std::string& filename, bool verbose) const {
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        if (verbose) {
+            std::cerr << "Error: Could not open file for writing: " << filename << std::endl;
+        }
+        return false;
+    }
+
+    int header[4] = {QUANTIZED_MAGIC, QUANTIZED_VERSION, static_cast<int>(weightPrecision),
+                     static_cast<int>(layers.size())};
+    writeValues(file, header, 4);
+
+    for (const auto& layer : layers) {
+        int shape[3] = {layer.inputs, layer.outputs, static_cast<int>(layer.activation)};
+        writeValues(file, shape, 3);
+        writeValues(file, layer.biases.data(), layer.outputs);
+
+        if (weightPrecision == Precision::Int8) {
+            // Stored in the kernel's pair-interleaved layout so loading is a plain read
+            writeValues(file, layer.scales.data(), layer.outputs);
+            writeValues(file, layer.weights.data(), layer.weights.size());
+        } else {
+            writeValues(file, layer.halfWeights.data(), layer.halfWeights.size());
+        }
+    }
+
+    file.close();
+    if (verbose) {
+        std::cout << "Quantized model saved to: " << filename << std::endl;
+    }
+    return true;
+}
+
+bool QuantizedNetwork::loadModel(const std::string& filename, bool verbose) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        if (verbose) {
+            std::cerr << "Error: Could not open file for reading: " << filename << std::endl;
+        }
+        return false;
+    }
+
+    int header[4] = {0, 0, 0, 0};
+    if (!readValues(file, header, 4) || header[0] != QUANTIZED_MAGIC || header[1] != QUANTIZED_VERSION ||
+        (header[2] != static_cast<int>(Precision::Int8) && header[2] != static_cast<int>(Precision::Float16)) ||
+        header[3] <= 0) {
+        if (verbose) {
+            std::cerr << "Error: Not a quantized model file: " << filename << std::endl;
+        }
+        return false;
+    }
+
+    Precision precision = static_cast<Precision>(header[2]);
+    std::vector<QuantizedLayer> loaded(header[3]);
+    for (auto& layer : loaded) {
+        int shape[3] = {0, 0, -1};
+        if (!readValues(file, shape, 3) || shape[0] <= 0 || shape[1] <= 0 || !Activations::isValid(shape[2])) {
+            if (verbose) {
+                std::cerr << "Error: Corrupt layer header in " << filename << std::endl;
+            }
+            return false;
+        }
+        layer.inputs = shape[0];
+        layer.outputs = shape[1];
+        layer.activation = static_cast<Activations::Type>(shape[2]);
+        layer.biases.resize(layer.outputs);
+        bool ok = readValues(file, layer.biases.data(), layer.outputs);
+
+        if (precision == Precision::Int8) {
+            layer.paddedInputs = roundUpToEven(layer.inputs);
+            layer.scales.resize(layer.outputs);
+            layer.weights.resize(static_cast<size_t>(layer.paddedInputs) * layer.outputs);
+            ok = ok && readValues(file, layer.scales.data(), layer.outputs);
+            ok = ok && readValues(file, layer.weights.data(), layer.weights.size());
+        } else {
+            layer.halfWeights.resize(static_cast<size_t>(layer.inputs) * layer.outputs);
+            ok = ok && readValues(file, layer.halfWeights.data(), layer.halfWeights.size());
+        }
+
+        if (!ok) {
+            if (verbose) {
+                std::cerr << "Error: Truncated quantized model file: " << filename << std::endl;
+            }
+            return false;
+        }
+    }
+
+    for (size_t l = 1; l < loaded.size(); ++l) {
+        if (loaded[l].inputs != loaded[l - 1].outputs) {
+            if (verbose) {
+                std::cerr << "Error: Layer " << l << " input size does not match the previous layer" << std::endl;
+            }
+            return false;
+        }
+    }
+
+    weightPrecision = precision;
+    layers = std::move(loaded);
+    if (verbose) {
+        std::cout << "Quantized model loaded from: " << filename << std::endl;
+    }
+    return true;
+}
@@ -0,0 +1,58 @@
+#include "SequentialTest.h"
+#include <cmath>
+#include <iostream>
+
+SequentialTest::SequentialTest(const Settings& settings) : config(settings) {
+    bool valid = config.nullWinRate > 0.0 && config.nullWinRate < config.altWinRate && config.altWinRate < 1.0 &&
+                 config.alpha > 0.0 && config.alpha < 0.5 && config.beta > 0.0 && config.beta < 0.5 &&
+                 config.maxEpisodes >= 1;
+    if (!valid) {
+        std::cerr << "Error: Invalid sequential test settings; using the defaults" << std::endl;
+        config = Settings();
+    }
+
+    winStep = std::log(config.altWinRate / config.nullWinRate);
+    lossStep = std::log((1.0 - config.altWinRate) / (1.0 - config.nullWinRate));
+    upper = std::log((1.0 - config.beta) / config.alpha);
+    lower = std::log(config.beta / (1.0 - config.alpha));
+}
+
+SequentialTest::Decision SequentialTest::addResult(bool win) {
+    if (decided()) {
+        return state;
+    }
+
+    ++played;
+    if (win) {
+        ++won;
+        llr += winStep;
+    } else {
+        llr += lossStep;
+    }
+
+    if (llr >= upper) {
+        state = Decision::Accept;
+    } else if (llr <= lower) {
+        state = Decision::Reject;
+    } else if (played >= config.maxEpisodes) {
+        // Truncated: side with whichever rate the observed one is closer to
+        double midpoint = 0.5 * (config.nullWinRate + config.altWinRate);
+        state = won >= midpoint * played ? Decision::Accept : Decision::Reject;
+    }
+    return state;
+}
+
+void SequentialTest::reset() {
+    state = Decision::Continue;
+    played = 0;
+    won = 0;
+    llr = 0.0;
+}
+
+const char* SequentialTest::decisionName(Decision decision) {
+    switch (decision) {
+        case Decision::Accept: return "accept";
+        case Decision::Reject: return "reject";
+        default: return "continue";
+    }
+}
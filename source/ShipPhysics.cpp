@@ -0,0 +1,229 @@
+#include "ShipPhysics.h"
+#include "MatrixKernels.h"
+
+#ifdef MATRIX_KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+#ifdef MATRIX_KERNELS_X86
+
+// Each pass runs stepFast's operations in its order: the table is gathered at
+// the wrapped angle, thrust and strafe are the same fused multiply-adds, the
+// turn is added in double and truncated, and the clamp divides by a
+// correctly rounded sqrt. So every ship lands on the same bits as the scalar
+// step. Both passes fly whole blocks of ships and leave the last few to the
+// scalar step.
+
+// Angle the frame starts with, wrapped to 0 .. 359. A float quotient by 360
+// is within one of the true one while |rotation| < 2^24, so the remainder
+// needs at most one correction either way; blocks with larger angles go
+// through the scalar step instead.
+TARGET_AVX512 inline __m512i wrapDegreesAvx512(__m512i rotation) {
+    const __mmask16 ALL = 0xFFFF;
+    const __m512i fullTurn = _mm512_set1_epi32(360);
+    __m512 quotient = _mm512_mul_ps(_mm512_maskz_cvtepi32_ps(ALL, rotation), _mm512_set1_ps(1.0f / 360.0f));
+    __m512i degrees = _mm512_sub_epi32(rotation,
+                                       _mm512_mullo_epi32(_mm512_maskz_cvttps_epi32(ALL, quotient), fullTurn));
+    degrees = _mm512_mask_add_epi32(degrees, _mm512_cmplt_epi32_mask(degrees, _mm512_setzero_si512()), degrees,
+                                    fullTurn);
+    degrees = _mm512_mask_add_epi32(degrees, _mm512_cmplt_epi32_mask(degrees, _mm512_setzero_si512()), degrees,
+                                    fullTurn);
+    return _mm512_mask_sub_epi32(degrees, _mm512_cmpge_epi32_mask(degrees, fullTurn), degrees, fullTurn);
+}
+
+// Eight ships' rotation + turn, added in double and truncated toward zero
+// (the zero-masked conversions keep GCC from warning about undefined lanes)
+TARGET_AVX512 inline void turnAvx512(int* rotation, const double* turn, const int* flying) {
+    __m256i angles = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(rotation));
+    __m256i turned = _mm512_maskz_cvttpd_epi32(
+        0xFF, _mm512_add_pd(_mm512_maskz_cvtepi32_pd(0xFF, angles), _mm512_loadu_pd(turn)));
+    __m256i idle = _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(flying)),
+                                      _mm256_setzero_si256());
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(rotation), _mm256_blendv_epi8(turned, angles, idle));
+}
+
+TARGET_AVX512 int stepAvx512(const ShipArrays& ships, const ShipPhysics::CommandArrays& commands, const int* flying,
+                             int count, const ShipPhysics::Settings& settings) {
+    const __m512 zero = _mm512_setzero_ps();
+    const __m512 width = _mm512_set1_ps(settings.width);
+    const __m512 height = _mm512_set1_ps(settings.height);
+    const __m512 drag = _mm512_set1_ps(settings.dragFactor);
+    const __m512 maxSpeed = _mm512_set1_ps(settings.maxSpeed);
+    const __m512 maxSpeedSquared = _mm512_set1_ps(settings.maxSpeed * settings.maxSpeed);
+    const __m512i largestAngle = _mm512_set1_epi32((1 << 24) - 1);
+
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __mmask16 active = _mm512_cmpneq_epi32_mask(_mm512_loadu_si512(flying + i), _mm512_setzero_si512());
+        if (active == 0) {
+            continue;
+        }
+        __m512i rotation = _mm512_loadu_si512(ships.rotation + i);
+        if (_mm512_cmpgt_epi32_mask(_mm512_maskz_abs_epi32(0xFFFF, rotation), largestAngle) != 0) {
+            ShipArrays block = {ships.posX + i, ships.posY + i, ships.velX + i, ships.velY + i, ships.rotation + i};
+            ShipPhysics::CommandArrays blockCommands = {commands.thrust + i, commands.strafe + i, commands.turn + i,
+                                                        commands.brake + i};
+            ShipPhysics::stepScalar(block, blockCommands, flying + i, 16, settings);
+            continue;
+        }
+        __m512i degrees = wrapDegreesAvx512(rotation);
+        __m512 s = _mm512_mask_i32gather_ps(zero, active, degrees, ShipPhysics::TRIG.sin, 4);
+        __m512 c = _mm512_mask_i32gather_ps(zero, active, degrees, ShipPhysics::TRIG.cos, 4);
+
+        __m512 thrust = _mm512_loadu_ps(commands.thrust + i);
+        __m512 strafe = _mm512_loadu_ps(commands.strafe + i);
+        __m512 brake = _mm512_loadu_ps(commands.brake + i);
+        __m512 velX = _mm512_loadu_ps(ships.velX + i);
+        __m512 velY = _mm512_loadu_ps(ships.velY + i);
+        velX = _mm512_add_ps(velX, _mm512_fmadd_ps(s, thrust, _mm512_mul_ps(c, strafe)));
+        velY = _mm512_add_ps(velY, _mm512_fmsub_ps(s, strafe, _mm512_mul_ps(c, thrust)));
+
+        turnAvx512(ships.rotation + i, commands.turn + i, flying + i);
+        turnAvx512(ships.rotation + i + 8, commands.turn + i + 8, flying + i + 8);
+
+        __m512 damping = _mm512_mul_ps(drag, brake);
+        velX = _mm512_mul_ps(velX, damping);
+        velY = _mm512_mul_ps(velY, damping);
+        __m512 speedSquared = _mm512_fmadd_ps(velY, velY, _mm512_mul_ps(velX, velX));
+        __mmask16 tooFast = _mm512_mask_cmp_ps_mask(active, speedSquared, maxSpeedSquared, _CMP_GT_OQ);
+        if (tooFast != 0) {
+            __m512 scale = _mm512_div_ps(maxSpeed, _mm512_maskz_sqrt_ps(0xFFFF, speedSquared));
+            velX = _mm512_mask_mul_ps(velX, tooFast, velX, scale);
+            velY = _mm512_mask_mul_ps(velY, tooFast, velY, scale);
+        }
+        _mm512_mask_storeu_ps(ships.velX + i, active, velX);
+        _mm512_mask_storeu_ps(ships.velY + i, active, velY);
+
+        // Move, then jump to the opposite edge on leaving the arena
+        __m512 x = _mm512_add_ps(_mm512_loadu_ps(ships.posX + i), velX);
+        __m512 y = _mm512_add_ps(_mm512_loadu_ps(ships.posY + i), velY);
+        x = _mm512_mask_mov_ps(x, _mm512_cmp_ps_mask(x, zero, _CMP_LT_OQ), width);
+        x = _mm512_mask_mov_ps(x, _mm512_cmp_ps_mask(x, width, _CMP_GT_OQ), zero);
+        y = _mm512_mask_mov_ps(y, _mm512_cmp_ps_mask(y, zero, _CMP_LT_OQ), height);
+        y = _mm512_mask_mov_ps(y, _mm512_cmp_ps_mask(y, height, _CMP_GT_OQ), zero);
+        _mm512_mask_storeu_ps(ships.posX + i, active, x);
+        _mm512_mask_storeu_ps(ships.posY + i, active, y);
+    }
+    _mm256_zeroupper();
+    return i;
+}
+
+// Four ships' angles in double, and their rotation - 360 * floor(rotation / 360)
+TARGET_AVX2 inline __m128i wrapDegreesAvx2(__m128i rotation, __m256d& angle) {
+    angle = _mm256_cvtepi32_pd(rotation);
+    __m128i turns = _mm256_cvttpd_epi32(_mm256_floor_pd(_mm256_div_pd(angle, _mm256_set1_pd(360.0))));
+    return _mm_sub_epi32(rotation, _mm_mullo_epi32(turns, _mm_set1_epi32(360)));
+}
+
+TARGET_AVX2 int stepAvx2(const ShipArrays& ships, const ShipPhysics::CommandArrays& commands, const int* flying,
+                          int count, const ShipPhysics::Settings& settings) {
+    const __m256 zero = _mm256_setzero_ps();
+    const __m256 width = _mm256_set1_ps(settings.width);
+    const __m256 height = _mm256_set1_ps(settings.height);
+    const __m256 drag = _mm256_set1_ps(settings.dragFactor);
+    const __m256 maxSpeed = _mm256_set1_ps(settings.maxSpeed);
+    const __m256 maxSpeedSquared = _mm256_set1_ps(settings.maxSpeed * settings.maxSpeed);
+
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m256 active = _mm256_castsi256_ps(_mm256_xor_si256(
+            _mm256_cmpeq_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(flying + i)),
+                               _mm256_setzero_si256()),
+            _mm256_set1_epi32(-1)));
+        if (_mm256_movemask_ps(active) == 0) {
+            continue;
+        }
+
+        __m256i rotation = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ships.rotation + i));
+        __m256d low, high;
+        __m128i degreesLow = wrapDegreesAvx2(_mm256_castsi256_si128(rotation), low);
+        __m128i degreesHigh = wrapDegreesAvx2(_mm256_extracti128_si256(rotation, 1), high);
+        __m256i degrees = _mm256_inserti128_si256(_mm256_castsi128_si256(degreesLow), degreesHigh, 1);
+        __m256 s = _mm256_i32gather_ps(ShipPhysics::TRIG.sin, degrees, 4);
+        __m256 c = _mm256_i32gather_ps(ShipPhysics::TRIG.cos, degrees, 4);
+
+        __m256 thrust = _mm256_loadu_ps(commands.thrust + i);
+        __m256 strafe = _mm256_loadu_ps(commands.strafe + i);
+        __m256 brake = _mm256_loadu_ps(commands.brake + i);
+        __m256 oldVelX = _mm256_loadu_ps(ships.velX + i);
+        __m256 oldVelY = _mm256_loadu_ps(ships.velY + i);
+        __m256 velX = _mm256_add_ps(oldVelX, _mm256_fmadd_ps(s, thrust, _mm256_mul_ps(c, strafe)));
+        __m256 velY = _mm256_add_ps(oldVelY, _mm256_fmsub_ps(s, strafe, _mm256_mul_ps(c, thrust)));
+
+        __m128i turnedLow = _mm256_cvttpd_epi32(_mm256_add_pd(low, _mm256_loadu_pd(commands.turn + i)));
+        __m128i turnedHigh = _mm256_cvttpd_epi32(_mm256_add_pd(high, _mm256_loadu_pd(commands.turn + i + 4)));
+        __m256i turned = _mm256_inserti128_si256(_mm256_castsi128_si256(turnedLow), turnedHigh, 1);
+        turned = _mm256_castps_si256(
+            _mm256_blendv_ps(_mm256_castsi256_ps(rotation), _mm256_castsi256_ps(turned), active));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(ships.rotation + i), turned);
+
+        __m256 damping = _mm256_mul_ps(drag, brake);
+        velX = _mm256_mul_ps(velX, damping);
+        velY = _mm256_mul_ps(velY, damping);
+        __m256 speedSquared = _mm256_fmadd_ps(velY, velY, _mm256_mul_ps(velX, velX));
+        __m256 tooFast = _mm256_cmp_ps(speedSquared, maxSpeedSquared, _CMP_GT_OQ);
+        if (_mm256_movemask_ps(tooFast) != 0) {
+            __m256 scale = _mm256_div_ps(maxSpeed, _mm256_sqrt_ps(speedSquared));
+            velX = _mm256_blendv_ps(velX, _mm256_mul_ps(velX, scale), tooFast);
+            velY = _mm256_blendv_ps(velY, _mm256_mul_ps(velY, scale), tooFast);
+        }
+        velX = _mm256_blendv_ps(oldVelX, velX, active);
+        velY = _mm256_blendv_ps(oldVelY, velY, active);
+        _mm256_storeu_ps(ships.velX + i, velX);
+        _mm256_storeu_ps(ships.velY + i, velY);
+
+        __m256 oldX = _mm256_loadu_ps(ships.posX + i);
+        __m256 oldY = _mm256_loadu_ps(ships.posY + i);
+        __m256 x = _mm256_add_ps(oldX, velX);
+        __m256 y = _mm256_add_ps(oldY, velY);
+        x = _mm256_blendv_ps(x, width, _mm256_cmp_ps(x, zero, _CMP_LT_OQ));
+        x = _mm256_blendv_ps(x, zero, _mm256_cmp_ps(x, width, _CMP_GT_OQ));
+        y = _mm256_blendv_ps(y, height, _mm256_cmp_ps(y, zero, _CMP_LT_OQ));
+        y = _mm256_blendv_ps(y, zero, _mm256_cmp_ps(y, height, _CMP_GT_OQ));
+        _mm256_storeu_ps(ships.posX + i, _mm256_blendv_ps(oldX, x, active));
+        _mm256_storeu_ps(ships.posY + i, _mm256_blendv_ps(oldY, y, active));
+    }
+    _mm256_zeroupper();
+    return i;
+}
+
+#endif // MATRIX_KERNELS_X86
+
+}
+
+void ShipPhysics::step(const ShipArrays& ships, const CommandArrays& commands, const int* flying, int count,
+                       const Settings& settings) {
+    int done = 0;
+    switch (MatrixKernels::activeIsa()) {
+#ifdef MATRIX_KERNELS_X86
+        case MatrixKernels::Isa::AVX512:
+            done = stepAvx512(ships, commands, flying, count, settings);
+            break;
+        case MatrixKernels::Isa::AVX2:
+            done = stepAvx2(ships, commands, flying, count, settings);
+            break;
+#endif
+        default:
+            break;
+    }
+    if (done < count) {
+        ShipArrays rest = {ships.posX + done, ships.posY + done, ships.velX + done, ships.velY + done,
+                           ships.rotation + done};
+        CommandArrays restCommands = {commands.thrust + done, commands.strafe + done, commands.turn + done,
+                                      commands.brake + done};
+        stepScalar(rest, restCommands, flying + done, count - done, settings);
+    }
+}
+
+void ShipPhysics::stepScalar(const ShipArrays& ships, const CommandArrays& commands, const int* flying, int count,
+                             const Settings& settings) {
+    for (int i = 0; i < count; ++i) {
+        if (flying[i] != 0) {
+            Command command = {commands.thrust[i], commands.strafe[i], commands.turn[i], commands.brake[i]};
+            stepFast(ships.posX[i], ships.posY[i], ships.velX[i], ships.velY[i], ships.rotation[i], command,
+                     settings);
+        }
+    }
+}
@@ -1,10 +1,7 @@
 #include "SpaceShip.h"
+#include "ShipPhysics.h"
 #include <math.h>
 
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
-
 double directionToAngle(int num)
 {
     switch (num)
@@ -29,22 +26,16 @@ SpaceShip::SpaceShip()
     rotationAngle = 0;
 }
 
-void SpaceShip::addVelocity(Vector2D vel)
+void SpaceShip::addVelocity(const Vector2D& vel)
 {
     velocity.add(vel);
 }
 
 void SpaceShip::thrust(const double power)
 {
-    // Convert degrees to radians, offset so 0° = north
-    double angleRad = (rotationAngle - 90.0) * (M_PI / 180.0);
-
-    // Compute thrust vector
-    double a = std::cos(angleRad) * power; // X component
-    double b = std::sin(angleRad) * power; // Y component
-
-    Vector2D newVelocity(a, b);
-    addVelocity(newVelocity);
+    // Nose direction from the whole-degree table (0° = north)
+    Vec2<float> nose = ShipPhysics::heading(rotationAngle);
+    addVelocity(Vector2D(nose.x * power, nose.y * power));
 }
 
 
@@ -83,18 +74,9 @@ void SpaceShip::strafe(int direction, const double power)
 {
     // direction: -1 = left, +1 = right
 
-    // Convert rotationAngle (degrees) to radians
-    double angleRad = (rotationAngle - 90.0) * (M_PI / 180.0);
-
-    // Offset by ±90° for strafe
-    double strafeAngle = angleRad + direction * (M_PI / 2.0);
-
-    // Compute strafe vector
-    double a = std::cos(strafeAngle) * power; // X component
-    double b = std::sin(strafeAngle) * power; // Y component
-
-    Vector2D newVelocity(a, b);
-    addVelocity(newVelocity);
+    // Nose direction turned ±90° for strafe
+    Vec2<float> wing = ShipPhysics::heading(rotationAngle + direction * 90);
+    addVelocity(Vector2D(wing.x * power, wing.y * power));
 }
 
 void SpaceShip::updatePosition()
@@ -0,0 +1,222 @@
+#include "StaticNetwork.h"
+#include "ActivationKernels.h"
+#include <algorithm>
+
+namespace StaticKernels {
+
+#ifdef MATRIX_KERNELS_X86
+
+namespace {
+
+// One layer per call with every loop bound a template constant: the Out sums
+// sit in ceil(Out / WIDTH) registers while the In inputs stream past, and
+// stay there through the bias add and the activation. A partial last block
+// is loaded masked, but stored whole to a local block and copied out: the
+// caller reads those outputs right away, and a masked store cannot forward
+// to a later load, which stalled every call until the store retired.
+//
+// forwardLayer sums each output over k in order with fused multiply-adds
+// from zero, like the AVX2 / AVX-512 gemv kernels, and activates with
+// ActivationKernels.h's math, so it matches gemv + Activations::forward bit
+// for bit. backwardLayer fuses the weight update into the multiply-add the
+// same way as MatrixKernels::rankUpdate, and sums each input's error across
+// the vector lanes.
+#define DEFINE_STATIC_KERNELS(TARGET)                                                                 \
+    template <int COUNT>                                                                              \
+    TARGET static inline V loadBlock(const float* p) {                                               \
+        if constexpr (COUNT == Ops::WIDTH) return Ops::load(p);                                       \
+        else return Ops::loadFirst(p, COUNT);                                                         \
+    }                                                                                                 \
+                                                                                                      \
+    template <int COUNT>                                                                              \
+    TARGET static inline void storeBlock(float* p, V v) {                                             \
+        if constexpr (COUNT == Ops::WIDTH) Ops::store(p, v);                                          \
+        else {                                                                                        \
+            alignas(64) float block[Ops::WIDTH];                                                      \
+            Ops::store(block, v);                                                                     \
+            std::copy_n(block, COUNT, p);                                                             \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    template <int In, int Out, int KERNEL>                                                            \
+    TARGET static void forwardLayer(const float* in, const float* w, const float* bias, float* out,   \
+                                    const float* table) {                                             \
+        constexpr int BLOCKS = (Out + Ops::WIDTH - 1) / Ops::WIDTH;                                   \
+        constexpr int LAST = Out - (BLOCKS - 1) * Ops::WIDTH;                                         \
+        V acc[BLOCKS];                                                                                \
+        for (int c = 0; c < BLOCKS; ++c)                                                              \
+            acc[c] = Ops::set1(0.0f);                                                                 \
+        for (int k = 0; k < In; ++k) {                                                                \
+            V x = Ops::set1(in[k]);                                                                   \
+            const float* row = w + k * Out;                                                           \
+            for (int c = 0; c + 1 < BLOCKS; ++c)                                                      \
+                acc[c] = Ops::fmadd(x, Ops::load(row + c * Ops::WIDTH), acc[c]);                      \
+            acc[BLOCKS - 1] = Ops::fmadd(x, loadBlock<LAST>(row + (BLOCKS - 1) * Ops::WIDTH),         \
+                                         acc[BLOCKS - 1]);                                            \
+        }                                                                                             \
+        for (int c = 0; c + 1 < BLOCKS; ++c) {                                                        \
+            V x = Ops::add(acc[c], Ops::load(bias + c * Ops::WIDTH));                                 \
+            Ops::store(out + c * Ops::WIDTH, activate<KERNEL>(x, table));                             \
+        }                                                                                             \
+        V x = Ops::add(acc[BLOCKS - 1], loadBlock<LAST>(bias + (BLOCKS - 1) * Ops::WIDTH));           \
+        storeBlock<LAST>(out + (BLOCKS - 1) * Ops::WIDTH, activate<KERNEL>(x, table));                \
+    }                                                                                                 \
+                                                                                                      \
+    template <int In, int Out, int KERNEL>                                                            \
+    TARGET static void backwardLayer(const float* in, const float* out, const float* error,           \
+                                     float learningRate, float* w, float* bias, float* errorIn) {     \
+        constexpr int BLOCKS = (Out + Ops::WIDTH - 1) / Ops::WIDTH;                                   \
+        constexpr int LAST = Out - (BLOCKS - 1) * Ops::WIDTH;                                         \
+        V rate = Ops::set1(learningRate);                                                             \
+        V gradient[BLOCKS];                                                                           \
+        for (int c = 0; c + 1 < BLOCKS; ++c) {                                                        \
+            V e = Ops::load(error + c * Ops::WIDTH);                                                  \
+            gradient[c] = Ops::mul(Ops::mul(e, rate), derive<KERNEL>(Ops::load(out + c * Ops::WIDTH))); \
+        }                                                                                             \
+        V e = loadBlock<LAST>(error + (BLOCKS - 1) * Ops::WIDTH);                                     \
+        V y = loadBlock<LAST>(out + (BLOCKS - 1) * Ops::WIDTH);                                       \
+        gradient[BLOCKS - 1] = Ops::mul(Ops::mul(e, rate), derive<KERNEL>(y));                        \
+        for (int i = 0; i < In; ++i) {                                                                \
+            V x = Ops::set1(in[i]);                                                                   \
+            float* row = w + i * Out;                                                                 \
+            V sum = Ops::set1(0.0f);                                                                  \
+            for (int c = 0; c + 1 < BLOCKS; ++c) {                                                    \
+                V updated = Ops::fmadd(x, gradient[c], Ops::load(row + c * Ops::WIDTH));              \
+                Ops::store(row + c * Ops::WIDTH, updated);                                            \
+                sum = Ops::fmadd(gradient[c], updated, sum);                                          \
+            }                                                                                         \
+            float* last = row + (BLOCKS - 1) * Ops::WIDTH;                                            \
+            V updated = Ops::fmadd(x, gradient[BLOCKS - 1], loadBlock<LAST>(last));                   \
+            storeBlock<LAST>(last, updated);                                                          \
+            if (errorIn) errorIn[i] = Ops::sum(Ops::fmadd(gradient[BLOCKS - 1], updated, sum));       \
+        }                                                                                             \
+        for (int c = 0; c + 1 < BLOCKS; ++c)                                                          \
+            Ops::store(bias + c * Ops::WIDTH, Ops::add(Ops::load(bias + c * Ops::WIDTH), gradient[c])); \
+        float* lastBias = bias + (BLOCKS - 1) * Ops::WIDTH;                                           \
+        storeBlock<LAST>(lastBias, Ops::add(loadBlock<LAST>(lastBias), gradient[BLOCKS - 1]));        \
+    }                                                                                                 \
+                                                                                                      \
+    template <int In, int Out>                                                                        \
+    TARGET static void forwardKernel(Activations::Kernel kernel, const float* in, const float* w,     \
+                                     const float* bias, float* out, const float* table) {             \
+        switch (kernel) {                                                                             \
+            case Activations::SIGMOID_POLYNOMIAL:                                                     \
+                forwardLayer<In, Out, Activations::SIGMOID_POLYNOMIAL>(in, w, bias, out, table); break; \
+            case Activations::TANH_POLYNOMIAL:                                                        \
+                forwardLayer<In, Out, Activations::TANH_POLYNOMIAL>(in, w, bias, out, table); break;  \
+            case Activations::SIGMOID_TABLE:                                                          \
+                forwardLayer<In, Out, Activations::SIGMOID_TABLE>(in, w, bias, out, table); break;    \
+            case Activations::TANH_TABLE:                                                             \
+                forwardLayer<In, Out, Activations::TANH_TABLE>(in, w, bias, out, table); break;       \
+            case Activations::RELU:                                                                   \
+                forwardLayer<In, Out, Activations::RELU>(in, w, bias, out, table); break;             \
+            case Activations::LEAKY_RELU:                                                             \
+                forwardLayer<In, Out, Activations::LEAKY_RELU>(in, w, bias, out, table); break;       \
+            case Activations::HARD_TANH:                                                              \
+                forwardLayer<In, Out, Activations::HARD_TANH>(in, w, bias, out, table); break;        \
+        }                                                                                             \
+    }                                                                                                 \
+                                                                                                      \
+    template <int In, int Out>                                                                        \
+    TARGET static void backwardKernel(Activations::Type type, const float* in, const float* out,      \
+                                      const float* error, float learningRate, float* w, float* bias,  \
+                                      float* errorIn) {                                               \
+        switch (type) {                                                                               \
+            case Activations::Type::Sigmoid:                                                          \
+                backwardLayer<In, Out, Activations::SIGMOID_POLYNOMIAL>(in, out, error, learningRate, \
+                                                                        w, bias, errorIn);            \
+                break;                                                                                \
+            case Activations::Type::Tanh:                                                             \
+                backwardLayer<In, Out, Activations::TANH_POLYNOMIAL>(in, out, error, learningRate, w, \
+                                                                     bias, errorIn);                  \
+                break;                                                                                \
+            case Activations::Type::ReLU:                                                             \
+                backwardLayer<In, Out, Activations::RELU>(in, out, error, learningRate, w, bias,      \
+                                                          errorIn);                                   \
+                break;                                                                                \
+            case Activations::Type::LeakyReLU:                                                        \
+                backwardLayer<In, Out, Activations::LEAKY_RELU>(in, out, error, learningRate, w, bias, \
+                                                                errorIn);                             \
+                break;                                                                                \
+            case Activations::Type::HardTanh:                                                         \
+                backwardLayer<In, Out, Activations::HARD_TANH>(in, out, error, learningRate, w, bias, \
+                                                               errorIn);                              \
+                break;                                                                                \
+        }                                                                                             \
+    }
+
+namespace avx2 {
+
+using namespace Activations::avx2;
+DEFINE_STATIC_KERNELS(TARGET_AVX2)
+
+}
+
+namespace avx512 {
+
+using namespace Activations::avx512;
+DEFINE_STATIC_KERNELS(TARGET_AVX512)
+
+}
+
+#undef DEFINE_STATIC_KERNELS
+
+}
+
+#endif // MATRIX_KERNELS_X86
+
+template <int In, int Out>
+bool forward(Activations::Type type, const float* in, const float* w, const float* bias, float* out) {
+#ifdef MATRIX_KERNELS_X86
+    Activations::Accuracy tier = Activations::accuracy();
+    bool transcendental = (type == Activations::Type::Sigmoid || type == Activations::Type::Tanh);
+    if (transcendental && tier == Activations::Accuracy::Exact) {
+        return false;
+    }
+    Activations::Kernel kernel = Activations::vectorKernel(type, tier);
+    const float* table = tier == Activations::Accuracy::Table ? Activations::sigmoidTable() : nullptr;
+    switch (MatrixKernels::activeIsa()) {
+        case MatrixKernels::Isa::AVX512:
+            avx512::forwardKernel<In, Out>(kernel, in, w, bias, out, table);
+            return true;
+        case MatrixKernels::Isa::AVX2:
+            avx2::forwardKernel<In, Out>(kernel, in, w, bias, out, table);
+            return true;
+        default:
+            break;
+    }
+#endif
+    return false;
+}
+
+template <int In, int Out>
+bool backward(Activations::Type type, const float* in, const float* out, const float* error, float learningRate,
+              float* w, float* bias, float* errorIn) {
+#ifdef MATRIX_KERNELS_X86
+    switch (MatrixKernels::activeIsa()) {
+        case MatrixKernels::Isa::AVX512:
+            avx512::backwardKernel<In, Out>(type, in, out, error, learningRate, w, bias, errorIn);
+            return true;
+        case MatrixKernels::Isa::AVX2:
+            avx2::backwardKernel<In, Out>(type, in, out, error, learningRate, w, bias, errorIn);
+            return true;
+        default:
+            break;
+    }
+#endif
+    return false;
+}
+
+// The shapes marked in HAS_KERNEL
+#define INSTANTIATE_STATIC_KERNELS(IN, OUT)                                                            \
+    template bool forward<IN, OUT>(Activations::Type, const float*, const float*, const float*, float*); \
+    template bool backward<IN, OUT>(Activations::Type, const float*, const float*, const float*, float,  \
+                                    float*, float*, float*);
+
+INSTANTIATE_STATIC_KERNELS(12, 32)
+INSTANTIATE_STATIC_KERNELS(32, 16)
+INSTANTIATE_STATIC_KERNELS(16, 4)
+
+#undef INSTANTIATE_STATIC_KERNELS
+
+}
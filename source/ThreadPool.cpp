@@ -0,0 +1,112 @@
+#include "ThreadPool.h"
+#include <memory>
+
+namespace {
+
+// Set while a thread is executing pool tasks, so nested loops run inline
+thread_local bool insidePoolTask = false;
+
+std::unique_ptr<ThreadPool>& sharedPoolSlot() {
+    static std::unique_ptr<ThreadPool> pool(new ThreadPool());
+    return pool;
+}
+
+}
+
+ThreadPool::ThreadPool(int threadCount) {
+    if (threadCount <= 0) {
+        threadCount = hardwareThreads();
+    }
+    for (int i = 1; i < threadCount; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        stopping = true;
+    }
+    workReady.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+int ThreadPool::hardwareThreads() {
+    unsigned int count = std::thread::hardware_concurrency();
+    return count > 0 ? static_cast<int>(count) : 1;
+}
+
+ThreadPool& ThreadPool::shared() {
+    return *sharedPoolSlot();
+}
+
+void ThreadPool::setSharedThreadCount(int threadCount) {
+    sharedPoolSlot().reset(new ThreadPool(threadCount));
+}
+
+// Pull indices from the current job until none are left
+void ThreadPool::drainJob() {
+    bool wasInside = insidePoolTask;
+    insidePoolTask = true;
+    for (int index = nextIndex.fetch_add(1); index < jobCount; index = nextIndex.fetch_add(1)) {
+        jobFunction(jobContext, index);
+    }
+    insidePoolTask = wasInside;
+}
+
+void ThreadPool::run(int count, TaskFunction function, const void* context) {
+    if (count <= 0) {
+        return;
+    }
+
+    // Serial path: no workers, tiny jobs, or called from inside another task
+    if (workers.empty() || count == 1 || insidePoolTask) {
+        for (int i = 0; i < count; ++i) {
+            function(context, i);
+        }
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(stateMutex);
+        jobFunction = function;
+        jobContext = context;
+        jobCount = count;
+        nextIndex.store(0);
+        activeWorkers = static_cast<int>(workers.size());
+        ++generation;
+    }
+    workReady.notify_all();
+
+    drainJob();
+
+    // Wait until every worker has left the job before it goes out of scope
+    std::unique_lock<std::mutex> lock(stateMutex);
+    workDone.wait(lock, [this] { return activeWorkers == 0; });
+}
+
+void ThreadPool::workerLoop() {
+    unsigned long long seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex);
+            workReady.wait(lock, [&] { return stopping || generation != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = generation;
+        }
+
+        drainJob();
+
+        {
+            std::lock_guard<std::mutex> lock(stateMutex);
+            if (--activeWorkers == 0) {
+                workDone.notify_one();
+            }
+        }
+    }
+}
@@ -2,6 +2,10 @@
 #include "SpaceShip.h"
 #include "GameSettings.h"
 #include "GameLogic.h"
+#include "StaticNetwork.h"
+#include "ParallelTrainer.h"
+#include "ThreadPool.h"
+#include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <random>
@@ -9,30 +13,120 @@
 #include <limits>
 #include <chrono>
 #include <cmath>
+#include <memory>
+#include <type_traits>
 #include <conio.h>
 
-TrainingManager::TrainingManager(NeuralNetwork* nn)
-    : network(nn), bestLoss(std::numeric_limits<float>::max()), bestBatch(0), totalBatches(0)
+template <typename Network>
+TrainingManager<Network>::TrainingManager(Network* nn)
+    : network(nn), bestLoss(std::numeric_limits<float>::max()), bestBatch(0), totalBatches(0),
+      runSeed(GameLogic::processRunSeed()), dataRng(runSeed, DATA_STREAM)
 {
 }
 
-TrainingManager::~TrainingManager()
+template <typename Network>
+TrainingManager<Network>::~TrainingManager()
 {
 }
 
-std::vector<TrainingExample> TrainingManager::generateBatchData(int numExamples)
+namespace {
+
+// Only the dynamic network supports data-parallel training
+std::unique_ptr<ParallelTrainer> makeParallelTrainer(NeuralNetwork* network, int workers, bool hogwild)
+{
+    ParallelTrainer::Mode mode = hogwild ? ParallelTrainer::Mode::Hogwild : ParallelTrainer::Mode::Synchronous;
+    return std::unique_ptr<ParallelTrainer>(new ParallelTrainer(*network, workers, mode));
+}
+
+template <typename Network>
+std::unique_ptr<ParallelTrainer> makeParallelTrainer(Network*, int, bool)
+{
+    std::cout << "Parallel training needs the dynamic NeuralNetwork; training on one thread.\n";
+    return nullptr;
+}
+
+float trainOnBatch(NeuralNetwork* network, ParallelTrainer* parallel, const std::vector<TrainingExample>& batch,
+                   Optimizer& optimizer)
+{
+    // Plain SGD's learning rate is per example (it used to step after every
+    // one). A mini-batch step averages the gradient, so it takes the rate
+    // times the batch rows to move the weights as far per batch.
+    bool miniBatch = parallel || network->batchMode == NeuralNetwork::BatchMode::MiniBatch;
+    if (optimizer.settings().type == Optimizer::Type::SGD && miniBatch) {
+        int rows = 0;
+        for (const auto& example : batch)
+            rows += example.input.rows;
+        float rate = optimizer.settings().learningRate * rows;
+        return parallel ? parallel->trainBatch(batch, rate) : network->trainBatch(batch, rate);
+    }
+    return parallel ? parallel->trainBatch(batch, optimizer) : network->trainBatch(batch, optimizer);
+}
+
+// Fixed-size networks only have the plain SGD update
+template <typename Network>
+float trainOnBatch(Network* network, ParallelTrainer*, const std::vector<TrainingExample>& batch,
+                   Optimizer& optimizer)
+{
+    return network->trainBatch(batch, optimizer.settings().learningRate);
+}
+
+bool loadOptimizerState(Optimizer& optimizer, const std::string& filename, const NeuralNetwork* network)
+{
+    return optimizer.loadState(filename, *network, false);
+}
+
+template <typename Network>
+bool loadOptimizerState(Optimizer&, const std::string&, const Network*)
+{
+    return false;
+}
+
+}
+
+template <typename Network>
+void TrainingManager<Network>::setOptimizer(const Optimizer::Settings& settings)
+{
+    if (!std::is_same<Network, NeuralNetwork>::value && settings.type != Optimizer::Type::SGD) {
+        std::cout << "StaticNetwork training only supports sgd; ignoring " << Optimizer::name(settings.type) << ".\n";
+        return;
+    }
+    optimizer = Optimizer(settings);
+}
+
+template <typename Network>
+void TrainingManager<Network>::saveCheckpoint(const std::string& filename)
+{
+    // Building the image is a copy of the parameters; the disk work runs on the writer thread
+    auto image = std::make_shared<std::vector<unsigned char>>();
+    ModelFormat::buildImage(network->layerBlocks(), *image);
+    modelWriter.submit(filename, [image](const std::string& path) { return ModelFormat::writeImage(path, *image); });
+
+    if (optimizer.hasState()) {
+        auto state = std::make_shared<Optimizer>(optimizer);
+        modelWriter.submit(filename + ".opt",
+                           [state](const std::string& path) { return state->saveState(path, false); });
+    }
+}
+
+template <typename Network>
+void TrainingManager<Network>::setParallelTraining(int workers, bool hogwild)
+{
+    trainingWorkers = workers;
+    hogwildTraining = hogwild;
+}
+
+template <typename Network>
+std::vector<TrainingExample> TrainingManager<Network>::generateBatchData(int numExamples)
 {
     std::vector<TrainingExample> examples;
-    std::mt19937 rng(std::random_device{}());
-    std::uniform_real_distribution<float> dist(0.0f, 1.0f);
 
     for (int i = 0; i < numExamples; ++i) {
         // Generate random 12-input game state matching simulation and game mode
-        float shipX = dist(rng);
-        float shipY = dist(rng);
-        float shipVelX = (dist(rng) * 2.0f - 1.0f);
-        float shipVelY = (dist(rng) * 2.0f - 1.0f);
-        float shipRotation = dist(rng);
+        float shipX = dataRng.uniform();
+        float shipY = dataRng.uniform();
+        float shipVelX = (dataRng.uniform() * 2.0f - 1.0f);
+        float shipVelY = (dataRng.uniform() * 2.0f - 1.0f);
+        float shipRotation = dataRng.uniform();
 
         // Station relative info
         float stationDx = (STATION_X / 400.0f - shipX);
@@ -41,16 +135,15 @@ std::vector<TrainingExample> TrainingManager::generateBatchData(int numExamples)
         float stationAngle = std::atan2(stationDy, stationDx) / 3.14159f;
 
         // Bullet info (random closest bullet)
-        float closestBulletDist = dist(rng) * 2.0f;
-        float closestBulletAngle = (dist(rng) * 2.0f - 1.0f);
-        float closestBulletVelX = (dist(rng) * 2.0f - 1.0f);
-        float closestBulletVelY = (dist(rng) * 2.0f - 1.0f);
-        float numBullets = dist(rng);
+        float closestBulletDist = dataRng.uniform() * 2.0f;
+        float closestBulletAngle = (dataRng.uniform() * 2.0f - 1.0f);
+        float closestBulletVelX = (dataRng.uniform() * 2.0f - 1.0f);
+        float closestBulletVelY = (dataRng.uniform() * 2.0f - 1.0f);
+        float numBullets = dataRng.uniform();
 
         // Create 12-input example
         TrainingExample example;
-        example.input = Matrix(1, 12);
-        example.input.data[0] = {
+        example.input = Matrix(1, 12, {
             shipX,                      // 0: Ship X
             shipY,                      // 1: Ship Y
             shipVelX,                   // 2: Ship velocity X
@@ -63,7 +156,7 @@ std::vector<TrainingExample> TrainingManager::generateBatchData(int numExamples)
             closestBulletVelX,          // 9: Closest bullet vel X
             closestBulletVelY,          // 10: Closest bullet vel Y
             numBullets                  // 11: Number of bullets
-        };
+        });
 
         // Target 4 outputs: thrust, strafe, rotation, brake
         // IMPORTANT: Sigmoid outputs 0-1, so targets must be 0-1
@@ -105,7 +198,7 @@ std::vector<TrainingExample> TrainingManager::generateBatchData(int numExamples)
 
         // Force balanced rotation in training data
         // 25% forced negative, 25% forced positive, 50% natural
-        float rotationRoll = dist(rng);
+        float rotationRoll = dataRng.uniform();
         if (rotationRoll < 0.25f) {
             rotationRaw = -std::abs(rotationRaw);  // Force negative
             if (rotationRaw > -0.3f) rotationRaw = -0.5f;
@@ -120,13 +213,12 @@ std::vector<TrainingExample> TrainingManager::generateBatchData(int numExamples)
         float targetThrustTanh = targetThrust * 2.0f - 1.0f;  // 0-1 -> -1 to +1
         float targetBrakeTanh = targetBrake * 2.0f - 1.0f;    // 0-1 -> -1 to +1
 
-        example.target = Matrix(1, 4);
-        example.target.data[0] = {
+        example.target = Matrix(1, 4, {
             std::max(-1.0f, std::min(1.0f, targetThrustTanh)),   // -1 to +1 (tanh)
             std::max(-1.0f, std::min(1.0f, strafeRaw)),          // -1 to +1 (tanh)
             std::max(-1.0f, std::min(1.0f, rotationRaw)),        // -1 to +1 (tanh)
             std::max(-1.0f, std::min(1.0f, targetBrakeTanh))     // -1 to +1 (tanh)
-        };
+        });
 
         examples.push_back(example);
     }
@@ -134,7 +226,8 @@ std::vector<TrainingExample> TrainingManager::generateBatchData(int numExamples)
     return examples;
 }
 
-void TrainingManager::initializeTrainingState()
+template <typename Network>
+void TrainingManager<Network>::initializeTrainingState()
 {
     // Check if model already exists
     std::ifstream modelCheck("trained_model.nn");
@@ -144,6 +237,16 @@ void TrainingManager::initializeTrainingState()
     if (modelExists) {
         std::cout << "Found existing trained model. Loading and continuing training...\n" << std::endl;
         network->loadModel("trained_model.nn");
+
+        // Pick up momentum / moment estimates where the last session left them
+        if (optimizer.settings().type != Optimizer::Type::SGD) {
+            if (loadOptimizerState(optimizer, "trained_model.nn.opt", network)) {
+                std::cout << "Resuming " << Optimizer::name(optimizer.settings().type) << " state after "
+                          << optimizer.steps() << " steps.\n" << std::endl;
+            } else {
+                std::cout << "No matching optimizer state found; moments start from zero.\n" << std::endl;
+            }
+        }
     } else {
         std::cout << "No existing model found. Starting fresh training...\n" << std::endl;
     }
@@ -151,9 +254,12 @@ void TrainingManager::initializeTrainingState()
     std::cout << "Configuration:" << std::endl;
     std::cout << "  Training duration: " << TRAINING_TIME_SECONDS << " seconds" << std::endl;
     std::cout << "  Examples per batch: " << EXAMPLES_PER_BATCH << std::endl;
-    std::cout << "  Learning rate: " << LEARNING_RATE << std::endl;
+    std::cout << "  Optimizer: " << Optimizer::name(optimizer.settings().type)
+              << ", learning rate " << optimizer.settings().learningRate << std::endl;
     std::cout << "  Progress update: every " << DISPLAY_INTERVAL_BATCHES << " batches" << std::endl;
-    std::cout << "  Validation: " << VALIDATION_REQUIRED_WINS << "/" << VALIDATION_TESTS << " wins required to save" << std::endl;
+    std::cout << "  Validation: sequential test, win rate " << acceptanceTest.nullWinRate << " vs "
+              << acceptanceTest.altWinRate << " (alpha " << acceptanceTest.alpha << ", beta " << acceptanceTest.beta
+              << "), at most " << acceptanceTest.maxEpisodes << " episodes" << std::endl;
     std::cout << "======================================" << std::endl;
     std::cout << "  Press 'Q' to stop and save best model" << std::endl;
     std::cout << "======================================\n" << std::endl;
@@ -172,7 +278,7 @@ void TrainingManager::initializeTrainingState()
                 std::string line;
                 float lastBestLoss = std::numeric_limits<float>::max();
                 while (std::getline(readLog, line)) {
-                    if (line.empty() || line[0] == 'B' || line[0] == '-') continue;
+                    if (line.empty() || line[0] == 'B' || line[0] == '-' || line[0] == 'V') continue;
 
                     size_t pos1 = line.find(',');
                     size_t pos2 = line.find(',', pos1 + 1);
@@ -194,7 +300,8 @@ void TrainingManager::initializeTrainingState()
     }
 }
 
-void TrainingManager::logBatchProgress(float batchLoss, float validationLoss, float improvement)
+template <typename Network>
+void TrainingManager<Network>::logBatchProgress(float batchLoss, float validationLoss, float improvement)
 {
     std::ofstream logFile(TRAINING_LOG_FILE, std::ios::app);
     if (logFile.is_open()) {
@@ -204,24 +311,53 @@ void TrainingManager::logBatchProgress(float batchLoss, float validationLoss, fl
     }
 }
 
-void TrainingManager::loadBestModel()
+template <typename Network>
+void TrainingManager<Network>::logValidation(const SequentialTest& test)
 {
-    if (std::ifstream(BEST_MODEL_FILE).good()) {
-        network->loadModel(BEST_MODEL_FILE, false);
+    std::ofstream logFile(TRAINING_LOG_FILE, std::ios::app);
+    if (logFile.is_open()) {
+        logFile << "Validation," << totalBatches << "," << test.wins() << "," << test.episodes() << ","
+                << SequentialTest::decisionName(test.decision()) << std::endl;
     }
 }
 
-void TrainingManager::updateBestModel(float validationLoss)
+template <typename Network>
+void TrainingManager<Network>::loadBestModel()
+{
+    if (bestSnapshot) {
+        // The moments and step count go back with the weights, or a stateful
+        // optimizer keeps stepping from state the weights no longer match
+        network->copyParametersFrom(*bestSnapshot);
+        optimizer = bestOptimizer;
+    }
+}
+
+template <typename Network>
+void TrainingManager<Network>::updateBestModel(float validationLoss)
 {
     if (validationLoss < bestLoss) {
-        network->saveModel(BEST_MODEL_FILE, false);
+        saveBestModel();
+    }
+}
+
+template <typename Network>
+void TrainingManager<Network>::saveBestModel()
+{
+    if (bestSnapshot) {
+        bestSnapshot->copyParametersFrom(*network);
+    } else {
+        bestSnapshot.reset(new Network(*network));
     }
+    bestOptimizer = optimizer;
+    hasBestOptimizer = optimizer.hasState();
+    saveCheckpoint(BEST_MODEL_FILE);
 }
 
-float TrainingManager::simulateGameFitness(int simulationFrames)
+template <typename Network>
+float TrainingManager<Network>::simulateGameFitness(int simulationFrames)
 {
     // Use shared GameLogic for consistent behavior with game mode
-    SimulationResult result = GameLogic::runSimulation(network, simulationFrames);
+    SimulationResult result = GameLogic::runSimulation(network, simulationFrames, runSeed, nextEpisode++);
 
     // Store results for reporting
     lastSimWon = result.won;
@@ -230,27 +366,44 @@ float TrainingManager::simulateGameFitness(int simulationFrames)
     return result.totalLoss;
 }
 
-bool TrainingManager::validateModel(int numTests, int requiredWins, int maxFrames)
+template <typename Network>
+bool TrainingManager<Network>::validateModel(int maxFrames)
 {
-    int wins = 0;
+    // Episodes run a pool-sized round at a time, but the test sees them in
+    // episode order and stops at the first decision, so the outcome depends only
+    // on the episode indices; episodes played past the decision are ignored
+    SequentialTest test(acceptanceTest);
+    int roundSize = ThreadPool::shared().size();
+    std::vector<SimulationResult> results;
     int hits = 0;
     float totalLoss = 0.0f;
-
-    for (int i = 0; i < numTests; ++i) {
-        SimulationResult result = GameLogic::runSimulation(network, maxFrames);
-        if (result.won) wins++;
-        if (result.hit) hits++;
-        totalLoss += result.totalLoss;
+    while (!test.decided()) {
+        int count = std::min(roundSize, test.settings().maxEpisodes - test.episodes());
+        GameLogic::runSimulations(network, maxFrames, runSeed, nextEpisode, count, results);
+        nextEpisode += count;
+
+        for (const SimulationResult& result : results) {
+            if (result.hit) hits++;
+            totalLoss += result.totalLoss;
+            if (test.addResult(result.won) != SequentialTest::Decision::Continue) {
+                break;
+            }
+        }
     }
 
-    float avgLoss = totalLoss / numTests;
-    std::cout << "  Validation: " << wins << "/" << numTests << " wins, "
-              << hits << " hits, avg loss: " << std::fixed << std::setprecision(2) << avgLoss;
+    validationDecisions++;
+    validationEpisodes += test.episodes();
+    float avgLoss = totalLoss / test.episodes();
+    std::cout << "  Validation: " << test.wins() << "/" << test.episodes() << " wins, "
+              << hits << " hits, avg loss: " << std::fixed << std::setprecision(2) << avgLoss
+              << " (" << SequentialTest::decisionName(test.decision()) << ")";
+    logValidation(test);
 
-    return wins >= requiredWins;
+    return test.decision() == SequentialTest::Decision::Accept;
 }
 
-void TrainingManager::train()
+template <typename Network>
+void TrainingManager<Network>::train()
 {
     std::cout << "\n========================================" << std::endl;
     std::cout << "  Continuous Neural Network Training" << std::endl;
@@ -259,9 +412,44 @@ void TrainingManager::train()
 
     initializeTrainingState();
 
+    // A best model left by an earlier session is where every batch starts from
+    if (std::ifstream(BEST_MODEL_FILE).good()) {
+        bestSnapshot.reset(new Network(*network));
+        if (bestSnapshot->loadModel(BEST_MODEL_FILE, false)) {
+            bestOptimizer = optimizer;
+            hasBestOptimizer = loadOptimizerState(bestOptimizer, BEST_MODEL_FILE + ".opt", network);
+        } else {
+            bestSnapshot.reset();
+        }
+    }
+
     // Generate validation set
     std::vector<TrainingExample> validationSet = generateBatchData(EXAMPLES_PER_BATCH / 5);
 
+    // Hogwild workers apply their own shards' steps, which has no place for a
+    // stateful optimizer's whole-batch moments
+    bool hogwild = hogwildTraining;
+    if (hogwild && optimizer.settings().type != Optimizer::Type::SGD) {
+        std::cout << "Hogwild training needs the sgd optimizer; using synchronous updates with "
+                  << Optimizer::name(optimizer.settings().type) << ".\n";
+        hogwild = false;
+    }
+    std::unique_ptr<ParallelTrainer> parallel;
+    if (trainingWorkers != 1) {
+        parallel = makeParallelTrainer(network, trainingWorkers, hogwild);
+    }
+    double oneWorkerRate = 0.0;
+    if (parallel) {
+        std::cout << "Training on " << parallel->workerCount() << " workers ("
+                  << ParallelTrainer::modeName(parallel->mode()) << " updates)\n";
+        oneWorkerRate = parallel->reportScaling(generateBatchData(EXAMPLES_PER_BATCH),
+                                                optimizer.settings().learningRate, std::cout);
+        std::cout << std::endl;
+    }
+    // Hogwild workers keep training while this thread validates, so the network
+    // is only stable (and only restored or simulated) after synchronize()
+    bool asynchronous = parallel && parallel->mode() == ParallelTrainer::Mode::Hogwild;
+
     auto startTime = std::chrono::high_resolution_clock::now();
     auto lastDisplayTime = startTime;
 
@@ -284,14 +472,19 @@ void TrainingManager::train()
             break;
         }
 
-        // Load best model at start of each batch
-        loadBestModel();
+        // Load best model at start of each batch. Hogwild workers are still on
+        // the batches before, so there it happens after each game evaluation.
+        if (!asynchronous || totalBatches % GAME_EVALUATION_INTERVAL == 0) {
+            loadBestModel();
+        }
 
         // Run a training batch
         totalBatches++;
         std::vector<TrainingExample> batchData = generateBatchData(EXAMPLES_PER_BATCH);
-        float batchLoss = network->trainBatch(batchData, LEARNING_RATE);
-        float validationLoss = network->calculateLoss(validationSet);
+        float batchLoss = trainOnBatch(network, parallel.get(), batchData, optimizer);
+        // Hogwild: on the weights as they are, without waiting for the workers
+        float validationLoss = parallel ? parallel->calculateLoss(validationSet)
+                                        : network->calculateLoss(validationSet);
 
         float improvement = 0.0f;
         std::string evalMethod = "Valid";
@@ -299,14 +492,17 @@ void TrainingManager::train()
         bool showGameFitness = false;
 
         // Periodically evaluate using actual game simulation
-        if (totalBatches % 100 == 0) {  // Evaluate less often for faster training
+        if (totalBatches % GAME_EVALUATION_INTERVAL == 0) {  // Evaluate less often for faster training
+            if (parallel) {
+                parallel->synchronize();
+            }
             gameFitness = simulateGameFitness(MAX_FRAMES);
             showGameFitness = true;
 
             if (lastSimWon) {
                 // This model won once - but is it consistent?
                 std::cout << "\n*** Single win detected - validating consistency... ***\n";
-                bool isConsistent = validateModel(VALIDATION_TESTS, VALIDATION_REQUIRED_WINS, VALIDATION_MAX_FRAMES);
+                bool isConsistent = validateModel(VALIDATION_MAX_FRAMES);
 
                 if (isConsistent) {
                     std::cout << " - PASSED!\n";
@@ -314,10 +510,11 @@ void TrainingManager::train()
                         // First validated winning model
                         std::cout << "*** FIRST VALIDATED WIN! Saving model. ***\n";
                         hasWinningModel = true;
+                        firstWinBatch = totalBatches;
                         bestWinLoss = gameFitness;
                         bestLoss = gameFitness;
                         bestBatch = totalBatches;
-                        network->saveModel("best_model.nn", false);
+                        saveBestModel();
                         improvement = 1.0f;
                         evalMethod = "VALIDATED WIN (first!)";
                     } else if (gameFitness < bestWinLoss) {
@@ -327,7 +524,7 @@ void TrainingManager::train()
                         bestWinLoss = gameFitness;
                         bestLoss = gameFitness;
                         bestBatch = totalBatches;
-                        network->saveModel("best_model.nn", false);
+                        saveBestModel();
                         evalMethod = "VALIDATED WIN (better)";
                     } else {
                         evalMethod = "VALIDATED WIN (not best)";
@@ -342,7 +539,7 @@ void TrainingManager::train()
                     improvement = bestLoss - gameFitness;
                     bestLoss = gameFitness;
                     bestBatch = totalBatches;
-                    network->saveModel("best_model.nn", false);
+                    saveBestModel();
                     evalMethod = "Game (no win yet)";
                 }
             }
@@ -395,6 +592,9 @@ void TrainingManager::train()
         }
     }
 
+    if (parallel) {
+        parallel->synchronize();
+    }
     auto endTime = std::chrono::high_resolution_clock::now();
     auto totalTime = std::chrono::duration_cast<std::chrono::seconds>(endTime - startTime).count();
 
@@ -409,18 +609,49 @@ void TrainingManager::train()
     std::cout << "Total training time: " << totalTime << " seconds" << std::endl;
     std::cout << "Best validation loss: " << std::fixed << std::setprecision(6) << bestLoss << std::endl;
     std::cout << "Best performance at batch: " << bestBatch << std::endl;
+    if (firstWinBatch > 0) {
+        std::cout << "First validated win at batch: " << firstWinBatch << std::endl;
+    } else {
+        std::cout << "No validated win this session" << std::endl;
+    }
     std::cout << "Average batches per second: " << (totalBatches / static_cast<float>(totalTime)) << std::endl;
+    if (parallel) {
+        // Scaling as this session's training actually ran, against the one-worker rate measured at the start
+        double rate = parallel->throughput();
+        double speedup = oneWorkerRate > 0.0 ? rate / oneWorkerRate : 0.0;
+        std::cout << "Parallel training: " << std::setprecision(0) << rate << " examples/s on "
+                  << parallel->workerCount() << " workers (" << ParallelTrainer::modeName(parallel->mode())
+                  << "), speedup " << std::setprecision(2) << speedup << "x, efficiency " << std::setprecision(0)
+                  << 100.0 * speedup / parallel->workerCount() << "%" << std::endl;
+    }
+    if (validationDecisions > 0) {
+        std::cout << "Validation decisions: " << validationDecisions << ", " << std::setprecision(1)
+                  << (validationEpisodes / static_cast<float>(validationDecisions)) << " episodes each on average"
+                  << std::endl;
+    }
     std::cout << "=======================================\n" << std::endl;
 
     // Save the best model as the final trained model
-    if (std::ifstream(BEST_MODEL_FILE).good()) {
-        // Load the best model and save it as trained_model.nn
-        network->loadModel(BEST_MODEL_FILE, false);
-        network->saveModel("trained_model.nn");
+    bool fromBest = bestSnapshot != nullptr;
+    if (fromBest) {
+        network->copyParametersFrom(*bestSnapshot);
+        if (hasBestOptimizer) {
+            optimizer = bestOptimizer;
+        }
+    }
+    saveCheckpoint("trained_model.nn");
+    modelWriter.flush();
+
+    std::cout << "Checkpoint files: " << modelWriter.completedWrites() << " written, "
+              << modelWriter.coalescedWrites() << " superseded before reaching disk" << std::endl;
+    if (modelWriter.failedWrites() > 0) {
+        std::cerr << "Error: " << modelWriter.failedWrites() << " checkpoint file(s) could not be written" << std::endl;
+    } else if (fromBest) {
         std::cout << "Best winning model saved as trained_model.nn!" << std::endl;
     } else {
-        // No best model found, save current network
-        network->saveModel("trained_model.nn");
         std::cout << "Current model saved as trained_model.nn" << std::endl;
     }
 }
+
+template class TrainingManager<NeuralNetwork>;
+template class TrainingManager<ProductionNetwork>;
@@ -0,0 +1,216 @@
+#include "VecSimulation.h"
+#include "NeuroEvolution.h"
+#include "QuantizedNetwork.h"
+#include "StaticNetwork.h"
+#include <algorithm>
+#include <cmath>
+
+template <typename Network>
+VecSimulation<Network>::VecSimulation(Network* network, int maxFrames, int lanes)
+    : network(network), maxFrames(maxFrames), lanes(std::max(1, lanes)), settings(GameLogic::shipSettings()),
+      bullets(this->lanes, GameLogic::bulletCapacity(maxFrames)) {
+    posX.resize(this->lanes);
+    posY.resize(this->lanes);
+    velX.resize(this->lanes);
+    velY.resize(this->lanes);
+    rotation.resize(this->lanes);
+    fireCounter.resize(this->lanes);
+    frame.resize(this->lanes);
+    totalLoss.resize(this->lanes);
+    previousDistance.resize(this->lanes);
+    closestDistance.resize(this->lanes);
+    slot.assign(this->lanes, -1);
+    scans.resize(this->lanes);
+    flying.resize(this->lanes);
+    stepping.reserve(this->lanes);
+    encoding.resize(this->lanes);
+    states.resize(static_cast<size_t>(this->lanes) * GameLogic::INPUT_COUNT);
+    actions.resize(static_cast<size_t>(this->lanes) * GameLogic::OUTPUT_COUNT);
+    thrust.resize(this->lanes);
+    strafe.resize(this->lanes);
+    turn.resize(this->lanes);
+    brake.resize(this->lanes);
+}
+
+template <typename Network>
+void VecSimulation<Network>::run(uint64_t runSeed, uint64_t firstEpisode, int count,
+                                 std::vector<SimulationResult>& results) {
+    results.resize(count);
+    run(runSeed, firstEpisode, count, results.data());
+}
+
+template <typename Network>
+void VecSimulation<Network>::run(uint64_t runSeed, uint64_t firstEpisode, int count, SimulationResult* results) {
+    batches = 0;
+    rows = 0;
+    int next = 0;
+    int active = 0;
+    for (int lane = 0; lane < lanes; ++lane) {
+        slot[lane] = -1;
+    }
+
+    while (true) {
+        // Refill idle lanes. An episode with no frames to play is scored on the spot.
+        for (int lane = 0; lane < lanes && next < count; ++lane) {
+            while (slot[lane] < 0 && next < count) {
+                startEpisode(lane, next++, runSeed, firstEpisode);
+                if (maxFrames <= 0) {
+                    finishEpisode(lane, false, false, results);
+                } else {
+                    ++active;
+                }
+            }
+        }
+        if (active == 0) {
+            break;
+        }
+
+        // The station fires at every live ship, then one pass moves and
+        // measures every lane's bullets
+        for (int lane = 0; lane < lanes; ++lane) {
+            flying[lane] = slot[lane] >= 0;
+            if (!flying[lane]) {
+                continue;
+            }
+            fireCounter[lane]++;
+            if (fireCounter[lane] > BULLET_FIRE_RATE) {
+                double shipX = posX[lane];
+                double shipY = posY[lane];
+                double distance = std::sqrt(
+                    (shipX - STATION_X) * (shipX - STATION_X) +
+                    (shipY - STATION_Y) * (shipY - STATION_Y)
+                );
+                if (distance > SAFE_ZONE_RADIUS) {
+                    float bulletVelX, bulletVelY;
+                    if (GameLogic::aimAtShip(shipX, shipY, velX[lane], velY[lane], bulletVelX, bulletVelY)) {
+                        bullets.add(lane, STATION_X, STATION_Y, bulletVelX, bulletVelY, BULLET_LIFETIME);
+                    }
+                    fireCounter[lane] = 0;
+                }
+            }
+        }
+        bullets.scan(posX.data(), posY.data(), flying.data(), scans.data());
+
+        // Hits end episodes, survivors encode their inputs
+        stepping.clear();
+        for (int lane = 0; lane < lanes; ++lane) {
+            if (!flying[lane]) {
+                continue;
+            }
+            const BulletField::Scan& scan = scans[lane];
+            if (scan.hit) {
+                finishEpisode(lane, false, true, results);
+                flying[lane] = 0;
+                --active;
+                continue;
+            }
+
+            // Gather the lane's encoder inputs into row order; encoding is one pass below
+            int row = static_cast<int>(stepping.size());
+            encoding.shipX[row] = posX[lane];
+            encoding.shipY[row] = posY[lane];
+            encoding.velX[row] = velX[lane];
+            encoding.velY[row] = velY[lane];
+            encoding.rotation[row] = rotation[lane];
+            encoding.bulletCount[row] = bullets.size(lane);
+            encoding.found[row] = scan.nearest >= 0;
+            if (scan.nearest >= 0) {
+                encoding.bulletX[row] = bullets.x(lane, scan.nearest);
+                encoding.bulletY[row] = bullets.y(lane, scan.nearest);
+                encoding.bulletVelX[row] = bullets.velX(lane, scan.nearest);
+                encoding.bulletVelY[row] = bullets.velY(lane, scan.nearest);
+                encoding.bulletDistanceSquared[row] = scan.nearestDistanceSquared;
+            }
+            stepping.push_back(lane);
+        }
+        if (stepping.empty()) {
+            continue;
+        }
+        GameLogic::buildInputs(encoding, static_cast<int>(stepping.size()), states.data());
+
+        // One forward pass for every ship still flying
+        network->predictBatch(states.data(), stepping.size(), actions.data());
+        ++batches;
+        rows += static_cast<long long>(stepping.size());
+
+        // Fly every ship not hit in one pass across the lanes, then score them
+        int flyingCount = static_cast<int>(stepping.size());
+        for (int row = 0; row < flyingCount; ++row) {
+            int lane = stepping[row];
+            ShipPhysics::Command command = GameLogic::shipCommand(
+                GameLogic::decodeOutputs(actions.data() + row * GameLogic::OUTPUT_COUNT));
+            thrust[lane] = command.thrust;
+            strafe[lane] = command.strafe;
+            turn[lane] = command.turn;
+            brake[lane] = command.brake;
+        }
+        ShipArrays ships = {posX.data(), posY.data(), velX.data(), velY.data(), rotation.data()};
+        ShipPhysics::CommandArrays commands = {thrust.data(), strafe.data(), turn.data(), brake.data()};
+        ShipPhysics::step(ships, commands, flying.data(), lanes, settings);
+
+        for (int row = 0; row < flyingCount; ++row) {
+            int lane = stepping[row];
+            double shipX = posX[lane];
+            double shipY = posY[lane];
+
+            double dx = STATION_X - shipX;
+            double dy = STATION_Y - shipY;
+            float currentDistance = std::sqrt(dx * dx + dy * dy);
+
+            totalLoss[lane] += 0.15f;
+            float distanceChange = currentDistance - previousDistance[lane];
+            totalLoss[lane] += distanceChange * 0.2f;
+
+            if (currentDistance < closestDistance[lane]) {
+                closestDistance[lane] = currentDistance;
+            }
+
+            if (currentDistance < 50.0f) {
+                totalLoss[lane] -= 100.0f;
+                finishEpisode(lane, true, false, results);
+                --active;
+                continue;
+            }
+
+            previousDistance[lane] = currentDistance;
+            if (++frame[lane] >= maxFrames) {
+                finishEpisode(lane, false, false, results);
+                --active;
+            }
+        }
+    }
+}
+
+template <typename Network>
+void VecSimulation<Network>::startEpisode(int lane, int index, uint64_t runSeed, uint64_t firstEpisode) {
+    double startX, startY;
+    GameLogic::startPosition(runSeed, firstEpisode + index, startX, startY);
+
+    posX[lane] = static_cast<float>(startX);
+    posY[lane] = static_cast<float>(startY);
+    velX[lane] = 0.0f;
+    velY[lane] = 0.0f;
+    rotation[lane] = 0;
+    fireCounter[lane] = 0;
+    frame[lane] = 0;
+    totalLoss[lane] = 0.0f;
+    previousDistance[lane] = std::sqrt(
+        (STATION_X - startX) * (STATION_X - startX) +
+        (STATION_Y - startY) * (STATION_Y - startY)
+    );
+    closestDistance[lane] = previousDistance[lane];
+    bullets.clear(lane);  // keeps its capacity for the next episode
+    slot[lane] = index;
+}
+
+template <typename Network>
+void VecSimulation<Network>::finishEpisode(int lane, bool won, bool hit, SimulationResult* results) {
+    results[slot[lane]] = GameLogic::scoreEpisode(won, hit, totalLoss[lane], closestDistance[lane],
+                                                  previousDistance[lane], frame[lane]);
+    slot[lane] = -1;
+}
+
+template class VecSimulation<NeuralNetwork>;
+template class VecSimulation<ProductionNetwork>;
+template class VecSimulation<QuantizedNetwork>;
+template class VecSimulation<NeuroEvolution::Member>;
@@ -1,31 +1,6 @@
 #include "Vector2D.h"
 #include <cmath>
 
-Vector2D::Vector2D() {
-    x = 0;
-    y = 0;
-}
-
-Vector2D::Vector2D(double x, double y) {
-    this->x = x;
-    this->y = y;
-}
-
-void Vector2D::add(const Vector2D vector) {
-    double vx = vector.getX();
-    double vy = vector.getY();
-    x += vx;
-    y += vy;
-}
-
-double Vector2D::getX() const {
-    return x;
-}
-
-double Vector2D::getY() const {
-    return y;
-}
-
 bool Vector2D::equals(const Vector2D other) const {
     if (getX() != other.getX()){
         return false;
@@ -9,27 +9,40 @@
 #include <algorithm>
 #include <chrono>
 #include <string>
+#include <cstdlib>
 #include "SpaceShip.h"
 #include "SpaceStation.h"
-#include "Bullet.h"
+#include "BulletField.h"
 #include "NeuralNetwork.h"
+#include "MappedNetwork.h"
 #include "TrainingManager.h"
+#include "NeuroEvolution.h"
 #include "GameWindow.h"
+#include "Benchmark.h"
+#include "QuantizedNetwork.h"
 
 // ========== GAME CONFIGURATION ==========
 const int WINDOW_WIDTH = 800;
 const int WINDOW_HEIGHT = 600;
 const int STATION_X = WINDOW_WIDTH / 2;
 const int STATION_Y = WINDOW_HEIGHT / 2;
+const int MAX_FRAMES = 5000;
+const int BULLET_FIRE_RATE = 20;
+const float BULLET_SPEED = 3.0f;
+// Frames a bullet lives: long enough to fly from the station to the side edges.
+// Bullets wrap like training's, so without this they would stay forever.
+const int BULLET_LIFETIME = static_cast<int>(WINDOW_WIDTH / 2 / BULLET_SPEED);
 
 // ========== GAME STATE ==========
 SpaceShip ship;
 SpaceStation station(STATION_X, STATION_Y);
-std::vector<Bullet> enemyBullets;
+// Same pool and bullet pass as training; sized for the bullets BULLET_LIFETIME
+// lets live at once, so a game never fills it
+BulletField enemyBullets(WINDOW_WIDTH, WINDOW_HEIGHT, (BULLET_LIFETIME + 1) / (BULLET_FIRE_RATE + 1) + 1);
+// Last bullet pass: its nearest bullet is the one the next frame's sensors report
+BulletField::Scan bulletScan = {false, -1, 0.0f};
 NeuralNetwork* aiController = nullptr;
 int bulletFireCounter = 0;  // Match training simulation counter
-const int BULLET_FIRE_RATE = 20;
-const float BULLET_SPEED = 3.0f;
 
 // Ship position is now stored in the ship object
 // These are updated from ship.getPosition() for convenience
@@ -68,34 +81,14 @@ void updateShipPosition()
 
 void updateEnemyBullets()
 {
-    // Update all bullets
-    for (auto& bullet : enemyBullets) {
-        bullet.update();
-
-        // Check collision with ship
-        Vector2D shipPos(playerX, playerY);
-        Vector2D bulletPos = bullet.getPosition();
-        double dx = bulletPos.getX() - shipPos.getX();
-        double dy = bulletPos.getY() - shipPos.getY();
-        double distance = std::sqrt(dx * dx + dy * dy);
-
-        if (distance < 20.0) {
-            gameLost = true;
-            gameStatus = "LOST - Hit by bullet!";
-            gameRunning = false;
-        }
+    // Move, wrap and collide every bullet in one pass (SAME AS TRAINING);
+    // bullets whose lifetime is over are despawned by the same call
+    bulletScan = enemyBullets.scan(static_cast<float>(playerX), static_cast<float>(playerY));
+    if (bulletScan.hit) {
+        gameLost = true;
+        gameStatus = "LOST - Hit by bullet!";
+        gameRunning = false;
     }
-
-    // Remove off-screen bullets
-    enemyBullets.erase(
-        std::remove_if(enemyBullets.begin(), enemyBullets.end(),
-            [](const Bullet& b) {
-                Vector2D pos = b.getPosition();
-                return pos.getX() < -50 || pos.getX() > WINDOW_WIDTH + 50 ||
-                       pos.getY() < -50 || pos.getY() > WINDOW_HEIGHT + 50;
-            }),
-        enemyBullets.end()
-    );
 }
 
 void updateStationFire()
@@ -112,9 +105,8 @@ void updateStationFire()
             double vx = (dx / distance) * BULLET_SPEED;
             double vy = (dy / distance) * BULLET_SPEED;
 
-            Vector2D stationPos(STATION_X, STATION_Y);
-            Vector2D bulletVel(vx, vy);
-            enemyBullets.push_back(Bullet(stationPos, bulletVel, &ship));
+            enemyBullets.add(static_cast<float>(STATION_X), static_cast<float>(STATION_Y),
+                             static_cast<float>(vx), static_cast<float>(vy), BULLET_LIFETIME);
         }
 
         bulletFireCounter = 0;
@@ -174,17 +166,48 @@ void processAIAction(float thrustVal, float strafeVal, float rotationVal, float
     }
 }
 
-void runGameMode()
+// modelFile picks the .nn controller; empty
+// means best_model.nn, then trained_model.nn
+void runGameMode(const std::string& modelFile)
 {
     std::cout << "\n---------------------------------------" << std::endl;
     std::cout << "|         SPACE STATION GAME             |" << std::endl;
     std::cout << "|    AI Goal: Reach the Space Station    |" << std::endl;
     std::cout << "---------------------------------------\n" << std::endl;
 
-    // Load best model (most up-to-date during training)
-    if (!aiController->loadModel("best_model.nn")) {
+    // Fly from the mapped model file when it can be mapped: the weights are
+    // used in place, read only. Version 1 files, which cannot be mapped, are
+    // loaded into aiController instead.
+    MappedNetwork mappedController;
+    auto loadController = [&](const std::string& filename) {
+        if (mappedController.open(filename, true, false)) {
+            if (mappedController.inputSize() == 12 && mappedController.outputSize() == 4) {
+                return true;
+            }
+            mappedController.close();
+        }
+        return aiController->loadModel(filename);
+    };
+
+    // A .qnn file is a size-only storage format (see QuantizedNetwork.h), not a
+    // controller: its inference is slower than fp32 and it loses win rate
+    auto isQuantizedFile = [](const std::string& filename) {
+        return filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".qnn") == 0;
+    };
+
+    // Load the model asked for, else the best model (most up-to-date during training)
+    if (!modelFile.empty() && isQuantizedFile(modelFile)) {
+        std::cout << "Warning: " << modelFile << " is a quantized model, which game mode does not fly. "
+                  << "Using untrained network." << std::endl;
+    } else if (!modelFile.empty()) {
+        if (loadController(modelFile)) {
+            std::cout << "Loaded " << modelFile << std::endl;
+        } else {
+            std::cout << "Warning: Could not load " << modelFile << ". Using untrained network." << std::endl;
+        }
+    } else if (!loadController("best_model.nn")) {
         // Fall back to trained_model.nn if best_model doesn't exist
-        if (!aiController->loadModel("trained_model.nn")) {
+        if (!loadController("trained_model.nn")) {
             std::cout << "Warning: Could not load any model. Using untrained network." << std::endl;
         } else {
             std::cout << "Loaded trained_model.nn" << std::endl;
@@ -237,6 +260,7 @@ void runGameMode()
     playerX = startX;
     playerY = startY;
     enemyBullets.clear();  // Clear any bullets
+    bulletScan = {false, -1, 0.0f};
     bulletFireCounter = 0;  // Reset fire counter (same as training starts at 0)
     gameRunning = true;
     gameWon = false;
@@ -261,7 +285,6 @@ void runGameMode()
     }
 
     int frameCount = 0;
-    const int MAX_FRAMES = 5000;
 
     while (gameRunning && frameCount < MAX_FRAMES && window.isOpen()) {
         frameCount++;
@@ -278,31 +301,25 @@ void runGameMode()
         float stationDistance = std::sqrt(stationDx * stationDx + stationDy * stationDy);
         float stationAngle = std::atan2(stationDy, stationDx);  // Absolute angle (same as training)
 
-        // Find closest bullet
-        float closestBulletDistance = 1000.0f;
+        // Closest bullet: last frame's pass already found it, measured from
+        // where the ship still is (one sqrt and one atan2, same as training)
+        float closestBulletDistance = BulletField::NEAREST_RANGE;
         float closestBulletAngle = 0.0f;
         float closestBulletVelX = 0.0f;
         float closestBulletVelY = 0.0f;
 
-        for (const auto& bullet : enemyBullets) {
-            Vector2D bPos = bullet.getPosition();
-            double bdx = bPos.getX() - playerX;
-            double bdy = bPos.getY() - playerY;
-            float bDist = std::sqrt(bdx * bdx + bdy * bdy);
-
-            if (bDist < closestBulletDistance) {
-                closestBulletDistance = bDist;
-                closestBulletAngle = std::atan2(bdy, bdx);  // Absolute angle (same as training)
-                Vector2D bVel = bullet.getVelocity();
-                closestBulletVelX = bVel.getX();
-                closestBulletVelY = bVel.getY();
-            }
+        if (bulletScan.nearest >= 0) {
+            float bdx = enemyBullets.x(bulletScan.nearest) - static_cast<float>(playerX);
+            float bdy = enemyBullets.y(bulletScan.nearest) - static_cast<float>(playerY);
+            closestBulletDistance = std::sqrt(bulletScan.nearestDistanceSquared);
+            closestBulletAngle = std::atan2(bdy, bdx);  // Absolute angle (same as training)
+            closestBulletVelX = enemyBullets.velX(bulletScan.nearest);
+            closestBulletVelY = enemyBullets.velY(bulletScan.nearest);
         }
 
         // Build 12-input sensor array (EXACTLY MATCHES TRAINING SIMULATION)
         Vector2D vel = ship.getVelocity();
-        Matrix gameState(1, 12);
-        gameState.data[0] = {
+        float gameState[12] = {
             static_cast<float>(playerX / WINDOW_WIDTH),              // 0: Ship X
             static_cast<float>(playerY / WINDOW_HEIGHT),             // 1: Ship Y
             static_cast<float>(vel.getX() / 10.0f),                  // 2: Ship velocity X
@@ -317,13 +334,18 @@ void runGameMode()
             static_cast<float>(enemyBullets.size() / 10.0f)           // 11: Number of bullets
         };
 
-        Matrix decision = aiController->predict(gameState);
+        float decision[4];
+        if (mappedController.isOpen()) {
+            mappedController.predictInto(gameState, decision);
+        } else {
+            aiController->predictInto(gameState, decision);
+        }
         // Extract 4 outputs: thrust, strafe, rotation, brake
         processAIAction(
-            decision.data[0][0],  // thrust
-            decision.data[0][1],  // strafe
-            decision.data[0][2],  // rotation
-            decision.data[0][3]   // brake
+            decision[0],  // thrust
+            decision[1],  // strafe
+            decision[2],  // rotation
+            decision[3]   // brake
         );
 
         // Update ship physics (same as training)
@@ -369,15 +391,94 @@ void runGameMode()
     std::cout << std::endl;
 }
 
-void runTrainingMode()
+void runTrainingMode(int workers, bool hogwild, const Optimizer::Settings& optimizer)
 {
-    TrainingManager trainer(aiController);
+    TrainingManager<NeuralNetwork> trainer(aiController);
+    trainer.setOptimizer(optimizer);
+    trainer.setParallelTraining(workers, hogwild);
     trainer.train();
 }
 
+void runEvolutionMode(int workers)
+{
+    NeuroEvolution::runSession(*aiController, workers);
+}
+
 // ========== MAIN ==========
 
-int main() {
+// The test build (tests/main.cpp) brings its own main
+#ifndef UNIT_TESTS
+int main(int argc, char* argv[]) {
+    // Developer mode: time the network hot paths and exit (non-zero if a check failed)
+    if (argc > 1 && std::string(argv[1]) == "--benchmark") {
+        return Benchmark::runAll() ? 0 : 1;
+    }
+
+    // Developer mode: write a model (best_model.nn unless named) as an int8 or
+    // fp16 quantized model, <name>.<mode>.qnn. The topology comes from the file.
+    if (argc > 2 && std::string(argv[1]) == "--quantize") {
+        std::string mode = argv[2];
+        if (mode != "int8" && mode != "fp16") {
+            std::cerr << "Usage: --quantize int8|fp16 [model.nn]" << std::endl;
+            return 1;
+        }
+        std::string source = argc > 3 ? argv[3] : "best_model.nn";
+        std::vector<unsigned char> image;
+        std::vector<ModelFormat::LayerBlock> blocks;
+        bool hasActivations;
+        std::string error;
+        if (!ModelFormat::load(source, image, blocks, hasActivations, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+        std::vector<int> sizes = {blocks.front().inputs};
+        for (const auto& block : blocks)
+            sizes.push_back(block.outputs);
+        NeuralNetwork network(sizes);
+        if (!network.loadModel(source)) {
+            return 1;
+        }
+
+        QuantizedNetwork::Precision precision =
+            mode == "int8" ? QuantizedNetwork::Precision::Int8 : QuantizedNetwork::Precision::Float16;
+        QuantizedNetwork quantized = QuantizedNetwork::quantize(network, precision);
+        std::string stem = source.size() > 3 && source.compare(source.size() - 3, 3, ".nn") == 0
+                               ? source.substr(0, source.size() - 3)
+                               : source;
+        return quantized.saveModel(stem + "." + mode + ".qnn") ? 0 : 1;
+    }
+
+    // Training options: --workers N (0 = all hardware threads; supervised
+    // training defaults to 1, evolution to all), --hogwild (sgd only) and
+    // --optimizer sgd|momentum|rmsprop|adam (default sgd; the others are
+    // opt-in until they reach a validated win in fewer batches).
+    // Game option: --model FILE, the .nn model game mode flies.
+    std::string gameModel;
+    int trainingWorkers = 1;
+    int evolutionWorkers = 0;
+    bool hogwild = false;
+    Optimizer::Type optimizerType = Optimizer::Type::SGD;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--workers" && i + 1 < argc) {
+            trainingWorkers = evolutionWorkers = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--model" && i + 1 < argc) {
+            gameModel = argv[++i];
+        } else if (arg == "--hogwild") {
+            hogwild = true;
+        } else if (arg == "--optimizer" && i + 1 < argc) {
+            if (!Optimizer::parse(argv[++i], optimizerType)) {
+                std::cerr << "Usage: --optimizer sgd|momentum|rmsprop|adam" << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (hogwild && optimizerType != Optimizer::Type::SGD) {
+        std::cerr << "Error: --hogwild needs --optimizer sgd (Hogwild workers step without optimizer state)"
+                  << std::endl;
+        return 1;
+    }
+
     std::cout << "\n---------------------------------------" << std::endl;
     std::cout << "|   SPACE STATION AI GAME & TRAINER      |" << std::endl;
     std::cout << "---------------------------------------\n" << std::endl;
@@ -388,7 +489,8 @@ int main() {
     std::cout << "Select mode:" << std::endl;
     std::cout << "1) Training - Train AI to reach station" << std::endl;
     std::cout << "2) Game - Watch trained AI play" << std::endl;
-    std::cout << "Enter choice (1 or 2): ";
+    std::cout << "3) Evolution - Evolve a population on simulated games" << std::endl;
+    std::cout << "Enter choice (1, 2 or 3): ";
 
     int choice;
     std::cin >> choice;
@@ -396,12 +498,14 @@ int main() {
     std::cout << std::endl;
 
     if (choice == 1) {
-        runTrainingMode();
+        runTrainingMode(trainingWorkers, hogwild, Optimizer::defaults(optimizerType));
     } else if (choice == 2) {
-        runGameMode();
+        runGameMode(gameModel);
+    } else if (choice == 3) {
+        runEvolutionMode(evolutionWorkers);
     } else {
         std::cout << "Invalid choice. Running training mode..." << std::endl;
-        runTrainingMode();
+        runTrainingMode(trainingWorkers, hogwild, Optimizer::defaults(optimizerType));
     }
 
     // Cleanup
@@ -410,3 +514,4 @@ int main() {
     std::cout << "Program complete." << std::endl;
     return 0;
 }
+#endif
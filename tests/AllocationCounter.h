@@ -0,0 +1,15 @@
+#pragma once
+
+// Counts every heap allocation made through operator new, on any thread.
+//
+// AllocationCounter.cpp replaces the global operator new / delete (plain,
+// array and aligned forms) with versions that bump one relaxed atomic before
+// calling malloc, so std::vector growth, std::string, thread_local buffers and
+// Matrix storage are all seen. Tests read count() before and after a hot loop
+// to check that it runs allocation-free. It is compiled into the test build
+// only, so the game and trainer keep the standard allocator.
+class AllocationCounter {
+public:
+    // operator new calls since the program started
+    static long long count();
+};
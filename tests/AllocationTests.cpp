@@ -0,0 +1,135 @@
+#include "AllocationCounter.h"
+#include "BulletField.h"
+#include "GameLogic.h"
+#include "GameSettings.h"
+#include "NeuralNetwork.h"
+#include "Optimizer.h"
+#include "StaticNetwork.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Hot paths that must not touch the heap once their workspace or the
+// thread's scratch is sized. Each test makes the first calls uncounted.
+
+namespace {
+
+const int INFERENCE_CALLS = 10000;
+
+struct Shape {
+    const char* name;
+    std::vector<int> sizes;
+    int steps;
+};
+
+const Shape TRAINING_SHAPES[] = {
+    {"{12, 32, 16, 4}", {12, 32, 16, 4}, 1000},
+    {"{12, 512, 512, 4}", {12, 512, 512, 4}, 5},
+};
+
+Matrix makeSampleState(int seed) {
+    Matrix state(1, 12);
+    for (int j = 0; j < state.cols; ++j) {
+        state(0, j) = static_cast<float>((seed * 31 + j * 17) % 100) / 100.0f;
+    }
+    return state;
+}
+
+std::vector<TrainingExample> makeBatch() {
+    std::vector<TrainingExample> batch;
+    for (int i = 0; i < 32; ++i)
+        batch.emplace_back(makeSampleState(i), Matrix(1, 4, {0.5f, -0.5f, 0.25f, -1.0f}));
+    return batch;
+}
+
+// Heap allocations made by `steps` calls of step
+template <typename Step>
+long long countAllocations(int steps, Step step) {
+    long long before = AllocationCounter::count();
+    for (int i = 0; i < steps; ++i)
+        step();
+    return AllocationCounter::count() - before;
+}
+
+// A frame's decisions with bullets on screen, as runSimulation makes them
+template <typename Network>
+long long countDecisions(Network& network) {
+    BulletField bullets(GameLogic::bulletCapacity(MAX_FRAMES));
+    for (int i = 0; i < 20; ++i)
+        bullets.add(STATION_X, STATION_Y, 0.1f * i - 1.0f, 1.0f - 0.05f * i);
+    const ShipPhysics::Settings settings = GameLogic::shipSettings();
+    ShipBody<float> ship = {{100.0f, 100.0f}, {0.0f, 0.0f}, 0};
+    float rotation;
+    BulletField::Scan scan = GameLogic::updateBullets(ship.position.x, ship.position.y, bullets);
+    GameLogic::applyAIDecision(ship, &network, settings, bullets, scan, rotation);
+    return countAllocations(INFERENCE_CALLS, [&] {
+        scan = GameLogic::updateBullets(ship.position.x, ship.position.y, bullets);
+        GameLogic::applyAIDecision(ship, &network, settings, bullets, scan, rotation);
+    });
+}
+
+}
+
+// Every zero below means nothing unless the counter sees ordinary allocations
+TEST(AllocationCounter, CountsOperatorNew) {
+    long long before = AllocationCounter::count();
+    std::unique_ptr<std::vector<float>> probe(new std::vector<float>(64));
+    EXPECT_GE(AllocationCounter::count() - before, 2);
+    EXPECT_EQ((*probe)[0], 0.0f);
+}
+
+TEST(TrainingAllocations, SingleExample) {
+    std::vector<TrainingExample> batch = makeBatch();
+    for (const Shape& shape : TRAINING_SHAPES) {
+        NeuralNetwork network(shape.sizes);
+        network.train(batch[0].input, batch[0].target, 0.01f);
+        EXPECT_EQ(countAllocations(shape.steps, [&] { network.train(batch[0].input, batch[0].target, 0.01f); }), 0)
+            << shape.name;
+    }
+}
+
+TEST(TrainingAllocations, Batches) {
+    std::vector<TrainingExample> batch = makeBatch();
+    for (const Shape& shape : TRAINING_SHAPES) {
+        NeuralNetwork network(shape.sizes);
+        for (auto mode : {NeuralNetwork::BatchMode::MiniBatch, NeuralNetwork::BatchMode::PerSample}) {
+            network.batchMode = mode;
+            network.trainBatch(batch, 0.01f);
+            EXPECT_EQ(countAllocations(shape.steps, [&] { network.trainBatch(batch, 0.01f); }), 0)
+                << shape.name << (mode == NeuralNetwork::BatchMode::MiniBatch ? " mini-batch" : " per-sample");
+        }
+    }
+}
+
+TEST(TrainingAllocations, AdamBatches) {
+    std::vector<TrainingExample> batch = makeBatch();
+    for (const Shape& shape : TRAINING_SHAPES) {
+        NeuralNetwork network(shape.sizes);
+        Optimizer adam(Optimizer::defaults(Optimizer::Type::Adam));
+        network.trainBatch(batch, adam);
+        EXPECT_EQ(countAllocations(shape.steps, [&] { network.trainBatch(batch, adam); }), 0) << shape.name;
+    }
+}
+
+TEST(InferenceAllocations, PredictInto) {
+    Matrix state = makeSampleState(0);
+    float decision[GameLogic::OUTPUT_COUNT];
+    for (const Shape& shape : TRAINING_SHAPES) {
+        NeuralNetwork network(shape.sizes);
+        network.predictInto(state.data(), decision);
+        EXPECT_EQ(countAllocations(INFERENCE_CALLS, [&] { network.predictInto(state.data(), decision); }), 0)
+            << shape.name;
+    }
+
+    ProductionNetwork staticNetwork;
+    staticNetwork.predictInto(state.data(), decision);
+    EXPECT_EQ(countAllocations(INFERENCE_CALLS, [&] { staticNetwork.predictInto(state.data(), decision); }), 0);
+}
+
+TEST(InferenceAllocations, ApplyAIDecision) {
+    NeuralNetwork network({12, 32, 16, 4});
+    EXPECT_EQ(countDecisions(network), 0);
+    ProductionNetwork staticNetwork;
+    EXPECT_EQ(countDecisions(staticNetwork), 0);
+}
@@ -0,0 +1,7 @@
+#include <gtest/gtest.h>
+
+// source/main.cpp is built with UNIT_TESTS defined, which leaves its main() out
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}